@@ -0,0 +1,6 @@
+-- Binary galaxy snapshots: packed systems/lanes/anomalies with a string table (see galaxy_snapshot.h)
+ALTER TABLE public.saves
+    ADD COLUMN IF NOT EXISTS snapshot BYTEA NULL;
+
+COMMENT ON COLUMN public.saves.snapshot IS 'Versioned binary galaxy snapshot (optionally zstd); save_data then only holds a small descriptor';
+COMMENT ON COLUMN public.saves.version IS 'Application save schema version: 1 = JSON in save_data, 2 = binary snapshot';
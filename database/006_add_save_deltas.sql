@@ -0,0 +1,15 @@
+-- Append-only log of game edits against a save's snapshot (see galaxy_snapshot.h).
+-- Writing a new snapshot (or a JSON save) clears the slot's log.
+CREATE TABLE IF NOT EXISTS public.save_deltas (
+    save_id UUID NOT NULL REFERENCES public.saves(id) ON DELETE CASCADE,
+    sequence INTEGER NOT NULL,
+    delta BYTEA NOT NULL,
+    created_at TIMESTAMPTZ NOT NULL DEFAULT NOW(),
+    PRIMARY KEY (save_id, sequence)
+);
+
+ALTER TABLE public.saves
+    ADD COLUMN IF NOT EXISTS delta_count INTEGER NOT NULL DEFAULT 0;
+
+COMMENT ON TABLE public.save_deltas IS 'Binary galaxy edit deltas, replayed in sequence order onto saves.snapshot when loading';
+COMMENT ON COLUMN public.saves.delta_count IS 'Deltas appended since the snapshot was last written; the last used save_deltas.sequence';
@@ -6,7 +6,7 @@ export class GalaxyApiService {
   static async listSaves(): Promise<
     Array<{ id: string; save_slot: number; created_at: string; updated_at: string }>
   > {
-    const resp = await fetch(`${API_BASE_URL}/api/saves`)
+    const resp = await fetch(`${API_BASE_URL}/api/saves?summary=true`)
     if (!resp.ok) throw new Error(`HTTP ${resp.status}`)
     const data = await resp.json()
     return (data.saves || []).map((s: any) => ({
@@ -0,0 +1,454 @@
+// Standalone benchmark for the galaxy generator and backend server.
+//
+//   make bench && ./build/space4x-bench > bench.json
+//
+// Times every GalaxyGenerator stage across system counts and seeds, galaxy
+// serialization (JSON and snapshot), generateRandomSystem, and drives HTTP
+// load against an in-process BackendServer (or a running one with
+// --http-external). Results are one JSON document so runs can be diffed
+// between releases; engine logging is muted unless --verbose is given.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include "galaxy.h"
+#include "galaxy_snapshot.h"
+#include "backend_server.h"
+#include "galaxy_json.h"
+#include "json_writer.h"
+#include "logging.h"
+
+using namespace space4x;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Options {
+    std::vector<int> sizes = {400, 2000, 10000, 50000};
+    std::vector<int> seeds = {42, 1337};
+    bool parallel = false;
+    int detailIterations = 2000;
+    bool http = true;
+    bool httpExternal = false;
+    int httpPort = 3101;
+    int httpClients = 4;
+    int httpRequests = 2000;  // Per endpoint
+    std::string output;
+    bool verbose = false;
+};
+
+std::vector<int> parseList(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) values.push_back(std::atoi(item.c_str()));
+    }
+    return values;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --sizes 400,2000,10000,50000  System counts to generate\n"
+              << "  --seeds 42,1337               Seeds per system count\n"
+              << "  --parallel                    Use the parallel generation pipeline\n"
+              << "  --details N                   generateRandomSystem calls (default 2000)\n"
+              << "  --http-requests N             Requests per endpoint (default 2000)\n"
+              << "  --http-clients N              Concurrent keep-alive clients (default 4)\n"
+              << "  --http-port N                 Server port (default 3101)\n"
+              << "  --http-external               Load a server already running on --http-port\n"
+              << "  --no-http                     Skip the HTTP load driver\n"
+              << "  --out FILE                    Write the JSON report to FILE instead of stdout\n"
+              << "  --verbose                     Keep engine logging\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sizes" && hasValue) {
+            options.sizes = parseList(argv[++i]);
+        } else if (arg == "--seeds" && hasValue) {
+            options.seeds = parseList(argv[++i]);
+        } else if (arg == "--parallel") {
+            options.parallel = true;
+        } else if (arg == "--details" && hasValue) {
+            options.detailIterations = std::atoi(argv[++i]);
+        } else if (arg == "--http-requests" && hasValue) {
+            options.httpRequests = std::atoi(argv[++i]);
+        } else if (arg == "--http-clients" && hasValue) {
+            options.httpClients = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--http-port" && hasValue) {
+            options.httpPort = std::atoi(argv[++i]);
+        } else if (arg == "--http-external") {
+            options.httpExternal = true;
+        } else if (arg == "--no-http") {
+            options.http = false;
+        } else if (arg == "--out" && hasValue) {
+            options.output = argv[++i];
+        } else if (arg == "--verbose") {
+            options.verbose = true;
+        } else {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Same defaults as /api/galaxy/generate, with the radius grown so density
+// stays that of the 400-system galaxy
+GalaxyConfig benchConfig(int systems, int seed, bool parallel) {
+    GalaxyConfig config;
+    config.seed = seed;
+    config.radius = 500.0 * std::sqrt(systems / 400.0);
+    config.starSystemCount = systems;
+    config.anomalyCount = std::max(25, systems / 16);
+    config.minDistance = 2.0;
+    config.connectivity.minConnections = 1;
+    config.connectivity.maxConnections = 8;
+    config.connectivity.maxDistance = 10.0;
+    config.connectivity.distanceDecayFactor = 0.8;
+    config.connectivity.useVoronoiConnectivity = true;
+    config.generation.parallel = parallel;
+    config.visualization.width = 2000;
+    config.visualization.height = 2000;
+    config.visualization.scale = 6.0;
+    config.fixedSystems = {
+        {"sol", "Sol System", 0.0, 0.0, "origin", true},
+        {"alpha-centauri", "Alpha Centauri", 4.37, 0.0, "core", true},
+        {"tau-ceti", "Tau Ceti", -7.8, 9.1, "core", true},
+        {"barnards-star", "Barnard's Star", 2.1, -5.6, "core", true},
+        {"bellatrix", "Bellatrix", 180.0, 165.0, "rim", true},
+        {"lumiere", "Lumière", 0.0, 0.0, "rim", false, 250.0, 20.0},
+        {"aspida", "Aspida", 0.0, 0.0, "rim", false, 350.0, 20.0}
+    };
+    return config;
+}
+
+// ============================================================================
+// GENERATION AND SERIALIZATION
+// ============================================================================
+
+void benchGeneration(const Options& options, JsonWriter& json) {
+    json.key("generation").beginArray();
+    for (int systems : options.sizes) {
+        for (int seed : options.seeds) {
+            std::cerr << "⏱️  Generating " << systems << " systems (seed " << seed << ")" << std::endl;
+            GalaxyGenerator generator(benchConfig(systems, seed, options.parallel));
+            Clock::time_point start = Clock::now();
+            Galaxy galaxy = generator.generateGalaxy();
+            double totalMs = millisecondsSince(start);
+
+            start = Clock::now();
+            std::string body = serializeGalaxy(galaxy);
+            double serializeMs = millisecondsSince(start);
+
+            start = Clock::now();
+            std::string snapshot = encodeGalaxySnapshot(galaxy);
+            double encodeMs = millisecondsSince(start);
+
+            Galaxy decoded;
+            std::string error;
+            start = Clock::now();
+            bool decodedOk = decodeGalaxySnapshot(snapshot, decoded, error);
+            double decodeMs = millisecondsSince(start);
+
+            json.beginObject()
+                .field("systems", static_cast<int>(galaxy.systems.size()))
+                .field("seed", seed)
+                .field("parallel", options.parallel)
+                .field("warpLanes", static_cast<int>(galaxy.warpLanes.size()))
+                .field("anomalies", static_cast<int>(galaxy.anomalies.size()))
+                .field("totalMs", totalMs);
+            json.key("stagesMs").beginObject();
+            for (const auto& stage : generator.stageTimings()) {
+                json.field(stage.stage, stage.milliseconds);
+            }
+            json.endObject();
+            json.key("serialization").beginObject()
+                .field("jsonMs", serializeMs)
+                .field("jsonBytes", static_cast<long long>(body.size()))
+                .field("snapshotEncodeMs", encodeMs)
+                .field("snapshotDecodeMs", decodedOk ? decodeMs : -1.0)
+                .field("snapshotBytes", static_cast<long long>(snapshot.size()))
+                .endObject();
+            json.endObject();
+        }
+    }
+    json.endArray();
+}
+
+void benchSystemDetails(const Options& options, JsonWriter& json) {
+    std::cerr << "⏱️  Generating " << options.detailIterations << " system details" << std::endl;
+    const SystemConfigManager& manager = SystemConfigManager::catalog();
+    size_t planets = 0;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < options.detailIterations; i++) {
+        std::string id = "system-" + std::to_string(i + 1);
+        planets += manager.generateRandomSystem(id, id).planets.size();
+    }
+    double totalMs = millisecondsSince(start);
+
+    json.key("systemDetails").beginObject()
+        .field("iterations", options.detailIterations)
+        .field("totalMs", totalMs)
+        .field("perCallUs", options.detailIterations > 0 ? totalMs * 1000.0 / options.detailIterations : 0.0)
+        .field("planets", static_cast<long long>(planets))
+        .endObject();
+}
+
+// ============================================================================
+// HTTP LOAD DRIVER
+// ============================================================================
+
+// One keep-alive connection; reconnects when the server closes it
+class HttpClient {
+public:
+    explicit HttpClient(int port) : port(port) {}
+    ~HttpClient() { disconnect(); }
+
+    // Status code of the response, or -1 on a transport error
+    int request(const std::string& method, const std::string& path, const std::string& body) {
+        for (int attempt = 0; attempt < 2; attempt++) {
+            if (fd < 0 && !connectToServer()) return -1;
+            std::string out = method + " " + path + " HTTP/1.1\r\nHost: localhost\r\n";
+            if (!body.empty()) {
+                out += "Content-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+            }
+            out += "\r\n" + body;
+            int status = -1;
+            if (sendAll(out) && readResponse(status)) return status;
+            disconnect();  // Stale keep-alive connection; retry once on a fresh one
+        }
+        return -1;
+    }
+
+private:
+    int port;
+    int fd = -1;
+    std::string buffer;
+
+    bool connectToServer() {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            disconnect();
+            return false;
+        }
+        buffer.clear();
+        return true;
+    }
+
+    void disconnect() {
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+
+    bool sendAll(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    bool fill() {
+        char chunk[65536];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, n);
+        return true;
+    }
+
+    bool readResponse(int& status) {
+        size_t headEnd;
+        while ((headEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) return false;
+        }
+        std::string head = buffer.substr(0, headEnd);
+        status = std::atoi(head.c_str() + head.find(' ') + 1);
+
+        size_t length = 0;
+        for (const char* name : {"Content-Length:", "content-length:"}) {
+            size_t at = head.find(name);
+            if (at != std::string::npos) length = std::strtoul(head.c_str() + at + std::strlen(name), nullptr, 10);
+        }
+        size_t total = headEnd + 4 + length;
+        while (buffer.size() < total) {
+            if (!fill()) return false;
+        }
+        buffer.erase(0, total);
+        if (head.find("Connection: close") != std::string::npos) disconnect();
+        return true;
+    }
+};
+
+struct Endpoint {
+    const char* name;
+    std::string method;
+    std::string body;
+    std::string (*path)(int i);  // Request i's path, so lookups spread over the galaxy
+};
+
+std::string generatePath(int) { return "/api/galaxy/generate"; }
+std::string systemPath(int i) { return "/api/system/system-" + std::to_string(1 + i % 350); }
+std::string tilePath(int i) {
+    int z = i % 4, tiles = 1 << z;
+    return "/api/galaxy/tile?z=" + std::to_string(z) + "&x=" + std::to_string((i / 4) % tiles) +
+           "&y=" + std::to_string((i / 16) % tiles);
+}
+std::string routePath(int i) { return "/api/route?from=sol&to=system-" + std::to_string(1 + i % 350); }
+std::string healthPath(int) { return "/api/galaxy/health"; }
+
+void benchEndpoint(const Options& options, const Endpoint& endpoint, JsonWriter& json) {
+    std::vector<std::vector<double>> latencies(options.httpClients);
+    std::atomic<int> next(0);
+    std::atomic<int> errors(0);
+
+    Clock::time_point start = Clock::now();
+    std::vector<std::thread> clients;
+    for (int c = 0; c < options.httpClients; c++) {
+        clients.emplace_back([&, c]() {
+            HttpClient client(options.httpPort);
+            for (int i = next++; i < options.httpRequests; i = next++) {
+                Clock::time_point sent = Clock::now();
+                int status = client.request(endpoint.method, endpoint.path(i), endpoint.body);
+                latencies[c].push_back(millisecondsSince(sent));
+                if (status < 200 || status >= 400) errors++;
+            }
+        });
+    }
+    for (auto& client : clients) client.join();
+    double seconds = millisecondsSince(start) / 1000.0;
+
+    std::vector<double> all;
+    for (const auto& client : latencies) all.insert(all.end(), client.begin(), client.end());
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double q) {
+        if (all.empty()) return 0.0;
+        return all[std::min(all.size() - 1, static_cast<size_t>(q * all.size()))];
+    };
+
+    json.beginObject()
+        .field("name", endpoint.name)
+        .field("method", endpoint.method)
+        .field("requests", static_cast<int>(all.size()))
+        .field("errors", errors.load())
+        .field("seconds", seconds)
+        .field("requestsPerSecond", seconds > 0.0 ? all.size() / seconds : 0.0)
+        .field("p50Ms", percentile(0.50))
+        .field("p95Ms", percentile(0.95))
+        .field("p99Ms", percentile(0.99))
+        .field("maxMs", all.empty() ? 0.0 : all.back())
+        .endObject();
+}
+
+void benchHttp(const Options& options, JsonWriter& json) {
+    // The in-process server runs without a database unless one is configured
+    setenv("SPACE4X_SKIP_DB", "1", 0);
+    std::unique_ptr<BackendServer> server;
+    std::thread serverThread;
+    if (!options.httpExternal) {
+        server.reset(new BackendServer(options.httpPort));
+        if (!server->start()) {
+            std::cerr << "❌ Benchmark server failed to start on port " << options.httpPort << std::endl;
+            return;
+        }
+        serverThread = std::thread([&]() { server->run(); });
+    }
+
+    // Publishes the galaxy every other endpoint reads
+    const std::string generateBody = "{\"seed\":42,\"systems\":400}";
+    HttpClient warmup(options.httpPort);
+    if (warmup.request("POST", "/api/galaxy/generate", generateBody) != 200) {
+        std::cerr << "❌ Benchmark server did not generate a galaxy" << std::endl;
+    }
+
+    std::cerr << "⏱️  HTTP load: " << options.httpRequests << " requests per endpoint, "
+              << options.httpClients << " clients" << std::endl;
+    const Endpoint endpoints[] = {
+        {"galaxy_generate_cached", "POST", generateBody, generatePath},
+        {"system_details", "GET", "", systemPath},
+        {"galaxy_tile", "GET", "", tilePath},
+        {"route", "GET", "", routePath},
+        {"galaxy_health", "GET", "", healthPath},
+    };
+    json.key("http").beginObject()
+        .field("clients", options.httpClients)
+        .field("external", options.httpExternal);
+    json.key("endpoints").beginArray();
+    for (const auto& endpoint : endpoints) {
+        benchEndpoint(options, endpoint, json);
+    }
+    json.endArray();
+    json.endObject();
+
+    if (server) {
+        server->stop();
+        serverThread.join();
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 1;
+
+    if (!options.verbose) setLogLevel(LogLevel::Error);
+
+    JsonWriter json(4096);
+    json.beginObject()
+        .field("benchmark", "space4x")
+        .field("timestamp", static_cast<long long>(std::time(nullptr)))
+        .field("compiler", __VERSION__)
+        .field("hardwareThreads", static_cast<int>(std::thread::hardware_concurrency()));
+    benchGeneration(options, json);
+    if (options.detailIterations > 0) benchSystemDetails(options, json);
+    if (options.http) benchHttp(options, json);
+    json.endObject();
+
+    setLogLevel(LogLevel::Debug);
+    if (options.output.empty()) {
+        std::cout << json.str() << std::endl;
+    } else {
+        std::ofstream file(options.output);
+        file << json.str() << std::endl;
+        if (!file) {
+            std::cerr << "❌ Could not write " << options.output << std::endl;
+            return 1;
+        }
+        std::cerr << "📊 Wrote " << options.output << std::endl;
+    }
+    return 0;
+}
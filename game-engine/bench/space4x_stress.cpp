@@ -0,0 +1,361 @@
+// Scalability stress suite for the galaxy generator.
+//
+//   make stress && ./build/space4x-stress > stress.json
+//
+// Generates galaxies at growing sizes (10k to 100k systems by default) and
+// fails, with a non-zero exit status, when any of them
+//   - is not one connected lane network (as verifyConnectivity sees it),
+//   - comes out different when generated again from the same seed, or
+//   - takes longer or peaks at more resident memory in a stage than that
+//     stage's ceiling allows (see kStageCeilings).
+// Stage timings and per-stage peak RSS go into a JSON report either way, so a
+// pass that went quadratic shows up before deploy rather than in production.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <sys/resource.h>
+#include "galaxy.h"
+#include "galaxy_snapshot.h"
+#include "json_writer.h"
+#include "logging.h"
+
+using namespace space4x;
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double millisecondsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Budget per stage, linear in the system count: a stage that stays within it
+// at 100k systems scales the way it should. Time is allowed a fixed slack so
+// small sizes don't trip on noise; memory is the process's peak RSS while the
+// stage ran. --ceiling-scale stretches the time budgets for slow machines.
+struct StageCeiling {
+    const char* stage;
+    double msPerThousand;
+    double rssKbPerSystem;
+};
+
+const double kStageSlackMs = 250.0;
+const double kBaseRssKb = 64.0 * 1024.0;  // Process, catalog and allocator overhead
+
+// Roughly 4x the time and 2x the memory a 100k-system galaxy needs on a
+// current desktop core; a pass that turns quadratic overshoots by orders
+const StageCeiling kStageCeilings[] = {
+    {"sites", 2.0, 2.0},
+    {"neighbors", 6.0, 2.0},
+    {"systems", 30.0, 2.5},
+    {"lanes", 4.0, 2.5},
+    {"redundant_lanes", 2.0, 2.5},
+    {"connectivity", 2.0, 2.5},
+    {"materialize", 4.0, 3.5},
+    {"anomalies", 2.0, 3.5},
+    {"index", 12.0, 6.0},
+};
+
+// Stages not in the table (a new one, or the non-Voronoi pipeline) get this
+const StageCeiling kDefaultCeiling = {"other", 30.0, 6.0};
+
+const StageCeiling& ceilingFor(const char* stage) {
+    for (const auto& ceiling : kStageCeilings) {
+        if (std::strcmp(ceiling.stage, stage) == 0) return ceiling;
+    }
+    return kDefaultCeiling;
+}
+
+// Peak resident memory. On Linux the high-water mark can be reset, which gives
+// a peak per stage; elsewhere it is the peak since the process started.
+class PeakMemory {
+public:
+    static void resetPeak() {
+        std::ofstream clear("/proc/self/clear_refs");
+        clear << "5";
+    }
+
+    static long peakKb() {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.compare(0, 6, "VmHWM:") == 0) return std::strtol(line.c_str() + 6, nullptr, 10);
+        }
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024;  // Bytes there
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+};
+
+// FNV-1a, to compare runs (and releases) without keeping whole snapshots
+uint64_t fingerprint(const std::string& data) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string hex(uint64_t value) {
+    std::ostringstream out;
+    out << std::hex << value;
+    return out.str();
+}
+
+struct Options {
+    std::vector<int> sizes = {10000, 25000, 50000, 100000};
+    std::vector<int> seeds = {42};
+    bool parallel = false;
+    bool determinism = true;
+    double ceilingScale = 1.0;
+    std::string output;
+    bool verbose = false;
+};
+
+std::vector<int> parseList(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) values.push_back(std::atoi(item.c_str()));
+    }
+    return values;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --sizes 10000,25000,50000,100000  System counts, in the order run\n"
+              << "  --seeds 42                        Seeds per system count\n"
+              << "  --parallel                        Use the parallel generation pipeline\n"
+              << "  --no-determinism                  Skip the second run per seed\n"
+              << "  --ceiling-scale X                 Multiply the stage time ceilings (default 1)\n"
+              << "  --out FILE                        Write the JSON report to FILE instead of stdout\n"
+              << "  --verbose                         Keep engine logging\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sizes" && hasValue) {
+            options.sizes = parseList(argv[++i]);
+        } else if (arg == "--seeds" && hasValue) {
+            options.seeds = parseList(argv[++i]);
+        } else if (arg == "--parallel") {
+            options.parallel = true;
+        } else if (arg == "--no-determinism") {
+            options.determinism = false;
+        } else if (arg == "--ceiling-scale" && hasValue) {
+            options.ceilingScale = std::atof(argv[++i]);
+            if (options.ceilingScale <= 0.0) {
+                printUsage(argv[0]);
+                return false;
+            }
+        } else if (arg == "--out" && hasValue) {
+            options.output = argv[++i];
+        } else if (arg == "--verbose") {
+            options.verbose = true;
+        } else {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Same density and defaults as the benchmark's galaxies
+GalaxyConfig stressConfig(int systems, int seed, bool parallel) {
+    GalaxyConfig config;
+    config.seed = seed;
+    config.radius = 500.0 * std::sqrt(systems / 400.0);
+    config.starSystemCount = systems;
+    config.anomalyCount = std::max(25, systems / 16);
+    config.minDistance = 2.0;
+    config.connectivity.minConnections = 1;
+    config.connectivity.maxConnections = 8;
+    config.connectivity.maxDistance = 10.0;
+    config.connectivity.distanceDecayFactor = 0.8;
+    config.connectivity.useVoronoiConnectivity = true;
+    config.generation.parallel = parallel;
+    config.visualization.width = 2000;
+    config.visualization.height = 2000;
+    config.visualization.scale = 6.0;
+    config.fixedSystems = {
+        {"sol", "Sol System", 0.0, 0.0, "origin", true},
+        {"alpha-centauri", "Alpha Centauri", 4.37, 0.0, "core", true},
+        {"tau-ceti", "Tau Ceti", -7.8, 9.1, "core", true},
+        {"barnards-star", "Barnard's Star", 2.1, -5.6, "core", true},
+        {"bellatrix", "Bellatrix", 180.0, 165.0, "rim", true},
+        {"lumiere", "Lumière", 0.0, 0.0, "rim", false, 250.0, 20.0},
+        {"aspida", "Aspida", 0.0, 0.0, "rim", false, 350.0, 20.0}
+    };
+    return config;
+}
+
+// ============================================================================
+// STRESS RUNS
+// ============================================================================
+
+struct StageSample {
+    const char* stage;
+    double milliseconds;
+    long peakRssKb;
+};
+
+struct RunResult {
+    size_t systems = 0;
+    size_t connected = 0;
+    size_t warpLanes = 0;
+    double totalMs = 0.0;
+    long peakRssKb = 0;
+    uint64_t fingerprint = 0;
+    std::vector<StageSample> stages;
+};
+
+RunResult generate(const GalaxyConfig& config) {
+    RunResult result;
+    GalaxyGenerator generator(config);
+    generator.setStageObserver([&result](const StageTiming& timing) {
+        result.stages.push_back({timing.stage, timing.milliseconds, PeakMemory::peakKb()});
+        PeakMemory::resetPeak();
+    });
+
+    PeakMemory::resetPeak();
+    Clock::time_point start = Clock::now();
+    Galaxy galaxy = generator.generateGalaxy();
+    result.totalMs = millisecondsSince(start);
+
+    result.systems = galaxy.systems.size();
+    result.connected = generator.connectedSystemCount();
+    result.warpLanes = galaxy.warpLanes.size();
+    for (const auto& stage : result.stages) result.peakRssKb = std::max(result.peakRssKb, stage.peakRssKb);
+    result.fingerprint = fingerprint(encodeGalaxySnapshot(galaxy));
+    return result;
+}
+
+// Records a failed check for the report and the console
+void fail(std::vector<std::string>& failures, const std::string& message) {
+    std::cerr << "❌ " << message << std::endl;
+    failures.push_back(message);
+}
+
+void stressSize(const Options& options, int systems, int seed, JsonWriter& json, std::vector<std::string>& failures) {
+    std::cerr << "🏋️  Generating " << systems << " systems (seed " << seed << ")" << std::endl;
+    GalaxyConfig config = stressConfig(systems, seed, options.parallel);
+    RunResult run = generate(config);
+    std::string label = std::to_string(systems) + " systems, seed " + std::to_string(seed);
+
+    if (run.connected != run.systems) {
+        fail(failures, label + ": only " + std::to_string(run.connected) + " of " + std::to_string(run.systems) +
+                       " systems are connected");
+    }
+
+    bool deterministic = true;
+    if (options.determinism) {
+        RunResult again = generate(config);
+        deterministic = again.fingerprint == run.fingerprint;
+        if (!deterministic) {
+            fail(failures, label + ": second generation differs (" + hex(run.fingerprint) + " vs " +
+                           hex(again.fingerprint) + ")");
+        }
+    }
+
+    json.beginObject()
+        .field("systems", static_cast<long long>(run.systems))
+        .field("seed", seed)
+        .field("parallel", options.parallel)
+        .field("connectedSystems", static_cast<long long>(run.connected))
+        .field("warpLanes", static_cast<long long>(run.warpLanes))
+        .field("fingerprint", hex(run.fingerprint))
+        .field("deterministic", deterministic)
+        .field("totalMs", run.totalMs)
+        .field("peakRssKb", static_cast<long long>(run.peakRssKb));
+    json.key("stages").beginArray();
+    for (const auto& stage : run.stages) {
+        const StageCeiling& ceiling = ceilingFor(stage.stage);
+        double maxMs = (kStageSlackMs + ceiling.msPerThousand * systems / 1000.0) * options.ceilingScale;
+        double maxRssKb = kBaseRssKb + ceiling.rssKbPerSystem * systems;
+        if (stage.milliseconds > maxMs) {
+            fail(failures, label + ": stage " + stage.stage + " took " + std::to_string(stage.milliseconds) +
+                           " ms (ceiling " + std::to_string(maxMs) + " ms)");
+        }
+        if (stage.peakRssKb > maxRssKb) {
+            fail(failures, label + ": stage " + stage.stage + " peaked at " + std::to_string(stage.peakRssKb) +
+                           " kB resident (ceiling " + std::to_string(static_cast<long>(maxRssKb)) + " kB)");
+        }
+        json.beginObject()
+            .field("stage", stage.stage)
+            .field("ms", stage.milliseconds)
+            .field("maxMs", maxMs)
+            .field("peakRssKb", static_cast<long long>(stage.peakRssKb))
+            .field("maxRssKb", static_cast<long long>(maxRssKb))
+            .endObject();
+    }
+    json.endArray();
+    json.endObject();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    if (!options.verbose) setLogLevel(LogLevel::Error);
+
+    std::vector<std::string> failures;
+    JsonWriter json(4096);
+    json.beginObject()
+        .field("suite", "space4x-stress")
+        .field("timestamp", static_cast<long long>(std::time(nullptr)))
+        .field("compiler", __VERSION__)
+        .field("hardwareThreads", static_cast<int>(std::thread::hardware_concurrency()))
+        .field("ceilingScale", options.ceilingScale);
+    json.key("runs").beginArray();
+    for (int systems : options.sizes) {
+        for (int seed : options.seeds) {
+            stressSize(options, systems, seed, json, failures);
+        }
+    }
+    json.endArray();
+    json.key("failures").beginArray();
+    for (const auto& failure : failures) json.value(failure);
+    json.endArray();
+    json.field("passed", failures.empty());
+    json.endObject();
+
+    setLogLevel(LogLevel::Debug);
+    if (options.output.empty()) {
+        std::cout << json.str() << std::endl;
+    } else {
+        std::ofstream file(options.output);
+        file << json.str() << std::endl;
+        if (!file) {
+            std::cerr << "❌ Could not write " << options.output << std::endl;
+            return 1;
+        }
+        std::cerr << "📊 Wrote " << options.output << std::endl;
+    }
+
+    if (!failures.empty()) {
+        std::cerr << "❌ " << failures.size() << " stress check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cerr << "✅ All stress checks passed" << std::endl;
+    return 0;
+}
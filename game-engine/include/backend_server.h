@@ -2,20 +2,35 @@
 
 #include <string>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <unordered_map>
 #include <libpq-fe.h>
 #include "galaxy.h"
-#include "http_server.h"
+#include "galaxy_cache.h"
+#include "session_store.h"
+#include "galaxy_jobs.h"
+#include "http_request.h"
+#include "http_transport.h"
+#include "galaxy_request.h"
+#include "thread_pool.h"
+#include "job_system.h"
+#include "database_pool.h"
+#include "metrics.h"
 
 namespace space4x {
 
 class BackendServer {
 private:
-    int port;
-    int server_fd;
-    bool running;
+    // Bounded event-driven front end, and the route table it dispatches through
+    HttpRouter router;
+    HttpTransport http;
     
-    // Database connection
-    PGconn* db_connection;
+    // Database access: pooled connections with prepared statements, plus a
+    // background writer for save upserts
+    DatabasePool database;
+    AsyncSaveWriter saveWriter;
     std::string db_host;
     std::string db_name;
     std::string db_user;
@@ -23,26 +38,83 @@ private:
     int db_port;
     
     // Game engine components
-    Galaxy currentGalaxy;
-    SystemConfigManager systemConfigManager;
+    GalaxySessionStore sessions;  // Live galaxy per (user, save slot)
+    GalaxyCache galaxyCache;
+    const SystemConfigManager& systemConfigManager;  // The shared catalog
+    std::unique_ptr<GalaxyJobQueue> galaxyJobs;      // Background generation, uses galaxyCache
+    std::atomic<size_t> activeStreams{0};            // Event streams holding a worker thread
+    JobSystem simulationJobs;                        // Shared by every session's ticks
+    
+    // Request metrics, registered at construction
+    std::vector<MetricId> requestTimers;     // Per router label
+    std::vector<MetricId> responseCounters;  // Per status class, 1xx..5xx
+    MetricId sessionsRehydrated;
+    MetricId tickTimer;
     
     // HTTP request handling
-    std::string handleRequest(const std::string& request);
+    HttpResponse handleRequest(const HttpRequest& request);  // Records metrics around routeRequest()
+    HttpResponse routeRequest(const HttpRequest& request, const HttpRouter::Match& route);
+    HttpResponse handleMetrics();
     std::string handleHealthCheck();
-    std::string handleGetCurrentUser();
-    std::string handleGalaxyGenerate(const std::string& request);
+    std::string handleGetCurrentUser(const HttpRequest& request);
+    HttpResponse handleGalaxyGenerate(const HttpRequest& request);
+    std::string handleCreateGalaxyJob(const HttpRequest& request);
+    HttpResponse handleGalaxyJob(const HttpRequest& request);  // Status, result, events and cancel by id
+    HttpResponse streamGalaxyJob(const std::shared_ptr<GalaxyJob>& job);
     std::string handleGalaxyHealth();
-    std::string handleSystemDetails(const std::string& request);
-    std::string handleGameState();
-    std::string handleGameAction(const std::string& request);
-    std::string handleGetSaves();
-    std::string handleSaveGame(const std::string& request);
-    std::string handleLoadGame(const std::string& request);
+    HttpResponse handleSystemDetails(const HttpRequest& request);
+    HttpResponse handleGameState(const HttpRequest& request);
+    std::string handleGameAction(const HttpRequest& request);
+    std::string orderFleet(const GalaxySessionStore::Key& key, const GameAction& action);  // move_fleet
+    HttpResponse handleGameTick(const HttpRequest& request);        // ?ticks=N, default 1
+    HttpResponse handleSimulationState(const HttpRequest& request);
+    std::string handleRoute(const HttpRequest& request);
+    HttpResponse handleGalaxyTile(const HttpRequest& request);
+    HttpResponse handleGetSaves(const HttpRequest& request);  // ?summary=true leaves out save_data
+    std::string handleSaveGame(const HttpRequest& request);
+    HttpResponse handleLoadGame(const HttpRequest& request);
     std::string handleApiTest();
     
+    // Cached galaxy for config, generated on a miss; job, when given, hears of
+    // every stage and may cancel by throwing
+    std::shared_ptr<const GalaxyCache::Entry> generatedGalaxy(const GalaxyConfig& config, const std::string& cacheKey,
+                                                              GalaxyJob* job = nullptr);
+    
+    // Sessions: the user comes from the X-Space4X-User header or ?user= (default
+    // kDefaultUser), the slot from ?slot= or else the user's active slot. False
+    // if either is malformed
+    bool sessionKey(const HttpRequest& request, GalaxySessionStore::Key& key);
+    bool requestUser(const HttpRequest& request, std::string& user);
+    
+    // The key's session, rebuilt from its save slot if it isn't resident; null
+    // if the slot holds no snapshot save
+    std::shared_ptr<const GalaxySession> loadSession(const GalaxySessionStore::Key& key);
+    
+    // Makes galaxy the key's session and its slot the user's active one; the
+    // caches start empty unless it already was. With a save slot, later game
+    // actions are logged there as deltas on top of loggedDeltas existing ones.
+    // base, when given, is queued first as the slot's new save, unless the slot
+    // was last autosaved with the same etag.
+    void publishGalaxy(const GalaxySessionStore::Key& key, std::shared_ptr<const Galaxy> galaxy,
+                       std::shared_ptr<const std::string> base = nullptr, const std::string& etag = "",
+                       size_t loggedDeltas = 0);
+    
+    // Queues delta (already applied to galaxy) for the key's save slot, or a
+    // fresh base once the log is long enough. Called from the key's session update
+    void logGalaxyDelta(const GalaxySessionStore::Key& key, GalaxySessionStore::SaveState& save,
+                        const Galaxy& galaxy, const GalaxyDelta& delta);
+    
+    // System record for an add_system action, with star info from the config manager
+    StarSystem discoveredSystem(const GameAction& action);
+    
     // Save/load helpers
-    std::string loadSavedStateForUser(const std::string& username, int slot, bool& found);
-    bool upsertSavedStateForUser(const std::string& username, int slot, const std::string& saveJson, std::string& errorOut);
+    // Always returns JSON; snapshot saves are decoded with their delta log replayed, and
+    // restored receives the galaxy if given. deltaCount receives the log's length, or
+    // kCompactAfterDeltas if it can't be appended to anymore
+    std::string loadSavedStateForUser(const std::string& username, int slot, bool& found, Galaxy* restored = nullptr,
+                                      size_t* deltaCount = nullptr);
+    std::string savedStateToJson(const std::string& saveData, const std::vector<std::string>& deltas,
+                                 Galaxy* restored, std::string& errorOut, size_t* deltaCount = nullptr);
     
     // Database operations
     bool connectToDatabase();
@@ -51,13 +123,21 @@ private:
     
     // HTTP utilities
     std::string createJsonResponse(const std::string& json);
+    HttpResponse createJsonResponse(std::shared_ptr<const std::string> json, const std::string& etag = "");
+    // Compressed as the request's Accept-Encoding allows, each encoding with its own
+    // ETag; answers 304 when If-None-Match has any of them. A cached galaxy's
+    // encodings are produced once and kept in its cache entry
+    HttpResponse createJsonResponse(const HttpRequest& request, std::shared_ptr<const std::string> json,
+                                    const std::string& etag = "",
+                                    const std::shared_ptr<const GalaxyCache::Entry>& cached = nullptr);
+    std::string createNotModifiedResponse(const std::string& etag);
+    // contentEncoding, when given, marks the response as negotiated (Vary: Accept-Encoding)
+    std::string responseHead(size_t contentLength, const char* contentType = "application/json",
+                             const std::string& etag = "", const char* status = "200 OK",
+                             const char* contentEncoding = nullptr);
     std::string createErrorResponse(int status, const std::string& message);
     std::string createErrorResponse(const std::string& message);
     std::string createCorsResponse();
-    std::string extractPath(const std::string& request);
-    std::string extractMethod(const std::string& request);
-    std::string extractBody(const std::string& request);
-    std::string serializeSystemDefinition(const SystemDefinition& systemDef);
     
     // CORS support
     std::string addCorsHeaders(const std::string& response);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace space4x {
+
+// Offline galaxy pre-baking: --mode batch. Generates a list of galaxies in
+// parallel, one per worker thread, and writes each as a snapshot or JSON
+// file and/or into the saves table.
+//
+//   --seeds A-B        seeds A..B over the template (repeatable; "A" alone is one seed)
+//   --template FILE    galaxy request JSON the seeds are applied to (default: service defaults)
+//   --config FILE      galaxy request JSON, or one request per line (repeatable)
+//   --format F         snapshot (default) or json
+//   --out DIR          writes DIR/galaxy-<seed>.s4x or .json
+//   --db               COPYs every galaxy into the saves table in one transaction
+//   --user NAME        owner of the saved galaxies (default keith)
+//   --slot N           slot of the first seed; later seeds take the next ones. Configs
+//                      use their own save_slot
+//   --threads N        galaxies generated at once (default: hardware concurrency)
+//   --db-conninfo S    libpq connection string (default: the service's database)
+struct BatchOptions {
+    struct SeedRange {
+        int first;
+        int last;
+    };
+
+    std::vector<SeedRange> seedRanges;
+    std::string templateFile;
+    std::vector<std::string> configFiles;
+    bool json = false;
+    std::string outDir;
+    bool toDatabase = false;
+    std::string user = "keith";
+    int firstSlot = 1;
+    size_t threads = 0;
+    std::string connectionInfo;
+};
+
+// Reads the options following --mode batch. False with error set on an
+// unknown or malformed option, or when there is nothing to generate or
+// nowhere to write
+bool parseBatchOptions(int argc, char* argv[], BatchOptions& options, std::string& error);
+
+// Generates and writes every galaxy; the process exit code (0 when all were written)
+int runBatch(const BatchOptions& options);
+
+} // namespace space4x
@@ -3,6 +3,7 @@
 #include <vector>
 #include <unordered_map>
 #include <random>
+#include <cstdint>
 #include <nlohmann/json.hpp>
 
 namespace space4x {
@@ -68,6 +69,10 @@ struct Asteroid : public CelestialBody {
     }
 };
 
+// Star classes procedural systems draw from, by uniform index; shared by
+// catalog generation and the galaxy's fixed systems
+inline constexpr const char* kStarTypes[] = {"G-class", "K-class", "M-class", "F-class", "A-class"};
+
 // Complete star system definition
 struct SystemDefinition {
     std::string systemId;
@@ -89,14 +94,22 @@ class SystemConfigManager {
 public:
     SystemConfigManager();
     
+    SystemConfigManager(const SystemConfigManager&) = delete;
+    SystemConfigManager& operator=(const SystemConfigManager&) = delete;
+    
+    // Process-wide catalog, loaded on first use and immutable after; its
+    // definitions stay valid for the life of the process, so galaxies can
+    // point at them however long they are kept
+    static const SystemConfigManager& catalog();
+    
     // Load predefined systems
     void loadPredefinedSystems();
     
     // Get system definition by ID
     const SystemDefinition* getSystemDefinition(const std::string& systemId) const;
     
-    // Generate random system
-    SystemDefinition generateRandomSystem(const std::string& systemId, const std::string& systemName);
+    // Generate random system; deterministic in systemId and safe to call concurrently
+    SystemDefinition generateRandomSystem(const std::string& systemId, const std::string& systemName) const;
     
     // Check if system is predefined
     bool isSystemPredefined(const std::string& systemId) const;
@@ -105,9 +118,11 @@ private:
     std::unordered_map<std::string, SystemDefinition> predefinedSystems;
     
     // Helper methods for random generation
-    Planet generateRandomPlanet(int planetIndex, double distanceFromStar, std::mt19937& gen);
-    Moon generateRandomMoon(int moonIndex, const Planet& parentPlanet, std::mt19937& gen);
-    std::vector<ResourceDeposit> generateRandomResources(const std::string& bodyType, int habitability);
+    // bodySeed keys the body's own resource stream, derived from the system seed
+    Planet generateRandomPlanet(int planetIndex, double distanceFromStar, std::mt19937& gen, uint64_t bodySeed) const;
+    Moon generateRandomMoon(int moonIndex, const Planet& parentPlanet, std::mt19937& gen, uint64_t bodySeed) const;
+    void generateRandomResources(bool isPlanet, int habitability, uint64_t bodySeed,
+                                 std::vector<ResourceDeposit>& resources) const;
     
     // JSON loading methods
     bool loadSystemsFromJson(const std::string& filename);
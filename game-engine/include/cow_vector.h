@@ -0,0 +1,176 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <iterator>
+#include <cstddef>
+
+namespace space4x {
+
+// Vector kept as shared chunks of up to kChunkSize elements. Copying one only
+// copies the chunk pointers; edit(), push_back() and erase() clone the single
+// chunk they touch if another copy still shares it, so an edited copy of a
+// large galaxy costs O(chunks) plus the chunks it actually changed. Erasing
+// shrinks just the chunk it hits instead of shifting everything after it.
+//
+// Like std::vector, a const CowVector may be read from any number of threads,
+// while a non-const one belongs to one thread at a time. Reads are const only:
+// writes go through edit(), so reading never clones.
+template <typename T>
+class CowVector {
+public:
+    static const size_t kChunkSize = 512;
+
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef const T& reference;
+
+        const_iterator() = default;
+        const_iterator(const CowVector* owner, size_t chunk, size_t position)
+            : owner(owner), chunk(chunk), position(position) {}
+
+        reference operator*() const { return (*owner->chunks[chunk])[position]; }
+        pointer operator->() const { return &**this; }
+        const_iterator& operator++() {
+            if (++position == owner->chunks[chunk]->size()) {
+                chunk++;
+                position = 0;
+            }
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const const_iterator& other) const { return chunk == other.chunk && position == other.position; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        const CowVector* owner = nullptr;
+        size_t chunk = 0;
+        size_t position = 0;
+    };
+
+    CowVector() = default;
+    CowVector(std::vector<T> items) { assign(std::move(items)); }
+    CowVector& operator=(std::vector<T> items) {
+        assign(std::move(items));
+        return *this;
+    }
+
+    size_t size() const { return offsets.back(); }
+    bool empty() const { return size() == 0; }
+
+    const T& operator[](size_t index) const {
+        size_t chunk = chunkOf(index);
+        return (*chunks[chunk])[index - offsets[chunk]];
+    }
+    const T& back() const { return chunks.back()->back(); }
+
+    const_iterator begin() const { return const_iterator(this, 0, 0); }
+    const_iterator end() const { return const_iterator(this, chunks.size(), 0); }
+
+    // Writable element; clones its chunk first if another copy shares it
+    T& edit(size_t index) {
+        size_t chunk = chunkOf(index);
+        return (*own(chunk))[index - offsets[chunk]];
+    }
+
+    void push_back(T value) {
+        if (chunks.empty() || chunks.back()->size() >= kChunkSize) {
+            chunks.push_back(std::make_shared<std::vector<T>>());
+            chunks.back()->reserve(kChunkSize);
+            offsets.push_back(offsets.back());
+        }
+        own(chunks.size() - 1)->push_back(std::move(value));
+        offsets.back()++;
+    }
+
+    void erase(size_t index) {
+        size_t chunk = chunkOf(index);
+        std::vector<T>& items = *own(chunk);
+        items.erase(items.begin() + (index - offsets[chunk]));
+        for (size_t c = chunk + 1; c < offsets.size(); c++) {
+            offsets[c]--;
+        }
+        if (items.empty()) {
+            chunks.erase(chunks.begin() + chunk);
+            offsets.erase(offsets.begin() + chunk + 1);
+        }
+    }
+
+    // Erases every element matching remove, keeping the rest in order; only
+    // chunks holding a match are cloned. Returns how many went
+    template <typename Predicate>
+    size_t eraseIf(Predicate&& remove) {
+        size_t removed = 0;
+        size_t kept = 0;
+        for (size_t c = 0; c < chunks.size(); c++) {
+            const std::vector<T>& items = *chunks[c];
+            if (std::any_of(items.begin(), items.end(), remove)) {
+                std::vector<T>& owned = *own(c);
+                size_t before = owned.size();
+                owned.erase(std::remove_if(owned.begin(), owned.end(), remove), owned.end());
+                removed += before - owned.size();
+            }
+            if (chunks[c]->empty()) continue;
+            chunks[kept++] = std::move(chunks[c]);
+        }
+        chunks.resize(kept);
+        reindex();
+        return removed;
+    }
+
+    void clear() {
+        chunks.clear();
+        offsets.assign(1, 0);
+    }
+
+private:
+    std::vector<std::shared_ptr<std::vector<T>>> chunks;  // Never empty ones
+    std::vector<size_t> offsets = std::vector<size_t>(1, 0);  // Index of each chunk's first element, then size()
+
+    void assign(std::vector<T> items) {
+        chunks.clear();
+        for (size_t start = 0; start < items.size(); start += kChunkSize) {
+            size_t end = std::min(items.size(), start + kChunkSize);
+            chunks.push_back(std::make_shared<std::vector<T>>(std::make_move_iterator(items.begin() + start),
+                                                              std::make_move_iterator(items.begin() + end)));
+        }
+        reindex();
+    }
+
+    void reindex() {
+        offsets.assign(1, 0);
+        for (const auto& chunk : chunks) {
+            offsets.push_back(offsets.back() + chunk->size());
+        }
+    }
+
+    // Chunks stay full until something is erased, so the division is nearly always right
+    size_t chunkOf(size_t index) const {
+        size_t guess = std::min(index / kChunkSize, chunks.size() - 1);
+        if (offsets[guess] <= index && index < offsets[guess + 1]) return guess;
+        return static_cast<size_t>(std::upper_bound(offsets.begin() + 1, offsets.end(), index) - offsets.begin() - 1);
+    }
+
+    // The chunk, cloned first unless this copy is its only owner. Other owners
+    // only ever read it, and the fence orders their last reads (released with
+    // their reference) before the writes that follow
+    std::vector<T>* own(size_t chunk) {
+        if (chunks[chunk].use_count() != 1) {
+            chunks[chunk] = std::make_shared<std::vector<T>>(*chunks[chunk]);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return chunks[chunk].get();
+    }
+};
+
+} // namespace space4x
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <memory>
+#include <libpq-fe.h>
+#include "metrics.h"
+
+namespace space4x {
+
+// A named SQL statement prepared on every pooled connection
+struct PreparedStatement {
+    std::string name;
+    std::string sql;
+    int paramCount;
+    std::vector<int> paramFormats = {};  // Per parameter, 1 = binary; empty means all text
+};
+
+// Latency histogram and failure counter of one prepared statement on /metrics
+struct StatementMetrics {
+    MetricId latency;
+    MetricId errors;
+
+    static StatementMetrics forStatement(const std::string& name);
+    void record(double seconds, bool failed) const;
+};
+
+// Bounded pool of libpq connections. Each connection prepares the statements
+// once when it is opened; broken connections are dropped and replaced on the
+// next checkout, so the pool recovers from database restarts on its own.
+class DatabasePool {
+public:
+    // RAII checkout; returns the connection to the pool when destroyed
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(DatabasePool* pool, PGconn* connection) : pool(pool), connection(connection) {}
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { release(); }
+
+        explicit operator bool() const { return connection != nullptr; }
+        PGconn* get() const { return connection; }
+
+        // Runs a prepared statement; parameters are text unless paramFormats marks them
+        // binary, and resultFormat 1 returns binary columns. Caller PQclear()s
+        PGresult* execute(const std::string& statement, const std::vector<std::string>& params,
+                          const std::vector<int>& paramFormats = {}, int resultFormat = 0);
+
+    private:
+        DatabasePool* pool = nullptr;
+        PGconn* connection = nullptr;
+        void release();
+    };
+
+    DatabasePool() = default;
+    ~DatabasePool() { close(); }
+
+    DatabasePool(const DatabasePool&) = delete;
+    DatabasePool& operator=(const DatabasePool&) = delete;
+
+    void configure(const std::string& connectionInfo, size_t maxConnections,
+                   const std::vector<PreparedStatement>& statements);
+    bool open();   // Opens the first connection to validate the configuration
+    void close();  // Closes idle connections; leased ones close on return
+
+    // Waits up to timeout for a free or new connection; empty lease on failure
+    Lease acquire(std::chrono::milliseconds timeout = std::chrono::milliseconds(5000));
+
+private:
+    std::string connectionInfo;
+    std::vector<PreparedStatement> statements;
+    std::map<std::string, StatementMetrics> statementMetrics;  // Fixed by configure()
+    size_t maxConnections = 4;
+
+    std::mutex mutex;
+    std::condition_variable returned;
+    std::vector<PGconn*> idle;
+    size_t openConnections = 0;  // Idle plus leased
+    bool closed = false;
+    std::chrono::steady_clock::time_point nextConnectAttempt;
+
+    PGconn* connect();
+    void giveBack(PGconn* connection);
+    StatementMetrics metricsFor(const std::string& statement) const;
+};
+
+// Background writer for save upserts and delta appends. Request threads
+// enqueue and return; a dedicated connection sends each statement with
+// libpq's non-blocking API (PQsendQueryPrepared + PQflush/PQconsumeInput).
+// Per (user, slot) the writer keeps at most one base save plus the deltas
+// made on top of it, and writes them in that order. A newer base replaces a
+// queued one and drops its deltas, since the base already contains them.
+//
+// A failed write stays queued, deltas behind it included, and is retried
+// with growing backoff. Only a statement the database keeps rejecting is
+// dropped, after kMaxWriteAttempts tries; the loss is then kept for
+// takeFailure() until a later base for the slot is written.
+class AsyncSaveWriter {
+public:
+    enum class Format { Snapshot, Json };  // Base saves: binary snapshot, or client JSON
+
+    AsyncSaveWriter() = default;
+    ~AsyncSaveWriter() { stop(); }
+
+    AsyncSaveWriter(const AsyncSaveWriter&) = delete;
+    AsyncSaveWriter& operator=(const AsyncSaveWriter&) = delete;
+
+    // All statements take (username, slot, data); their paramFormats apply.
+    // append records one delta against the slot's saved base
+    void start(const std::string& connectionInfo, const PreparedStatement& upsertSnapshot,
+               const PreparedStatement& append, const PreparedStatement& upsertJson);
+    void stop();  // Writes everything still queued (failures are not retried), then joins
+
+    void enqueue(const std::string& username, int slot, const std::string& saveData, Format format = Format::Snapshot);
+    void enqueue(const std::string& username, int slot, std::shared_ptr<const std::string> saveData,
+                 Format format = Format::Snapshot);
+    void enqueueDelta(const std::string& username, int slot, std::shared_ptr<const std::string> delta);
+
+    // Read-your-writes: what is queued but not yet confirmed by the database.
+    // base is left empty when only deltas are pending; those follow whatever
+    // the database holds. False when nothing is pending
+    bool pendingSave(const std::string& username, int slot, std::string& base,
+                     std::vector<std::string>& deltas) const;
+
+    // Why writes to the slot were given up on, reported once
+    bool takeFailure(const std::string& username, int slot, std::string& error);
+
+private:
+    typedef std::pair<std::string, int> SaveKey;
+    struct PendingWrite {
+        std::shared_ptr<const std::string> data;
+        unsigned long sequence;
+        Format format = Format::Snapshot;
+    };
+    struct PendingSave {
+        PendingWrite base = {nullptr, 0};
+        std::deque<PendingWrite> deltas;
+        unsigned failures = 0;    // In a row, for the backoff
+        unsigned rejections = 0;  // Of the front write by the database itself
+        std::chrono::steady_clock::time_point retryAt;
+    };
+
+    std::string connectionInfo;
+    PreparedStatement upsertStatement;
+    PreparedStatement appendStatement;
+    PreparedStatement upsertJsonStatement;
+    StatementMetrics upsertMetrics;
+    StatementMetrics appendMetrics;
+    StatementMetrics upsertJsonMetrics;
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<SaveKey> queue;  // Keys with pending writes, each listed once
+    std::map<SaveKey, PendingSave> pending;
+    std::map<SaveKey, std::string> failures;
+    unsigned long nextSequence = 0;
+    bool running = false;
+    PGconn* connection = nullptr;
+
+    PendingSave& entryFor(const SaveKey& key);  // Queues new keys; caller holds mutex
+    bool nextKey(std::unique_lock<std::mutex>& lock, SaveKey& key);  // False once stopped and drained
+    void writerLoop();
+    bool ensureConnected();
+    bool writeSave(const PreparedStatement& statement, const SaveKey& key, const std::string& data,
+                   std::string& error);
+};
+
+} // namespace space4x
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+namespace space4x {
+
+// Delaunay triangulation of a 2D point set (incremental Bowyer-Watson).
+// Points are inserted along a Hilbert curve and located by walking from the
+// previous insertion, so the expected cost is O(n log n) for the sort plus
+// O(1) per insertion for well-spread inputs such as galaxy sites. The
+// bounding super triangle is kept symbolically at infinity, so convex hull
+// edges survive regardless of how elongated the input is.
+//
+// Returns every triangulation edge once as an (a, b) index pair with a < b,
+// sorted ascending. These are exactly the Voronoi cell adjacencies.
+std::vector<std::pair<size_t, size_t>> computeDelaunayEdges(const std::vector<std::pair<double, double>>& points);
+
+} // namespace space4x
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+namespace space4x {
+
+// Batch distance kernels over SoA coordinates (xs[i], ys[i]), e.g. the arrays
+// of a GalaxyGeometry. The implementation is chosen once per process from the
+// CPU: AVX2 on x86-64 when available, NEON on AArch64, scalar otherwise.
+// SPACE4X_SIMD=scalar forces the fallback. Every variant computes
+// dx * dx + dy * dy without fused multiply-add, so results are bit-identical
+// to the scalar loop.
+struct DistanceKernels {
+    const char* name;
+
+    // out[i] = squared distance from (px, py) to point i
+    void (*squaredDistances)(const double* xs, const double* ys, size_t count,
+                             double px, double py, double* out);
+
+    // out[i] = distance from (px, py) to point i
+    void (*distances)(const double* xs, const double* ys, size_t count,
+                      double px, double py, double* out);
+
+    // Index of the first point strictly closer than sqrt(radiusSquared), or count
+    size_t (*firstWithin)(const double* xs, const double* ys, size_t count,
+                          double px, double py, double radiusSquared);
+};
+
+const DistanceKernels& distanceKernels();
+
+// True if any point lies strictly closer than radius
+inline bool anyWithin(const double* xs, const double* ys, size_t count, double px, double py, double radius) {
+    return distanceKernels().firstWithin(xs, ys, count, px, py, radius * radius) < count;
+}
+
+// Up to k nearest points passing accept(index), as (distance, index) pairs
+// sorted ascending with ties broken by index. Only the k winners are sorted.
+template <typename Filter>
+std::vector<std::pair<double, uint32_t>> nearestPoints(const double* xs, const double* ys, size_t count,
+                                                       double px, double py, size_t k, Filter&& accept) {
+    std::vector<double> squared(count);
+    distanceKernels().squaredDistances(xs, ys, count, px, py, squared.data());
+
+    std::vector<std::pair<double, uint32_t>> found;
+    found.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (accept(i)) found.push_back({squared[i], static_cast<uint32_t>(i)});
+    }
+    if (found.size() > k) {
+        std::nth_element(found.begin(), found.begin() + k, found.end());
+        found.resize(k);
+    }
+    std::sort(found.begin(), found.end());
+    for (auto& entry : found) {
+        entry.first = std::sqrt(entry.first);
+    }
+    return found;
+}
+
+} // namespace space4x
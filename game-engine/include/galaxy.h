@@ -4,10 +4,19 @@
 #include <string>
 #include <unordered_map>
 #include <random>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <chrono>
+#include <functional>
 #include "celestial_bodies.h"
+#include "cow_vector.h"
 
 namespace space4x {
 
+struct RouteLandmarks;
+
 struct StarSystem {
     std::string id;
     std::string name;
@@ -55,6 +64,16 @@ struct WarpLane {
     bool discovered;
 };
 
+const double kLightYearsPerTurn = 5.0;  // Warp speed
+
+// Turns to cross a lane of the given length
+inline int laneTravelTime(double distance) {
+    return static_cast<int>(std::ceil(distance / kLightYearsPerTurn));
+}
+
+// Lane record between two systems; travel time and discovery follow from them
+WarpLane makeWarpLane(const StarSystem& from, const StarSystem& to, double distance);
+
 struct FixedSystem {
     std::string id;
     std::string name;
@@ -69,11 +88,20 @@ struct FixedSystem {
 
 struct VoronoiSite {
     double x, y;  // Position
-    std::string systemId;  // Associated system ID (empty if no system)
+    uint32_t systemIndex;  // Index of the associated system (valid if hasSystem)
     std::vector<size_t> neighbors;  // Indices of neighboring sites
     bool hasSystem;
 };
 
+// How neighboring Voronoi sites are determined
+enum class ConnectivityMode {
+    NearestNeighbors,  // Six nearest sites, made symmetric (original game approach)
+    Delaunay           // Exact Voronoi adjacency from a Delaunay triangulation
+};
+
+ConnectivityMode connectivityModeFromString(const std::string& name);
+const char* connectivityModeName(ConnectivityMode mode);
+
 struct GalaxyConfig {
     int seed;
     double radius;  // Light years
@@ -89,8 +117,14 @@ struct GalaxyConfig {
         double maxDistance;
         double distanceDecayFactor;
         bool useVoronoiConnectivity;  // Use Voronoi-based connections
+        ConnectivityMode mode = ConnectivityMode::NearestNeighbors;  // Voronoi neighbor backend
     } connectivity;
     
+    struct {
+        bool parallel = false;  // Tiled multi-threaded pipeline with per-stage RNG streams
+        int threads = 0;        // Worker threads (0 or more than the cores = hardware concurrency)
+    } generation;
+    
     struct {
         int width;
         int height;
@@ -98,90 +132,533 @@ struct GalaxyConfig {
     } visualization;
 };
 
+// Connectivity tier of a system, decoded once from StarSystem::type
+enum class SystemTier : uint8_t {
+    Origin,
+    Core,
+    Rim
+};
+constexpr size_t kSystemTierCount = 3;
+
+// Per tier: its StarSystem::type spelling, and how far its lanes may reach
+// relative to the base lane distance
+constexpr const char* kSystemTierNames[kSystemTierCount] = {"origin", "core", "rim"};
+constexpr double kTierRangeMultipliers[kSystemTierCount] = {
+    2.5,  // +150% for origin system (galactic capital)
+    2.0,  // +100% for core systems (extremely well connected)
+    0.4   // -60% for rim systems (very isolated)
+};
+
+// Range multiplier of a lane between tiers A and B: mixed connections use the
+// more generous one
+template <SystemTier A, SystemTier B>
+constexpr double tierPairRangeMultiplier() {
+    return kTierRangeMultipliers[static_cast<size_t>(A)] > kTierRangeMultipliers[static_cast<size_t>(B)]
+        ? kTierRangeMultipliers[static_cast<size_t>(A)] : kTierRangeMultipliers[static_cast<size_t>(B)];
+}
+
+SystemTier systemTierFromType(const std::string& type);
+inline const char* systemTierName(SystemTier tier) { return kSystemTierNames[static_cast<size_t>(tier)]; }
+
+// Kind of an anomaly; Anomaly::type holds its name (see galaxy.cpp's table)
+enum class AnomalyType : uint8_t {
+    Nebula,
+    BlackHole,
+    Wormhole,
+    Artifact,
+    Resource
+};
+
+class LaneGraph;
+
+// Structure-of-arrays view of the per-system fields that distance and graph
+// code reads, indexed like Galaxy::systems. Positions and tiers sit in their
+// own contiguous arrays; lanes are kept in CSR form, so the neighbors of i
+// are laneTargets[laneOffsets[i] .. laneOffsets[i + 1]), and laneIds names
+// the lane behind each entry by its position in the list it was built from.
+struct GalaxyGeometry {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<SystemTier> tier;
+
+    std::vector<uint32_t> laneOffsets;    // size() + 1 entries once lanes are assigned
+    std::vector<uint32_t> laneTargets;
+    std::vector<double> laneDistances;    // Parallel to laneTargets
+    std::vector<uint32_t> laneIds;        // Parallel to laneTargets
+
+    size_t size() const { return x.size(); }
+    bool hasLanes() const { return laneOffsets.size() == x.size() + 1; }
+
+    double distance(uint32_t a, uint32_t b) const {
+        double dx = x[a] - x[b];
+        double dy = y[a] - y[b];
+        return std::sqrt(dx * dx + dy * dy);
+    }
+    double distanceTo(uint32_t a, double px, double py) const {
+        double dx = x[a] - px;
+        double dy = y[a] - py;
+        return std::sqrt(dx * dx + dy * dy);
+    }
+
+    uint32_t degree(uint32_t node) const { return laneOffsets[node + 1] - laneOffsets[node]; }
+    const uint32_t* neighborsBegin(uint32_t node) const { return laneTargets.data() + laneOffsets[node]; }
+    const uint32_t* neighborsEnd(uint32_t node) const { return laneTargets.data() + laneOffsets[node + 1]; }
+
+    // Copies positions and tiers; clears any lanes
+    void assignPositions(const std::vector<StarSystem>& systems);
+    void assignPositions(const CowVector<StarSystem>& systems);
+
+    // Lane adjacency in the graph's neighbor order
+    void assignLanes(const LaneGraph& lanes);
+
+    // Lane adjacency from (from, to, distance) triples, in the order given
+    void assignLanes(const std::vector<std::pair<uint32_t, uint32_t>>& endpoints,
+                     const std::vector<double>& distances);
+
+    // Id of the lane between a and b, -1 if none; scans the shorter range
+    int64_t findLane(uint32_t a, uint32_t b) const;
+
+    // In-place lane edits matching what assignLanes would rebuild: a new lane
+    // (id one past the last) goes last in both ranges; removing one shifts
+    // the ids after it down
+    void appendLane(uint32_t a, uint32_t b, double distance, uint32_t id);
+    void removeLane(uint32_t a, uint32_t b, uint32_t id);
+
+    size_t heapBytes() const;
+};
+
+// What one or more edits changed, with enough data to replay them on a copy
+// of the galaxy they were made against. Lanes are named by their endpoints.
+struct GalaxyDelta {
+    uint64_t baseRevision = 0;  // Galaxy::revision the edits were made against
+
+    struct Flag {
+        std::string id;
+        bool value;
+    };
+    struct LaneFlag {
+        std::string from, to;
+        bool value;
+    };
+
+    std::vector<StarSystem> systemsAdded;  // Without connections; see lanesAdded
+    std::vector<std::string> systemsRemoved;
+    std::vector<WarpLane> lanesAdded;      // Requested lanes and connectivity repairs
+    std::vector<std::pair<std::string, std::string>> lanesRemoved;
+    std::vector<Flag> systemsExplored;
+    std::vector<LaneFlag> lanesDiscovered;
+    std::vector<Flag> anomaliesDiscovered;
+
+    bool empty() const {
+        return systemsAdded.empty() && systemsRemoved.empty() && lanesAdded.empty() && lanesRemoved.empty() &&
+               systemsExplored.empty() && lanesDiscovered.empty() && anomaliesDiscovered.empty();
+    }
+    bool changesSystems() const { return !systemsAdded.empty() || !systemsRemoved.empty(); }
+};
+
+// Galaxies are copied for every edit, so the bulky parts are shared between
+// copies: the record vectors are copy-on-write by chunk and the id index is
+// replaced rather than modified. An edited copy costs the chunks it touches
+// plus the geometry's flat arrays.
 struct Galaxy {
+    typedef std::unordered_map<std::string, uint32_t> SystemIdIndex;
+
     GalaxyConfig config;
-    std::vector<StarSystem> systems;
-    std::vector<Anomaly> anomalies;
-    std::vector<WarpLane> warpLanes;
+    CowVector<StarSystem> systems;
+    CowVector<Anomaly> anomalies;
+    CowVector<WarpLane> warpLanes;
     struct {
         double minX, maxX, minY, maxY, radius;
     } bounds;
+
+    // System ID -> position in systems, and the SoA geometry with lane
+    // adjacency; both rebuilt by indexSystems() whenever systems change.
+    // Lane edits keep the geometry in step themselves
+    std::shared_ptr<const SystemIdIndex> systemIndex = std::make_shared<SystemIdIndex>();
+    GalaxyGeometry geometry;
+
+    // Number of edit deltas applied since generation; saved with snapshots so
+    // a replayed delta log can tell which entries the base already contains
+    uint64_t revision = 0;
+
+    // ALT tables for route queries, built at generation time (route_planner.h).
+    // Only valid for the lanes they were built from: indexLanes() and lane
+    // edits drop them
+    std::shared_ptr<const RouteLandmarks> landmarks;
+
+    void indexSystems();
+    void indexLanes();  // Only the geometry's lane adjacency
+    const StarSystem* findSystem(const std::string& id) const;
+    int64_t findSystemIndex(const std::string& id) const;  // -1 when absent
+    int64_t findLaneIndex(const std::string& from, const std::string& to) const;  // Either direction, via geometry
+
+    // Incremental edits (galaxy_mutation.cpp). Each keeps systemIndex, geometry
+    // and connections in step, appends what changed to delta, and returns false
+    // with error set, leaving the galaxy untouched, if the edit is invalid.
+    // Removals that split the lane network are repaired locally: only the
+    // affected endpoints are searched, and each stranded component gets the
+    // shortest lane back to the rest.
+    bool addSystem(StarSystem system, GalaxyDelta& delta, std::string& error);  // Linked to its nearest systems
+    bool removeSystem(const std::string& id, GalaxyDelta& delta, std::string& error);
+    bool addLane(const std::string& from, const std::string& to, GalaxyDelta& delta, std::string& error);
+    bool removeLane(const std::string& from, const std::string& to, GalaxyDelta& delta, std::string& error);
+    bool setSystemExplored(const std::string& id, bool explored, GalaxyDelta& delta, std::string& error);
+    bool setLaneDiscovered(const std::string& from, const std::string& to, bool discovered,
+                           GalaxyDelta& delta, std::string& error);
+    bool setAnomalyDiscovered(const std::string& id, bool discovered, GalaxyDelta& delta, std::string& error);
+
+    // Replays a recorded delta, repairs included, and bumps revision. Deltas
+    // made against an older revision are already contained and skipped; one
+    // made against a newer revision means entries are missing and fails
+    // before touching anything. A delta that doesn't fit the galaxy fails
+    // part-way, so replay onto a galaxy that can be thrown away.
+    bool applyDelta(const GalaxyDelta& delta, std::string& error);
+};
+
+// Stages of parallel generation; each draws from its own RNG streams
+enum class GenerationStage : uint32_t {
+    Sites = 1,
+    FixedSystems,
+    Systems,
+    Lanes,
+    Anomalies
 };
 
 class SeededRandom {
 private:
-    std::mt19937 generator;
-    std::uniform_real_distribution<double> distribution;
+    // Serial mode: the original game's single mt19937 sequence. Streams
+    // never allocate it, so they cost a couple of words instead of ~5 KB.
+    std::unique_ptr<std::mt19937> generator;
+    std::uniform_real_distribution<double> distribution{0.0, 1.0};
+    
+    // Counter-based mode: draw n is a pure hash of (streamKey, n), so streams
+    // for any (seed, stage, index) can be created in any order on any thread
+    uint64_t streamKey = 0;
+    uint64_t counter = 0;
+    
+    SeededRandom() = default;
+    
+    // SplitMix64 finalizer
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
 
 public:
-    SeededRandom(int seed) : generator(seed), distribution(0.0, 1.0) {}
+    SeededRandom(int seed) : generator(new std::mt19937(seed)) {}
     
-    double next() { return distribution(generator); }
+    static SeededRandom stream(int seed, GenerationStage stage, uint64_t index) {
+        SeededRandom rng;
+        rng.streamKey = mix(mix(mix(static_cast<uint64_t>(static_cast<uint32_t>(seed))) +
+                                static_cast<uint64_t>(stage)) + index);
+        return rng;
+    }
+    
+    double next() {
+        if (generator) return distribution(*generator);
+        uint64_t bits = mix(streamKey + (++counter) * 0x9E3779B97F4A7C15ULL);
+        return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0);  // 53-bit mantissa
+    }
     double range(double min, double max) { return min + next() * (max - min); }
     int intRange(int min, int max) { return min + static_cast<int>(next() * (max - min + 1)); }
     bool boolean(double probability = 0.5) { return next() < probability; }
 };
 
+// Uniform-grid spatial index over 2D positions (light years). The grid covers
+// center ± extent on both axes (the galaxy disc by default); points outside it
+// are kept in the border cells, so queries stay exact for anything beyond it.
+class SpatialGrid {
+public:
+    SpatialGrid() = default;
+    SpatialGrid(double extent, double cellSize) { reset(extent, cellSize); }
+    SpatialGrid(double centerX, double centerY, double extent, double cellSize) { reset(centerX, centerY, extent, cellSize); }
+
+    // Cell size giving roughly one point per cell, but never below minCellSize
+    static double cellSizeFor(double extent, size_t expectedPoints, double minCellSize);
+
+    void reset(double extent, double cellSize) { reset(0.0, 0.0, extent, cellSize); }
+    void reset(double centerX, double centerY, double extent, double cellSize);  // Covers center ± extent
+    size_t insert(double x, double y);  // Returns the point index (insertion order)
+    size_t size() const { return points.size(); }
+    bool empty() const { return points.empty(); }
+
+    // True if any indexed point lies strictly closer than radius
+    bool anyWithin(double x, double y, double radius) const;
+
+    // Calls visit(index, distance) for every point with distance <= radius
+    template <typename Visitor>
+    void forEachWithin(double x, double y, double radius, Visitor&& visit) const;
+
+    // Calls visit(index) for every point inside [minX, maxX] x [minY, maxY]
+    template <typename Visitor>
+    void forEachInBox(double minX, double minY, double maxX, double maxY, Visitor&& visit) const;
+
+    // Up to k nearest points passing accept(index), as (distance, index) pairs
+    // sorted ascending with ties broken by index
+    template <typename Filter>
+    std::vector<std::pair<double, size_t>> nearest(double x, double y, size_t k, Filter&& accept) const;
+    std::vector<std::pair<double, size_t>> nearest(double x, double y, size_t k) const {
+        return nearest(x, y, k, [](size_t) { return true; });
+    }
+
+private:
+    struct Entry {
+        double x, y;
+        size_t index;
+    };
+
+    double originX = 0.0, originY = 0.0;
+    double cellSize = 1.0;
+    double inverseCellSize = 1.0;
+    int cellsPerSide = 1;
+    std::vector<std::vector<Entry>> cells;
+    std::vector<std::pair<double, double>> points;
+
+    int cellCoord(double value, double origin) const;
+    int cellX(double x) const { return cellCoord(x, originX); }
+    int cellY(double y) const { return cellCoord(y, originY); }
+    const std::vector<Entry>& cellAt(int cx, int cy) const { return cells[cy * cellsPerSide + cx]; }
+};
+
+template <typename Visitor>
+void SpatialGrid::forEachWithin(double x, double y, double radius, Visitor&& visit) const {
+    if (points.empty()) return;
+
+    const double radiusSquared = radius * radius;
+    const int minX = cellX(x - radius), maxX = cellX(x + radius);
+    const int minY = cellY(y - radius), maxY = cellY(y + radius);
+
+    for (int cy = minY; cy <= maxY; cy++) {
+        for (int cx = minX; cx <= maxX; cx++) {
+            for (const Entry& entry : cellAt(cx, cy)) {
+                double dx = entry.x - x;
+                double dy = entry.y - y;
+                double distanceSquared = dx * dx + dy * dy;
+                if (distanceSquared <= radiusSquared) {
+                    visit(entry.index, std::sqrt(distanceSquared));
+                }
+            }
+        }
+    }
+}
+
+template <typename Visitor>
+void SpatialGrid::forEachInBox(double minX, double minY, double maxX, double maxY, Visitor&& visit) const {
+    if (points.empty()) return;
+
+    const int firstX = cellX(minX), lastX = cellX(maxX);
+    const int firstY = cellY(minY), lastY = cellY(maxY);
+    for (int cy = firstY; cy <= lastY; cy++) {
+        for (int cx = firstX; cx <= lastX; cx++) {
+            for (const Entry& entry : cellAt(cx, cy)) {
+                if (entry.x >= minX && entry.x <= maxX && entry.y >= minY && entry.y <= maxY) {
+                    visit(entry.index);
+                }
+            }
+        }
+    }
+}
+
+template <typename Filter>
+std::vector<std::pair<double, size_t>> SpatialGrid::nearest(double x, double y, size_t k, Filter&& accept) const {
+    std::vector<std::pair<double, size_t>> found;
+    if (k == 0 || points.empty()) return found;
+
+    const int centerX = cellX(x);
+    const int centerY = cellY(y);
+
+    // Scan square rings of cells outwards. Every cell outside ring r is at least
+    // r * cellSize away, so once k candidates lie within that bound we are done.
+    for (int ring = 0; ring < cellsPerSide; ring++) {
+        for (int cy = centerY - ring; cy <= centerY + ring; cy++) {
+            if (cy < 0 || cy >= cellsPerSide) continue;
+
+            bool edgeRow = (cy == centerY - ring || cy == centerY + ring);
+            int step = edgeRow ? 1 : 2 * ring;
+            for (int cx = centerX - ring; cx <= centerX + ring; cx += step) {
+                if (cx < 0 || cx >= cellsPerSide) continue;
+
+                for (const Entry& entry : cellAt(cx, cy)) {
+                    if (!accept(entry.index)) continue;
+                    double dx = entry.x - x;
+                    double dy = entry.y - y;
+                    found.push_back({std::sqrt(dx * dx + dy * dy), entry.index});
+                }
+            }
+        }
+
+        if (found.size() >= k) {
+            std::nth_element(found.begin(), found.begin() + (k - 1), found.end());
+            found.resize(k);
+            if (found.back().first <= ring * cellSize) break;
+        }
+    }
+
+    std::sort(found.begin(), found.end());
+    return found;
+}
+
+// Undirected warp lane graph keyed by system index (position in the systems
+// vector). Lane generation runs entirely on this; string IDs are attached only
+// when lanes are materialized for the Galaxy.
+class LaneGraph {
+public:
+    struct Edge {
+        uint32_t from, to;
+        double distance;
+    };
+
+    explicit LaneGraph(size_t nodeCount = 0) : adjacency(nodeCount) {}
+
+    size_t nodeCount() const { return adjacency.size(); }
+    size_t edgeCount() const { return edgeList.size(); }
+    size_t degree(uint32_t node) const { return adjacency[node].size(); }
+    const std::vector<uint32_t>& neighbors(uint32_t node) const { return adjacency[node]; }
+    const std::vector<Edge>& edges() const { return edgeList; }
+
+    bool connected(uint32_t a, uint32_t b) const {
+        const auto& list = adjacency[a];
+        return std::find(list.begin(), list.end(), b) != list.end();
+    }
+
+    // Adds the lane a-b unless it already exists; returns whether it was added
+    bool addEdge(uint32_t a, uint32_t b, double distance) {
+        if (connected(a, b)) return false;
+        edgeList.push_back({a, b, distance});
+        adjacency[a].push_back(b);
+        adjacency[b].push_back(a);
+        return true;
+    }
+
+private:
+    std::vector<std::vector<uint32_t>> adjacency;
+    std::vector<Edge> edgeList;
+};
+
+// Union-find over system indices with union by size and iterative path halving
+class DisjointSet {
+public:
+    explicit DisjointSet(size_t count = 0) : parent(count), sizes(count, 1), components(count) {
+        for (size_t i = 0; i < count; i++) parent[i] = static_cast<uint32_t>(i);
+    }
+
+    uint32_t find(uint32_t x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    // Merges the sets holding a and b; returns false if they were already joined
+    bool unite(uint32_t a, uint32_t b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) return false;
+        if (sizes[a] < sizes[b]) std::swap(a, b);
+        parent[b] = a;
+        sizes[a] += sizes[b];
+        components--;
+        return true;
+    }
+
+    size_t setSize(uint32_t x) { return sizes[find(x)]; }
+    size_t componentCount() const { return components; }
+
+private:
+    std::vector<uint32_t> parent;
+    std::vector<size_t> sizes;
+    size_t components;
+};
+
+// Wall time of one generation pipeline stage
+struct StageTiming {
+    const char* stage;
+    double milliseconds;
+};
+
 class GalaxyGenerator {
 private:
     GalaxyConfig config;
     SeededRandom random;
-    SystemConfigManager systemConfigManager;
+    const SystemConfigManager& systemConfigManager;  // The shared catalog
     std::vector<VoronoiSite> voronoiSites;
-    
+    SpatialGrid siteIndex;    // Mirrors voronoiSites (same indices)
+    SpatialGrid systemIndex;  // Mirrors the generated systems vector
+    GalaxyGeometry geometry;  // Hot fields of the generated systems (same indices)
+    std::vector<StageTiming> timings;
+    std::chrono::steady_clock::time_point stageStart;
+    std::function<void(const StageTiming&)> stageObserver;
+    size_t reachableSystems = 0;  // Result of the last verifyConnectivity()
+
     // Voronoi-based generation (new approach from original game)
     std::vector<VoronoiSite> generateVoronoiSites(int numSites);
+    std::vector<VoronoiSite> generateVoronoiSitesTiled(int numSites, double minDistance);
     bool isValidVoronoiPosition(const std::pair<double, double>& pos, double minDistance);
     void computeVoronoiNeighbors();
     std::vector<StarSystem> generateSystemsFromVoronoi();
-    std::vector<WarpLane> generateVoronoiWarpLanes(std::vector<StarSystem>& systems);
+    StarSystem createVoronoiSystem(const VoronoiSite& site, int systemNumber, SeededRandom& rng);
+    LaneGraph generateVoronoiWarpLanes(const std::vector<StarSystem>& systems);
     
     // Original generation methods (fallback)
     std::vector<StarSystem> generateStarSystems();
     std::vector<Anomaly> generateAnomalies(const std::vector<StarSystem>& systems);
-    std::vector<WarpLane> generateWarpLanes(std::vector<StarSystem>& systems);
+    LaneGraph generateWarpLanes(const std::vector<StarSystem>& systems);
+    
+    // Parallel generation: worker count (1 when serial) and per-stage RNG streams
+    int workerCount() const;
+    void beginStage(GenerationStage stage);
+    void endStage(const char* stage);  // Records the time since the previous stage ended
     
     // Utility methods
     std::pair<double, double> generateRandomPositionInCircle();
-    bool isPositionTooCloseToSystems(const std::pair<double, double>& pos, 
-                                   const std::vector<StarSystem>& systems, 
+    void indexSystems(const std::vector<StarSystem>& systems);
+    bool isPositionTooCloseToSystems(const std::pair<double, double>& pos,
+                                   const SpatialGrid& systems,
                                    double minDistance);
     bool isPositionTooClose(const std::pair<double, double>& pos,
-                          const std::vector<Anomaly>& anomalies,
+                          const SpatialGrid& anomalies,
                           double minDistance);
-    double calculateDistance(const std::pair<double, double>& a, 
-                           const std::pair<double, double>& b);
     
             // Connection methods
-            void createWarpLane(StarSystem& system1, StarSystem& system2, double distance,
-                               std::vector<WarpLane>& warpLanes,
-                               std::unordered_map<std::string, std::vector<std::string>>& connections);
-            void ensureMinimumConnectivity(std::vector<StarSystem>& systems,
-                                         std::vector<WarpLane>& warpLanes,
-                                         std::unordered_map<std::string, std::vector<std::string>>& connections);
-            void ensureNetworkConnectivity(std::vector<StarSystem>& systems,
-                                         std::vector<WarpLane>& warpLanes,
-                                         std::unordered_map<std::string, std::vector<std::string>>& connections);
-            void addRedundantConnections(std::vector<StarSystem>& systems,
-                                       std::vector<WarpLane>& warpLanes,
-                                       std::unordered_map<std::string, std::vector<std::string>>& connections);
+            void createWarpLane(uint32_t system1, uint32_t system2, double distance, LaneGraph& lanes);
+            void ensureMinimumConnectivity(const std::vector<StarSystem>& systems, LaneGraph& lanes);
+            void ensureNetworkConnectivity(const std::vector<StarSystem>& systems, LaneGraph& lanes);
+            void addRedundantConnections(const std::vector<StarSystem>& systems, LaneGraph& lanes);
             
             // Tiered connectivity helper
-            double calculateTieredDistance(const StarSystem* system1, const StarSystem* system2, double baseDistance);
+            double calculateTieredDistance(uint32_t system1, uint32_t system2, double baseDistance);
+            
+            // Connectivity verification: systems reachable from the first one
+            size_t verifyConnectivity(const std::vector<StarSystem>& systems, const LaneGraph& lanes);
             
-            // Connectivity verification
-            void verifyConnectivity(const std::vector<StarSystem>& systems,
-                                  const std::unordered_map<std::string, std::vector<std::string>>& connections);
+            // Attach string IDs: fills system.connections and returns the lane list
+            std::vector<WarpLane> materializeWarpLanes(std::vector<StarSystem>& systems, const LaneGraph& lanes);
     
     // Name and type generation
     std::string generateSystemName(int index);
-    std::string generateAnomalyName(const std::string& type, int index);
-    std::string determineSystemType(const std::pair<double, double>& position);
-    std::string generateAnomalyType();
+    std::string generateAnomalyName(AnomalyType type, int index);
+    SystemTier determineSystemType(const std::pair<double, double>& position);
+    AnomalyType generateAnomalyType();
 
 public:
     GalaxyGenerator(const GalaxyConfig& cfg);
     Galaxy generateGalaxy();
+
+    // Stages of the last generateGalaxy() call, in pipeline order
+    const std::vector<StageTiming>& stageTimings() const { return timings; }
+    
+    // Systems the last generateGalaxy() found reachable over its lanes from the
+    // first system; the network is connected when this equals the system count
+    size_t connectedSystemCount() const { return reachableSystems; }
+    
+    // How many stages generateGalaxy() reports for config
+    static size_t stageCount(const GalaxyConfig& config);
+    
+    // Called on the generating thread as each stage ends; may throw to
+    // abandon the galaxy, and the exception leaves generateGalaxy()
+    void setStageObserver(std::function<void(const StageTiming&)> observer) { stageObserver = std::move(observer); }
 };
 
 // JSON serialization functions
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "galaxy.h"
+#include "http_encoding.h"
+
+namespace space4x {
+
+// Canonical form of every GalaxyConfig field that affects the generated galaxy.
+// Worker thread count is left out: parallel output doesn't depend on it.
+std::string canonicalGalaxyKey(const GalaxyConfig& config);
+
+// Strong ETag for a response body (quoted FNV-1a 64 of the bytes)
+std::string computeEtag(const std::string& body);
+
+// Rough heap footprint of a galaxy, used for the cache budget
+size_t estimateGalaxyBytes(const Galaxy& galaxy);
+
+// LRU cache of generated galaxies with their serialized response and save
+// snapshot, bounded by a byte budget. Entries are immutable and shared, so a
+// hit hands out the same buffers the first request produced; compressed forms
+// of the response are added to an entry the first time a client asks for one.
+class GalaxyCache {
+public:
+    struct Entry {
+        std::shared_ptr<const Galaxy> galaxy;
+        std::shared_ptr<const std::string> json;
+        std::shared_ptr<const std::string> snapshot;
+        std::string etag;
+        size_t bytes = 0;
+
+    private:
+        friend class GalaxyCache;
+        mutable std::mutex encodingMutex;  // Held while an encoding is produced
+        mutable std::shared_ptr<const std::string> encoded[kContentEncodingCount];
+        mutable size_t encodedBytes = 0;   // On top of bytes; guarded by the cache mutex
+        mutable bool resident = false;     // Counted in the budget; guarded by the cache mutex
+    };
+
+    explicit GalaxyCache(size_t budgetBytes) : budget(budgetBytes) {}
+
+    GalaxyCache(const GalaxyCache&) = delete;
+    GalaxyCache& operator=(const GalaxyCache&) = delete;
+
+    // Marks the entry most recently used; null on a miss
+    std::shared_ptr<const Entry> find(const std::string& key);
+
+    // Builds and stores the entry, evicting least recently used ones to fit.
+    // An entry larger than the whole budget is returned but not kept.
+    std::shared_ptr<const Entry> insert(const std::string& key, std::shared_ptr<const Galaxy> galaxy,
+                                        std::shared_ptr<const std::string> json,
+                                        std::shared_ptr<const std::string> snapshot);
+
+    // entry's JSON in encoding, compressed once and kept with the entry; null for
+    // identity or when compression fails
+    std::shared_ptr<const std::string> encodedJson(const std::shared_ptr<const Entry>& entry, ContentEncoding encoding);
+
+    size_t size() const;
+    size_t bytes() const;
+
+private:
+    typedef std::list<std::pair<std::string, std::shared_ptr<const Entry>>> LruList;
+
+    size_t budget;
+    size_t used = 0;
+    mutable std::mutex mutex;
+    LruList lru;  // Front is most recently used
+    std::unordered_map<std::string, LruList::iterator> index;
+
+    void evictToFit(size_t incoming);  // Caller holds mutex
+    void drop(LruList::iterator it);   // Caller holds mutex
+};
+
+} // namespace space4x
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+#include <deque>
+#include <chrono>
+#include <stdexcept>
+#include <cstdint>
+#include "galaxy.h"
+#include "galaxy_cache.h"
+#include "thread_pool.h"
+
+namespace space4x {
+
+enum class JobState { Queued, Running, Done, Failed, Cancelled };
+
+const char* jobStateName(JobState state);
+
+// Thrown out of a generation whose job was cancelled
+struct GenerationCancelled : std::runtime_error {
+    GenerationCancelled() : std::runtime_error("Generation cancelled") {}
+};
+
+// One background galaxy generation, shared by every client that asked for
+// the same config while it was in flight.
+class GalaxyJob {
+public:
+    // A running job nobody has polled for this long is cancelled at its next stage
+    static const int kAbandonAfterSeconds = 60;
+
+    struct Progress {
+        JobState state = JobState::Queued;
+        std::string stage;       // Last finished stage
+        size_t stagesDone = 0;
+        size_t stageCount = 0;   // Generator stages plus serialization
+        double elapsedMs = 0.0;  // Running time so far, or in total once finished
+        std::string error;       // Why it failed
+        uint64_t version = 0;    // Bumped on every change
+    };
+
+    GalaxyJob(std::string id, std::string key, const GalaxyConfig& config);
+
+    GalaxyJob(const GalaxyJob&) = delete;
+    GalaxyJob& operator=(const GalaxyJob&) = delete;
+
+    const std::string& id() const { return jobId; }
+    const std::string& key() const { return jobKey; }
+    const GalaxyConfig& config() const { return jobConfig; }
+
+    // Current progress; counts as a poll
+    Progress progress() const;
+
+    // Progress once its version passes seen, or when timeout runs out; counts as a poll
+    Progress waitForChange(uint64_t seen, std::chrono::milliseconds timeout) const;
+
+    // The generated galaxy once Done, else null
+    std::shared_ptr<const GalaxyCache::Entry> result() const;
+
+    // Queued or running, and not cancelled
+    bool active() const;
+
+    // One more client coalesced onto the job
+    void subscribe();
+
+    // Withdraws one client's interest. The job is cancelled when none is left;
+    // true if it is (or already was) cancelled
+    bool unsubscribe();
+
+    // Runner side. start() is false if the job was cancelled while queued;
+    // stageFinished() throws GenerationCancelled once the job is cancelled or abandoned
+    bool start();
+    void stageFinished(const char* stage);
+    void finish(std::shared_ptr<const GalaxyCache::Entry> entry);
+    void fail(const std::string& error);
+    void cancel();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    const std::string jobId;
+    const std::string jobKey;
+    const GalaxyConfig jobConfig;
+
+    mutable std::mutex mutex;
+    mutable std::condition_variable changed;
+    Progress current;
+    size_t subscribers = 1;
+    bool cancelRequested = false;
+    std::shared_ptr<const GalaxyCache::Entry> entry;
+    Clock::time_point startedAt;
+    mutable Clock::time_point lastPolled;
+
+    Progress snapshot() const;  // Caller holds mutex
+    void publish();             // Caller holds mutex; bumps the version and wakes waiters
+};
+
+// Bounded background executor for galaxy jobs. Identical configs in flight
+// share one job, and finished jobs are kept a while so clients can collect them.
+class GalaxyJobQueue {
+public:
+    // Builds the galaxy for a job, reporting stages through job.stageFinished()
+    typedef std::function<std::shared_ptr<const GalaxyCache::Entry>(GalaxyJob& job)> Runner;
+
+    GalaxyJobQueue(size_t threads, size_t maxPending, size_t keepFinished, Runner runner);
+    ~GalaxyJobQueue();  // Cancels what is left, then joins the threads
+
+    GalaxyJobQueue(const GalaxyJobQueue&) = delete;
+    GalaxyJobQueue& operator=(const GalaxyJobQueue&) = delete;
+
+    // The job in flight for key (coalesced is set), else a new queued one;
+    // null when maxPending jobs are already waiting
+    std::shared_ptr<GalaxyJob> submit(const std::string& key, const GalaxyConfig& config, bool& coalesced);
+
+    std::shared_ptr<GalaxyJob> find(const std::string& id) const;
+
+private:
+    Runner runner;
+    size_t maxPending;
+    size_t keepFinished;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<GalaxyJob>> jobs;      // By id
+    std::unordered_map<std::string, std::shared_ptr<GalaxyJob>> inFlight;  // By config key
+    std::deque<std::string> finishedIds;  // Oldest first, trimmed to keepFinished
+    size_t pending = 0;
+    uint64_t nextId = 1;
+
+    std::unique_ptr<ThreadPool> pool;  // Declared last, so its threads stop before the rest goes
+
+    void run(const std::shared_ptr<GalaxyJob>& job);
+};
+
+} // namespace space4x
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include "galaxy.h"
+#include "celestial_bodies.h"
+#include "json_writer.h"
+
+namespace space4x {
+
+// JSON bodies shared by every HTTP front end and the batch tools, written with
+// JsonWriter so numbers come out exactly as they always have (6 significant digits).
+
+// Body of /api/galaxy/generate
+std::string serializeGalaxy(const Galaxy& galaxy);
+
+// Body of /api/system/<id>
+std::string serializeSystemDefinition(const SystemDefinition& systemDef);
+
+// One entry of a galaxy's "systems" / "anomalies" array, for bodies that list a subset
+void writeSystem(JsonWriter& json, const StarSystem& system);
+void writeAnomaly(JsonWriter& json, const Anomaly& anomaly);
+
+} // namespace space4x
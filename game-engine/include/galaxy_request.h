@@ -0,0 +1,93 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "galaxy.h"
+
+namespace space4x {
+
+// Galaxy generation request decoded from a JSON body. config starts out as
+// the caller's defaults; only fields present in the body are overwritten.
+//
+// Recognised members (all optional):
+//   seed, radius, systems | starSystemCount, anomalies | anomalyCount, minDistance,
+//   save_slot, use_saved, connectivity_mode, parallel, threads,
+//   connectivity { minConnections, maxConnections, maxDistance,
+//                  distanceDecayFactor, useVoronoiConnectivity, mode },
+//   generation { parallel, threads },
+//   visualization { width, height, scale },
+//   fixedSystems [ { id, name, x, y, type, hasFixedPosition,
+//                    targetDistance, distanceTolerance } ]
+// Unknown members are skipped.
+struct GalaxyRequest {
+    GalaxyConfig config;
+    int saveSlot = 1;
+    bool useSaved = false;
+
+    bool seedProvided = false;
+    bool radiusProvided = false;
+    bool systemsProvided = false;
+    bool anomaliesProvided = false;
+    bool fixedSystemsProvided = false;
+
+    bool anyGenerationParams() const {
+        return seedProvided || radiusProvided || systemsProvided || anomaliesProvided;
+    }
+};
+
+// One edit or order posted to /api/game/action. Only top-level members are read:
+//   action: add_system | remove_system | add_lane | remove_lane |
+//           set_explored | set_lane_discovered | set_anomaly_discovered |
+//           move_fleet
+//   id (system, anomaly or fleet), from, to (lane endpoints; a new fleet's
+//   start and its destination), name, type, x, y (add_system), value (new
+//   flag, default true)
+struct GameAction {
+    std::string action;
+    std::string id;
+    std::string from;
+    std::string to;
+    std::string name;
+    std::string type;
+    double x = 0.0;
+    double y = 0.0;
+    bool positionProvided = false;  // Both x and y given
+    bool value = true;
+};
+
+// Route queries posted to /api/route:
+//   metric: distance | time (default distance)
+//   from, to: one route, and/or
+//   routes [ { from, to } ]: a batch, e.g. the orders for a group of fleets
+// A top-level from/to pair comes first in routes.
+struct RouteQuery {
+    std::string from;
+    std::string to;
+};
+
+struct RouteRequest {
+    std::string metric = "distance";
+    std::vector<RouteQuery> routes;
+};
+
+// Generation parameters for anything a request body leaves out: the default
+// galaxy served by /api/galaxy and baked by --mode batch
+GalaxyRequest defaultGalaxyRequest();
+
+// Streams the body through nlohmann's SAX parser straight into request; no
+// DOM is built. An empty body is valid. False with error set on malformed
+// JSON or a member of the wrong type.
+bool decodeGalaxyRequest(const std::string& body, GalaxyRequest& request, std::string& error);
+
+// False with error set on malformed JSON, a mistyped member or a missing action
+bool decodeGameAction(const std::string& body, GameAction& action, std::string& error);
+
+// False with error set on malformed JSON, a mistyped member, a route without
+// both endpoints, or no route at all
+bool decodeRouteRequest(const std::string& body, RouteRequest& request, std::string& error);
+
+// Reads only the top-level save_slot of an arbitrary (possibly large) save
+// body, validating the rest as JSON without materialising it
+bool decodeSaveSlot(const std::string& body, int& saveSlot, std::string& error);
+
+} // namespace space4x
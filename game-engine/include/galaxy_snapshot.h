@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include "galaxy.h"
+
+namespace space4x {
+
+// Versioned binary snapshot of a generated galaxy, stored in saves.snapshot.
+//
+// Layout (little-endian):
+//   "S4XS" | u16 version | u16 flags | u32 payload size (uncompressed)
+//   payload: config, string table, then packed system / anomaly / lane records
+//
+// Every id, name and type string is stored once in the string table and
+// referenced by index; lanes refer to systems by index. Connections aren't
+// stored: they are rebuilt from the lanes in lane order, which is the order
+// generation produces them in, so a decoded galaxy serializes identically.
+// Version 2 adds the galaxy's edit revision; version 1 decodes as revision 0.
+const uint16_t kSnapshotVersion = 2;
+const uint16_t kSnapshotCompressed = 1;  // Payload is a zstd frame
+
+// True if the bytes start with the snapshot magic (as opposed to legacy JSON)
+bool isGalaxySnapshot(const std::string& data);
+
+// compress is ignored unless the build has zstd (make ZSTD=1)
+std::string encodeGalaxySnapshot(const Galaxy& galaxy, bool compress = true);
+
+// Restores detailedSystem pointers from definitions when given
+bool decodeGalaxySnapshot(const std::string& data, Galaxy& galaxy, std::string& error,
+                          const SystemConfigManager* definitions = nullptr);
+
+// One edit delta, appended to save_deltas after its base snapshot.
+//
+// Layout (little-endian):
+//   "S4XD" | u16 version | u16 flags (0) | u32 payload size
+//   payload: u64 base revision, then each GalaxyDelta list as a count plus records
+//
+// Deltas are small, so strings are stored inline, length-prefixed, and the
+// payload is never compressed.
+const uint16_t kDeltaVersion = 1;
+
+bool isGalaxyDelta(const std::string& data);
+std::string encodeGalaxyDelta(const GalaxyDelta& delta);
+bool decodeGalaxyDelta(const std::string& data, GalaxyDelta& delta, std::string& error,
+                       const SystemConfigManager* definitions = nullptr);
+
+} // namespace space4x
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include "galaxy.h"
+
+namespace space4x {
+
+// Viewport queries over one galaxy's layout, so the map can stream what is
+// visible instead of the whole galaxy.
+//
+// Zoom z splits the galaxy square (±radius) into 2^z x 2^z tiles. Level of
+// detail: at zoom z a system is shown only if it is the best of its cell in a
+// grid kCellsPerTile times finer than the tiles, where fixed and origin
+// systems always win, then core before rim and hubs before leaves. A tile so
+// holds about kCellsPerTile^2 systems however dense the galaxy is; from
+// maxZoom() on the cells are smaller than the minimum system spacing and
+// nothing is dropped. A lane is shown when both its ends are, clipped to the
+// viewport.
+//
+// Results are indices into the indexed galaxy's systems, warpLanes and
+// anomalies, so they also apply to any later galaxy with the same systems
+// and lanes (flag edits only).
+class GalaxyTileIndex {
+public:
+    static const int kCellsPerTile = 16;
+    static const int kMaxZoom = 12;
+
+    struct Viewport {
+        double minX, minY, maxX, maxY;
+        int zoom;
+    };
+
+    struct LaneSegment {
+        uint32_t lane;
+        double x1, y1, x2, y2;  // Within the viewport
+        bool clipped;           // An end was cut off at the viewport edge
+    };
+
+    struct Tile {
+        std::vector<uint32_t> systems;
+        std::vector<LaneSegment> lanes;
+        std::vector<uint32_t> anomalies;
+        size_t hiddenSystems = 0;  // Inside the viewport but below its level of detail
+    };
+
+    // The spatial index is built on the first query
+    explicit GalaxyTileIndex(std::shared_ptr<const Galaxy> galaxy);
+
+    GalaxyTileIndex(const GalaxyTileIndex&) = delete;
+    GalaxyTileIndex& operator=(const GalaxyTileIndex&) = delete;
+
+    int maxZoom() const { return finestZoom; }
+
+    // Area of tile (x, y) at zoom, with x and y counted from the -radius corner;
+    // false if the tile doesn't exist
+    bool tileViewport(int zoom, int x, int y, Viewport& viewport) const;
+
+    // Everything visible in the viewport, in index order
+    Tile query(const Viewport& viewport);
+
+private:
+    std::shared_ptr<const Galaxy> source;
+    double extent;  // Half the side of the galaxy square
+    int finestZoom;
+
+    std::once_flag built;
+    SpatialGrid systemGrid;
+    SpatialGrid anomalyGrid;
+    std::vector<uint8_t> systemZoom;  // Lowest zoom each system shows at
+    std::vector<uint32_t> laneEnds;   // Per lane: from, to system indices
+    int laneCellsPerSide = 1;
+    double laneCellSize = 1.0;
+    std::vector<uint32_t> laneCellOffsets;  // CSR: lanes whose bounding box touches each cell
+    std::vector<uint32_t> laneCellLanes;
+
+    void build();
+    int laneCell(double value) const;
+};
+
+} // namespace space4x
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstddef>
+
+namespace space4x {
+
+// Response Content-Encodings. gzip is always built in (zlib); br needs
+// make BROTLI=1 and zstd make ZSTD=1.
+enum class ContentEncoding { Identity, Gzip, Brotli, Zstd };
+
+const size_t kContentEncodingCount = 4;
+
+// Bodies smaller than this go out as they are; compression wouldn't pay for its headers
+const size_t kMinCompressBytes = 1024;
+
+// Header token: "identity", "gzip", "br" or "zstd"
+const char* contentEncodingName(ContentEncoding encoding);
+
+// Whether this build can produce encoding
+bool encodingSupported(ContentEncoding encoding);
+
+// Best supported encoding the Accept-Encoding header allows: highest q wins,
+// ties go br, zstd, gzip. Identity when nothing acceptable is built in
+ContentEncoding negotiateEncoding(const std::string& acceptEncoding);
+
+// body compressed with encoding; null for identity or if compression failed
+std::shared_ptr<const std::string> encodeBody(const std::string& body, ContentEncoding encoding);
+
+// Strong ETag of an encoded variant: the identity tag with -<encoding> inside
+// the quotes, since the bytes differ
+std::string encodedEtag(const std::string& etag, ContentEncoding encoding);
+
+} // namespace space4x
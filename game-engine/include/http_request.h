@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace space4x {
+
+// One HTTP/1.x request, parsed once and handed to every handler. Header names
+// are stored lowercased; the target is split into path and raw query string.
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::string query;    // Without the leading '?'
+    std::string version;  // e.g. "HTTP/1.1"
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+
+    // Parses a complete request (head plus body); false if the request line is malformed
+    static bool parse(const std::string& raw, HttpRequest& request);
+
+    // Empty when absent; name is matched case-insensitively
+    std::string header(const std::string& name) const;
+
+    // Value of name=value in the query string, percent-decoded; empty when absent
+    std::string queryParam(const std::string& name) const;
+
+    bool keepAlive() const;
+};
+
+} // namespace space4x
@@ -1,19 +1,23 @@
 #pragma once
 
 #include <string>
+#include <memory>
 #include "galaxy.h"
+#include "http_request.h"
+#include "http_transport.h"
 
 namespace space4x {
 
+// Minimal generator front end (/generate-galaxy, /system/<id>, /health) on the
+// same bounded transport and serializers as BackendServer
 class SimpleHttpServer {
 private:
-    int port;
-    int server_fd;
-    bool running;
-    Galaxy currentGalaxy;  // Store the current galaxy for system lookups
+    HttpRouter router;
+    HttpTransport http;
+    std::shared_ptr<const Galaxy> currentGalaxy;  // Latest generated galaxy, for system lookups (atomic access)
 
 public:
-    SimpleHttpServer(int p);
+    SimpleHttpServer(int p, const HttpTransport::Limits& limits = HttpTransport::Limits());
     ~SimpleHttpServer();
     
     bool start();
@@ -21,23 +25,13 @@ public:
     void run();
     
 private:
-    void handleRequest(int socket);
-    std::string handleGalaxyGeneration(const std::string& request);
-    std::string handleSystemDetails(const std::string& request);
+    HttpResponse handleRequest(const HttpRequest& request);
+    std::string handleGalaxyGeneration(const HttpRequest& request);
+    std::string handleSystemDetails(const HttpRequest& request);
     std::string handleHealthCheck();
-    std::string handleNotFound();
     std::string createJsonResponse(const std::string& json);
-    std::string createErrorResponse(const std::string& message);
     std::string createErrorResponse(int code, const std::string& message);
-    
-    // Simple JSON parsing helpers
-    int extractIntValue(const std::string& json, const std::string& key, int defaultValue);
-    double extractDoubleValue(const std::string& json, const std::string& key, double defaultValue);
-    bool extractBoolValue(const std::string& json, const std::string& key, bool defaultValue);
-    std::string extractJsonSection(const std::string& json, const std::string& sectionName);
-    std::string galaxyToSimpleJson(const struct Galaxy& galaxy);
-    struct GalaxyConfig parseSimpleGalaxyConfig(const std::string& json);
-    std::string serializeSystemDefinition(const struct SystemDefinition& systemDef);
+    bool parseSimpleGalaxyConfig(const std::string& json, GalaxyConfig& config, std::string& error);
 };
 
 } // namespace space4x
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+#include "http_request.h"
+#include "thread_pool.h"
+#include "metrics.h"
+
+namespace space4x {
+
+class EventPoller;
+struct ClientConnection;
+
+// Response head and body kept apart so large bodies go out with writev instead
+// of being concatenated; the body is shared with anything else that keeps it
+struct HttpResponse {
+    std::string head;  // Status line and headers through the blank line (or a complete response)
+    std::shared_ptr<const std::string> body;
+    std::function<void(int fd)> stream;  // Writes the rest of a streamed response on a worker; the connection closes after
+
+    HttpResponse(std::string complete) : head(std::move(complete)) {}
+    HttpResponse(std::string responseHead, std::shared_ptr<const std::string> responseBody)
+        : head(std::move(responseHead)), body(std::move(responseBody)) {}
+};
+
+// Writes all of data to a non-blocking socket, waiting while its buffer is full;
+// false if the peer is gone or stalls for 30 s
+bool writeAll(int fd, const std::string& data);
+
+// Incremental framing of the requests on one connection. Bytes are appended
+// as they arrive; the head is scanned once and the body length remembered, so
+// a large body costs one pass however many reads it takes. Chunked request
+// bodies are not supported.
+class HttpRequestParser {
+public:
+    enum class Status { NeedMore, Complete, Malformed, TooLarge, Unsupported };
+
+    explicit HttpRequestParser(size_t maxRequestBytes) : maxRequestBytes(maxRequestBytes) {}
+
+    void append(const char* data, size_t size) { buffer.append(data, size); }
+
+    // Bytes held that are not yet taken off as requests
+    size_t buffered() const { return buffer.size(); }
+
+    // How much more is worth reading: up to one byte past the request limit, so
+    // an oversized request shows as one; 0 once there
+    size_t room() const { return buffer.size() > maxRequestBytes ? 0 : maxRequestBytes + 1 - buffer.size(); }
+
+    // Takes the next complete request off the buffer into request
+    Status next(HttpRequest& request);
+
+    // True once per request whose head asked for "Expect: 100-continue" while its
+    // body is still to come; the caller then sends the interim response
+    bool wantsContinue();
+
+private:
+    size_t maxRequestBytes;
+    std::string buffer;
+    size_t scanned = 0;             // Bytes already searched for the end of the head
+    size_t bodyStart = 0;           // Offset of the body once the head is complete, else 0
+    size_t total = 0;               // Head plus body length once known
+    bool expectContinue = false;
+
+    Status readHead();
+};
+
+// Method and path dispatch. A pattern is an exact path, or a prefix ending in
+// "/:id" that matches any path below it. Exact patterns win over prefixes, then
+// patterns match in the order they were added.
+class HttpRouter {
+public:
+    typedef std::function<HttpResponse(const HttpRequest&)> Handler;
+
+    struct Match {
+        const Handler* handler = nullptr;  // Null: no route, or pathKnown with another method
+        size_t label = 0;                  // Index into labels(); the last one is "other"
+        bool pathKnown = false;
+    };
+
+    // method is "GET", "POST", ... or "*" for any
+    void add(const std::string& method, const std::string& pattern, Handler handler);
+
+    Match match(const HttpRequest& request) const;
+
+    // Distinct patterns in the order added, then "other"; fixed once routes are in,
+    // so per-route metric series can be registered up front
+    std::vector<std::string> labels() const;
+
+private:
+    struct Route {
+        std::string method;
+        std::string path;  // Exact path, or the prefix of a "/:id" pattern
+        bool prefix;
+        size_t label;
+        Handler handler;
+    };
+    std::vector<Route> routes;
+    std::vector<std::string> patterns;
+};
+
+// Event-driven HTTP/1.1 server core: one loop thread waits on epoll (Linux) or
+// kqueue (macOS) and hands ready connections to a fixed worker pool, which
+// parses, dispatches to the handler and writes the response (keep-alive and
+// pipelining included). A response the socket has no room for is parked with
+// its connection, which is rearmed for writing, so a slow reader never holds a
+// worker.
+//
+// Connections, queued work and buffered requests are bounded: past
+// maxConnections new clients get a 503 and are closed, and while more than
+// maxQueuedPerWorker connections per worker wait for a thread the listener is
+// paused, so further clients queue in the kernel's accept backlog instead of
+// in memory. Reads stop once a request's limit is buffered, and unparsed
+// requests on all connections together stay within maxBufferedBytes; a
+// connection that has more to send once that is spent gets a 503 and is
+// closed. The loop closes connections that sit past their deadline: idle
+// between requests, sending a request too slowly, or not draining a response,
+// so stalled clients cannot pin the connection slots. Responses are not
+// counted; they are sized by the handler.
+class HttpTransport {
+public:
+    struct Limits {
+        size_t workers = 0;                              // 0 = hardware concurrency, at least 4
+        size_t maxConnections = 4096;
+        size_t maxQueuedPerWorker = 64;
+        size_t maxRequestBytes = 64 * 1024 * 1024;      // Head and body together
+        size_t maxBufferedBytes = 256 * 1024 * 1024;    // Unparsed request bytes across all connections
+        std::chrono::milliseconds idleTimeout{30000};    // Waiting for the next request
+        std::chrono::milliseconds requestTimeout{30000}; // From a request's first byte to its last
+        std::chrono::milliseconds writeTimeout{30000};   // Longest stall while a response drains
+    };
+
+    typedef std::function<HttpResponse(const HttpRequest&)> Handler;
+    // Complete response for errors the transport answers itself (400, 413, 501, 503)
+    typedef std::function<std::string(int status, const std::string& message)> ErrorResponder;
+
+    HttpTransport(int port, const Limits& limits, Handler handler, ErrorResponder errorResponse);
+    ~HttpTransport();
+
+    HttpTransport(const HttpTransport&) = delete;
+    HttpTransport& operator=(const HttpTransport&) = delete;
+
+    bool start();  // Binds and listens; false (logged) on failure
+    void stop();   // Makes run() return, closing the listener; safe from any thread
+
+    // Serves until stop(); onTick, when given, runs on the loop thread about every 500 ms
+    void run(const std::function<void()>& onTick = nullptr);
+
+    bool running() const { return isRunning.load(); }
+    size_t workerCount() const { return limits.workers; }
+    int port() const { return listenPort; }
+
+private:
+    int listenPort;
+    Limits limits;
+    Handler handler;
+    ErrorResponder errorResponse;
+
+    int listenFd = -1;
+    std::atomic<bool> isRunning{false};
+    bool listenerPaused = false;
+    std::unique_ptr<EventPoller> poller;
+    std::unique_ptr<ThreadPool> workers;
+    std::mutex connectionsMutex;
+    std::unordered_map<int, std::shared_ptr<ClientConnection>> connections;
+    std::atomic<size_t> bufferedBytes{0};  // Held by connection parsers, against maxBufferedBytes
+    MetricId connectionsRejected;
+    MetricId listenerPauses;
+    MetricId connectionsTimedOut;
+    MetricId requestsShed;
+
+    void acceptConnections();
+    void serviceConnection(const std::shared_ptr<ClientConnection>& connection);
+    bool sendPending(const std::shared_ptr<ClientConnection>& connection);
+    void park(const std::shared_ptr<ClientConnection>& connection, bool forWrite,
+              std::chrono::steady_clock::time_point deadline);
+    void closeConnection(const std::shared_ptr<ClientConnection>& connection);
+    void closeExpiredConnections();  // On the loop thread, after each batch of events
+    void applyBackpressure();  // Pauses or resumes the listener by queue depth
+};
+
+} // namespace space4x
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+namespace space4x {
+
+// Work-stealing pool for data-parallel loops. Each worker owns a deque of
+// range chunks: it takes its own from the front and, once those run out,
+// steals from the back of another worker's, so chunks that run long on one
+// core are picked up by idle ones. The thread calling parallelFor() works
+// through chunks as well instead of blocking, so loops issued from many
+// request threads at once all make progress.
+class JobSystem {
+public:
+    typedef std::function<void(size_t begin, size_t end)> RangeBody;
+
+    explicit JobSystem(size_t threadCount = 0);  // 0 = hardware concurrency
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Process-wide pool sized to hardware concurrency, for galaxy generation
+    static JobSystem& global();
+
+    // Calls body(begin, end) for consecutive ranges covering [0, count), each
+    // grain long (the last may be shorter) and starting at a multiple of grain,
+    // and returns once all have run. body must only write state owned by its
+    // range. The first exception a range throws is rethrown here.
+    void parallelFor(size_t count, size_t grain, const RangeBody& body);
+
+    size_t size() const { return workers.size(); }
+
+private:
+    struct Batch {
+        const RangeBody* body;
+        std::atomic<size_t> remaining;  // Lowered under mutex only; read without it
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr failure;
+    };
+    struct Chunk {
+        Batch* batch;
+        size_t begin, end;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;  // One per worker
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextQueue{0};            // Round-robin start for a batch's chunks
+    std::mutex sleepMutex;
+    std::condition_variable available;
+    std::atomic<long> queued{0};
+    bool stopping = false;
+
+    void stop();  // Wakes and joins every started worker
+    void workerLoop(size_t self);
+    bool take(size_t self, Chunk& chunk);  // Own queue first, then steal
+    static void run(const Chunk& chunk);
+};
+
+} // namespace space4x
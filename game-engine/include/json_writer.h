@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace space4x {
+
+// Append-only JSON writer over a single growing buffer. Commas between members
+// and elements are inserted automatically, strings are escaped, and numbers are
+// formatted with std::to_chars (no locale or stream state involved).
+//
+// Doubles use significantDigits like printf's %g; the default of 6 matches the
+// iostream output the API has always produced. Pass 0 for shortest round-trip.
+class JsonWriter {
+public:
+    explicit JsonWriter(size_t reserveBytes = 0, int significantDigits = 6);
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    JsonWriter& key(std::string_view name);  // Member name inside an object
+
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text) { return value(std::string_view(text)); }
+    JsonWriter& value(double number);
+    JsonWriter& value(int number) { return value(static_cast<long long>(number)); }
+    JsonWriter& value(long number) { return value(static_cast<long long>(number)); }
+    JsonWriter& value(long long number);
+    JsonWriter& value(unsigned long number) { return value(static_cast<unsigned long long>(number)); }
+    JsonWriter& value(unsigned long long number);
+    JsonWriter& value(bool flag);
+    JsonWriter& null();
+    JsonWriter& raw(std::string_view json);  // Already-serialized JSON value
+
+    // key(name).value(v) in one call
+    template <typename T>
+    JsonWriter& field(std::string_view name, const T& v) { return key(name).value(v); }
+
+    const std::string& str() const { return out; }
+    size_t size() const { return out.size(); }
+    std::string release() { return std::move(out); }  // Hands the buffer over without copying
+
+private:
+    std::string out;
+    std::vector<bool> firstInScope;  // One entry per open object/array
+    bool afterKey = false;
+    int significantDigits;
+
+    void separate();
+};
+
+} // namespace space4x
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+namespace space4x {
+
+// Console verbosity. Error mutes std::cout, leaving only std::cerr; Info keeps
+// startup and per-operation summaries; Debug (the default) adds per-request
+// and per-item lines.
+enum class LogLevel : int {
+    Error = 0,
+    Info = 1,
+    Debug = 2
+};
+
+// "error", "info" or "debug"; false leaves level unchanged
+bool parseLogLevel(const std::string& name, LogLevel& level);
+
+void setLogLevel(LogLevel level);
+LogLevel logLevel();
+
+inline bool logEnabled(LogLevel level) { return static_cast<int>(level) <= static_cast<int>(logLevel()); }
+
+} // namespace space4x
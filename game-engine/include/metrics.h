@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace space4x {
+
+typedef uint32_t MetricId;
+
+// Process-wide counters and latency histograms, exposed by /metrics in the
+// Prometheus text format.
+//
+// Recording is lock-free: every thread owns a shard of plain relaxed atomics
+// that only it writes, and a scrape sums the shards. Shards live as long as
+// the process, so totals never go backwards when a thread exits. Only
+// registering a series takes the lock, so hot paths register once and keep
+// the id.
+class MetricsRegistry {
+public:
+    static const size_t kMaxSeries = 512;
+    static const size_t kBucketCount = 14;
+    static const double kBucketBounds[kBucketCount];  // Upper bounds in seconds; +Inf is implicit
+
+    static MetricsRegistry& global();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // The same (name, labels) always returns the same id. labels is the
+    // preformatted label list, see metricLabel(). Past kMaxSeries the returned
+    // id records nothing
+    MetricId counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    MetricId histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    void add(MetricId counter, uint64_t amount = 1);
+    void observe(MetricId histogram, double seconds);
+
+    std::string render() const;
+
+private:
+    enum class Kind : uint8_t { Counter, Histogram };
+    struct Series {
+        std::string name;
+        std::string help;
+        std::string labels;
+        Kind kind;
+    };
+
+    // Per series: count, sum in nanoseconds, then one slot per bucket
+    static const size_t kSlotsPerSeries = 2 + kBucketCount;
+    struct Shard {
+        std::atomic<uint64_t> slots[kMaxSeries * kSlotsPerSeries];
+        Shard();
+    };
+
+    mutable std::mutex mutex;
+    std::vector<Series> series;
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    MetricsRegistry() = default;
+    MetricId registerSeries(const std::string& name, const std::string& help, const std::string& labels, Kind kind);
+    Shard& localShard();
+};
+
+// name="value" with the value escaped for the exposition format; join several with ','
+std::string metricLabel(const std::string& name, const std::string& value);
+
+// Observes the time from construction to destruction into a histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(MetricId histogram) : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() { MetricsRegistry::global().observe(histogram, elapsedSeconds()); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    double elapsedSeconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    MetricId histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace space4x
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+#include "galaxy.h"
+
+namespace space4x {
+
+enum class RouteMetric : uint8_t {
+    Distance,    // Sum of lane lengths (LY)
+    TravelTime   // Sum of lane travel times (turns)
+};
+
+// ALT landmark tables: exact lane-network distances from a few far-apart
+// systems. By the triangle inequality, |d(L, t) - d(L, v)| never overestimates
+// the distance from v to t, and on a sparse lane network it is a much tighter
+// bound than the straight line. Only valid for the lanes they were built from.
+struct RouteLandmarks {
+    static const size_t kDefaultCount = 8;
+
+    std::vector<uint32_t> systems;   // Landmark system indices
+    std::vector<double> distances;   // distances[l * systemCount + v]; INFINITY when unreachable
+    size_t systemCount = 0;
+
+    // Farthest-point selection: each landmark is the system farthest (by lane
+    // distance) from the ones already chosen, starting from system 0
+    static std::shared_ptr<const RouteLandmarks> build(const GalaxyGeometry& geometry,
+                                                       size_t count = kDefaultCount);
+
+    // Lower bound on the lane distance between two systems
+    double lowerBound(uint32_t from, uint32_t to) const;
+
+    size_t heapBytes() const { return systems.capacity() * sizeof(uint32_t) + distances.capacity() * sizeof(double); }
+};
+
+struct Route {
+    bool found = false;
+    std::vector<uint32_t> path;  // System indices, from origin to destination
+    double distance = 0.0;
+    int travelTime = 0;
+};
+
+// Shortest paths over one galaxy's warp lanes, shared by all request threads.
+// Single queries run A* with max(straight line, landmark bound) as the
+// heuristic, both admissible because a lane is never shorter than the
+// distance between its endpoints. Results are memoized per (from, to, metric)
+// for the planner's lifetime; lane edits publish a galaxy with a new planner,
+// which is what invalidates them.
+class RoutePlanner {
+public:
+    typedef std::pair<uint32_t, uint32_t> Query;  // (from, to) system indices
+
+    // Uses the galaxy's landmarks, building them on the first query if it has none
+    explicit RoutePlanner(std::shared_ptr<const Galaxy> galaxy);
+
+    RoutePlanner(const RoutePlanner&) = delete;
+    RoutePlanner& operator=(const RoutePlanner&) = delete;
+
+    const Galaxy& galaxy() const { return *source; }
+
+    std::shared_ptr<const Route> route(uint32_t from, uint32_t to, RouteMetric metric);
+
+    // Batch form for fleet orders, answered in query order. Uncached queries
+    // that share an origin are answered by one Dijkstra search from it
+    std::vector<std::shared_ptr<const Route>> routes(const std::vector<Query>& queries, RouteMetric metric);
+
+    size_t cachedRoutes() const;
+
+private:
+    std::shared_ptr<const Galaxy> source;
+    std::vector<int> laneTimes;  // Travel time per geometry lane slot
+    std::once_flag landmarksBuilt;
+    std::shared_ptr<const RouteLandmarks> landmarks;
+
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<const Route>> cache;
+
+    const RouteLandmarks& tables();
+    double weight(size_t slot, RouteMetric metric) const;
+    double heuristic(const RouteLandmarks& tables, uint32_t from, uint32_t to, RouteMetric metric) const;
+    std::shared_ptr<const Route> search(uint32_t from, uint32_t to, RouteMetric metric);
+    void searchFrom(uint32_t from, const std::vector<uint32_t>& targets, RouteMetric metric,
+                    std::vector<std::shared_ptr<const Route>>& found);
+
+    std::shared_ptr<const Route> cached(uint64_t key) const;
+    void remember(uint64_t key, const std::shared_ptr<const Route>& route);
+};
+
+} // namespace space4x
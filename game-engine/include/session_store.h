@@ -0,0 +1,145 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <chrono>
+#include <cstdint>
+#include "galaxy.h"
+#include "system_detail_cache.h"
+#include "route_planner.h"
+#include "galaxy_tiles.h"
+#include "simulation.h"
+
+namespace space4x {
+
+// One player's live galaxy with the caches built over it. Never modified once
+// published: an edit publishes a new session around an edited copy, so a
+// request holding the old one keeps a consistent view (copy-on-write). Until
+// an edit the galaxy is shared with the generation cache and other sessions.
+struct GalaxySession {
+    std::shared_ptr<const Galaxy> galaxy;
+    std::shared_ptr<SystemDetailCache> details;  // Lazily built system details
+    std::shared_ptr<RoutePlanner> routes;        // Routes over the galaxy's lanes
+    std::shared_ptr<GalaxyTileIndex> tiles;      // Viewport index over its layout
+    // Turn engine, started by the first tick or fleet order; unlike the rest it
+    // is mutable, and only touched inside GalaxySessionStore::update
+    std::shared_ptr<GalaxySimulation> simulation;
+
+    // Session with empty caches
+    static std::shared_ptr<const GalaxySession> create(std::shared_ptr<const Galaxy> galaxy);
+
+    // Session for galaxy, an edited copy of this one's with delta applied. Flag and
+    // lane edits keep system indices, so memoized details carry over; routes and
+    // the tile index carry over only flag edits. A running simulation is rebased
+    // onto the edited galaxy
+    std::shared_ptr<const GalaxySession> edited(std::shared_ptr<const Galaxy> galaxy, const GalaxyDelta& delta) const;
+
+    // Copy of this session with a simulation started from its galaxy
+    std::shared_ptr<const GalaxySession> withSimulation() const;
+};
+
+// Live sessions by (user, save slot), sharded so requests of different players
+// never contend on one lock.
+//
+// Everything a session holds but its simulation is already persisted by the
+// save writer (base save plus delta log), so the store is only a working set:
+// sessions idle past the timeout, and least recently used ones past the cap,
+// are dropped and rebuilt from their slot on the next request. A dropped
+// session's simulation restarts from the saved economy.
+class GalaxySessionStore {
+public:
+    typedef std::pair<std::string, int> Key;  // (user, save slot)
+
+    // How the session's save slot is kept current; lives as long as the session
+    struct SaveState {
+        bool logging = false;       // Game actions are appended to the slot as deltas
+        size_t loggedDeltas = 0;    // Deltas on the slot's current base
+        std::string autosavedEtag;  // Galaxy last autosaved to the slot, if unchanged since
+    };
+
+    GalaxySessionStore(size_t maxSessions, std::chrono::seconds idleTimeout);
+
+    GalaxySessionStore(const GalaxySessionStore&) = delete;
+    GalaxySessionStore& operator=(const GalaxySessionStore&) = delete;
+
+    // Resident session, marked used; null if there is none
+    std::shared_ptr<const GalaxySession> find(const Key& key);
+
+    // Runs apply(current, save) under the key's own lock, so updates of one
+    // session are serialized while other sessions and readers proceed. current
+    // is null when nothing is resident. The session returned becomes resident
+    // (null drops it along with its save state) and is returned from here.
+    template <typename Update>
+    std::shared_ptr<const GalaxySession> update(const Key& key, Update&& apply);
+
+    // Slot a user's requests default to: the one last published for them, else 1.
+    // Remembered for as many users as there are sessions, least recently used
+    // forgotten first, so arbitrary user names cannot grow it without bound
+    void setActiveSlot(const std::string& user, int slot);
+    int activeSlot(const std::string& user);
+
+    // Drops idle sessions, then least recently used ones down to the cap;
+    // returns how many went. Sessions busy in an update are skipped
+    size_t evict();
+
+    size_t size() const { return resident.load(std::memory_order_relaxed); }
+
+private:
+    static const size_t kShardCount = 16;
+
+    struct Entry {
+        std::mutex mutex;                              // Held through update()
+        std::shared_ptr<const GalaxySession> session;  // Read with atomic_load, so readers skip the mutex
+        SaveState save;
+        std::atomic<int64_t> lastUsed{0};
+        bool evicted = false;  // Set under mutex once out of the shard; updates then retry
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Key, std::shared_ptr<Entry>, KeyHash> entries;
+    };
+    struct ActiveSlot {
+        int slot;
+        uint64_t lastUsed;  // From activeUses, which orders uses exactly
+    };
+
+    size_t maxSessions;
+    int64_t idleMillis;
+    Shard shards[kShardCount];
+    std::atomic<size_t> resident{0};
+    std::mutex activeMutex;
+    std::unordered_map<std::string, ActiveSlot> activeSlots;
+    uint64_t activeUses = 0;
+
+    Shard& shardFor(const Key& key) { return shards[KeyHash()(key) % kShardCount]; }
+    std::shared_ptr<Entry> acquire(const Key& key);  // Existing entry or a fresh empty one
+    // Makes session resident in entry, whose mutex the caller holds
+    void install(const Key& key, Entry& entry, std::shared_ptr<const GalaxySession> session);
+    static int64_t nowMillis();
+};
+
+template <typename Update>
+std::shared_ptr<const GalaxySession> GalaxySessionStore::update(const Key& key, Update&& apply) {
+    std::shared_ptr<const GalaxySession> next;
+    for (;;) {
+        std::shared_ptr<Entry> entry = acquire(key);
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        if (entry->evicted) continue;  // Evicted while we waited; its successor takes the update
+
+        next = apply(std::atomic_load(&entry->session), entry->save);
+        install(key, *entry, next);
+        break;
+    }
+    if (size() > maxSessions) evict();
+    return next;
+}
+
+} // namespace space4x
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+#include "galaxy.h"
+#include "job_system.h"
+#include "json_writer.h"
+#include "route_planner.h"
+
+namespace space4x {
+
+// Per-system economy, one array per field and indexed like Galaxy::systems,
+// so a tick streams through each field instead of hopping between records
+struct EconomyState {
+    std::vector<int64_t> population;
+    std::vector<double> gdp;
+    std::vector<int32_t> minerals;  // Stockpiles, seeded from StarSystem::resources
+    std::vector<int32_t> energy;
+    std::vector<int32_t> research;
+
+    size_t size() const { return population.size(); }
+    void resize(size_t count);
+};
+
+// A fleet moving system to system along warp lanes. It spends each lane's
+// WarpLane::travelTime turns in transit
+struct Fleet {
+    std::string id;
+    uint32_t system = 0;          // Where it is, or the system it last left
+    std::vector<uint32_t> path;   // Systems still to reach, nearest first; empty when idle
+    int turnsLeft = 0;            // Turns until it reaches path.front()
+};
+
+// What one tick changed: the systems whose economy moved, with their new
+// values, and every fleet that moved
+struct TickDelta {
+    struct SystemChange {
+        uint32_t system;
+        int64_t population;
+        double gdp;
+        int32_t minerals, energy, research;
+    };
+    struct FleetChange {
+        size_t fleet;       // Index into GalaxySimulation::fleets()
+        uint32_t system;    // Current, or last left
+        int turnsLeft;      // To the next stop; 0 once idle
+        bool arrived;       // Reached system this tick
+    };
+
+    uint64_t tick = 0;
+    std::vector<SystemChange> systems;
+    std::vector<FleetChange> fleets;
+};
+
+// Server-side turn engine over one galaxy. Economy state is double-buffered:
+// a tick reads the current buffer (a system's and its lane neighbours'
+// values) and writes only its own slot of the next, so systems update in
+// parallel on a JobSystem without locks, and the buffers swap once all are
+// done. Per tick:
+//   - population grows logistically towards a capacity set by the system's
+//     planets and moons, and migrates along lanes into explored systems;
+//   - gdp is output per head plus trade with populated neighbours;
+//   - populated systems add to their mineral, energy and research stockpiles;
+//   - fleets advance one turn along their routes.
+//
+// The simulation is not thread-safe; the session store serializes ticks and
+// orders per session.
+class GalaxySimulation {
+public:
+    static const size_t kMaxFleets = 10000;
+
+    // Economy taken from the galaxy's systems, no fleets, tick 0
+    explicit GalaxySimulation(std::shared_ptr<const Galaxy> galaxy);
+
+    // Simulation over galaxy, an edited copy of this one's, carrying economy over
+    // by system id and keeping fleets whose system survived; orders whose
+    // remaining path no longer exists are dropped, leaving the fleet idle
+    std::shared_ptr<GalaxySimulation> rebased(std::shared_ptr<const Galaxy> galaxy) const;
+
+    // Sends fleet id towards system to along the fastest route. A new fleet
+    // starts at from; one in transit finishes its current lane first. False
+    // with error set if a system is unknown, the fleet cap is reached or no
+    // route exists
+    bool orderFleet(const std::string& id, const std::string& from, const std::string& to,
+                    RoutePlanner& routes, std::string& error);
+
+    TickDelta tick(JobSystem& jobs);
+
+    const Galaxy& galaxy() const { return *source; }
+    uint64_t tickCount() const { return ticks; }
+    const EconomyState& economy() const { return state[current]; }
+    const std::vector<Fleet>& fleets() const { return fleetList; }
+    const Fleet* findFleet(const std::string& id) const;  // Null when there is none
+
+private:
+    std::shared_ptr<const Galaxy> source;
+    EconomyState state[2];
+    int current = 0;
+    uint64_t ticks = 0;
+
+    // Fixed per galaxy: capacity from planets and moons, explored flags
+    std::vector<int64_t> capacity;
+    std::vector<uint8_t> explored;
+
+    std::vector<Fleet> fleetList;
+    std::unordered_map<std::string, size_t> fleetIndex;
+
+    // Scratch reused across ticks: each chunk's changes, in chunk order
+    std::vector<std::vector<TickDelta::SystemChange>> systemChanges;
+    std::vector<std::vector<TickDelta::FleetChange>> fleetChanges;
+
+    void prepare();  // capacity and explored from the galaxy
+    int laneTurns(uint32_t from, uint32_t to) const;  // 0 when there is no such lane
+    void stepSystems(size_t begin, size_t end, std::vector<TickDelta::SystemChange>& changes);
+    void stepFleets(size_t begin, size_t end, std::vector<TickDelta::FleetChange>& changes);
+};
+
+// JSON bodies: a tick's changes, and the whole simulation state a client
+// starts from before applying deltas
+void writeTickDelta(JsonWriter& json, const GalaxySimulation& simulation, const TickDelta& delta);
+std::string serializeSimulation(const GalaxySimulation& simulation);
+
+} // namespace space4x
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <memory_resource>
+#include "celestial_bodies.h"
+
+namespace space4x {
+
+// Procedural system details for one galaxy, built on first request and kept
+// until the galaxy is replaced. Definitions and the per-system slot table come
+// from a monotonic arena owned by the cache, so dropping the cache releases
+// them in one shot. Serialized bodies stay on the ordinary heap because
+// in-flight responses may still hold them after the cache is gone.
+class SystemDetailCache {
+public:
+    struct Detail {
+        const SystemDefinition* system = nullptr;
+        std::shared_ptr<const std::string> json;
+        std::string etag;
+
+        explicit operator bool() const { return json != nullptr; }
+    };
+
+    // systemCount bounds the indices get() accepts
+    explicit SystemDetailCache(size_t systemCount);
+
+    SystemDetailCache(const SystemDetailCache&) = delete;
+    SystemDetailCache& operator=(const SystemDetailCache&) = delete;
+
+    // Memoized detail for the system at index. On a miss build(definition)
+    // fills a fresh definition and returns its JSON body; it runs without the
+    // lock held, and if two requests race the first one stored wins.
+    template <typename Build>
+    Detail get(uint32_t index, Build&& build);
+
+    size_t systemCount() const { return slots.size(); }
+    size_t size() const;
+
+private:
+    mutable std::mutex mutex;
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::deque<SystemDefinition> definitions;  // Append-only, so addresses stay valid
+    std::pmr::vector<Detail> slots;                 // Indexed like Galaxy::systems
+    size_t built = 0;
+
+    Detail lookup(uint32_t index) const;
+    Detail store(uint32_t index, SystemDefinition&& definition, std::string&& json);
+};
+
+template <typename Build>
+SystemDetailCache::Detail SystemDetailCache::get(uint32_t index, Build&& build) {
+    if (index >= slots.size()) return Detail();
+
+    Detail detail = lookup(index);
+    if (detail) return detail;
+
+    SystemDefinition definition;
+    std::string json = build(definition);
+    return store(index, std::move(definition), std::move(json));
+}
+
+} // namespace space4x
@@ -1,21 +1,325 @@
 #include "backend_server.h"
+#include "json_writer.h"
+#include "galaxy_json.h"
+#include "galaxy_snapshot.h"
+#include "galaxy_cache.h"
+#include "galaxy_request.h"
+#include "metrics.h"
+#include "logging.h"
 #include <iostream>
 #include <sstream>
 #include <fstream>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <unistd.h>
+#include <iomanip>
 #include <cstring>
+#include <cctype>
 #include <algorithm>
-#include <regex>
 #include <cstdlib>
+#include <thread>
+#include <chrono>
+#include <limits>
 
 namespace space4x {
 
+namespace {
+
+const size_t kDatabasePoolSize = 8;
+const size_t kDefaultGalaxyCacheMB = 256;
+const size_t kMaxRoutesPerRequest = 1000;
+const long kMaxTicksPerRequest = 100;
+const size_t kDefaultMaxSessions = 256;
+const long kDefaultSessionIdleSeconds = 600;
+const int64_t kSessionSweepSeconds = 30;
+
+// Background generation: threads, jobs allowed to wait, finished jobs kept
+// for collection, and the largest galaxy a job may ask for
+const size_t kGalaxyJobThreads = 2;
+const size_t kMaxPendingGalaxyJobs = 16;
+const size_t kKeepFinishedGalaxyJobs = 64;
+const int kMaxJobSystemCount = 250000;
+const double kMaxJobRadius = 100000.0;
+const int kStreamKeepAliveSeconds = 15;
+
+// Player of requests that don't name one, until there is real authentication
+const char* const kDefaultUser = "keith";
+const size_t kMaxUsernameLength = 64;
+
+// Statements prepared once on every pooled connection
+const PreparedStatement kPingStatement = {"ping", "SELECT NOW()", 0};
+const PreparedStatement kGetUserStatement = {
+    "get_user", "SELECT id, username, email, membership FROM users WHERE username = $1 LIMIT 1", 1};
+const PreparedStatement kListSavesStatement = {
+    "list_saves",
+    "SELECT s.id, s.save_slot, s.save_data, s.created_at, s.updated_at FROM saves s "
+    "JOIN users u ON s.user_id = u.id WHERE u.username = $1 ORDER BY s.save_slot", 1};
+// Listing without the save bodies; clients fetch a slot's data from /api/saves/<id> when opened
+const PreparedStatement kListSaveSummariesStatement = {
+    "list_save_summaries",
+    "SELECT s.id, s.save_slot, CASE WHEN s.snapshot IS NULL THEN 'json' ELSE 'snapshot' END,\n"
+    "  COALESCE(octet_length(s.snapshot), octet_length(s.save_data::text)), s.delta_count, s.created_at, s.updated_at\n"
+    "FROM saves s JOIN users u ON s.user_id = u.id WHERE u.username = $1 ORDER BY s.save_slot", 1};
+// Loads return the snapshot bytes when present, else the legacy JSON text, followed
+// by the save's deltas in order; one statement, so base and log are consistent
+// (binary result format)
+const PreparedStatement kLoadSlotStatement = {
+    "load_save_slot",
+    "SELECT data FROM (\n"
+    "  SELECT 0 AS sequence, COALESCE(s.snapshot, convert_to(s.save_data::text, 'UTF8')) AS data\n"
+    "  FROM saves s JOIN users u ON s.user_id = u.id WHERE u.username = $1 AND s.save_slot = $2::int\n"
+    "  UNION ALL\n"
+    "  SELECT d.sequence, d.delta FROM save_deltas d JOIN saves s ON d.save_id = s.id JOIN users u ON s.user_id = u.id\n"
+    "  WHERE u.username = $1 AND s.save_slot = $2::int\n"
+    ") save ORDER BY sequence", 2};
+const PreparedStatement kLoadByIdStatement = {
+    "load_save_by_id",
+    "SELECT data FROM (\n"
+    "  SELECT 0 AS sequence, COALESCE(s.snapshot, convert_to(s.save_data::text, 'UTF8')) AS data\n"
+    "  FROM saves s JOIN users u ON s.user_id = u.id WHERE s.id = $1 AND u.username = $2\n"
+    "  UNION ALL\n"
+    "  SELECT d.sequence, d.delta FROM save_deltas d JOIN saves s ON d.save_id = s.id JOIN users u ON s.user_id = u.id\n"
+    "  WHERE s.id = $1 AND u.username = $2\n"
+    ") save ORDER BY sequence", 2};
+// Upsert using CTE to get user id; a new base clears the slot's delta log
+const PreparedStatement kUpsertSaveStatement = {
+    "upsert_save",
+    "WITH u AS (SELECT id FROM users WHERE username = $1),\n"
+    "ins AS (\n"
+    "  INSERT INTO saves (user_id, save_slot, save_data)\n"
+    "  SELECT u.id, $2::int, $3::jsonb FROM u\n"
+    "  ON CONFLICT (user_id, save_slot) DO UPDATE SET save_data = $3::jsonb, snapshot = NULL, version = 1,\n"
+    "    delta_count = 0, updated_at = NOW()\n"
+    "  RETURNING id\n"
+    "),\n"
+    "cleared AS (DELETE FROM save_deltas d USING ins WHERE d.save_id = ins.id)\n"
+    "SELECT id FROM ins", 3};
+// Binary snapshot upsert; save_data keeps only a small descriptor so listings stay light
+const PreparedStatement kUpsertSnapshotStatement = {
+    "upsert_save_snapshot",
+    "WITH u AS (SELECT id FROM users WHERE username = $1),\n"
+    "ins AS (\n"
+    "  INSERT INTO saves (user_id, save_slot, save_data, snapshot, version)\n"
+    "  SELECT u.id, $2::int, jsonb_build_object('format', 'snapshot', 'bytes', octet_length($3::bytea)), $3::bytea, 2 FROM u\n"
+    "  ON CONFLICT (user_id, save_slot) DO UPDATE SET save_data = EXCLUDED.save_data,\n"
+    "    snapshot = EXCLUDED.snapshot, version = EXCLUDED.version, delta_count = 0, updated_at = NOW()\n"
+    "  RETURNING id\n"
+    "),\n"
+    "cleared AS (DELETE FROM save_deltas d USING ins WHERE d.save_id = ins.id)\n"
+    "SELECT id FROM ins", 3, {0, 0, 1}};
+// Appends one edit delta to a snapshot save; JSON saves have nothing to replay onto
+const PreparedStatement kAppendDeltaStatement = {
+    "append_save_delta",
+    "WITH u AS (SELECT id FROM users WHERE username = $1),\n"
+    "s AS (\n"
+    "  UPDATE saves SET delta_count = delta_count + 1 FROM u\n"
+    "  WHERE saves.user_id = u.id AND saves.save_slot = $2::int AND saves.snapshot IS NOT NULL\n"
+    "  RETURNING saves.id, saves.delta_count\n"
+    ")\n"
+    "INSERT INTO save_deltas (save_id, sequence, delta) SELECT id, delta_count, $3::bytea FROM s", 3, {0, 0, 1}};
+
+// Deltas logged on one base before the next game action writes a fresh
+// snapshot instead, which bounds how much a load has to replay
+const size_t kCompactAfterDeltas = 64;
+
+// Status code from a response's status line; 0 if there is none
+int responseStatus(const std::string& head) {
+    if (head.size() < 12 || head.compare(0, 5, "HTTP/") != 0) return 0;
+    return std::atoi(head.c_str() + head.find(' ') + 1);
+}
+
+// Memory budget for cached galaxies; SPACE4X_GALAXY_CACHE_MB overrides (0 disables)
+size_t galaxyCacheBudget() {
+    const char* env = std::getenv("SPACE4X_GALAXY_CACHE_MB");
+    size_t megabytes = env ? std::strtoul(env, nullptr, 10) : kDefaultGalaxyCacheMB;
+    return megabytes * 1024 * 1024;
+}
+
+// Live galaxy sessions kept in memory; SPACE4X_MAX_SESSIONS and
+// SPACE4X_SESSION_IDLE_SECONDS override
+size_t maxGalaxySessions() {
+    const char* env = std::getenv("SPACE4X_MAX_SESSIONS");
+    size_t sessions = env ? std::strtoul(env, nullptr, 10) : kDefaultMaxSessions;
+    return std::max<size_t>(sessions, 1);
+}
+
+std::chrono::seconds sessionIdleTimeout() {
+    const char* env = std::getenv("SPACE4X_SESSION_IDLE_SECONDS");
+    return std::chrono::seconds(env ? std::strtol(env, nullptr, 10) : kDefaultSessionIdleSeconds);
+}
+
+// Transport bounds; SPACE4X_MAX_CONNECTIONS overrides the open-connection cap
+HttpTransport::Limits httpLimits() {
+    HttpTransport::Limits limits;
+    const char* env = std::getenv("SPACE4X_MAX_CONNECTIONS");
+    if (env) limits.maxConnections = std::max<size_t>(std::strtoul(env, nullptr, 10), 1);
+    return limits;
+}
+
+// Letters, digits and ._@- only, since usernames end up in logs and metrics
+bool validUsername(const std::string& user) {
+    if (user.empty() || user.size() > kMaxUsernameLength) return false;
+    for (char c : user) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '_' && c != '@' && c != '-') return false;
+    }
+    return true;
+}
+
+void writeJobProgress(JsonWriter& json, const GalaxyJob& job, const GalaxyJob::Progress& progress) {
+    json.beginObject()
+        .field("jobId", job.id())
+        .field("state", jobStateName(progress.state))
+        .field("stage", progress.stage)
+        .field("stagesDone", static_cast<int>(progress.stagesDone))
+        .field("stageCount", static_cast<int>(progress.stageCount))
+        .field("elapsedMs", progress.elapsedMs);
+    if (!progress.error.empty()) json.field("error", progress.error);
+    json.endObject();
+}
+
+bool jobFinished(JobState state) {
+    return state == JobState::Done || state == JobState::Failed || state == JobState::Cancelled;
+}
+
+// Holds one of the limited event-stream places until released
+class StreamSlot {
+public:
+    explicit StreamSlot(std::atomic<size_t>& count) : count(count) {}
+    ~StreamSlot() { count.fetch_sub(1, std::memory_order_relaxed); }
+    
+    StreamSlot(const StreamSlot&) = delete;
+    StreamSlot& operator=(const StreamSlot&) = delete;
+    
+private:
+    std::atomic<size_t>& count;
+};
+
+// If-None-Match check: a list of strong or weak tags, or "*". Encoded variants
+// of etag ("<tag>-gzip") match too, so a client keeps its 304s across encodings
+bool etagMatches(const std::string& ifNoneMatch, const std::string& etag) {
+    size_t start = 0;
+    while (start < ifNoneMatch.size()) {
+        size_t end = ifNoneMatch.find(',', start);
+        if (end == std::string::npos) end = ifNoneMatch.size();
+        std::string candidate = ifNoneMatch.substr(start, end - start);
+        size_t first = candidate.find_first_not_of(" \t");
+        size_t last = candidate.find_last_not_of(" \t");
+        if (first != std::string::npos) {
+            candidate = candidate.substr(first, last - first + 1);
+            if (candidate.compare(0, 2, "W/") == 0) candidate.erase(0, 2);
+            if (candidate == "*" || candidate == etag) return true;
+            if (etag.size() > 1 && candidate.size() > etag.size() && candidate.back() == '"' &&
+                candidate.compare(0, etag.size() - 1, etag, 0, etag.size() - 1) == 0 &&
+                candidate[etag.size() - 1] == '-') {
+                return true;
+            }
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
+// Finite number from a query parameter; false if it is missing or malformed
+bool parseNumberParam(const std::string& text, double& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = std::strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size() && std::isfinite(value);
+}
+
+// Changes applied by an action. Added systems are written as they now are in
+// the galaxy, so their connections include any repair lanes.
+void writeDelta(JsonWriter& json, const Galaxy& galaxy, const GalaxyDelta& delta) {
+    json.beginObject();
+    json.key("systemsAdded").beginArray();
+    for (const auto& added : delta.systemsAdded) {
+        const StarSystem* system = galaxy.findSystem(added.id);
+        writeSystem(json, system ? *system : added);
+    }
+    json.endArray();
+    json.key("systemsRemoved").beginArray();
+    for (const auto& id : delta.systemsRemoved) json.value(id);
+    json.endArray();
+    json.key("lanesAdded").beginArray();
+    for (const auto& lane : delta.lanesAdded) {
+        json.beginObject()
+            .field("from", lane.from)
+            .field("to", lane.to)
+            .field("distance", lane.distance)
+            .endObject();
+    }
+    json.endArray();
+    json.key("lanesRemoved").beginArray();
+    for (const auto& lane : delta.lanesRemoved) {
+        json.beginObject().field("from", lane.first).field("to", lane.second).endObject();
+    }
+    json.endArray();
+    json.key("systemsExplored").beginArray();
+    for (const auto& flag : delta.systemsExplored) {
+        json.beginObject().field("id", flag.id).field("explored", flag.value).endObject();
+    }
+    json.endArray();
+    json.key("lanesDiscovered").beginArray();
+    for (const auto& flag : delta.lanesDiscovered) {
+        json.beginObject().field("from", flag.from).field("to", flag.to).field("discovered", flag.value).endObject();
+    }
+    json.endArray();
+    json.key("anomaliesDiscovered").beginArray();
+    for (const auto& flag : delta.anomaliesDiscovered) {
+        json.beginObject().field("id", flag.id).field("discovered", flag.value).endObject();
+    }
+    json.endArray();
+    json.endObject();
+}
+
+} // namespace
+
+// ============================================================================
+// BACKEND SERVER
+// ============================================================================
+
 BackendServer::BackendServer(int port) 
-    : port(port), server_fd(-1), running(false), db_connection(nullptr),
+    : http(port, httpLimits(),
+           [this](const HttpRequest& request) { return handleRequest(request); },
+           [this](int status, const std::string& message) { return createErrorResponse(status, message); }),
       db_host("localhost"), db_name("space4x_game"), db_user("space4x_user"), 
-      db_password(""), db_port(5432) {
+      db_password(""), db_port(5432), sessions(maxGalaxySessions(), sessionIdleTimeout()),
+      galaxyCache(galaxyCacheBudget()), systemConfigManager(SystemConfigManager::catalog()) {
+    // Paths carrying an id share one route; exact paths win over the "/:id" prefixes
+    router.add("*", "/health", [this](const HttpRequest&) { return HttpResponse(handleHealthCheck()); });
+    router.add("GET", "/metrics", [this](const HttpRequest&) { return handleMetrics(); });
+    router.add("*", "/api/test", [this](const HttpRequest&) { return HttpResponse(handleApiTest()); });
+    router.add("GET", "/api/user/current", [this](const HttpRequest& request) { return HttpResponse(handleGetCurrentUser(request)); });
+    router.add("POST", "/api/galaxy/generate", [this](const HttpRequest& request) { return handleGalaxyGenerate(request); });
+    router.add("*", "/api/galaxy/health", [this](const HttpRequest&) { return HttpResponse(handleGalaxyHealth()); });
+    router.add("GET", "/api/galaxy/tile", [this](const HttpRequest& request) { return handleGalaxyTile(request); });
+    router.add("POST", "/api/galaxy/jobs", [this](const HttpRequest& request) { return HttpResponse(handleCreateGalaxyJob(request)); });
+    router.add("GET", "/api/galaxy/jobs/:id", [this](const HttpRequest& request) { return handleGalaxyJob(request); });
+    router.add("DELETE", "/api/galaxy/jobs/:id", [this](const HttpRequest& request) { return handleGalaxyJob(request); });
+    router.add("GET", "/api/system/:id", [this](const HttpRequest& request) { return handleSystemDetails(request); });
+    router.add("*", "/api/game/state", [this](const HttpRequest& request) { return handleGameState(request); });
+    router.add("POST", "/api/game/action", [this](const HttpRequest& request) { return HttpResponse(handleGameAction(request)); });
+    router.add("POST", "/api/game/tick", [this](const HttpRequest& request) { return handleGameTick(request); });
+    router.add("GET", "/api/game/simulation", [this](const HttpRequest& request) { return handleSimulationState(request); });
+    router.add("GET", "/api/route", [this](const HttpRequest& request) { return HttpResponse(handleRoute(request)); });
+    router.add("POST", "/api/route", [this](const HttpRequest& request) { return HttpResponse(handleRoute(request)); });
+    router.add("GET", "/api/saves", [this](const HttpRequest& request) { return handleGetSaves(request); });
+    router.add("POST", "/api/saves", [this](const HttpRequest& request) { return HttpResponse(handleSaveGame(request)); });
+    router.add("GET", "/api/saves/:id", [this](const HttpRequest& request) { return handleLoadGame(request); });
+    
+    // Registered up front so requests record without touching the registry lock;
+    // anything unrouted counts as "other", so the series count stays fixed
+    MetricsRegistry& metrics = MetricsRegistry::global();
+    for (const std::string& route : router.labels()) {
+        requestTimers.push_back(metrics.histogram("space4x_http_request_seconds", "HTTP request latency by route",
+                                                  metricLabel("route", route)));
+    }
+    for (int statusClass = 1; statusClass <= 5; statusClass++) {
+        responseCounters.push_back(metrics.counter("space4x_http_responses_total", "HTTP responses by status class",
+                                                   metricLabel("status", std::to_string(statusClass) + "xx")));
+    }
+    sessionsRehydrated = metrics.counter("space4x_sessions_rehydrated_total", "Galaxy sessions rebuilt from their save");
+    tickTimer = metrics.histogram("space4x_tick_seconds", "Simulation tick latency");
+    
+    galaxyJobs.reset(new GalaxyJobQueue(kGalaxyJobThreads, kMaxPendingGalaxyJobs, kKeepFinishedGalaxyJobs,
+                                        [this](GalaxyJob& job) { return generatedGalaxy(job.config(), job.key(), &job); }));
 }
 
 BackendServer::~BackendServer() {
@@ -37,42 +341,13 @@ bool BackendServer::start() {
         }
     }
     
-    // Create socket
-    server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd < 0) {
-        std::cerr << "❌ Failed to create socket" << std::endl;
-        return false;
-    }
-    
-    // Set socket options
-    int opt = 1;
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        std::cerr << "❌ Failed to set socket options" << std::endl;
-        close(server_fd);
-        return false;
-    }
-    
-    // Bind socket
-    struct sockaddr_in address;
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = INADDR_ANY;
-    address.sin_port = htons(port);
-    
-    if (bind(server_fd, (struct sockaddr*)&address, sizeof(address)) < 0) {
-        std::cerr << "❌ Bind failed on port " << port << std::endl;
-        close(server_fd);
-        return false;
-    }
-    
-    // Listen for connections
-    if (listen(server_fd, 10) < 0) {
-        std::cerr << "❌ Failed to listen on socket" << std::endl;
-        close(server_fd);
+    if (!http.start()) {
         return false;
     }
     
-    running = true;
-    std::cout << "🚀 Space 4X Backend server running on port " << port << std::endl;
+    int port = http.port();
+    std::cout << "🚀 Space 4X Backend server running on port " << port 
+              << " (" << http.workerCount() << " worker threads)" << std::endl;
     std::cout << "📊 Health check available at http://localhost:" << port << "/health" << std::endl;
     std::cout << "🌌 Galaxy API available at http://localhost:" << port << "/api/galaxy/generate" << std::endl;
     
@@ -80,98 +355,59 @@ bool BackendServer::start() {
 }
 
 void BackendServer::stop() {
-    running = false;
-    if (server_fd >= 0) {
-        close(server_fd);
-        server_fd = -1;
-    }
+    http.stop();
     std::cout << "🛑 Backend server stopped" << std::endl;
 }
 
 void BackendServer::run() {
-    while (running) {
-        struct sockaddr_in client_address;
-        socklen_t client_len = sizeof(client_address);
+    auto lastSweep = std::chrono::steady_clock::now();
+    http.run([this, &lastSweep]() {
+        // Log lines end in '\n' rather than std::endl; they reach the console here
+        std::cout.flush();
         
-        int client_fd = accept(server_fd, (struct sockaddr*)&client_address, &client_len);
-        if (client_fd < 0) {
-            if (running) {
-                std::cerr << "❌ Failed to accept connection" << std::endl;
-            }
-            continue;
-        }
-        
-        // Read request
-        char buffer[4096];
-        std::string request;
-        int bytes_read;
-        
-        while ((bytes_read = read(client_fd, buffer, sizeof(buffer) - 1)) > 0) {
-            buffer[bytes_read] = '\0';
-            request += buffer;
-            
-            // Check if we have a complete HTTP request
-            if (request.find("\r\n\r\n") != std::string::npos) {
-                break;
-            }
+        // Idle sessions are already persisted, so dropping them only costs a reload
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastSweep < std::chrono::seconds(kSessionSweepSeconds)) return;
+        lastSweep = now;
+        size_t evicted = sessions.evict();
+        if (evicted > 0 && logEnabled(LogLevel::Info)) {
+            std::cout << "🧹 Evicted " << evicted << " idle galaxy sessions (" << sessions.size()
+                      << " resident)\n";
         }
-        
-        if (bytes_read < 0) {
-            std::cerr << "❌ Failed to read request" << std::endl;
-            close(client_fd);
-            continue;
-        }
-        
-        // Process request
-        std::string response = handleRequest(request);
-        
-        // Send response
-        if (write(client_fd, response.c_str(), response.length()) < 0) {
-            std::cerr << "❌ Failed to send response" << std::endl;
-        }
-        
-        close(client_fd);
-    }
+    });
 }
 
-std::string BackendServer::handleRequest(const std::string& request) {
-    std::string method = extractMethod(request);
-    std::string path = extractPath(request);
-    std::string body = extractBody(request);
+HttpResponse BackendServer::handleRequest(const HttpRequest& request) {
+    auto started = std::chrono::steady_clock::now();
+    HttpRouter::Match route = router.match(request);
+    HttpResponse response = routeRequest(request, route);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
     
-    std::cout << "📨 " << method << " " << path << std::endl;
+    MetricsRegistry& metrics = MetricsRegistry::global();
+    metrics.observe(requestTimers[route.label], seconds);
+    int status = responseStatus(response.head);
+    if (status >= 100 && status < 600) metrics.add(responseCounters[status / 100 - 1]);
     
+    if (logEnabled(LogLevel::Debug)) {
+        std::cout << "📨 " << request.method << " " << request.path << " " << status << " ("
+                  << std::fixed << std::setprecision(2) << seconds * 1000.0 << " ms)\n";
+    }
+    return response;
+}
+
+HttpResponse BackendServer::routeRequest(const HttpRequest& request, const HttpRouter::Match& route) {
     // Handle CORS preflight requests
-    if (method == "OPTIONS") {
+    if (request.method == "OPTIONS") {
         return createCorsResponse();
     }
     
-    // Route requests
-    if (path == "/health") {
-        return handleHealthCheck();
-    } else if (path == "/api/test") {
-        return handleApiTest();
-    } else if (path == "/api/user/current" && method == "GET") {
-        return handleGetCurrentUser();
-    } else if (path == "/api/galaxy/generate" && method == "POST") {
-        return handleGalaxyGenerate(body);
-    } else if (path == "/api/galaxy/health") {
-        return handleGalaxyHealth();
-    } else if (path.find("/api/system/") == 0 && method == "GET") {
-        return handleSystemDetails(request);
-    } else if (path == "/api/game/state") {
-        return handleGameState();
-    } else if (path == "/api/game/action" && method == "POST") {
-        return handleGameAction(body);
-    } else if (path == "/api/saves" && method == "GET") {
-        return handleGetSaves();
-    } else if (path == "/api/saves" && method == "POST") {
-        return handleSaveGame(body);
-    } else if (path.find("/api/saves/") == 0 && method == "GET") {
-        return handleLoadGame(request);
-    } else {
-        return createErrorResponse(404, "Route not found");
+    if (route.handler) {
+        return (*route.handler)(request);
     }
+    if (route.pathKnown) {
+        return createErrorResponse(405, "Method not allowed");
+    }
+    return createErrorResponse(404, "Route not found");
 }
 
 std::string BackendServer::handleHealthCheck() {
@@ -196,15 +432,19 @@ std::string BackendServer::handleApiTest() {
     return createJsonResponse(json.str());
 }
 
-std::string BackendServer::handleGetCurrentUser() {
-    if (!db_connection) {
+std::string BackendServer::handleGetCurrentUser(const HttpRequest& request) {
+    std::string user;
+    if (!requestUser(request, user)) {
+        return createErrorResponse(400, "Invalid user");
+    }
+    DatabasePool::Lease db = database.acquire();
+    if (!db) {
         return createErrorResponse(500, "Database connection not available");
     }
     
-    // For now, return the default "keith" user
+    // The user is taken at its word for now
     // In a real implementation, this would validate session/auth tokens
-    const char* query = "SELECT id, username, email, membership FROM users WHERE username = 'keith' LIMIT 1";
-    PGresult* result = PQexec(db_connection, query);
+    PGresult* result = db.execute(kGetUserStatement.name, {user});
     
     if (PQresultStatus(result) != PGRES_TUPLES_OK) {
         std::string error = PQresultErrorMessage(result);
@@ -237,192 +477,60 @@ std::string BackendServer::handleGetCurrentUser() {
     return createJsonResponse(json.str());
 }
 
-std::string BackendServer::handleGalaxyGenerate(const std::string& request) {
+HttpResponse BackendServer::handleGalaxyGenerate(const HttpRequest& request) {
     try {
-        std::cout << "🌌 Received galaxy generation request" << std::endl;
-        
-        // Parse request body for parameters
-        int radius = 500;
-        int systems = 400;
-        int anomalies = 25;
-        long seed = 1111111111;
-        int saveSlot = 1;
-        bool useSavedFlag = false;
-        bool radiusProvided = false, systemsProvided = false, anomaliesProvided = false, seedProvided = false;
+        if (logEnabled(LogLevel::Debug)) {
+            std::cout << "🌌 Received galaxy generation request\n";
+        }
         
-        // Simple JSON parsing for parameters
-        std::regex radiusRegex(R"("radius":\s*(\d+))");
-        std::regex systemsRegex(R"("systems":\s*(\d+))");
-        std::regex anomaliesRegex(R"("anomalies":\s*(\d+))");
-        std::regex seedRegex(R"("seed":\s*(\d+))");
-        std::regex slotRegex(R"("save_slot":\s*(\d+))");
-        std::regex useSavedRegex(R"("use_saved":\s*(true|false))");
+        GalaxyRequest params = defaultGalaxyRequest();
+        GalaxyConfig& config = params.config;
         
-        std::smatch match;
-        if (std::regex_search(request, match, radiusRegex)) {
-            radius = std::stoi(match[1].str());
-            radiusProvided = true;
-        }
-        if (std::regex_search(request, match, systemsRegex)) {
-            systems = std::stoi(match[1].str());
-            systemsProvided = true;
-        }
-        if (std::regex_search(request, match, anomaliesRegex)) {
-            anomalies = std::stoi(match[1].str());
-            anomaliesProvided = true;
-        }
-        if (std::regex_search(request, match, seedRegex)) {
-            seed = std::stol(match[1].str());
-            seedProvided = true;
-        }
-        if (std::regex_search(request, match, slotRegex)) {
-            saveSlot = std::stoi(match[1].str());
+        std::string error;
+        if (!decodeGalaxyRequest(request.body, params, error)) {
+            return createErrorResponse(400, error);
         }
-        if (std::regex_search(request, match, useSavedRegex)) {
-            useSavedFlag = (match[1].str() == "true");
+        std::string user;
+        if (!requestUser(request, user)) {
+            return createErrorResponse(400, "Invalid user");
         }
-        bool anyParamsProvided = radiusProvided || systemsProvided || anomaliesProvided || seedProvided;
+        GalaxySessionStore::Key key(user, params.saveSlot);
+        int saveSlot = params.saveSlot;
+        bool useSavedFlag = params.useSaved;
+        bool anyParamsProvided = params.anyGenerationParams();
 
         // Decide behavior: if use_saved is true, try load; otherwise if params provided, generate; else try load then generate
-        if (useSavedFlag) {
-            bool found = false;
-            std::string savedJson = loadSavedStateForUser("keith", saveSlot, found);
-            if (found && !savedJson.empty()) {
-                std::cout << "💾 Loaded existing saved galaxy for user keith (slot " << saveSlot << ")" << std::endl;
-                return createJsonResponse(savedJson);
-            }
-            // If requested use_saved but none found, fall through to generation
-        } else if (!useSavedFlag && !anyParamsProvided) {
+        // If requested use_saved but none found, fall through to generation
+        if (useSavedFlag || !anyParamsProvided) {
             bool found = false;
-            std::string savedJson = loadSavedStateForUser("keith", saveSlot, found);
+            Galaxy restored;
+            size_t deltaCount = 0;
+            std::string savedJson = loadSavedStateForUser(user, saveSlot, found, &restored, &deltaCount);
             if (found && !savedJson.empty()) {
-                std::cout << "💾 Loaded existing saved galaxy for user keith (slot " << saveSlot << ")" << std::endl;
-                return createJsonResponse(savedJson);
-            }
-        }
-        
-        // Generate galaxy using existing game engine
-        GalaxyConfig config;
-        config.seed = seed;
-        config.radius = radius;
-        config.starSystemCount = systems;
-        config.anomalyCount = anomalies;
-        config.minDistance = 2.0;
-        config.connectivity.minConnections = 1;
-        config.connectivity.maxConnections = 8;
-        config.connectivity.maxDistance = 10.0;
-        config.connectivity.distanceDecayFactor = 0.8;
-        config.connectivity.useVoronoiConnectivity = true;
-        config.visualization.width = 2000;
-        config.visualization.height = 2000;
-        config.visualization.scale = 6.0;
-        
-        // Add fixed systems
-        config.fixedSystems = {
-            {"sol", "Sol System", 0.0, 0.0, "origin", true},
-            {"alpha-centauri", "Alpha Centauri", 4.37, 0.0, "core", true},
-            {"tau-ceti", "Tau Ceti", -7.8, 9.1, "core", true},
-            {"barnards-star", "Barnard's Star", 2.1, -5.6, "core", true},
-            {"bellatrix", "Bellatrix", 180.0, 165.0, "rim", true},
-            {"lumiere", "Lumière", 0.0, 0.0, "rim", false, 250.0, 20.0},
-            {"aspida", "Aspida", 0.0, 0.0, "rim", false, 350.0, 20.0}
-        };
-        
-        GalaxyGenerator generator(config);
-        currentGalaxy = generator.generateGalaxy();
-        
-        // Convert to JSON using existing method
-        std::ostringstream json;
-        json << "{";
-        json << "\"config\":{";
-        json << "\"radius\":" << currentGalaxy.config.radius << ",";
-        json << "\"systems\":" << currentGalaxy.config.starSystemCount << ",";
-        json << "\"anomalies\":" << currentGalaxy.config.anomalyCount << ",";
-        json << "\"seed\":" << currentGalaxy.config.seed;
-        json << "},";
-        json << "\"visualization\":{";
-        json << "\"width\":" << currentGalaxy.config.visualization.width << ",";
-        json << "\"height\":" << currentGalaxy.config.visualization.height << ",";
-        json << "\"scale\":" << currentGalaxy.config.visualization.scale;
-        json << "},";
-        json << "\"systems\":[";
-        
-        for (size_t i = 0; i < currentGalaxy.systems.size(); i++) {
-            if (i > 0) json << ",";
-            const auto& system = currentGalaxy.systems[i];
-            json << "{";
-            json << "\"id\":\"" << system.id << "\",";
-            json << "\"name\":\"" << system.name << "\",";
-            json << "\"x\":" << system.x << ",";
-            json << "\"y\":" << system.y << ",";
-            json << "\"type\":\"" << system.type << "\",";
-            json << "\"isFixed\":" << (system.isFixed ? "true" : "false") << ",";
-            json << "\"explored\":true,";
-            
-            // Build connections array for this system
-            json << "\"connections\":[";
-            bool firstConnection = true;
-            for (const auto& lane : currentGalaxy.warpLanes) {
-                if (lane.from == system.id || lane.to == system.id) {
-                    if (!firstConnection) json << ",";
-                    std::string connectedId = (lane.from == system.id) ? lane.to : lane.from;
-                    json << "\"" << connectedId << "\"";
-                    firstConnection = false;
+                if (logEnabled(LogLevel::Info)) {
+                    std::cout << "💾 Loaded existing saved galaxy for user " << user << " (slot " << saveSlot << ")\n";
+                }
+                
+                // Snapshot saves bring the full galaxy back, so system lookups work again
+                // and further actions extend the slot's log; a long one is compacted now
+                if (!restored.systems.empty()) {
+                    auto galaxy = std::make_shared<const Galaxy>(std::move(restored));
+                    if (deltaCount >= kCompactAfterDeltas) {
+                        publishGalaxy(key, galaxy, std::make_shared<const std::string>(encodeGalaxySnapshot(*galaxy)));
+                    } else {
+                        publishGalaxy(key, galaxy, nullptr, "", deltaCount);
+                    }
                 }
+                return createJsonResponse(request, std::make_shared<const std::string>(std::move(savedJson)));
             }
-            json << "],";
-            
-            // Add system info
-            json << "\"systemInfo\":{";
-            json << "\"starType\":\"" << system.systemInfo.starType << "\",";
-            json << "\"planetCount\":" << system.systemInfo.planetCount << ",";
-            json << "\"moonCount\":" << system.systemInfo.moonCount << ",";
-            json << "\"asteroidCount\":" << system.systemInfo.asteroidCount;
-            json << "},";
-            
-            // Only mark systems as having detailed data if a predefined definition exists
-            bool hasDetailed = (system.detailedSystem != nullptr);
-            json << "\"hasDetailedData\":" << (hasDetailed ? "true" : "false");
-            json << "}";
-        }
-        
-        json << "],\"anomalies\":[";
-        for (size_t i = 0; i < currentGalaxy.anomalies.size(); i++) {
-            if (i > 0) json << ",";
-            const auto& anomaly = currentGalaxy.anomalies[i];
-            json << "{";
-            json << "\"id\":\"" << anomaly.id << "\",";
-            json << "\"name\":\"" << anomaly.name << "\",";
-            json << "\"x\":" << anomaly.x << ",";
-            json << "\"y\":" << anomaly.y << ",";
-            json << "\"type\":\"" << anomaly.type << "\"";
-            json << "}";
         }
         
-        json << "],\"warpLanes\":[";
-        for (size_t i = 0; i < currentGalaxy.warpLanes.size(); i++) {
-            if (i > 0) json << ",";
-            const auto& lane = currentGalaxy.warpLanes[i];
-            json << "{";
-            json << "\"from\":\"" << lane.from << "\",";
-            json << "\"to\":\"" << lane.to << "\",";
-            json << "\"distance\":" << lane.distance;
-            json << "}";
-        }
-        json << "]";
-        json << "}";
-        
-        std::cout << "✅ Galaxy generated successfully" << std::endl;
-        
-        // Persist generated state
-        std::string error;
-        if (!upsertSavedStateForUser("keith", saveSlot, json.str(), error)) {
-            std::cerr << "⚠️  Failed to persist save: " << error << std::endl;
-        } else {
-            std::cout << "💾 Saved galaxy to DB for user keith (slot " << saveSlot << ")" << std::endl;
-        }
+        std::shared_ptr<const GalaxyCache::Entry> entry = generatedGalaxy(config, canonicalGalaxyKey(config));
         
-        return createJsonResponse(json.str());
+        // Publish the new galaxy and persist it in the background; readers keep
+        // the old one until this point
+        publishGalaxy(key, entry->galaxy, entry->snapshot, entry->etag);
+        return createJsonResponse(request, entry->json, entry->etag, entry);
         
     } catch (const std::exception& e) {
         std::cerr << "❌ Galaxy generation failed: " << e.what() << std::endl;
@@ -430,6 +538,154 @@ std::string BackendServer::handleGalaxyGenerate(const std::string& request) {
     }
 }
 
+std::shared_ptr<const GalaxyCache::Entry> BackendServer::generatedGalaxy(const GalaxyConfig& config,
+                                                                        const std::string& cacheKey, GalaxyJob* job) {
+    // Identical configs produce identical galaxies, so repeats are served from memory
+    std::shared_ptr<const GalaxyCache::Entry> entry = galaxyCache.find(cacheKey);
+    if (entry) {
+        if (logEnabled(LogLevel::Debug)) {
+            std::cout << "♻️  Serving cached galaxy (" << entry->json->size() << " bytes)\n";
+        }
+        return entry;
+    }
+    
+    GalaxyGenerator generator(config);
+    if (job) {
+        generator.setStageObserver([job](const StageTiming& timing) { job->stageFinished(timing.stage); });
+    }
+    auto galaxy = std::make_shared<const Galaxy>(generator.generateGalaxy());
+    auto json = std::make_shared<const std::string>(serializeGalaxy(*galaxy));
+    auto snapshot = std::make_shared<const std::string>(encodeGalaxySnapshot(*galaxy));
+    if (job) job->stageFinished("serialize");
+    entry = galaxyCache.insert(cacheKey, std::move(galaxy), std::move(json), std::move(snapshot));
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "✅ Galaxy generated successfully\n";
+    }
+    return entry;
+}
+
+std::string BackendServer::handleCreateGalaxyJob(const HttpRequest& request) {
+    GalaxyRequest params = defaultGalaxyRequest();
+    const GalaxyConfig& config = params.config;
+    std::string error;
+    if (!decodeGalaxyRequest(request.body, params, error)) {
+        return createErrorResponse(400, error);
+    }
+    if (config.starSystemCount < 1 || config.starSystemCount > kMaxJobSystemCount) {
+        return createErrorResponse(400, "systems must be 1.." + std::to_string(kMaxJobSystemCount));
+    }
+    if (!(config.radius > 0.0 && config.radius <= kMaxJobRadius)) {
+        return createErrorResponse(400, "radius must be above 0 and at most " + std::to_string(static_cast<int>(kMaxJobRadius)));
+    }
+    
+    bool coalesced = false;
+    std::shared_ptr<GalaxyJob> job = galaxyJobs->submit(canonicalGalaxyKey(config), config, coalesced);
+    if (!job) {
+        return createErrorResponse(503, "Too many galaxy jobs waiting; retry later");
+    }
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << (coalesced ? "🔗 Joined galaxy job " : "🗂️  Queued galaxy job ") << job->id() << '\n';
+    }
+    
+    // The result URL carries this client's save slot, since coalesced clients may differ
+    std::string base = "/api/galaxy/jobs/" + job->id();
+    JsonWriter json(512);
+    json.beginObject()
+        .field("jobId", job->id())
+        .field("state", jobStateName(job->progress().state))
+        .field("coalesced", coalesced)
+        .field("statusUrl", base)
+        .field("eventsUrl", base + "/events")
+        .field("resultUrl", base + "/result?slot=" + std::to_string(params.saveSlot))
+        .endObject();
+    const std::string& body = json.str();
+    return responseHead(body.size(), "application/json", "", "202 Accepted") + body;
+}
+
+HttpResponse BackendServer::handleGalaxyJob(const HttpRequest& request) {
+    // /api/galaxy/jobs/<id>[/result|/events]
+    std::string rest = request.path.substr(std::strlen("/api/galaxy/jobs/"));
+    std::string id = rest.substr(0, rest.find('/'));
+    std::string action = id.size() < rest.size() ? rest.substr(id.size() + 1) : "";
+    std::shared_ptr<GalaxyJob> job = galaxyJobs->find(id);
+    if (!job) {
+        return createErrorResponse(404, "Job not found");
+    }
+    
+    if (request.method == "DELETE") {
+        if (!action.empty()) return createErrorResponse(404, "Route not found");
+        if (job->unsubscribe() && logEnabled(LogLevel::Info)) {
+            std::cout << "🛑 Cancelling galaxy job " << job->id() << '\n';
+        }
+    } else if (action == "events") {
+        return streamGalaxyJob(job);
+    } else if (action == "result") {
+        GalaxyJob::Progress progress = job->progress();
+        std::shared_ptr<const GalaxyCache::Entry> entry = job->result();
+        if (!entry) {
+            return createErrorResponse(409, std::string("Job is ") + jobStateName(progress.state));
+        }
+        GalaxySessionStore::Key key;
+        if (!sessionKey(request, key)) {
+            return createErrorResponse(400, "Invalid user or save slot");
+        }
+        
+        // Collecting the galaxy makes it the player's, exactly like a generate
+        publishGalaxy(key, entry->galaxy, entry->snapshot, entry->etag);
+        return createJsonResponse(request, entry->json, entry->etag, entry);
+    } else if (!action.empty()) {
+        return createErrorResponse(404, "Route not found");
+    }
+    
+    JsonWriter json(256);
+    writeJobProgress(json, *job, job->progress());
+    return createJsonResponse(json.str());
+}
+
+HttpResponse BackendServer::streamGalaxyJob(const std::shared_ptr<GalaxyJob>& job) {
+    // Every stream holds a worker thread, so only some of them may
+    size_t limit = std::max<size_t>(1, http.workerCount() / 4);
+    if (activeStreams.fetch_add(1, std::memory_order_relaxed) >= limit) {
+        activeStreams.fetch_sub(1, std::memory_order_relaxed);
+        return createErrorResponse(503, "Too many event streams; poll the job instead");
+    }
+    auto slot = std::make_shared<StreamSlot>(activeStreams);
+    
+    HttpResponse response("HTTP/1.1 200 OK\r\n"
+                          "Content-Type: text/event-stream\r\n"
+                          "Cache-Control: no-cache\r\n"
+                          "Connection: close\r\n"
+                          "Access-Control-Allow-Origin: *\r\n"
+                          "\r\n");
+    // Server-sent events: one per progress change, named after the final state
+    // at the end, with comments in between so proxies keep the stream open
+    response.stream = [this, job, slot](int fd) {
+        GalaxyJob::Progress progress = job->progress();
+        for (;;) {
+            JsonWriter json(256);
+            writeJobProgress(json, *job, progress);
+            bool last = jobFinished(progress.state);
+            std::string event = std::string("event: ") + (last ? jobStateName(progress.state) : "progress") +
+                                "\ndata: " + json.str() + "\n\n";
+            if (!writeAll(fd, event) || last) return;
+            
+            GalaxyJob::Progress next;
+            do {
+                next = job->waitForChange(progress.version, std::chrono::seconds(kStreamKeepAliveSeconds));
+                if (!http.running()) return;
+                if (next.version == progress.version && !writeAll(fd, ": keep-alive\n\n")) return;
+            } while (next.version == progress.version);
+            progress = next;
+        }
+    };
+    return response;
+}
+
+HttpResponse BackendServer::handleMetrics() {
+    auto body = std::make_shared<const std::string>(MetricsRegistry::global().render());
+    return HttpResponse(responseHead(body->size(), "text/plain; version=0.0.4"), body);
+}
+
 std::string BackendServer::handleGalaxyHealth() {
     std::ostringstream json;
     json << "{";
@@ -440,82 +696,598 @@ std::string BackendServer::handleGalaxyHealth() {
     return createJsonResponse(json.str());
 }
 
-std::string BackendServer::handleSystemDetails(const std::string& request) {
+HttpResponse BackendServer::handleSystemDetails(const HttpRequest& request) {
     // Extract system ID from path
-    std::regex pathRegex(R"(/api/system/([^/\s]+))");
-    std::smatch match;
-    
-    if (!std::regex_search(request, match, pathRegex)) {
+    std::string systemId = request.path.substr(std::strlen("/api/system/"));
+    if (systemId.empty() || systemId.find('/') != std::string::npos) {
         return createErrorResponse(400, "Invalid system ID");
     }
     
-    std::string systemId = match[1].str();
-    
     // First, try to get predefined system definition
     const SystemDefinition* systemDef = systemConfigManager.getSystemDefinition(systemId);
     
     if (systemDef) {
         // Found predefined system - serialize it
-        return serializeSystemDefinition(*systemDef);
+        return createJsonResponse(serializeSystemDefinition(*systemDef));
     }
     
-    // Not a predefined system - look up in current galaxy
-    if (currentGalaxy.systems.empty()) {
+    // Not a predefined system - look up in the player's galaxy. Holding the
+    // session keeps it alive even if the galaxy is replaced meanwhile.
+    GalaxySessionStore::Key key;
+    if (!sessionKey(request, key)) {
+        return createErrorResponse(400, "Invalid user or save slot");
+    }
+    std::shared_ptr<const GalaxySession> session = loadSession(key);
+    if (!session || session->galaxy->systems.empty()) {
         return createErrorResponse("No galaxy data available. Generate a galaxy first.");
     }
+    const std::shared_ptr<const Galaxy>& galaxy = session->galaxy;
+    const std::shared_ptr<SystemDetailCache>& details = session->details;
     
-    // Find the system in the current galaxy
-    const StarSystem* galaxySystem = nullptr;
-    for (const auto& sys : currentGalaxy.systems) {
-        if (sys.id == systemId) {
-            galaxySystem = &sys;
-            break;
-        }
+    int64_t index = galaxy->findSystemIndex(systemId);
+    if (index < 0) {
+        return createErrorResponse("System not found in current galaxy");
     }
+    const StarSystem& galaxySystem = galaxy->systems[index];
     
-    if (!galaxySystem) {
-        return createErrorResponse("System not found in current galaxy");
+    // Generate detailed system data once per galaxy; repeats reuse the stored body
+    SystemDetailCache::Detail detail = details->get(static_cast<uint32_t>(index), [&](SystemDefinition& generated) {
+        generated = systemConfigManager.generateRandomSystem(systemId, galaxySystem.name);
+        
+        // Override with galaxy system info
+        generated.systemId = systemId;
+        generated.systemName = galaxySystem.name;
+        generated.starType = galaxySystem.systemInfo.starType;
+        return serializeSystemDefinition(generated);
+    });
+    
+    if (etagMatches(request.header("If-None-Match"), detail.etag)) {
+        return createNotModifiedResponse(detail.etag);
     }
+    return createJsonResponse(detail.json, detail.etag);
+}
+
+bool BackendServer::requestUser(const HttpRequest& request, std::string& user) {
+    user = request.header("X-Space4X-User");
+    if (user.empty()) user = request.queryParam("user");
+    if (user.empty()) user = kDefaultUser;
+    return validUsername(user);
+}
+
+bool BackendServer::sessionKey(const HttpRequest& request, GalaxySessionStore::Key& key) {
+    if (!requestUser(request, key.first)) return false;
+    std::string slot = request.queryParam("slot");
+    if (slot.empty()) {
+        key.second = sessions.activeSlot(key.first);
+        return true;
+    }
+    char* end = nullptr;
+    long value = std::strtol(slot.c_str(), &end, 10);
+    if (*end != '\0' || value < 0 || value > std::numeric_limits<int>::max()) return false;
+    key.second = static_cast<int>(value);
+    return true;
+}
+
+std::shared_ptr<const GalaxySession> BackendServer::loadSession(const GalaxySessionStore::Key& key) {
+    std::shared_ptr<const GalaxySession> session = sessions.find(key);
+    if (session || key.second <= 0) return session;
     
-    // Generate detailed system data for this procedural system
-    SystemDefinition generatedSystem = systemConfigManager.generateRandomSystem(systemId, galaxySystem->name);
+    // Evicted, or from before a restart: rebuild it from the slot, once even
+    // when several requests miss together
+    return sessions.update(key, [&](std::shared_ptr<const GalaxySession> current,
+                                    GalaxySessionStore::SaveState& save) {
+        if (current) return current;
+        bool found = false;
+        Galaxy restored;
+        size_t deltaCount = 0;
+        loadSavedStateForUser(key.first, key.second, found, &restored, &deltaCount);
+        if (!found || restored.systems.empty()) return current;
+        
+        auto galaxy = std::make_shared<const Galaxy>(std::move(restored));
+        save.logging = true;
+        save.loggedDeltas = deltaCount;
+        if (deltaCount >= kCompactAfterDeltas) {
+            saveWriter.enqueue(key.first, key.second, std::make_shared<const std::string>(encodeGalaxySnapshot(*galaxy)));
+            save.loggedDeltas = 0;
+        }
+        MetricsRegistry::global().add(sessionsRehydrated);
+        if (logEnabled(LogLevel::Info)) {
+            std::cout << "💾 Restored galaxy session for user " << key.first << " (slot " << key.second << ")\n";
+        }
+        return GalaxySession::create(std::move(galaxy));
+    });
+}
+
+void BackendServer::publishGalaxy(const GalaxySessionStore::Key& key, std::shared_ptr<const Galaxy> galaxy,
+                                  std::shared_ptr<const std::string> base, const std::string& etag,
+                                  size_t loggedDeltas) {
+    // Under the session's lock, so no action's delta can slip in between the
+    // switch and the new base
+    sessions.update(key, [&](std::shared_ptr<const GalaxySession> current, GalaxySessionStore::SaveState& save) {
+        const int saveSlot = key.second;
+        if (saveSlot > 0 && base) {
+            bool alreadySaved = !etag.empty() && save.autosavedEtag == etag;
+            save.autosavedEtag = etag;
+            if (!alreadySaved) {
+                saveWriter.enqueue(key.first, saveSlot, std::move(base));
+            }
+            loggedDeltas = 0;
+        }
+        save.logging = saveSlot > 0;
+        save.loggedDeltas = loggedDeltas;
+        
+        if (current && current->galaxy == galaxy) return current;
+        return GalaxySession::create(galaxy);
+    });
+    sessions.setActiveSlot(key.first, key.second);
+}
+
+void BackendServer::logGalaxyDelta(const GalaxySessionStore::Key& key, GalaxySessionStore::SaveState& save,
+                                   const Galaxy& galaxy, const GalaxyDelta& delta) {
+    if (!save.logging) return;
     
-    // Override with galaxy system info
-    generatedSystem.systemId = galaxySystem->id;
-    generatedSystem.systemName = galaxySystem->name;
-    generatedSystem.starType = galaxySystem->systemInfo.starType;
+    // The slot no longer holds the last autosaved galaxy
+    save.autosavedEtag.clear();
     
-    // Serialize the generated system
-    return serializeSystemDefinition(generatedSystem);
+    if (++save.loggedDeltas >= kCompactAfterDeltas) {
+        saveWriter.enqueue(key.first, key.second, std::make_shared<const std::string>(encodeGalaxySnapshot(galaxy)));
+        save.loggedDeltas = 0;
+        if (logEnabled(LogLevel::Info)) {
+            std::cout << "🗜️  Compacting save slot " << key.second << " of " << key.first << " at revision "
+                      << galaxy.revision << '\n';
+        }
+    } else {
+        saveWriter.enqueueDelta(key.first, key.second, std::make_shared<const std::string>(encodeGalaxyDelta(delta)));
+    }
 }
 
-std::string BackendServer::handleGameState() {
+HttpResponse BackendServer::handleGameState(const HttpRequest& request) {
+    GalaxySessionStore::Key key;
+    if (!sessionKey(request, key)) {
+        return createErrorResponse(400, "Invalid user or save slot");
+    }
+    std::string lostError;
+    if (saveWriter.takeFailure(key.first, key.second, lostError)) {
+        return createErrorResponse(500, "The last save to this slot was not stored: " + lostError);
+    }
     bool found = false;
-    std::string savedJson = loadSavedStateForUser("keith", 1, found);
+    std::string savedJson = loadSavedStateForUser(key.first, key.second, found);
     if (found && !savedJson.empty()) {
-        return createJsonResponse(savedJson);
+        return createJsonResponse(request, std::make_shared<const std::string>(std::move(savedJson)));
     }
     return createErrorResponse(404, "No saved game state for user");
 }
 
-std::string BackendServer::handleGameAction(const std::string& request) {
-    std::ostringstream json;
-    json << "{";
-    json << "\"message\":\"Game action endpoint - to be implemented\",";
-    json << "\"action\":" << request;
-    json << "}";
+std::string BackendServer::handleGameAction(const HttpRequest& request) {
+    GameAction action;
+    std::string error;
+    if (!decodeGameAction(request.body, action, error)) {
+        return createErrorResponse(400, error);
+    }
+    
+    GalaxySessionStore::Key key;
+    if (!sessionKey(request, key)) {
+        return createErrorResponse(400, "Invalid user or save slot");
+    }
+    if (!loadSession(key)) {
+        return createErrorResponse(409, "No galaxy data available. Generate a galaxy first.");
+    }
+    if (action.action == "move_fleet") return orderFleet(key, action);
+    
+    // One edit per session at a time: each works on a private copy of the
+    // session's galaxy, which may be shared with the generation cache and
+    // other sessions and must stay untouched. The copy shares its records
+    // copy-on-write, so only the chunks the edit touches are duplicated
+    std::shared_ptr<Galaxy> galaxy;
+    GalaxyDelta delta;
+    int errorStatus = 0;
+    sessions.update(key, [&](std::shared_ptr<const GalaxySession> current, GalaxySessionStore::SaveState& save) {
+        if (!current) {
+            errorStatus = 409;
+            error = "No galaxy data available. Generate a galaxy first.";
+            return current;
+        }
+        const Galaxy& base = *current->galaxy;
+        galaxy = std::make_shared<Galaxy>(base);
+        bool applied;
+        if (action.action == "add_system") {
+            if (!action.positionProvided) {
+                errorStatus = 400;
+                error = "add_system needs x and y";
+                return current;
+            }
+            applied = galaxy->addSystem(discoveredSystem(action), delta, error);
+        } else if (action.action == "remove_system") {
+            applied = galaxy->removeSystem(action.id, delta, error);
+        } else if (action.action == "add_lane") {
+            applied = galaxy->addLane(action.from, action.to, delta, error);
+        } else if (action.action == "remove_lane") {
+            applied = galaxy->removeLane(action.from, action.to, delta, error);
+        } else if (action.action == "set_explored") {
+            applied = galaxy->setSystemExplored(action.id, action.value, delta, error);
+        } else if (action.action == "set_lane_discovered") {
+            applied = galaxy->setLaneDiscovered(action.from, action.to, action.value, delta, error);
+        } else if (action.action == "set_anomaly_discovered") {
+            applied = galaxy->setAnomalyDiscovered(action.id, action.value, delta, error);
+        } else {
+            errorStatus = 400;
+            error = "Unknown action \"" + action.action + "\"";
+            return current;
+        }
+        if (!applied) {
+            errorStatus = error.find("not found") != std::string::npos ? 404 : 400;
+            return current;
+        }
+        if (delta.empty()) return current;
+        
+        delta.baseRevision = base.revision;
+        galaxy->revision = base.revision + 1;
+        logGalaxyDelta(key, save, *galaxy, delta);
+        return current->edited(galaxy, delta);
+    });
+    if (errorStatus != 0) {
+        return createErrorResponse(errorStatus, error);
+    }
+    if (logEnabled(LogLevel::Debug)) {
+        std::cout << "🎯 Applied " << action.action << ": +" << delta.lanesAdded.size() << "/-"
+                  << delta.lanesRemoved.size() << " lanes\n";
+    }
+    
+    JsonWriter json(512 + delta.systemsAdded.size() * 320 + delta.lanesAdded.size() * 80);
+    json.beginObject()
+        .field("success", true)
+        .field("action", action.action);
+    json.key("delta");
+    writeDelta(json, *galaxy, delta);
+    json.endObject();
+    return createJsonResponse(json.str());
+}
+
+std::string BackendServer::orderFleet(const GalaxySessionStore::Key& key, const GameAction& action) {
+    std::string error;
+    int errorStatus = 0;
+    std::string system;
+    std::vector<std::string> path;
+    sessions.update(key, [&](std::shared_ptr<const GalaxySession> current, GalaxySessionStore::SaveState&) {
+        if (!current) {
+            errorStatus = 409;
+            error = "No galaxy data available. Generate a galaxy first.";
+            return current;
+        }
+        if (!current->simulation) current = current->withSimulation();
+        GalaxySimulation& simulation = *current->simulation;
+        if (!simulation.orderFleet(action.id, action.from, action.to, *current->routes, error)) {
+            errorStatus = error.find("Unknown") != std::string::npos ? 404 : 400;
+            return current;
+        }
+        // Copied out under the session's lock, before a tick can move it
+        const Fleet* fleet = simulation.findFleet(action.id);
+        system = simulation.galaxy().systems[fleet->system].id;
+        for (uint32_t stop : fleet->path) path.push_back(simulation.galaxy().systems[stop].id);
+        return current;
+    });
+    if (errorStatus != 0) {
+        return createErrorResponse(errorStatus, error);
+    }
+    if (logEnabled(LogLevel::Debug)) {
+        std::cout << "🚀 Fleet " << action.id << " ordered to " << action.to << " (" << path.size() << " jumps)\n";
+    }
+    
+    JsonWriter json(256 + path.size() * 16);
+    json.beginObject()
+        .field("success", true)
+        .field("action", action.action);
+    json.key("fleet").beginObject()
+        .field("id", action.id)
+        .field("system", system);
+    json.key("path").beginArray();
+    for (const std::string& stop : path) json.value(stop);
+    json.endArray();
+    json.endObject();
+    json.endObject();
+    return createJsonResponse(json.str());
+}
+
+HttpResponse BackendServer::handleGameTick(const HttpRequest& request) {
+    long ticks = 1;
+    std::string ticksParam = request.queryParam("ticks");
+    if (!ticksParam.empty()) {
+        char* end = nullptr;
+        ticks = std::strtol(ticksParam.c_str(), &end, 10);
+        if (*end != '\0' || ticks < 1 || ticks > kMaxTicksPerRequest) {
+            return createErrorResponse(400, "ticks must be 1-" + std::to_string(kMaxTicksPerRequest));
+        }
+    }
+    GalaxySessionStore::Key key;
+    if (!sessionKey(request, key)) {
+        return createErrorResponse(400, "Invalid user or save slot");
+    }
+    if (!loadSession(key)) {
+        return createErrorResponse(409, "No galaxy data available. Generate a galaxy first.");
+    }
+    
+    // Ticks of one session run one at a time under its lock; the jobs inside a
+    // tick are what run in parallel
+    std::shared_ptr<std::string> body;
+    uint64_t tickCount = 0;
+    sessions.update(key, [&](std::shared_ptr<const GalaxySession> current, GalaxySessionStore::SaveState&) {
+        if (!current) return current;
+        if (!current->simulation) current = current->withSimulation();
+        GalaxySimulation& simulation = *current->simulation;
+        
+        JsonWriter json(256);
+        json.beginObject();
+        json.key("deltas").beginArray();
+        for (long i = 0; i < ticks; i++) {
+            TickDelta delta;
+            {
+                ScopedTimer timer(tickTimer);
+                delta = simulation.tick(simulationJobs);
+            }
+            writeTickDelta(json, simulation, delta);
+        }
+        json.endArray();
+        tickCount = simulation.tickCount();
+        json.field("tick", static_cast<unsigned long long>(tickCount));
+        json.endObject();
+        body = std::make_shared<std::string>(json.release());
+        return current;
+    });
+    if (!body) {
+        return createErrorResponse(409, "No galaxy data available. Generate a galaxy first.");
+    }
+    if (logEnabled(LogLevel::Debug)) {
+        std::cout << "⏱️  Simulated " << ticks << " tick(s) for " << key.first << " (slot " << key.second
+                  << "), now at tick " << tickCount << '\n';
+    }
+    return createJsonResponse(request, std::move(body));
+}
+
+HttpResponse BackendServer::handleSimulationState(const HttpRequest& request) {
+    GalaxySessionStore::Key key;
+    if (!sessionKey(request, key)) {
+        return createErrorResponse(400, "Invalid user or save slot");
+    }
+    if (!loadSession(key)) {
+        return createErrorResponse(409, "No galaxy data available. Generate a galaxy first.");
+    }
+    
+    // Serialized under the session's lock, so no tick runs halfway through
+    std::shared_ptr<std::string> body;
+    sessions.update(key, [&](std::shared_ptr<const GalaxySession> current, GalaxySessionStore::SaveState&) {
+        if (!current) return current;
+        if (!current->simulation) current = current->withSimulation();
+        body = std::make_shared<std::string>(serializeSimulation(*current->simulation));
+        return current;
+    });
+    if (!body) {
+        return createErrorResponse(409, "No galaxy data available. Generate a galaxy first.");
+    }
+    return createJsonResponse(request, std::move(body));
+}
+
+std::string BackendServer::handleRoute(const HttpRequest& request) {
+    RouteRequest routeRequest;
+    std::string error;
+    if (request.method == "GET") {
+        RouteQuery query = {request.queryParam("from"), request.queryParam("to")};
+        if (query.from.empty() || query.to.empty()) {
+            return createErrorResponse(400, "from and to are required");
+        }
+        routeRequest.routes.push_back(query);
+        std::string metric = request.queryParam("metric");
+        if (!metric.empty()) routeRequest.metric = metric;
+    } else if (!decodeRouteRequest(request.body, routeRequest, error)) {
+        return createErrorResponse(400, error);
+    }
+    
+    RouteMetric metric;
+    if (routeRequest.metric == "distance") {
+        metric = RouteMetric::Distance;
+    } else if (routeRequest.metric == "time") {
+        metric = RouteMetric::TravelTime;
+    } else {
+        return createErrorResponse(400, "Unknown metric \"" + routeRequest.metric + "\"");
+    }
+    if (routeRequest.routes.size() > kMaxRoutesPerRequest) {
+        return createErrorResponse(400, "At most " + std::to_string(kMaxRoutesPerRequest) + " routes per request");
+    }
+    
+    // The session keeps its planner alive even if the galaxy is replaced meanwhile
+    GalaxySessionStore::Key key;
+    if (!sessionKey(request, key)) {
+        return createErrorResponse(400, "Invalid user or save slot");
+    }
+    std::shared_ptr<const GalaxySession> session = loadSession(key);
+    if (!session) {
+        return createErrorResponse(409, "No galaxy data available. Generate a galaxy first.");
+    }
+    RoutePlanner* planner = session->routes.get();
+    const Galaxy& galaxy = planner->galaxy();
+    
+    std::vector<RoutePlanner::Query> queries;
+    queries.reserve(routeRequest.routes.size());
+    for (const auto& route : routeRequest.routes) {
+        int64_t from = galaxy.findSystemIndex(route.from);
+        int64_t to = galaxy.findSystemIndex(route.to);
+        if (from < 0 || to < 0) {
+            return createErrorResponse(404, "System " + (from < 0 ? route.from : route.to) + " not found");
+        }
+        queries.push_back({static_cast<uint32_t>(from), static_cast<uint32_t>(to)});
+    }
+    std::vector<std::shared_ptr<const Route>> found = planner->routes(queries, metric);
+    
+    JsonWriter json(128 + found.size() * 256);
+    json.beginObject()
+        .field("success", true)
+        .field("metric", routeRequest.metric);
+    json.key("routes").beginArray();
+    for (size_t i = 0; i < found.size(); i++) {
+        const Route& route = *found[i];
+        json.beginObject()
+            .field("from", routeRequest.routes[i].from)
+            .field("to", routeRequest.routes[i].to)
+            .field("found", route.found);
+        if (route.found) {
+            json.field("distance", route.distance)
+                .field("travelTime", route.travelTime)
+                .field("hops", static_cast<int>(route.path.size()) - 1);
+            json.key("path").beginArray();
+            for (uint32_t system : route.path) json.value(galaxy.systems[system].id);
+            json.endArray();
+        }
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
     return createJsonResponse(json.str());
 }
 
-std::string BackendServer::handleGetSaves() {
-    if (!db_connection) {
+HttpResponse BackendServer::handleGalaxyTile(const HttpRequest& request) {
+    // Both from one session: the index's indices must refer to this galaxy
+    GalaxySessionStore::Key key;
+    if (!sessionKey(request, key)) {
+        return createErrorResponse(400, "Invalid user or save slot");
+    }
+    std::shared_ptr<const GalaxySession> session = loadSession(key);
+    if (!session) {
+        return createErrorResponse(409, "No galaxy data available. Generate a galaxy first.");
+    }
+    const Galaxy* galaxy = session->galaxy.get();
+    GalaxyTileIndex* tiles = session->tiles.get();
+    
+    // Either a tile address (z, x, y) or a free viewport (minX..maxY, optional zoom)
+    GalaxyTileIndex::Viewport viewport;
+    double z, x, y;
+    if (!request.queryParam("z").empty()) {
+        // Range-checked as doubles first: casting an out-of-range value to int is undefined
+        bool valid = parseNumberParam(request.queryParam("z"), z) && parseNumberParam(request.queryParam("x"), x) &&
+                     parseNumberParam(request.queryParam("y"), y) && z == std::floor(z) && x == std::floor(x) &&
+                     y == std::floor(y) && z >= 0 && z <= GalaxyTileIndex::kMaxZoom;
+        if (valid) {
+            double lastTile = std::ldexp(1.0, static_cast<int>(z)) - 1;
+            valid = x >= 0 && x <= lastTile && y >= 0 && y <= lastTile;
+        }
+        if (!valid || !tiles->tileViewport(static_cast<int>(z), static_cast<int>(x), static_cast<int>(y), viewport)) {
+            return createErrorResponse(400, "Invalid tile address; z must be 0.." + std::to_string(GalaxyTileIndex::kMaxZoom) +
+                                            " and x, y 0..2^z-1");
+        }
+    } else {
+        if (!parseNumberParam(request.queryParam("minX"), viewport.minX) ||
+            !parseNumberParam(request.queryParam("minY"), viewport.minY) ||
+            !parseNumberParam(request.queryParam("maxX"), viewport.maxX) ||
+            !parseNumberParam(request.queryParam("maxY"), viewport.maxY) ||
+            viewport.minX > viewport.maxX || viewport.minY > viewport.maxY) {
+            return createErrorResponse(400, "Expected z, x and y, or minX, minY, maxX and maxY");
+        }
+        viewport.zoom = tiles->maxZoom();
+        std::string zoom = request.queryParam("zoom");
+        if (!zoom.empty()) {
+            if (!parseNumberParam(zoom, z) || z < 0 || z > GalaxyTileIndex::kMaxZoom) {
+                return createErrorResponse(400, "zoom must be 0.." + std::to_string(GalaxyTileIndex::kMaxZoom));
+            }
+            viewport.zoom = static_cast<int>(z);
+        }
+    }
+    
+    GalaxyTileIndex::Tile tile = tiles->query(viewport);
+    JsonWriter json(256 + tile.systems.size() * 320 + tile.lanes.size() * 160 + tile.anomalies.size() * 96);
+    json.beginObject()
+        .field("zoom", viewport.zoom)
+        .field("maxZoom", tiles->maxZoom());
+    json.key("bounds").beginObject()
+        .field("minX", viewport.minX)
+        .field("minY", viewport.minY)
+        .field("maxX", viewport.maxX)
+        .field("maxY", viewport.maxY)
+        .endObject();
+    json.key("systems").beginArray();
+    for (uint32_t i : tile.systems) {
+        writeSystem(json, galaxy->systems[i]);
+    }
+    json.endArray();
+    json.key("anomalies").beginArray();
+    for (uint32_t i : tile.anomalies) {
+        writeAnomaly(json, galaxy->anomalies[i]);
+    }
+    json.endArray();
+    json.key("warpLanes").beginArray();
+    for (const auto& segment : tile.lanes) {
+        const WarpLane& lane = galaxy->warpLanes[segment.lane];
+        json.beginObject()
+            .field("from", lane.from)
+            .field("to", lane.to)
+            .field("distance", lane.distance)
+            .field("x1", segment.x1)
+            .field("y1", segment.y1)
+            .field("x2", segment.x2)
+            .field("y2", segment.y2)
+            .field("clipped", segment.clipped)
+            .endObject();
+    }
+    json.endArray();
+    json.field("hiddenSystems", static_cast<int>(tile.hiddenSystems));
+    json.endObject();
+    
+    // Panning back to a tile the client has seen costs a 304
+    auto body = std::make_shared<const std::string>(json.release());
+    std::string etag = computeEtag(*body);
+    return createJsonResponse(request, body, etag);
+}
+
+StarSystem BackendServer::discoveredSystem(const GameAction& action) {
+    StarSystem system;
+    system.id = action.id;
+    system.name = action.name.empty() ? action.id : action.name;
+    system.x = action.x;
+    system.y = action.y;
+    system.type = action.type;
+    if (system.type.empty()) {
+        // Same core radius the generator uses for connectivity tiers
+        system.type = std::sqrt(action.x * action.x + action.y * action.y) <= 300.0 ? "core" : "rim";
+    }
+    system.isFixed = false;
+    system.explored = false;
+    system.population = 0;
+    system.gdp = 0.0;
+    system.resources.minerals = 0;
+    system.resources.energy = 0;
+    system.resources.research = 0;
+    
+    system.detailedSystem = systemConfigManager.getSystemDefinition(system.id);
+    if (system.detailedSystem) {
+        const SystemDefinition& definition = *system.detailedSystem;
+        system.systemInfo.starType = definition.starType;
+        system.systemInfo.planetCount = definition.planets.size();
+        system.systemInfo.asteroidCount = definition.asteroids.size();
+        system.systemInfo.moonCount = 0;
+        for (const auto& planet : definition.planets) system.systemInfo.moonCount += planet.moons.size();
+    } else {
+        SystemDefinition definition = systemConfigManager.generateRandomSystem(system.id, system.name);
+        system.systemInfo.starType = definition.starType;
+        system.systemInfo.planetCount = definition.planets.size();
+        system.systemInfo.asteroidCount = 0;
+        system.systemInfo.moonCount = 0;
+        for (const auto& planet : definition.planets) system.systemInfo.moonCount += planet.moons.size();
+    }
+    return system;
+}
+
+HttpResponse BackendServer::handleGetSaves(const HttpRequest& request) {
+    std::string user;
+    if (!requestUser(request, user)) {
+        return createErrorResponse(400, "Invalid user");
+    }
+    DatabasePool::Lease db = database.acquire();
+    if (!db) {
         return createErrorResponse(500, "Database connection not available");
     }
     
-    // For now, get saves for the default "keith" user
+    std::string summaryParam = request.queryParam("summary");
+    bool summary = summaryParam == "true" || summaryParam == "1";
+    
     // In a real implementation, this would validate session/auth tokens
-    const char* query = "SELECT s.id, s.save_slot, s.save_data, s.created_at, s.updated_at FROM saves s JOIN users u ON s.user_id = u.id WHERE u.username = 'keith' ORDER BY s.save_slot";
-    PGresult* result = PQexec(db_connection, query);
+    PGresult* result = db.execute(summary ? kListSaveSummariesStatement.name : kListSavesStatement.name, {user});
     
     if (PQresultStatus(result) != PGRES_TUPLES_OK) {
         std::string error = PQresultErrorMessage(result);
@@ -532,125 +1304,169 @@ std::string BackendServer::handleGetSaves() {
         json << "{";
         json << "\"id\":\"" << PQgetvalue(result, i, 0) << "\",";
         json << "\"save_slot\":" << PQgetvalue(result, i, 1) << ",";
-        json << "\"save_data\":" << PQgetvalue(result, i, 2) << ",";
-        json << "\"created_at\":\"" << PQgetvalue(result, i, 3) << "\",";
-        json << "\"updated_at\":\"" << PQgetvalue(result, i, 4) << "\"";
+        if (summary) {
+            json << "\"format\":\"" << PQgetvalue(result, i, 2) << "\",";
+            json << "\"bytes\":" << PQgetvalue(result, i, 3) << ",";
+            json << "\"deltas\":" << PQgetvalue(result, i, 4) << ",";
+            json << "\"url\":\"/api/saves/" << PQgetvalue(result, i, 0) << "\",";
+            json << "\"created_at\":\"" << PQgetvalue(result, i, 5) << "\",";
+            json << "\"updated_at\":\"" << PQgetvalue(result, i, 6) << "\"";
+        } else {
+            json << "\"save_data\":" << PQgetvalue(result, i, 2) << ",";
+            json << "\"created_at\":\"" << PQgetvalue(result, i, 3) << "\",";
+            json << "\"updated_at\":\"" << PQgetvalue(result, i, 4) << "\"";
+        }
         json << "}";
     }
     
     json << "]}";
     PQclear(result);
     
-    return createJsonResponse(json.str());
+    return createJsonResponse(request, std::make_shared<const std::string>(json.str()));
 }
 
-std::string BackendServer::handleSaveGame(const std::string& request) {
-    if (!db_connection) {
-        return createErrorResponse(500, "Database connection not available");
+std::string BackendServer::handleSaveGame(const HttpRequest& request) {
+    std::string user;
+    if (!requestUser(request, user)) {
+        return createErrorResponse(400, "Invalid user");
     }
     
     // Parse minimal fields from request body
     int saveSlot = 1;
-    std::regex slotRegex(R"("save_slot":\s*(\d+))");
-    std::smatch match;
-    if (std::regex_search(request, match, slotRegex)) {
-        saveSlot = std::stoi(match[1].str());
+    std::string parseError;
+    if (!decodeSaveSlot(request.body, saveSlot, parseError)) {
+        return createErrorResponse(400, parseError);
     }
     
     // Everything after the body is treated as the saved state JSON
-    std::string saveJson = request;
+    auto saveJson = std::make_shared<const std::string>(request.body);
+    std::string previousError;
+    bool previousLost = saveWriter.takeFailure(user, saveSlot, previousError);
     
-    std::string error;
-    if (!upsertSavedStateForUser("keith", saveSlot, saveJson, error)) {
-        return createErrorResponse(500, std::string("Failed to save: ") + error);
-    }
+    // Queued as the slot's newest base under the session's lock, so it replaces
+    // any autosave and deltas still waiting and no action's delta lands after
+    // it. The slot no longer holds the last autosaved galaxy, and client JSON
+    // can't take game action deltas; a resident session stays playable
+    sessions.update({user, saveSlot}, [&](std::shared_ptr<const GalaxySession> current,
+                                          GalaxySessionStore::SaveState& save) {
+        save.logging = false;
+        save.autosavedEtag.clear();
+        saveWriter.enqueue(user, saveSlot, saveJson, AsyncSaveWriter::Format::Json);
+        return current;
+    });
     
-    std::ostringstream resp;
-    resp << "{";
-    resp << "\"status\":\"saved\",";
-    resp << "\"save_slot\":" << saveSlot;
-    resp << "}";
-    return createJsonResponse(resp.str());
+    JsonWriter json(128 + previousError.size());
+    json.beginObject()
+        .field("status", "saved")
+        .field("save_slot", saveSlot);
+    if (previousLost) json.field("previous_save_error", previousError);
+    json.endObject();
+    return createJsonResponse(json.str());
 }
-std::string BackendServer::loadSavedStateForUser(const std::string& username, int slot, bool& found) {
+std::string BackendServer::loadSavedStateForUser(const std::string& username, int slot, bool& found, Galaxy* restored,
+                                                size_t* deltaCount) {
     found = false;
-    if (!db_connection) {
-        return "";
-    }
-    const char* query = "SELECT s.save_data FROM saves s JOIN users u ON s.user_id = u.id WHERE u.username = $1 AND s.save_slot = $2 LIMIT 1";
-    const char* paramValues[] = { username.c_str(), std::to_string(slot).c_str() };
-    int paramLengths[] = { static_cast<int>(username.length()), static_cast<int>(std::to_string(slot).length()) };
-    int paramFormats[] = { 0, 0 };
-    PGresult* result = PQexecParams(db_connection, query, 2, nullptr, paramValues, paramLengths, paramFormats, 0);
-    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
-        std::string error = PQresultErrorMessage(result);
-        std::cerr << "❌ Load save failed: " << error << std::endl;
+    
+    // Anything still queued for the background writer is newer than the
+    // database copy. Deltas in flight may also be in the database already;
+    // replay skips the ones the galaxy contains
+    std::string saveData;
+    std::vector<std::string> deltas;
+    std::vector<std::string> pendingDeltas;
+    bool pending = saveWriter.pendingSave(username, slot, saveData, pendingDeltas);
+    if (!pending || saveData.empty()) {
+        DatabasePool::Lease db = database.acquire();
+        if (!db) {
+            return "";
+        }
+        PGresult* result = db.execute(kLoadSlotStatement.name, {username, std::to_string(slot)}, {}, 1);
+        if (PQresultStatus(result) != PGRES_TUPLES_OK) {
+            std::string error = PQresultErrorMessage(result);
+            std::cerr << "❌ Load save failed: " << error << std::endl;
+            PQclear(result);
+            return "";
+        }
+        int rows = PQntuples(result);
+        if (rows == 0) {
+            PQclear(result);
+            return "";
+        }
+        saveData.assign(PQgetvalue(result, 0, 0), PQgetlength(result, 0, 0));
+        for (int row = 1; row < rows; row++) {
+            deltas.emplace_back(PQgetvalue(result, row, 0), PQgetlength(result, row, 0));
+        }
         PQclear(result);
-        return "";
     }
-    if (PQntuples(result) == 0) {
-        PQclear(result);
+    deltas.insert(deltas.end(), std::make_move_iterator(pendingDeltas.begin()),
+                  std::make_move_iterator(pendingDeltas.end()));
+    
+    std::string error;
+    std::string json = savedStateToJson(saveData, deltas, restored, error, deltaCount);
+    if (!error.empty()) {
+        std::cerr << "❌ Load save failed: " << error << std::endl;
         return "";
     }
     found = true;
-    std::string json = PQgetvalue(result, 0, 0);
-    PQclear(result);
     return json;
 }
 
-bool BackendServer::upsertSavedStateForUser(const std::string& username, int slot, const std::string& saveJson, std::string& errorOut) {
-    if (!db_connection) {
-        errorOut = "No database connection";
-        return false;
+std::string BackendServer::savedStateToJson(const std::string& saveData, const std::vector<std::string>& deltas,
+                                            Galaxy* restored, std::string& errorOut, size_t* deltaCount) {
+    if (deltaCount) *deltaCount = 0;
+    if (!isGalaxySnapshot(saveData)) {
+        return saveData;  // Legacy JSON save; its deltas were cleared when it was written
     }
     
-    // Upsert using CTE to get user id
-    const char* query =
-        "WITH u AS (SELECT id FROM users WHERE username = $1),\n"
-        "ins AS (\n"
-        "  INSERT INTO saves (user_id, save_slot, save_data)\n"
-        "  SELECT u.id, $2::int, $3::jsonb FROM u\n"
-        "  ON CONFLICT (user_id, save_slot) DO UPDATE SET save_data = $3::jsonb, updated_at = NOW()\n"
-        "  RETURNING id\n"
-        ") SELECT id FROM ins";
-    
-    std::string slotStr = std::to_string(slot);
-    const char* paramValues[] = { username.c_str(), slotStr.c_str(), saveJson.c_str() };
-    int paramLengths[] = { static_cast<int>(username.length()), static_cast<int>(slotStr.length()), static_cast<int>(saveJson.length()) };
-    int paramFormats[] = { 0, 0, 0 };
-    PGresult* result = PQexecParams(db_connection, query, 3, nullptr, paramValues, paramLengths, paramFormats, 0);
-    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
-        errorOut = PQresultErrorMessage(result);
-        PQclear(result);
-        return false;
+    Galaxy galaxy;
+    if (!decodeGalaxySnapshot(saveData, galaxy, errorOut, &systemConfigManager)) {
+        return "";
     }
-    PQclear(result);
-    return true;
+    
+    size_t logLength = deltas.size();
+    for (const auto& encoded : deltas) {
+        GalaxyDelta delta;
+        if (!decodeGalaxyDelta(encoded, delta, errorOut, &systemConfigManager)) {
+            return "";
+        }
+        // A lost write leaves a gap: keep what replays cleanly and have the caller rebase
+        if (delta.baseRevision > galaxy.revision) {
+            std::cerr << "⚠️  Save delta log skips from revision " << galaxy.revision << " to "
+                      << delta.baseRevision << "; loading revision " << galaxy.revision << std::endl;
+            logLength = kCompactAfterDeltas;
+            break;
+        }
+        if (!galaxy.applyDelta(delta, errorOut)) {
+            errorOut = "Save delta does not apply: " + errorOut;
+            return "";
+        }
+    }
+    if (deltaCount) *deltaCount = logLength;
+    
+    std::string json = serializeGalaxy(galaxy);
+    if (restored) {
+        *restored = std::move(galaxy);
+    }
+    return json;
 }
 
-std::string BackendServer::handleLoadGame(const std::string& request) {
-    if (!db_connection) {
+HttpResponse BackendServer::handleLoadGame(const HttpRequest& request) {
+    std::string user;
+    if (!requestUser(request, user)) {
+        return createErrorResponse(400, "Invalid user");
+    }
+    DatabasePool::Lease db = database.acquire();
+    if (!db) {
         return createErrorResponse(500, "Database connection not available");
     }
     
     // Extract save ID from path
-    std::regex pathRegex(R"(/api/saves/([^/\s]+))");
-    std::smatch match;
-    
-    if (!std::regex_search(request, match, pathRegex)) {
+    std::string saveId = request.path.substr(std::strlen("/api/saves/"));
+    if (saveId.empty() || saveId.find('/') != std::string::npos) {
         return createErrorResponse(400, "Invalid save ID");
     }
     
-    std::string saveId = match[1].str();
-    
-    // For now, load save for the default "keith" user
     // In a real implementation, this would validate session/auth tokens
-    const char* query = "SELECT s.save_data FROM saves s JOIN users u ON s.user_id = u.id WHERE s.id = $1 AND u.username = 'keith'";
-    const char* paramValues[] = { saveId.c_str() };
-    int paramLengths[] = { static_cast<int>(saveId.length()) };
-    int paramFormats[] = { 0 }; // text format
-    
-    PGresult* result = PQexecParams(db_connection, query, 1, nullptr, paramValues, paramLengths, paramFormats, 0);
+    PGresult* result = db.execute(kLoadByIdStatement.name, {saveId, user}, {}, 1);
     
     if (PQresultStatus(result) != PGRES_TUPLES_OK) {
         std::string error = PQresultErrorMessage(result);
@@ -663,10 +1479,31 @@ std::string BackendServer::handleLoadGame(const std::string& request) {
         return createErrorResponse(404, "Save not found");
     }
     
-    std::string saveData = PQgetvalue(result, 0, 0);
+    auto saveData = std::make_shared<std::string>(PQgetvalue(result, 0, 0), PQgetlength(result, 0, 0));
+    std::vector<std::string> deltas;
+    for (int row = 1; row < PQntuples(result); row++) {
+        deltas.emplace_back(PQgetvalue(result, row, 0), PQgetlength(result, row, 0));
+    }
     PQclear(result);
     
-    return createJsonResponse(saveData);
+    // Snapshots are only expanded to JSON unless the client takes the binary
+    // form; a logged save is re-encoded with its deltas applied
+    bool wantsBinary = request.queryParam("format") == "binary";
+    if (wantsBinary && isGalaxySnapshot(*saveData) && deltas.empty()) {
+        return HttpResponse(responseHead(saveData->length(), "application/octet-stream"), saveData);
+    }
+    
+    std::string error;
+    Galaxy galaxy;
+    std::string json = savedStateToJson(*saveData, deltas, &galaxy, error);
+    if (!error.empty()) {
+        return createErrorResponse(500, "Failed to read save: " + error);
+    }
+    if (wantsBinary && isGalaxySnapshot(*saveData)) {
+        *saveData = encodeGalaxySnapshot(galaxy);
+        return HttpResponse(responseHead(saveData->length(), "application/octet-stream"), saveData);
+    }
+    return createJsonResponse(request, std::make_shared<const std::string>(std::move(json)));
 }
 
 bool BackendServer::connectToDatabase() {
@@ -677,32 +1514,34 @@ bool BackendServer::connectToDatabase() {
             << " user=" << db_user 
             << " password=" << db_password;
     
-    db_connection = PQconnectdb(connStr.str().c_str());
+    database.configure(connStr.str(), kDatabasePoolSize, {
+        kPingStatement, kGetUserStatement, kListSavesStatement, kListSaveSummariesStatement,
+        kLoadSlotStatement, kLoadByIdStatement
+    });
     
-    if (PQstatus(db_connection) != CONNECTION_OK) {
-        std::cerr << "❌ Database connection failed: " << PQerrorMessage(db_connection) << std::endl;
-        PQfinish(db_connection);
-        db_connection = nullptr;
+    // The writer reconnects on its own, so it runs even if the first connect fails
+    saveWriter.start(connStr.str(), kUpsertSnapshotStatement, kAppendDeltaStatement, kUpsertSaveStatement);
+    
+    if (!database.open()) {
         return false;
     }
     
-    std::cout << "✅ Connected to PostgreSQL database" << std::endl;
+    std::cout << "✅ Connected to PostgreSQL database (pool of up to " << kDatabasePoolSize << " connections)" << std::endl;
     return true;
 }
 
 void BackendServer::disconnectFromDatabase() {
-    if (db_connection) {
-        PQfinish(db_connection);
-        db_connection = nullptr;
-    }
+    saveWriter.stop();
+    database.close();
 }
 
 std::string BackendServer::testDatabaseConnection() {
-    if (!db_connection) {
+    DatabasePool::Lease db = database.acquire();
+    if (!db) {
         return "No database connection";
     }
     
-    PGresult* result = PQexec(db_connection, "SELECT NOW()");
+    PGresult* result = db.execute(kPingStatement.name, {});
     if (PQresultStatus(result) != PGRES_TUPLES_OK) {
         std::string error = PQresultErrorMessage(result);
         PQclear(result);
@@ -723,29 +1562,80 @@ void BackendServer::setDatabaseConfig(const std::string& host, const std::string
 }
 
 std::string BackendServer::createJsonResponse(const std::string& json) {
+    return responseHead(json.length()) + json;
+}
+
+HttpResponse BackendServer::createJsonResponse(std::shared_ptr<const std::string> json, const std::string& etag) {
+    std::string head = responseHead(json->length(), "application/json", etag);
+    return HttpResponse(std::move(head), std::move(json));
+}
+
+HttpResponse BackendServer::createJsonResponse(const HttpRequest& request, std::shared_ptr<const std::string> json,
+                                               const std::string& etag,
+                                               const std::shared_ptr<const GalaxyCache::Entry>& cached) {
+    ContentEncoding encoding = json->size() >= kMinCompressBytes
+        ? negotiateEncoding(request.header("Accept-Encoding")) : ContentEncoding::Identity;
+    if (!etag.empty() && etagMatches(request.header("If-None-Match"), etag)) {
+        return createNotModifiedResponse(encodedEtag(etag, encoding));
+    }
+    
+    std::shared_ptr<const std::string> encoded = cached ? galaxyCache.encodedJson(cached, encoding)
+                                                        : encodeBody(*json, encoding);
+    if (encoded) {
+        json = std::move(encoded);
+    } else {
+        encoding = ContentEncoding::Identity;
+    }
+    std::string head = responseHead(json->length(), "application/json", etag.empty() ? etag : encodedEtag(etag, encoding),
+                                    "200 OK", contentEncodingName(encoding));
+    return HttpResponse(std::move(head), std::move(json));
+}
+
+std::string BackendServer::createNotModifiedResponse(const std::string& etag) {
     std::ostringstream response;
-    response << "HTTP/1.1 200 OK\r\n";
-    response << "Content-Type: application/json\r\n";
+    response << "HTTP/1.1 304 Not Modified\r\n";
+    response << "ETag: " << etag << "\r\n";
+    response << "Access-Control-Allow-Origin: *\r\n";
+    response << "Access-Control-Expose-Headers: ETag\r\n";
+    response << "\r\n";
+    return response.str();
+}
+
+std::string BackendServer::responseHead(size_t contentLength, const char* contentType, const std::string& etag,
+                                        const char* status, const char* contentEncoding) {
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << "\r\n";
+    response << "Content-Type: " << contentType << "\r\n";
+    if (contentEncoding) {
+        if (std::strcmp(contentEncoding, "identity") != 0) {
+            response << "Content-Encoding: " << contentEncoding << "\r\n";
+        }
+        response << "Vary: Accept-Encoding\r\n";
+    }
+    if (!etag.empty()) {
+        response << "ETag: " << etag << "\r\n";
+        response << "Access-Control-Expose-Headers: ETag\r\n";
+    }
     response << "Access-Control-Allow-Origin: *\r\n";
     response << "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
-    response << "Access-Control-Allow-Headers: Content-Type, Authorization\r\n";
-    response << "Content-Length: " << json.length() << "\r\n";
+    response << "Access-Control-Allow-Headers: Content-Type, Authorization, X-Space4X-User\r\n";
+    response << "Content-Length: " << contentLength << "\r\n";
     response << "\r\n";
-    response << json;
     return response.str();
 }
 
 std::string BackendServer::createErrorResponse(int status, const std::string& message) {
-    std::ostringstream json;
-    json << "{\"error\":\"" << message << "\"}";
+    // Messages can carry database or parser text, so they are escaped
+    JsonWriter json(message.size() + 16);
+    json.beginObject().field("error", message).endObject();
     
     std::ostringstream response;
     response << "HTTP/1.1 " << status << " Error\r\n";
     response << "Content-Type: application/json\r\n";
     response << "Access-Control-Allow-Origin: *\r\n";
     response << "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
-    response << "Access-Control-Allow-Headers: Content-Type, Authorization\r\n";
-    response << "Content-Length: " << json.str().length() << "\r\n";
+    response << "Access-Control-Allow-Headers: Content-Type, Authorization, X-Space4X-User\r\n";
+    response << "Content-Length: " << json.size() << "\r\n";
     response << "\r\n";
     response << json.str();
     return response.str();
@@ -760,153 +1650,11 @@ std::string BackendServer::createCorsResponse() {
     response << "HTTP/1.1 200 OK\r\n";
     response << "Access-Control-Allow-Origin: *\r\n";
     response << "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
-    response << "Access-Control-Allow-Headers: Content-Type, Authorization\r\n";
+    response << "Access-Control-Allow-Headers: Content-Type, Authorization, X-Space4X-User, If-None-Match\r\n";
     response << "Access-Control-Max-Age: 86400\r\n";
     response << "Content-Length: 0\r\n";
     response << "\r\n";
     return response.str();
 }
 
-std::string BackendServer::extractPath(const std::string& request) {
-    std::istringstream stream(request);
-    std::string method, path, version;
-    stream >> method >> path >> version;
-    return path;
-}
-
-std::string BackendServer::extractMethod(const std::string& request) {
-    std::istringstream stream(request);
-    std::string method;
-    stream >> method;
-    return method;
-}
-
-std::string BackendServer::extractBody(const std::string& request) {
-    size_t bodyStart = request.find("\r\n\r\n");
-    if (bodyStart != std::string::npos) {
-        return request.substr(bodyStart + 4);
-    }
-    return "";
-}
-
-std::string BackendServer::serializeSystemDefinition(const SystemDefinition& systemDef) {
-    std::ostringstream json;
-    json << "{";
-    json << "\"systemId\":\"" << systemDef.systemId << "\",";
-    json << "\"systemName\":\"" << systemDef.systemName << "\",";
-    json << "\"starType\":\"" << systemDef.starType << "\",";
-    json << "\"starMass\":" << systemDef.starMass << ",";
-    json << "\"starRadius\":" << systemDef.starRadius << ",";
-    json << "\"starTemperature\":" << systemDef.starTemperature << ",";
-    
-    // Serialize planets
-    json << "\"planets\":[";
-    for (size_t i = 0; i < systemDef.planets.size(); i++) {
-        if (i > 0) json << ",";
-        const auto& planet = systemDef.planets[i];
-        
-        json << "{";
-        json << "\"id\":\"" << planet.id << "\",";
-        json << "\"name\":\"" << planet.name << "\",";
-        json << "\"type\":\"" << planet.type << "\",";
-        json << "\"distanceFromStar\":" << planet.distanceFromParent << ",";
-        json << "\"radius\":" << planet.radius << ",";
-        json << "\"diameter\":" << planet.diameter << ",";
-        json << "\"mass\":" << planet.mass << ",";
-        json << "\"gravity\":" << planet.gravity << ",";
-        json << "\"habitability\":" << planet.habitability << ",";
-        json << "\"atmosphere\":\"" << planet.atmosphere << "\",";
-        json << "\"composition\":\"" << planet.composition << "\",";
-        
-        // Serialize resources
-        json << "\"resources\":[";
-        for (size_t j = 0; j < planet.resources.size(); j++) {
-            if (j > 0) json << ",";
-            const auto& resource = planet.resources[j];
-            json << "{";
-            json << "\"type\":" << static_cast<int>(resource.type) << ",";
-            json << "\"abundance\":" << resource.abundance << ",";
-            json << "\"accessibility\":" << resource.accessibility;
-            json << "}";
-        }
-        json << "],";
-        
-        // Serialize moons
-        json << "\"moons\":[";
-        for (size_t j = 0; j < planet.moons.size(); j++) {
-            if (j > 0) json << ",";
-            const auto& moon = planet.moons[j];
-            
-            json << "{";
-            json << "\"id\":\"" << moon.id << "\",";
-            json << "\"name\":\"" << moon.name << "\",";
-            json << "\"type\":\"" << moon.type << "\",";
-            json << "\"distanceFromPlanet\":" << moon.distanceFromParent << ",";
-            json << "\"radius\":" << moon.radius << ",";
-            json << "\"diameter\":" << moon.diameter << ",";
-            json << "\"mass\":" << moon.mass << ",";
-            json << "\"gravity\":" << moon.gravity << ",";
-            json << "\"habitability\":" << moon.habitability << ",";
-            json << "\"atmosphere\":\"" << moon.atmosphere << "\",";
-            json << "\"composition\":\"" << moon.composition << "\",";
-            
-            // Moon resources
-            json << "\"resources\":[";
-            for (size_t k = 0; k < moon.resources.size(); k++) {
-                if (k > 0) json << ",";
-                const auto& resource = moon.resources[k];
-                json << "{";
-                json << "\"type\":" << static_cast<int>(resource.type) << ",";
-                json << "\"abundance\":" << resource.abundance << ",";
-                json << "\"accessibility\":" << resource.accessibility;
-                json << "}";
-            }
-            json << "]";
-            json << "}";
-        }
-        json << "]";
-        json << "}";
-    }
-    json << "],";
-    
-    // Serialize asteroids
-    json << "\"asteroids\":[";
-    for (size_t i = 0; i < systemDef.asteroids.size(); i++) {
-        if (i > 0) json << ",";
-        const auto& asteroid = systemDef.asteroids[i];
-        
-        json << "{";
-        json << "\"id\":\"" << asteroid.id << "\",";
-        json << "\"name\":\"" << asteroid.name << "\",";
-        json << "\"type\":\"" << asteroid.type << "\",";
-        json << "\"distanceFromStar\":" << asteroid.distanceFromParent << ",";
-        json << "\"radius\":" << asteroid.radius << ",";
-        json << "\"diameter\":" << asteroid.diameter << ",";
-        json << "\"mass\":" << asteroid.mass << ",";
-        json << "\"gravity\":" << asteroid.gravity << ",";
-        json << "\"habitability\":" << asteroid.habitability << ",";
-        json << "\"atmosphere\":\"" << asteroid.atmosphere << "\",";
-        json << "\"composition\":\"" << asteroid.composition << "\",";
-        
-        // Asteroid resources
-        json << "\"resources\":[";
-        for (size_t j = 0; j < asteroid.resources.size(); j++) {
-            if (j > 0) json << ",";
-            const auto& resource = asteroid.resources[j];
-            json << "{";
-            json << "\"type\":" << static_cast<int>(resource.type) << ",";
-            json << "\"abundance\":" << resource.abundance << ",";
-            json << "\"accessibility\":" << resource.accessibility;
-            json << "}";
-        }
-        json << "]";
-        json << "}";
-    }
-    json << "]";
-    
-    json << "}";
-    
-    return createJsonResponse(json.str());
-}
-
 } // namespace space4x
@@ -0,0 +1,452 @@
+#include "batch_runner.h"
+#include "galaxy.h"
+#include "galaxy_request.h"
+#include "galaxy_snapshot.h"
+#include "galaxy_json.h"
+#include "thread_pool.h"
+#include "logging.h"
+#include <libpq-fe.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <climits>
+#include <cerrno>
+#include <sys/stat.h>
+
+namespace space4x {
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// saves.save_slot is CHECKed to this range
+const int kMinSaveSlot = 1;
+const int kMaxSaveSlot = 10;
+
+// One galaxy to bake
+struct BatchJob {
+    GalaxyConfig config;
+    int slot;
+    std::string name;    // File name without extension
+    std::string source;  // Where it came from, for messages
+};
+
+bool parseInt(const std::string& text, int& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (*end != '\0' || errno == ERANGE || parsed < INT_MIN || parsed > INT_MAX) return false;
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+// "A-B" or "A"; a leading '-' belongs to A
+bool parseSeedRange(const std::string& text, BatchOptions::SeedRange& range) {
+    size_t dash = text.find('-', 1);
+    if (dash == std::string::npos) {
+        if (!parseInt(text, range.first)) return false;
+        range.last = range.first;
+        return true;
+    }
+    return parseInt(text.substr(0, dash), range.first) && parseInt(text.substr(dash + 1), range.last) &&
+           range.first <= range.last;
+}
+
+bool readFile(const std::string& path, std::string& contents) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+bool blankLine(const std::string& line) {
+    return line.find_first_not_of(" \t\r") == std::string::npos;
+}
+
+// A config file holds one request, or one request per non-blank line
+bool loadConfigFile(const std::string& path, const GalaxyRequest& defaults,
+                    std::vector<std::pair<GalaxyRequest, std::string>>& requests, std::string& error) {
+    std::string contents;
+    if (!readFile(path, contents)) {
+        error = "Cannot read " + path;
+        return false;
+    }
+    GalaxyRequest whole = defaults;
+    std::string wholeError;
+    if (decodeGalaxyRequest(contents, whole, wholeError)) {
+        requests.emplace_back(whole, path);
+        return true;
+    }
+
+    std::istringstream lines(contents);
+    std::string line;
+    for (int number = 1; std::getline(lines, line); number++) {
+        if (blankLine(line)) continue;
+        GalaxyRequest request = defaults;
+        if (!decodeGalaxyRequest(line, request, error)) {
+            error = path + ":" + std::to_string(number) + ": " + error;
+            return false;
+        }
+        requests.emplace_back(request, path + ":" + std::to_string(number));
+    }
+    return true;
+}
+
+// Expands seed ranges and config files into jobs, naming each after its seed
+bool planJobs(const BatchOptions& options, std::vector<BatchJob>& jobs, std::string& error) {
+    GalaxyRequest base = defaultGalaxyRequest();
+    if (!options.templateFile.empty()) {
+        std::string contents;
+        if (!readFile(options.templateFile, contents)) {
+            error = "Cannot read " + options.templateFile;
+            return false;
+        }
+        if (!decodeGalaxyRequest(contents, base, error)) {
+            error = options.templateFile + ": " + error;
+            return false;
+        }
+    }
+
+    int slot = options.firstSlot;
+    for (const BatchOptions::SeedRange& range : options.seedRanges) {
+        for (long long seed = range.first; seed <= range.last; seed++) {
+            BatchJob job{base.config, slot++, "", "seed " + std::to_string(seed)};
+            job.config.seed = static_cast<int>(seed);
+            jobs.push_back(std::move(job));
+        }
+    }
+    for (const std::string& path : options.configFiles) {
+        std::vector<std::pair<GalaxyRequest, std::string>> requests;
+        if (!loadConfigFile(path, defaultGalaxyRequest(), requests, error)) return false;
+        for (const auto& request : requests) {
+            jobs.push_back({request.first.config, request.first.saveSlot, "", request.second});
+        }
+    }
+    if (jobs.empty()) {
+        error = "Nothing to generate";
+        return false;
+    }
+
+    // Repeated seeds (different configs) get a numeric suffix so no file is overwritten
+    std::map<int, int> seen;
+    std::set<std::pair<std::string, int>> slots;
+    for (BatchJob& job : jobs) {
+        int& count = seen[job.config.seed];
+        job.name = "galaxy-" + std::to_string(job.config.seed);
+        if (count++ > 0) job.name += "-" + std::to_string(count);
+
+        if (!options.toDatabase) continue;
+        if (job.slot < kMinSaveSlot || job.slot > kMaxSaveSlot) {
+            error = job.source + ": save slot " + std::to_string(job.slot) + " is outside " +
+                    std::to_string(kMinSaveSlot) + ".." + std::to_string(kMaxSaveSlot);
+            return false;
+        }
+        if (!slots.insert({options.user, job.slot}).second) {
+            error = job.source + ": save slot " + std::to_string(job.slot) + " is used twice";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Text-format COPY field: backslash escapes for the characters COPY treats specially
+void appendCopyField(std::string& row, const std::string& value) {
+    for (char c : value) {
+        switch (c) {
+            case '\\': row += "\\\\"; break;
+            case '\n': row += "\\n"; break;
+            case '\r': row += "\\r"; break;
+            case '\t': row += "\\t"; break;
+            default: row += c;
+        }
+    }
+}
+
+// bytea in hex input form, with the backslash escaped for COPY
+void appendCopyBytea(std::string& row, const std::string& bytes) {
+    static const char digits[] = "0123456789abcdef";
+    row.reserve(row.size() + 3 + bytes.size() * 2);
+    row += "\\\\x";
+    for (unsigned char byte : bytes) {
+        row += digits[byte >> 4];
+        row += digits[byte & 0xf];
+    }
+}
+
+bool execute(PGconn* connection, const char* sql, ExecStatusType expected, std::string& error) {
+    PGresult* result = PQexec(connection, sql);
+    bool ok = PQresultStatus(result) == expected;
+    if (!ok) error = PQresultErrorMessage(result);
+    PQclear(result);
+    return ok;
+}
+
+// Streams rows into a temporary staging table with COPY, then moves them into
+// saves in one statement when finished. Rows may come from any thread.
+class SaveCopier {
+public:
+    ~SaveCopier() {
+        if (connection) PQfinish(connection);
+    }
+
+    bool begin(const std::string& connectionInfo, std::string& error) {
+        connection = PQconnectdb(connectionInfo.c_str());
+        if (PQstatus(connection) != CONNECTION_OK) {
+            error = PQerrorMessage(connection);
+            return false;
+        }
+        return execute(connection, "BEGIN", PGRES_COMMAND_OK, error) &&
+               execute(connection,
+                       "CREATE TEMP TABLE batch_saves (username TEXT, save_slot INT, save_data JSONB, snapshot BYTEA)"
+                       " ON COMMIT DROP", PGRES_COMMAND_OK, error) &&
+               execute(connection, "COPY batch_saves FROM STDIN", PGRES_COPY_IN, error);
+    }
+
+    // JSON saves go in save_data; snapshots leave only a descriptor there, as the service does
+    bool add(const std::string& user, int slot, const std::string& data, bool json) {
+        std::string row;
+        appendCopyField(row, user);
+        row += '\t' + std::to_string(slot) + '\t';
+        if (json) {
+            appendCopyField(row, data);
+            row += "\t\\N\n";
+        } else {
+            row += "{\"format\": \"snapshot\", \"bytes\": " + std::to_string(data.size()) + "}\t";
+            appendCopyBytea(row, data);
+            row += '\n';
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (failed) return false;
+        if (PQputCopyData(connection, row.data(), static_cast<int>(row.size())) != 1) {
+            failed = true;
+            copyError = PQerrorMessage(connection);
+        }
+        return !failed;
+    }
+
+    // Ends the COPY and upserts the staged rows (clearing their slots' delta logs)
+    // for users that exist; written is how many landed
+    bool commit(size_t& written, std::string& error) {
+        if (failed) {
+            error = copyError;
+            return false;
+        }
+        if (PQputCopyEnd(connection, nullptr) != 1) {
+            error = PQerrorMessage(connection);
+            return false;
+        }
+        PGresult* result = PQgetResult(connection);
+        bool copied = PQresultStatus(result) == PGRES_COMMAND_OK;
+        if (!copied) error = PQresultErrorMessage(result);
+        PQclear(result);
+        while ((result = PQgetResult(connection)) != nullptr) PQclear(result);
+        if (!copied) return false;
+
+        result = PQexec(connection,
+            "WITH ins AS (\n"
+            "  INSERT INTO saves (user_id, save_slot, save_data, snapshot, version)\n"
+            "  SELECT u.id, b.save_slot, b.save_data, b.snapshot, CASE WHEN b.snapshot IS NULL THEN 1 ELSE 2 END\n"
+            "  FROM batch_saves b JOIN users u ON u.username = b.username\n"
+            "  ON CONFLICT (user_id, save_slot) DO UPDATE SET save_data = EXCLUDED.save_data,\n"
+            "    snapshot = EXCLUDED.snapshot, version = EXCLUDED.version, delta_count = 0, updated_at = NOW()\n"
+            "  RETURNING id\n"
+            "),\n"
+            "cleared AS (DELETE FROM save_deltas d USING ins WHERE d.save_id = ins.id)\n"
+            "SELECT COUNT(*) FROM ins");
+        bool upserted = PQresultStatus(result) == PGRES_TUPLES_OK;
+        if (upserted) {
+            written = std::strtoul(PQgetvalue(result, 0, 0), nullptr, 10);
+        } else {
+            error = PQresultErrorMessage(result);
+        }
+        PQclear(result);
+        return upserted && execute(connection, "COMMIT", PGRES_COMMAND_OK, error);
+    }
+
+private:
+    PGconn* connection = nullptr;
+    std::mutex mutex;
+    bool failed = false;
+    std::string copyError;
+};
+
+bool writeFile(const std::string& path, const std::string& data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+}
+
+} // namespace
+
+// ============================================================================
+// OPTIONS
+// ============================================================================
+
+bool parseBatchOptions(int argc, char* argv[], BatchOptions& options, std::string& error) {
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--db") {
+            options.toDatabase = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            error = "Missing value for " + option;
+            return false;
+        }
+        std::string value = argv[++i];
+        int number = 0;
+        if (option == "--mode" || option == "--log-level") {
+            // Handled by main()
+        } else if (option == "--seeds") {
+            BatchOptions::SeedRange range;
+            if (!parseSeedRange(value, range)) {
+                error = "Bad seed range " + value + " (expected A-B or A)";
+                return false;
+            }
+            options.seedRanges.push_back(range);
+        } else if (option == "--template") {
+            options.templateFile = value;
+        } else if (option == "--config") {
+            options.configFiles.push_back(value);
+        } else if (option == "--format") {
+            if (value != "snapshot" && value != "json") {
+                error = "Unknown format " + value + " (expected snapshot or json)";
+                return false;
+            }
+            options.json = value == "json";
+        } else if (option == "--out") {
+            options.outDir = value;
+        } else if (option == "--user") {
+            options.user = value;
+        } else if (option == "--slot") {
+            if (!parseInt(value, options.firstSlot)) {
+                error = "Bad slot " + value;
+                return false;
+            }
+        } else if (option == "--threads") {
+            if (!parseInt(value, number) || number < 1) {
+                error = "Bad thread count " + value;
+                return false;
+            }
+            options.threads = static_cast<size_t>(number);
+        } else if (option == "--db-conninfo") {
+            options.connectionInfo = value;
+        } else {
+            error = "Unknown option " + option;
+            return false;
+        }
+    }
+    if (options.seedRanges.empty() && options.configFiles.empty()) {
+        error = "Give --seeds and/or --config";
+        return false;
+    }
+    if (options.outDir.empty() && !options.toDatabase) {
+        error = "Give --out and/or --db";
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// BATCH GENERATION
+// ============================================================================
+
+int runBatch(const BatchOptions& options) {
+    std::vector<BatchJob> jobs;
+    std::string error;
+    if (!planJobs(options, jobs, error)) {
+        std::cerr << "❌ " << error << std::endl;
+        return 1;
+    }
+    if (!options.outDir.empty() && mkdir(options.outDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "❌ Cannot create " << options.outDir << std::endl;
+        return 1;
+    }
+    SaveCopier copier;
+    if (options.toDatabase && !copier.begin(options.connectionInfo, error)) {
+        std::cerr << "❌ Database: " << error << std::endl;
+        return 1;
+    }
+
+    // One galaxy per worker; a config asking for the parallel pipeline still gets it
+    size_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, jobs.size());
+    std::cout << "🏭 Baking " << jobs.size() << " galaxies on " << threads << " threads" << std::endl;
+
+    const char* extension = options.json ? ".json" : ".s4x";
+    std::atomic<size_t> done{0};
+    std::atomic<size_t> failures{0};
+    std::atomic<size_t> bytes{0};
+    Clock::time_point started = Clock::now();
+    {
+        ThreadPool pool(threads);
+        for (const BatchJob& job : jobs) {
+            pool.submit([&, extension]() {
+                try {
+                    Clock::time_point jobStarted = Clock::now();
+                    GalaxyGenerator generator(job.config);
+                    Galaxy galaxy = generator.generateGalaxy();
+                    std::string data = options.json ? serializeGalaxy(galaxy)
+                                                    : encodeGalaxySnapshot(galaxy);
+                    bool ok = true;
+                    if (!options.outDir.empty() && !writeFile(options.outDir + "/" + job.name + extension, data)) {
+                        std::cerr << "❌ " << job.source << ": cannot write " << job.name << extension << std::endl;
+                        ok = false;
+                    }
+                    if (options.toDatabase && !copier.add(options.user, job.slot, data, options.json)) ok = false;
+                    if (!ok) {
+                        failures++;
+                        return;
+                    }
+                    bytes += data.size();
+                    size_t finished = ++done;
+                    if (logEnabled(LogLevel::Info)) {
+                        double ms = std::chrono::duration<double, std::milli>(Clock::now() - jobStarted).count();
+                        std::ostringstream line;
+                        line << "✅ [" << finished << "/" << jobs.size() << "] " << job.name << ": "
+                             << galaxy.systems.size() << " systems, " << data.size() << " bytes, "
+                             << static_cast<int>(ms) << " ms";
+                        std::cout << line.str() << std::endl;
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "❌ " << job.source << ": " << e.what() << std::endl;
+                    failures++;
+                }
+            });
+        }
+    }  // Joins the pool
+
+    double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+    std::cout << "📦 Baked " << done.load() << " galaxies (" << bytes.load() << " bytes) in " << seconds << " s"
+              << std::endl;
+
+    if (options.toDatabase) {
+        size_t written = 0;
+        if (failures > 0) {
+            // Nothing is committed unless every galaxy made it
+            std::cerr << "❌ Database: rolled back after " << failures.load() << " failures" << std::endl;
+        } else if (!copier.commit(written, error)) {
+            std::cerr << "❌ Database: " << error << std::endl;
+            return 1;
+        } else if (written < jobs.size()) {
+            std::cerr << "❌ Database: user " << options.user << " not found; nothing saved" << std::endl;
+            return 1;
+        } else {
+            std::cout << "💾 Saved " << written << " galaxies for " << options.user << std::endl;
+        }
+    }
+    return failures > 0 ? 1 : 0;
+}
+
+} // namespace space4x
@@ -1,4 +1,5 @@
 #include "celestial_bodies.h"
+#include "logging.h"
 #include <random>
 #include <cmath>
 #include <iostream>
@@ -9,10 +10,67 @@ using json = nlohmann::json;
 
 namespace space4x {
 
+namespace {
+
+// Fixed tables for procedural generation; indexing these never allocates
+constexpr const char* kPlanetAtmospheres[] = {
+    "Thin carbon dioxide", "Dense nitrogen-oxygen", "Methane and hydrogen",
+    "Thick carbon dioxide", "Hydrogen and helium", "None"
+};
+
+constexpr const char* kPlanetCompositions[] = {
+    "Silicate rock with iron core", "Gas giant", "Ice and rock",
+    "Mostly iron", "Carbon and silicate"
+};
+
+// Deposits most bodies carry regardless of type
+constexpr ResourceType kCommonResources[] = {ResourceType::MINERALS, ResourceType::RARE_METALS};
+
+// Most deposits a generated body can carry: the common ones plus water and crystals
+constexpr size_t kMaxGeneratedDeposits = sizeof(kCommonResources) / sizeof(kCommonResources[0]) + 2;
+
+template <typename T, size_t N>
+constexpr int lastIndex(const T (&)[N]) { return static_cast<int>(N) - 1; }
+
+// SplitMix64 as a standard random bit generator: 8 bytes of state, so every
+// body gets its own resource stream without disturbing the system's mt19937
+class SplitMix64 {
+public:
+    typedef uint64_t result_type;
+
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    result_type operator()() { return mix(state += 0x9E3779B97F4A7C15ULL); }
+
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    uint64_t state;
+};
+
+// Seed for child n of a body (planet n of a system, moon n of a planet)
+uint64_t childSeed(uint64_t parent, int n) {
+    return SplitMix64::mix(parent + static_cast<uint64_t>(n + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+} // namespace
+
 SystemConfigManager::SystemConfigManager() {
     loadPredefinedSystems();
 }
 
+const SystemConfigManager& SystemConfigManager::catalog() {
+    static const SystemConfigManager shared;
+    return shared;
+}
+
 void SystemConfigManager::loadPredefinedSystems() {
     // Try multiple possible paths for the JSON file
     std::vector<std::string> possiblePaths = {
@@ -24,17 +82,19 @@ void SystemConfigManager::loadPredefinedSystems() {
     
     for (const std::string& path : possiblePaths) {
         if (loadSystemsFromJson(path)) {
-            std::cout << "✅ Loaded " << predefinedSystems.size() << " predefined star systems from JSON (" << path << ")" << std::endl;
+            if (logEnabled(LogLevel::Info)) {
+                std::cout << "✅ Loaded " << predefinedSystems.size() << " predefined star systems from JSON (" << path << ")\n";
+            }
             return;
         }
     }
     
     // No fallback - JSON configuration is required
-    std::cout << "❌ Could not load systems.json from any of these paths:" << std::endl;
+    std::cerr << "❌ Could not load systems.json from any of these paths:" << std::endl;
     for (const std::string& path : possiblePaths) {
-        std::cout << "   - " << path << std::endl;
+        std::cerr << "   - " << path << std::endl;
     }
-    std::cout << "   Make sure config/systems.json exists and is valid" << std::endl;
+    std::cerr << "   Make sure config/systems.json exists and is valid" << std::endl;
 }
 
 const SystemDefinition* SystemConfigManager::getSystemDefinition(const std::string& systemId) const {
@@ -54,28 +114,38 @@ bool SystemConfigManager::isSystemPredefined(const std::string& systemId) const
 
 
 bool SystemConfigManager::loadSystemsFromJson(const std::string& filename) {
-    std::cout << "🔍 Trying to load: " << filename << std::endl;
+    if (logEnabled(LogLevel::Debug)) {
+        std::cout << "🔍 Trying to load: " << filename << '\n';
+    }
     std::ifstream file(filename);
     if (!file.is_open()) {
-        std::cout << "   ❌ File not found or cannot open: " << filename << std::endl;
+        if (logEnabled(LogLevel::Debug)) {
+            std::cout << "   ❌ File not found or cannot open: " << filename << '\n';
+        }
         return false;
     }
-    std::cout << "   ✅ File opened successfully: " << filename << std::endl;
+    if (logEnabled(LogLevel::Debug)) {
+        std::cout << "   ✅ File opened successfully: " << filename << '\n';
+    }
     
     try {
         json jsonData;
         file >> jsonData;
         file.close();
         
-        std::cout << "   📄 JSON parsed successfully" << std::endl;
+        if (logEnabled(LogLevel::Debug)) {
+            std::cout << "   📄 JSON parsed successfully\n";
+        }
         
         if (!jsonData.contains("systems") || !jsonData["systems"].is_array()) {
-            std::cout << "   ❌ No 'systems' array found in JSON" << std::endl;
+            std::cerr << "   ❌ No 'systems' array found in " << filename << std::endl;
             return false;
         }
         
         auto systemsArray = jsonData["systems"];
-        std::cout << "   📊 Found " << systemsArray.size() << " systems in JSON" << std::endl;
+        if (logEnabled(LogLevel::Debug)) {
+            std::cout << "   📊 Found " << systemsArray.size() << " systems in JSON\n";
+        }
         
         for (const auto& systemJson : systemsArray) {
             SystemDefinition system;
@@ -185,17 +255,19 @@ bool SystemConfigManager::loadSystemsFromJson(const std::string& filename) {
             predefinedSystems[system.systemId] = system;
         }
         
-        std::cout << "   📊 Total systems stored: " << predefinedSystems.size() << std::endl;
+        if (logEnabled(LogLevel::Debug)) {
+            std::cout << "   📊 Total systems stored: " << predefinedSystems.size() << '\n';
+        }
         return !predefinedSystems.empty();
         
     } catch (const json::exception& e) {
-        std::cout << "   ❌ JSON parsing error: " << e.what() << std::endl;
+        std::cerr << "   ❌ JSON parsing error in " << filename << ": " << e.what() << std::endl;
         return false;
     }
 }
 
 
-SystemDefinition SystemConfigManager::generateRandomSystem(const std::string& systemId, const std::string& systemName) {
+SystemDefinition SystemConfigManager::generateRandomSystem(const std::string& systemId, const std::string& systemName) const {
     SystemDefinition system;
     system.systemId = systemId;
     system.systemName = systemName;
@@ -206,13 +278,12 @@ SystemDefinition SystemConfigManager::generateRandomSystem(const std::string& sy
     std::mt19937 gen(seed);
     
     // Random star properties
-    std::vector<std::string> starTypes = {"G-class", "K-class", "M-class", "F-class", "A-class"};
-    std::uniform_int_distribution<> starTypeDist(0, starTypes.size() - 1);
+    std::uniform_int_distribution<> starTypeDist(0, lastIndex(kStarTypes));
     std::uniform_real_distribution<> massDist(0.5, 2.0);
     std::uniform_real_distribution<> radiusDist(0.7, 1.8);
     std::uniform_int_distribution<> tempDist(3000, 7000);
     
-    system.starType = starTypes[starTypeDist(gen)];
+    system.starType = kStarTypes[starTypeDist(gen)];
     system.starMass = massDist(gen);
     system.starRadius = radiusDist(gen);
     system.starTemperature = tempDist(gen);
@@ -220,21 +291,22 @@ SystemDefinition SystemConfigManager::generateRandomSystem(const std::string& sy
     // Generate 4-10 planets
     std::uniform_int_distribution<> planetCountDist(4, 10);
     int planetCount = planetCountDist(gen);
+    system.planets.reserve(planetCount);
     
     double currentDistance = 0.3; // Start close to star
+    std::uniform_real_distribution<> distanceIncrease(1.3, 2.2);
     for (int i = 0; i < planetCount; i++) {
-        Planet planet = generateRandomPlanet(i, currentDistance, gen);
-        system.planets.push_back(planet);
+        system.planets.push_back(generateRandomPlanet(i, currentDistance, gen, childSeed(seed, i)));
         
         // Increase distance for next planet
-        std::uniform_real_distribution<> distanceIncrease(1.3, 2.2);
         currentDistance *= distanceIncrease(gen);
     }
     
     return system;
 }
 
-Planet SystemConfigManager::generateRandomPlanet(int planetIndex, double distanceFromStar, std::mt19937& gen) {
+Planet SystemConfigManager::generateRandomPlanet(int planetIndex, double distanceFromStar, std::mt19937& gen,
+                                                 uint64_t bodySeed) const {
     Planet planet;
     planet.id = "planet-" + std::to_string(planetIndex + 1);
     planet.name = "Planet " + std::to_string(planetIndex + 1);
@@ -327,40 +399,32 @@ Planet SystemConfigManager::generateRandomPlanet(int planetIndex, double distanc
     }
     
     // Random atmosphere and composition
-    std::vector<std::string> atmospheres = {
-        "Thin carbon dioxide", "Dense nitrogen-oxygen", "Methane and hydrogen",
-        "Thick carbon dioxide", "Hydrogen and helium", "None"
-    };
-    std::vector<std::string> compositions = {
-        "Silicate rock with iron core", "Gas giant", "Ice and rock",
-        "Mostly iron", "Carbon and silicate"
-    };
-    
-    std::uniform_int_distribution<> atmoDist(0, atmospheres.size() - 1);
-    std::uniform_int_distribution<> compDist(0, compositions.size() - 1);
+    std::uniform_int_distribution<> atmoDist(0, lastIndex(kPlanetAtmospheres));
+    std::uniform_int_distribution<> compDist(0, lastIndex(kPlanetCompositions));
     
-    planet.atmosphere = atmospheres[atmoDist(gen)];
-    planet.composition = compositions[compDist(gen)];
+    planet.atmosphere = kPlanetAtmospheres[atmoDist(gen)];
+    planet.composition = kPlanetCompositions[compDist(gen)];
     
     // Generate resources
-    planet.resources = generateRandomResources("planet", planet.habitability);
+    generateRandomResources(true, planet.habitability, bodySeed, planet.resources);
     
     // 10% chance for at least one moon
     std::uniform_real_distribution<> moonChance(0.0, 1.0);
     if (moonChance(gen) <= 0.1) {
         std::uniform_int_distribution<> moonCountDist(1, 3);
         int moonCount = moonCountDist(gen);
+        planet.moons.reserve(moonCount);
         
         for (int i = 0; i < moonCount; i++) {
-            Moon moon = generateRandomMoon(i, planet, gen);
-            planet.moons.push_back(moon);
+            planet.moons.push_back(generateRandomMoon(i, planet, gen, childSeed(bodySeed, i)));
         }
     }
     
     return planet;
 }
 
-Moon SystemConfigManager::generateRandomMoon(int moonIndex, const Planet& parentPlanet, std::mt19937& gen) {
+Moon SystemConfigManager::generateRandomMoon(int moonIndex, const Planet& parentPlanet, std::mt19937& gen,
+                                             uint64_t bodySeed) const {
     Moon moon;
     moon.id = parentPlanet.id + "-moon-" + std::to_string(moonIndex + 1);
     moon.name = parentPlanet.name + " Moon " + std::to_string(moonIndex + 1);
@@ -386,20 +450,19 @@ Moon SystemConfigManager::generateRandomMoon(int moonIndex, const Planet& parent
     moon.composition = "Silicate rock and ice";
     
     // Generate resources
-    moon.resources = generateRandomResources("moon", moon.habitability);
+    generateRandomResources(false, moon.habitability, bodySeed, moon.resources);
     
     return moon;
 }
 
-std::vector<ResourceDeposit> SystemConfigManager::generateRandomResources(const std::string& bodyType, int habitability) {
-    std::vector<ResourceDeposit> resources;
-    std::random_device rd;
-    std::mt19937 gen(rd());
+void SystemConfigManager::generateRandomResources(bool isPlanet, int habitability, uint64_t bodySeed,
+                                                   std::vector<ResourceDeposit>& resources) const {
+    SplitMix64 gen(bodySeed);
+    resources.clear();
+    resources.reserve(kMaxGeneratedDeposits);
     
     // Base resource types that most bodies have
-    std::vector<ResourceType> commonResources = {ResourceType::MINERALS, ResourceType::RARE_METALS};
-    
-    for (ResourceType resType : commonResources) {
+    for (ResourceType resType : kCommonResources) {
         std::uniform_int_distribution<> abundanceDist(20, 80);
         std::uniform_int_distribution<> accessDist(30, 90);
         
@@ -421,15 +484,16 @@ std::vector<ResourceDeposit> SystemConfigManager::generateRandomResources(const
         resources.push_back(water);
     }
     
-    if (bodyType == "planet" && chance(gen) < 0.3) {
+    if (isPlanet && chance(gen) < 0.3) {
+        std::uniform_int_distribution<> abundanceDist(15, 44);
+        std::uniform_int_distribution<> accessDist(20, 59);
+        
         ResourceDeposit energy;
         energy.type = ResourceType::ENERGY_CRYSTALS;
-        energy.abundance = 15 + (rand() % 30);
-        energy.accessibility = 20 + (rand() % 40);
+        energy.abundance = abundanceDist(gen);
+        energy.accessibility = accessDist(gen);
         resources.push_back(energy);
     }
-    
-    return resources;
 }
 
 } // namespace space4x
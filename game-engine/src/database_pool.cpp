@@ -0,0 +1,455 @@
+#include "database_pool.h"
+#include "logging.h"
+#include <iostream>
+#include <algorithm>
+#include <poll.h>
+
+namespace space4x {
+
+namespace {
+
+// Pause between connection attempts while the database is unreachable
+const std::chrono::milliseconds kReconnectBackoff(1000);
+
+// Save writes retry after kReconnectBackoff, doubling up to this
+const std::chrono::milliseconds kMaxWriteBackoff(30000);
+
+// Tries before a write the database itself rejects is given up on
+const unsigned kMaxWriteAttempts = 5;
+
+bool prepareStatements(PGconn* connection, const std::vector<PreparedStatement>& statements) {
+    for (const auto& statement : statements) {
+        PGresult* result = PQprepare(connection, statement.name.c_str(), statement.sql.c_str(),
+                                     statement.paramCount, nullptr);
+        bool ok = PQresultStatus(result) == PGRES_COMMAND_OK;
+        if (!ok) {
+            std::cerr << "❌ Failed to prepare " << statement.name << ": " << PQresultErrorMessage(result) << std::endl;
+        }
+        PQclear(result);
+        if (!ok) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+// ============================================================================
+// CONNECTION POOL
+// ============================================================================
+
+DatabasePool::Lease::Lease(Lease&& other) noexcept : pool(other.pool), connection(other.connection) {
+    other.pool = nullptr;
+    other.connection = nullptr;
+}
+
+DatabasePool::Lease& DatabasePool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        connection = other.connection;
+        other.pool = nullptr;
+        other.connection = nullptr;
+    }
+    return *this;
+}
+
+void DatabasePool::Lease::release() {
+    if (pool && connection) {
+        pool->giveBack(connection);
+    }
+    pool = nullptr;
+    connection = nullptr;
+}
+
+StatementMetrics StatementMetrics::forStatement(const std::string& name) {
+    MetricsRegistry& metrics = MetricsRegistry::global();
+    std::string label = metricLabel("statement", name);
+    return {metrics.histogram("space4x_db_query_seconds", "Database statement latency", label),
+            metrics.counter("space4x_db_query_errors_total", "Database statements that failed", label)};
+}
+
+void StatementMetrics::record(double seconds, bool failed) const {
+    MetricsRegistry& metrics = MetricsRegistry::global();
+    metrics.observe(latency, seconds);
+    if (failed) metrics.add(errors);
+}
+
+PGresult* DatabasePool::Lease::execute(const std::string& statement, const std::vector<std::string>& params,
+                                       const std::vector<int>& paramFormats, int resultFormat) {
+    std::vector<const char*> values;
+    std::vector<int> lengths;
+    values.reserve(params.size());
+    lengths.reserve(params.size());
+    for (const auto& param : params) {
+        values.push_back(param.c_str());
+        lengths.push_back(static_cast<int>(param.length()));
+    }
+    StatementMetrics metrics = pool->metricsFor(statement);
+    auto start = std::chrono::steady_clock::now();
+    PGresult* result = PQexecPrepared(connection, statement.c_str(), static_cast<int>(params.size()),
+                                      values.data(), lengths.data(), paramFormats.empty() ? nullptr : paramFormats.data(),
+                                      resultFormat);
+    ExecStatusType status = result ? PQresultStatus(result) : PGRES_FATAL_ERROR;
+    metrics.record(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+                   status == PGRES_FATAL_ERROR || status == PGRES_BAD_RESPONSE);
+    return result;
+}
+
+void DatabasePool::configure(const std::string& info, size_t maxCount,
+                             const std::vector<PreparedStatement>& preparedStatements) {
+    std::lock_guard<std::mutex> lock(mutex);
+    connectionInfo = info;
+    maxConnections = std::max<size_t>(1, maxCount);
+    statements = preparedStatements;
+    statementMetrics.clear();
+    for (const auto& statement : statements) {
+        statementMetrics[statement.name] = StatementMetrics::forStatement(statement.name);
+    }
+    closed = false;
+}
+
+StatementMetrics DatabasePool::metricsFor(const std::string& statement) const {
+    auto it = statementMetrics.find(statement);
+    return it != statementMetrics.end() ? it->second : StatementMetrics::forStatement(statement);
+}
+
+bool DatabasePool::open() {
+    PGconn* connection = connect();
+    if (!connection) return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    openConnections++;
+    idle.push_back(connection);
+    return true;
+}
+
+void DatabasePool::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    for (PGconn* connection : idle) {
+        PQfinish(connection);
+    }
+    openConnections -= idle.size();
+    idle.clear();
+}
+
+DatabasePool::Lease DatabasePool::acquire(std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;) {
+        if (closed) return Lease();
+
+        if (!idle.empty()) {
+            PGconn* connection = idle.back();
+            idle.pop_back();
+            return Lease(this, connection);
+        }
+
+        // Don't hammer an unreachable server from every request thread
+        bool backingOff = std::chrono::steady_clock::now() < nextConnectAttempt;
+        if (backingOff && openConnections == 0) return Lease();
+
+        if (openConnections < maxConnections && !backingOff) {
+            openConnections++;
+            lock.unlock();
+            PGconn* connection = connect();
+            lock.lock();
+            if (connection) return Lease(this, connection);
+
+            openConnections--;
+            nextConnectAttempt = std::chrono::steady_clock::now() + kReconnectBackoff;
+            returned.notify_one();
+            return Lease();
+        }
+
+        if (returned.wait_until(lock, deadline) == std::cv_status::timeout && idle.empty()) {
+            return Lease();
+        }
+    }
+}
+
+PGconn* DatabasePool::connect() {
+    std::vector<PreparedStatement> toPrepare;
+    std::string info;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        info = connectionInfo;
+        toPrepare = statements;
+    }
+
+    PGconn* connection = PQconnectdb(info.c_str());
+    if (PQstatus(connection) != CONNECTION_OK) {
+        std::cerr << "❌ Database connection failed: " << PQerrorMessage(connection) << std::endl;
+        PQfinish(connection);
+        return nullptr;
+    }
+
+    if (!prepareStatements(connection, toPrepare)) {
+        PQfinish(connection);
+        return nullptr;
+    }
+    return connection;
+}
+
+void DatabasePool::giveBack(PGconn* connection) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Broken or shut-down connections are dropped; the next acquire opens a fresh one
+    if (closed || PQstatus(connection) != CONNECTION_OK) {
+        PQfinish(connection);
+        openConnections--;
+    } else {
+        idle.push_back(connection);
+    }
+    returned.notify_one();
+}
+
+// ============================================================================
+// ASYNC SAVE WRITER
+// ============================================================================
+
+void AsyncSaveWriter::start(const std::string& info, const PreparedStatement& upsertSnapshot,
+                            const PreparedStatement& append, const PreparedStatement& upsertJson) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running) return;
+    connectionInfo = info;
+    upsertStatement = upsertSnapshot;
+    appendStatement = append;
+    upsertJsonStatement = upsertJson;
+    upsertMetrics = StatementMetrics::forStatement(upsertSnapshot.name);
+    appendMetrics = StatementMetrics::forStatement(append.name);
+    upsertJsonMetrics = StatementMetrics::forStatement(upsertJson.name);
+    running = true;
+    worker = std::thread([this]() { writerLoop(); });
+}
+
+void AsyncSaveWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return;
+        running = false;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+    if (connection) {
+        PQfinish(connection);
+        connection = nullptr;
+    }
+}
+
+AsyncSaveWriter::PendingSave& AsyncSaveWriter::entryFor(const SaveKey& key) {
+    auto it = pending.find(key);
+    if (it == pending.end()) {
+        queue.push_back(key);
+        it = pending.emplace(key, PendingSave()).first;
+    }
+    return it->second;
+}
+
+void AsyncSaveWriter::enqueue(const std::string& username, int slot, const std::string& saveData, Format format) {
+    enqueue(username, slot, std::make_shared<const std::string>(saveData), format);
+}
+
+void AsyncSaveWriter::enqueue(const std::string& username, int slot, std::shared_ptr<const std::string> saveData,
+                              Format format) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        PendingSave& entry = entryFor(SaveKey(username, slot));
+        entry.base = {std::move(saveData), ++nextSequence, format};  // Newer state replaces a queued one
+        entry.deltas.clear();
+        entry.rejections = 0;
+    }
+    wake.notify_one();
+}
+
+void AsyncSaveWriter::enqueueDelta(const std::string& username, int slot, std::shared_ptr<const std::string> delta) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entryFor(SaveKey(username, slot)).deltas.push_back({std::move(delta), ++nextSequence});
+    }
+    wake.notify_one();
+}
+
+bool AsyncSaveWriter::pendingSave(const std::string& username, int slot, std::string& base,
+                                  std::vector<std::string>& deltas) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pending.find(SaveKey(username, slot));
+    if (it == pending.end()) return false;
+    base = it->second.base.data ? *it->second.base.data : std::string();
+    deltas.clear();
+    for (const auto& delta : it->second.deltas) deltas.push_back(*delta.data);
+    return true;
+}
+
+bool AsyncSaveWriter::takeFailure(const std::string& username, int slot, std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = failures.find(SaveKey(username, slot));
+    if (it == failures.end()) return false;
+    error = std::move(it->second);
+    failures.erase(it);
+    return true;
+}
+
+bool AsyncSaveWriter::nextKey(std::unique_lock<std::mutex>& lock, SaveKey& key) {
+    for (;;) {
+        if (queue.empty()) {
+            if (!running) return false;  // Stopped and drained
+            wake.wait(lock);
+            continue;
+        }
+
+        // The first key not backing off; once stopping, retries are due at once
+        auto now = std::chrono::steady_clock::now();
+        auto earliest = std::chrono::steady_clock::time_point::max();
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            auto retryAt = pending[*it].retryAt;
+            if (!running || retryAt <= now) {
+                key = *it;
+                queue.erase(it);
+                return true;
+            }
+            earliest = std::min(earliest, retryAt);
+        }
+        wake.wait_until(lock, earliest);
+    }
+}
+
+void AsyncSaveWriter::writerLoop() {
+    for (;;) {
+        SaveKey key;
+        PendingWrite write;
+        bool isBase;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!nextKey(lock, key)) return;
+            const PendingSave& entry = pending[key];
+            isBase = entry.base.data != nullptr;
+            write = isBase ? entry.base : entry.deltas.front();
+        }
+
+        bool isJson = isBase && write.format == Format::Json;
+        const PreparedStatement& statement = isJson ? upsertJsonStatement : isBase ? upsertStatement : appendStatement;
+        std::string error;
+        auto started = std::chrono::steady_clock::now();
+        bool written = writeSave(statement, key, *write.data, error);
+        (isJson ? upsertJsonMetrics : isBase ? upsertMetrics : appendMetrics)
+            .record(std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count(), !written);
+        // A lost connection is the database being away, not the write being refused
+        bool rejected = !written && connection && PQstatus(connection) == CONNECTION_OK;
+        if (written && isBase && logEnabled(LogLevel::Debug)) {
+            std::cout << "💾 Saved galaxy to DB for user " << key.first << " (slot " << key.second << ")\n";
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = pending.find(key);
+        if (it == pending.end()) continue;
+        PendingSave& entry = it->second;
+        bool current = isBase ? entry.base.sequence == write.sequence
+                              : !entry.deltas.empty() && entry.deltas.front().sequence == write.sequence;
+        if (written) {
+            entry.failures = 0;
+            entry.rejections = 0;
+            if (isBase) failures.erase(key);  // The slot holds a complete state again
+            if (current && isBase) {
+                entry.base.data.reset();
+            } else if (current) {
+                entry.deltas.pop_front();
+            }
+        } else if (current && running && (!rejected || ++entry.rejections < kMaxWriteAttempts)) {
+            // Keep it, and the deltas behind it, for another try
+            entry.failures++;
+            auto backoff = std::min<std::chrono::milliseconds>(
+                kMaxWriteBackoff, kReconnectBackoff * (1L << std::min(entry.failures - 1, 5u)));
+            entry.retryAt = std::chrono::steady_clock::now() + backoff;
+            std::cerr << "⚠️  Failed to persist save for user " << key.first << " (slot " << key.second
+                      << "), retrying in " << backoff.count() << " ms: " << error << std::endl;
+        } else if (current) {
+            // Later deltas can't skip a lost write, and after a lost base they have
+            // nothing to apply to; the next base supersedes them all
+            std::cerr << "❌ Gave up persisting save for user " << key.first << " (slot " << key.second
+                      << "): " << error << std::endl;
+            failures[key] = error;
+            if (isBase) entry.base.data.reset();
+            entry.deltas.clear();
+            entry.failures = 0;
+            entry.rejections = 0;
+        }
+        if (entry.base.data || !entry.deltas.empty()) {
+            queue.push_back(key);
+        } else {
+            pending.erase(it);  // Written, or given up on
+        }
+    }
+}
+
+bool AsyncSaveWriter::ensureConnected() {
+    if (connection && PQstatus(connection) == CONNECTION_OK) return true;
+    if (connection) {
+        PQfinish(connection);
+        connection = nullptr;
+    }
+
+    connection = PQconnectdb(connectionInfo.c_str());
+    if (PQstatus(connection) != CONNECTION_OK ||
+        !prepareStatements(connection, {upsertStatement, appendStatement, upsertJsonStatement}) ||
+        PQsetnonblocking(connection, 1) != 0) {
+        PQfinish(connection);
+        connection = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool AsyncSaveWriter::writeSave(const PreparedStatement& statement, const SaveKey& key, const std::string& data,
+                                std::string& error) {
+    if (!ensureConnected()) {
+        error = "No database connection";
+        return false;
+    }
+
+    std::string slot = std::to_string(key.second);
+    const char* values[] = { key.first.c_str(), slot.c_str(), data.c_str() };
+    int lengths[] = { static_cast<int>(key.first.length()), static_cast<int>(slot.length()), static_cast<int>(data.length()) };
+    const int* formats = statement.paramFormats.empty() ? nullptr : statement.paramFormats.data();
+    if (!PQsendQueryPrepared(connection, statement.name.c_str(), 3, values, lengths, formats, 0)) {
+        error = PQerrorMessage(connection);
+        return false;
+    }
+
+    int socket = PQsocket(connection);
+
+    // Push the (possibly multi-megabyte) parameters out without blocking on the socket
+    int flushState;
+    while ((flushState = PQflush(connection)) == 1) {
+        struct pollfd waitFor = {socket, POLLOUT | POLLIN, 0};
+        poll(&waitFor, 1, 1000);
+        if ((waitFor.revents & POLLIN) && !PQconsumeInput(connection)) break;
+    }
+    if (flushState < 0) {
+        error = PQerrorMessage(connection);
+        return false;
+    }
+
+    // Wait for the server to finish the upsert
+    while (PQisBusy(connection)) {
+        struct pollfd waitFor = {socket, POLLIN, 0};
+        poll(&waitFor, 1, 1000);
+        if (!PQconsumeInput(connection)) {
+            error = PQerrorMessage(connection);
+            return false;
+        }
+    }
+
+    bool ok = true;
+    while (PGresult* result = PQgetResult(connection)) {
+        if (PQresultStatus(result) != PGRES_TUPLES_OK && PQresultStatus(result) != PGRES_COMMAND_OK) {
+            error = PQresultErrorMessage(result);
+            ok = false;
+        }
+        PQclear(result);
+    }
+    return ok;
+}
+
+} // namespace space4x
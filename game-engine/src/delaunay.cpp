@@ -0,0 +1,416 @@
+#include "delaunay.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace space4x {
+
+namespace {
+
+struct Point {
+    double x, y;
+};
+
+// Vertices are stored counter-clockwise. adjacent[i] is the triangle across
+// the edge opposite vertices[i], or -1 on the outer boundary.
+struct Triangle {
+    size_t vertices[3];
+    long adjacent[3];
+    bool alive;
+};
+
+// A boundary edge of the cavity being re-triangulated
+struct CavityEdge {
+    size_t from, to;
+    long outside;       // Triangle on the far side of the edge (-1 if none)
+    int outsideSlot;    // Which adjacent[] entry of outside points back at the cavity
+};
+
+double orientation(const Point& a, const Point& b, const Point& c) {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+double cross(double ax, double ay, double bx, double by) {
+    return ax * by - ay * bx;
+}
+
+double det3(double a0, double a1, double a2,
+            double b0, double b1, double b2,
+            double c0, double c1, double c2) {
+    return a0 * (b1 * c2 - b2 * c1) - a1 * (b0 * c2 - b2 * c0) + a2 * (b0 * c1 - b1 * c0);
+}
+
+// True if p lies strictly inside the circumcircle of the CCW triangle abc
+bool inCircumcircle(const Point& a, const Point& b, const Point& c, const Point& p) {
+    double adx = a.x - p.x, ady = a.y - p.y;
+    double bdx = b.x - p.x, bdy = b.y - p.y;
+    double cdx = c.x - p.x, cdy = c.y - p.y;
+
+    double det = (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy)
+               + (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy)
+               + (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+    return det > 0.0;
+}
+
+// Position along a Hilbert curve of order 16 over [0, 65535]^2
+uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+    uint64_t d = 0;
+    for (uint32_t s = 1u << 15; s > 0; s >>= 1) {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = 65535 - x;
+                y = 65535 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+class Triangulator {
+public:
+    explicit Triangulator(const std::vector<std::pair<double, double>>& input) : pointCount(input.size()) {
+        points.reserve(pointCount);
+        for (const auto& p : input) {
+            points.push_back({p.first, p.second});
+        }
+        triangles.reserve(2 * pointCount + 1);
+        cavityStamp.reserve(2 * pointCount + 1);
+    }
+
+    std::vector<std::pair<size_t, size_t>> run() {
+        std::vector<std::pair<size_t, size_t>> edges;
+        if (pointCount < 2) return edges;
+
+        addSuperTriangle();
+        for (size_t index : insertionOrder()) {
+            insert(index);
+        }
+
+        // Keep edges between real points; triangles touching a super
+        // vertex still contribute their convex hull edge.
+        edges.reserve(3 * pointCount);
+        for (const Triangle& t : triangles) {
+            if (!t.alive) continue;
+            for (int i = 0; i < 3; i++) {
+                size_t a = t.vertices[(i + 1) % 3];
+                size_t b = t.vertices[(i + 2) % 3];
+                if (a < pointCount && b < pointCount) {
+                    edges.push_back({std::min(a, b), std::max(a, b)});
+                }
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        return edges;
+    }
+
+private:
+    size_t pointCount;
+    std::vector<Point> points;
+    std::vector<Triangle> triangles;
+    std::vector<size_t> cavityStamp;  // Insertion number that last claimed each triangle
+    size_t stamp = 0;
+    long lastTriangle = 0;
+
+    // The super triangle's vertices are points at infinity: vertex
+    // pointCount + k sits at center + R * superDirection[k] with R -> inf.
+    // Predicates take the leading term of their polynomial in R, so the
+    // super vertices never fall inside a real circumcircle and no hull edge
+    // is lost to a finite bounding triangle.
+    Point center{0.0, 0.0};
+    Point superDirection[3];
+
+    // Scratch buffers reused across insertions
+    std::vector<long> cavity;
+    std::vector<long> pending;
+    std::vector<CavityEdge> boundary;
+
+    void addSuperTriangle() {
+        double minX = points[0].x, maxX = points[0].x;
+        double minY = points[0].y, maxY = points[0].y;
+        for (size_t i = 1; i < pointCount; i++) {
+            minX = std::min(minX, points[i].x);
+            maxX = std::max(maxX, points[i].x);
+            minY = std::min(minY, points[i].y);
+            maxY = std::max(maxY, points[i].y);
+        }
+        center = {(minX + maxX) * 0.5, (minY + maxY) * 0.5};
+
+        // Counter-clockwise, 120 degrees apart, rotated off the axes so grid
+        // aligned sites do not tie with a direction.
+        const double pi = 3.14159265358979323846;
+        const double skew = 0.1234;
+        const double angles[3] = {7.0 * pi / 6.0, 11.0 * pi / 6.0, pi / 2.0};
+        for (int k = 0; k < 3; k++) {
+            superDirection[k] = {std::cos(angles[k] + skew), std::sin(angles[k] + skew)};
+        }
+
+        triangles.push_back({{pointCount, pointCount + 1, pointCount + 2}, {-1, -1, -1}, true});
+        cavityStamp.push_back(0);
+        lastTriangle = 0;
+    }
+
+    bool isSuper(size_t v) const {
+        return v >= pointCount;
+    }
+
+    const Point& direction(size_t v) const {
+        return superDirection[v - pointCount];
+    }
+
+    // Rotate v (keeping its cyclic order) so real vertices come first
+    int frontLoadReal(size_t v[3]) const {
+        int supers = isSuper(v[0]) + isSuper(v[1]) + isSuper(v[2]);
+        if (supers == 0 || supers == 3) return supers;
+        for (int turn = 0; turn < 3; turn++) {
+            bool settled = supers == 1 ? isSuper(v[2]) : !isSuper(v[0]);
+            if (settled) break;
+            size_t first = v[0];
+            v[0] = v[1];
+            v[1] = v[2];
+            v[2] = first;
+        }
+        return supers;
+    }
+
+    // Sign of the orientation of (i, j, k); positive means counter-clockwise
+    double orient(size_t i, size_t j, size_t k) const {
+        size_t v[3] = {i, j, k};
+        switch (frontLoadReal(v)) {
+            case 0:
+                return orientation(points[v[0]], points[v[1]], points[v[2]]);
+            case 1: {
+                const Point& a = points[v[0]];
+                const Point& b = points[v[1]];
+                const Point& u = direction(v[2]);
+                double lead = cross(b.x - a.x, b.y - a.y, u.x, u.y);
+                if (lead != 0.0) return lead;
+                return cross(b.x - a.x, b.y - a.y, center.x - a.x, center.y - a.y);
+            }
+            case 2: {
+                const Point& ui = direction(v[1]);
+                const Point& uj = direction(v[2]);
+                return cross(ui.x, ui.y, uj.x, uj.y);
+            }
+            default: {
+                const Point& u0 = direction(v[0]);
+                const Point& u1 = direction(v[1]);
+                const Point& u2 = direction(v[2]);
+                return cross(u1.x - u0.x, u1.y - u0.y, u2.x - u0.x, u2.y - u0.y);
+            }
+        }
+    }
+
+    // True if real point index lies strictly inside the circumcircle of t.
+    // With super vertices the circle degenerates to a half-plane; ties on
+    // its boundary fall through to the next power of R.
+    bool inCircle(const Triangle& t, size_t index) const {
+        size_t v[3] = {t.vertices[0], t.vertices[1], t.vertices[2]};
+        int supers = frontLoadReal(v);
+        if (supers == 0) {
+            return inCircumcircle(points[v[0]], points[v[1]], points[v[2]], points[index]);
+        }
+        if (supers == 3) return true;
+
+        const Point& p = points[index];
+        const Point& a = points[v[0]];
+        double adx = a.x - p.x, ady = a.y - p.y;
+        double alift = adx * adx + ady * ady;
+        double ex = center.x - p.x, ey = center.y - p.y;
+
+        if (supers == 1) {
+            const Point& b = points[v[1]];
+            const Point& u = direction(v[2]);
+            double bdx = b.x - p.x, bdy = b.y - p.y;
+            double lead = cross(adx, ady, bdx, bdy);
+            if (lead != 0.0) return lead > 0.0;
+            return det3(adx, ady, alift,
+                        bdx, bdy, bdx * bdx + bdy * bdy,
+                        u.x, u.y, 2.0 * (u.x * ex + u.y * ey)) > 0.0;
+        }
+
+        const Point& ui = direction(v[1]);
+        const Point& uj = direction(v[2]);
+        double lead = cross(adx, ady, ui.x - uj.x, ui.y - uj.y);
+        if (lead != 0.0) return lead > 0.0;
+        return det3(adx, ady, alift,
+                    ui.x, ui.y, 2.0 * (ui.x * ex + ui.y * ey),
+                    uj.x, uj.y, 2.0 * (uj.x * ex + uj.y * ey)) > 0.0;
+    }
+
+    std::vector<size_t> insertionOrder() const {
+        double minX = points[0].x, maxX = points[0].x;
+        double minY = points[0].y, maxY = points[0].y;
+        for (size_t i = 1; i < pointCount; i++) {
+            minX = std::min(minX, points[i].x);
+            maxX = std::max(maxX, points[i].x);
+            minY = std::min(minY, points[i].y);
+            maxY = std::max(maxY, points[i].y);
+        }
+        double scaleX = (maxX > minX) ? 65535.0 / (maxX - minX) : 0.0;
+        double scaleY = (maxY > minY) ? 65535.0 / (maxY - minY) : 0.0;
+
+        std::vector<std::pair<uint64_t, size_t>> keyed(pointCount);
+        for (size_t i = 0; i < pointCount; i++) {
+            uint32_t hx = static_cast<uint32_t>((points[i].x - minX) * scaleX);
+            uint32_t hy = static_cast<uint32_t>((points[i].y - minY) * scaleY);
+            keyed[i] = {hilbertIndex(hx, hy), i};
+        }
+        std::sort(keyed.begin(), keyed.end());
+
+        std::vector<size_t> order(pointCount);
+        for (size_t i = 0; i < pointCount; i++) {
+            order[i] = keyed[i].second;
+        }
+        return order;
+    }
+
+    bool contains(const Triangle& t, size_t index) const {
+        for (int i = 0; i < 3; i++) {
+            if (orient(t.vertices[(i + 1) % 3], t.vertices[(i + 2) % 3], index) < 0.0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Visibility walk from the previous insertion; falls back to a full scan
+    // if floating point trouble ever makes the walk cycle.
+    long locate(size_t index) const {
+        long current = lastTriangle;
+        const size_t maxSteps = triangles.size() + 16;
+
+        for (size_t step = 0; step < maxSteps; step++) {
+            const Triangle& t = triangles[current];
+            long next = -1;
+            for (int k = 0; k < 3; k++) {
+                int i = static_cast<int>((k + step) % 3);
+                if (orient(t.vertices[(i + 1) % 3], t.vertices[(i + 2) % 3], index) < 0.0) {
+                    next = t.adjacent[i];
+                    break;
+                }
+            }
+            if (next < 0) return current;
+            current = next;
+        }
+
+        for (size_t i = 0; i < triangles.size(); i++) {
+            if (triangles[i].alive && contains(triangles[i], index)) {
+                return static_cast<long>(i);
+            }
+        }
+        return -1;
+    }
+
+    bool isDuplicate(const Triangle& t, const Point& p) const {
+        for (size_t v : t.vertices) {
+            if (isSuper(v)) continue;
+            if (points[v].x == p.x && points[v].y == p.y) return true;
+        }
+        return false;
+    }
+
+    void insert(size_t index) {
+        const Point& p = points[index];
+        long start = locate(index);
+        if (start < 0 || isDuplicate(triangles[start], p)) return;
+
+        // Grow the cavity of triangles whose circumcircle contains p
+        stamp++;
+        cavity.clear();
+        pending.clear();
+        cavity.push_back(start);
+        pending.push_back(start);
+        cavityStamp[start] = stamp;
+
+        while (!pending.empty()) {
+            long current = pending.back();
+            pending.pop_back();
+
+            for (long neighbor : triangles[current].adjacent) {
+                if (neighbor < 0 || cavityStamp[neighbor] == stamp) continue;
+                if (inCircle(triangles[neighbor], index)) {
+                    cavityStamp[neighbor] = stamp;
+                    cavity.push_back(neighbor);
+                    pending.push_back(neighbor);
+                }
+            }
+        }
+
+        // Collect the cavity boundary before any slot is overwritten
+        boundary.clear();
+        for (long current : cavity) {
+            const Triangle& t = triangles[current];
+            for (int i = 0; i < 3; i++) {
+                long outside = t.adjacent[i];
+                if (outside >= 0 && cavityStamp[outside] == stamp) continue;
+
+                int slot = -1;
+                if (outside >= 0) {
+                    for (int j = 0; j < 3; j++) {
+                        if (triangles[outside].adjacent[j] == current) slot = j;
+                    }
+                }
+                boundary.push_back({t.vertices[(i + 1) % 3], t.vertices[(i + 2) % 3], outside, slot});
+            }
+        }
+
+        // Fan the boundary around p, reusing the cavity's slots first
+        std::vector<long> created(boundary.size());
+        for (size_t i = 0; i < boundary.size(); i++) {
+            if (i < cavity.size()) {
+                created[i] = cavity[i];
+            } else {
+                created[i] = static_cast<long>(triangles.size());
+                triangles.push_back({});
+                cavityStamp.push_back(0);
+            }
+        }
+        for (size_t i = boundary.size(); i < cavity.size(); i++) {
+            triangles[cavity[i]].alive = false;
+        }
+
+        for (size_t i = 0; i < boundary.size(); i++) {
+            const CavityEdge& edge = boundary[i];
+            Triangle& t = triangles[created[i]];
+            t.vertices[0] = edge.from;
+            t.vertices[1] = edge.to;
+            t.vertices[2] = index;
+            t.adjacent[0] = -1;
+            t.adjacent[1] = -1;
+            t.adjacent[2] = edge.outside;
+            t.alive = true;
+            if (edge.outside >= 0 && edge.outsideSlot >= 0) {
+                triangles[edge.outside].adjacent[edge.outsideSlot] = created[i];
+            }
+        }
+
+        // Stitch neighbouring fan triangles: (a, b, p) shares edge b-p with (b, c, p)
+        for (size_t i = 0; i < boundary.size(); i++) {
+            for (size_t j = 0; j < boundary.size(); j++) {
+                if (boundary[j].from == boundary[i].to) {
+                    triangles[created[i]].adjacent[0] = created[j];
+                    triangles[created[j]].adjacent[1] = created[i];
+                    break;
+                }
+            }
+        }
+
+        lastTriangle = created.empty() ? lastTriangle : created[0];
+    }
+};
+
+} // namespace
+
+std::vector<std::pair<size_t, size_t>> computeDelaunayEdges(const std::vector<std::pair<double, double>>& points) {
+    if (points.size() == 2) {
+        return {{0, 1}};
+    }
+    return Triangulator(points).run();
+}
+
+} // namespace space4x
@@ -0,0 +1,192 @@
+#include "distance_kernels.h"
+#include "logging.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define SPACE4X_HAVE_AVX2_KERNELS 1
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define SPACE4X_HAVE_NEON_KERNELS 1
+#endif
+
+namespace space4x {
+
+namespace {
+
+// ============================================================================
+// SCALAR
+// ============================================================================
+
+void squaredDistancesScalar(const double* xs, const double* ys, size_t count,
+                            double px, double py, double* out) {
+    for (size_t i = 0; i < count; i++) {
+        double dx = xs[i] - px;
+        double dy = ys[i] - py;
+        out[i] = dx * dx + dy * dy;
+    }
+}
+
+void distancesScalar(const double* xs, const double* ys, size_t count,
+                     double px, double py, double* out) {
+    for (size_t i = 0; i < count; i++) {
+        double dx = xs[i] - px;
+        double dy = ys[i] - py;
+        out[i] = std::sqrt(dx * dx + dy * dy);
+    }
+}
+
+size_t firstWithinScalar(const double* xs, const double* ys, size_t count,
+                         double px, double py, double radiusSquared) {
+    for (size_t i = 0; i < count; i++) {
+        double dx = xs[i] - px;
+        double dy = ys[i] - py;
+        if (dx * dx + dy * dy < radiusSquared) return i;
+    }
+    return count;
+}
+
+const DistanceKernels kScalarKernels = {"scalar", squaredDistancesScalar, distancesScalar, firstWithinScalar};
+
+// ============================================================================
+// AVX2 (4 doubles per step)
+// ============================================================================
+
+#ifdef SPACE4X_HAVE_AVX2_KERNELS
+
+// Only avx2 is enabled, not fma, so the compiler cannot contract the
+// multiply-add and change rounding
+__attribute__((target("avx2")))
+void squaredDistancesAvx2(const double* xs, const double* ys, size_t count,
+                          double px, double py, double* out) {
+    const __m256d vx = _mm256_set1_pd(px);
+    const __m256d vy = _mm256_set1_pd(py);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), vx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), vy);
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+    }
+    squaredDistancesScalar(xs + i, ys + i, count - i, px, py, out + i);
+}
+
+__attribute__((target("avx2")))
+void distancesAvx2(const double* xs, const double* ys, size_t count,
+                   double px, double py, double* out) {
+    const __m256d vx = _mm256_set1_pd(px);
+    const __m256d vy = _mm256_set1_pd(py);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), vx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), vy);
+        __m256d squared = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        _mm256_storeu_pd(out + i, _mm256_sqrt_pd(squared));
+    }
+    distancesScalar(xs + i, ys + i, count - i, px, py, out + i);
+}
+
+__attribute__((target("avx2")))
+size_t firstWithinAvx2(const double* xs, const double* ys, size_t count,
+                       double px, double py, double radiusSquared) {
+    const __m256d vx = _mm256_set1_pd(px);
+    const __m256d vy = _mm256_set1_pd(py);
+    const __m256d limit = _mm256_set1_pd(radiusSquared);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), vx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), vy);
+        __m256d squared = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(squared, limit, _CMP_LT_OQ));
+        if (mask) return i + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+    return i + firstWithinScalar(xs + i, ys + i, count - i, px, py, radiusSquared);
+}
+
+const DistanceKernels kAvx2Kernels = {"avx2", squaredDistancesAvx2, distancesAvx2, firstWithinAvx2};
+
+#endif
+
+// ============================================================================
+// NEON (2 doubles per step)
+// ============================================================================
+
+#ifdef SPACE4X_HAVE_NEON_KERNELS
+
+void squaredDistancesNeon(const double* xs, const double* ys, size_t count,
+                          double px, double py, double* out) {
+    const float64x2_t vx = vdupq_n_f64(px);
+    const float64x2_t vy = vdupq_n_f64(py);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t dx = vsubq_f64(vld1q_f64(xs + i), vx);
+        float64x2_t dy = vsubq_f64(vld1q_f64(ys + i), vy);
+        vst1q_f64(out + i, vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy)));
+    }
+    squaredDistancesScalar(xs + i, ys + i, count - i, px, py, out + i);
+}
+
+void distancesNeon(const double* xs, const double* ys, size_t count,
+                   double px, double py, double* out) {
+    const float64x2_t vx = vdupq_n_f64(px);
+    const float64x2_t vy = vdupq_n_f64(py);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t dx = vsubq_f64(vld1q_f64(xs + i), vx);
+        float64x2_t dy = vsubq_f64(vld1q_f64(ys + i), vy);
+        vst1q_f64(out + i, vsqrtq_f64(vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy))));
+    }
+    distancesScalar(xs + i, ys + i, count - i, px, py, out + i);
+}
+
+size_t firstWithinNeon(const double* xs, const double* ys, size_t count,
+                       double px, double py, double radiusSquared) {
+    const float64x2_t vx = vdupq_n_f64(px);
+    const float64x2_t vy = vdupq_n_f64(py);
+    const float64x2_t limit = vdupq_n_f64(radiusSquared);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        float64x2_t dx = vsubq_f64(vld1q_f64(xs + i), vx);
+        float64x2_t dy = vsubq_f64(vld1q_f64(ys + i), vy);
+        uint64x2_t closer = vcltq_f64(vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy)), limit);
+        if (vgetq_lane_u64(closer, 0)) return i;
+        if (vgetq_lane_u64(closer, 1)) return i + 1;
+    }
+    return i + firstWithinScalar(xs + i, ys + i, count - i, px, py, radiusSquared);
+}
+
+const DistanceKernels kNeonKernels = {"neon", squaredDistancesNeon, distancesNeon, firstWithinNeon};
+
+#endif
+
+const DistanceKernels& selectKernels() {
+    const char* forced = std::getenv("SPACE4X_SIMD");
+    if (forced && std::strcmp(forced, "scalar") == 0) return kScalarKernels;
+
+#ifdef SPACE4X_HAVE_AVX2_KERNELS
+    if (__builtin_cpu_supports("avx2")) return kAvx2Kernels;
+#endif
+#ifdef SPACE4X_HAVE_NEON_KERNELS
+    return kNeonKernels;
+#endif
+    return kScalarKernels;
+}
+
+} // namespace
+
+const DistanceKernels& distanceKernels() {
+    static const DistanceKernels& kernels = []() -> const DistanceKernels& {
+        const DistanceKernels& selected = selectKernels();
+        if (logEnabled(LogLevel::Info)) {
+            std::cout << "📐 Distance kernels: " << selected.name << '\n';
+        }
+        return selected;
+    }();
+    return kernels;
+}
+
+} // namespace space4x
@@ -1,11 +1,17 @@
 #include "galaxy.h"
+#include "route_planner.h"
+#include "delaunay.h"
+#include "metrics.h"
+#include "logging.h"
+#include "job_system.h"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
-#include <unordered_set>
 #include <queue>
+#include <thread>
+#include <atomic>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -13,70 +19,451 @@
 
 namespace space4x {
 
+// ============================================================================
+// SPATIAL INDEX
+// ============================================================================
+
+double SpatialGrid::cellSizeFor(double extent, size_t expectedPoints, double minCellSize) {
+    double area = 4.0 * extent * extent;
+    double spacing = std::sqrt(area / std::max<size_t>(expectedPoints, 1));
+    return std::max(spacing, minCellSize);
+}
+
+void SpatialGrid::reset(double centerX, double centerY, double extent, double size) {
+    const int maxCellsPerSide = 2048;
+    
+    extent = std::max(extent, 1.0);
+    size = std::max(size, 1e-6);
+    
+    cellsPerSide = static_cast<int>(std::ceil(2.0 * extent / size));
+    cellsPerSide = std::max(1, std::min(cellsPerSide, maxCellsPerSide));
+    originX = centerX - extent;
+    originY = centerY - extent;
+    cellSize = 2.0 * extent / cellsPerSide;
+    inverseCellSize = 1.0 / cellSize;
+    
+    cells.assign(static_cast<size_t>(cellsPerSide) * cellsPerSide, {});
+    points.clear();
+}
+
+size_t SpatialGrid::insert(double x, double y) {
+    size_t index = points.size();
+    points.push_back({x, y});
+    cells[cellY(y) * cellsPerSide + cellX(x)].push_back({x, y, index});
+    return index;
+}
+
+bool SpatialGrid::anyWithin(double x, double y, double radius) const {
+    if (points.empty()) return false;
+    
+    const double radiusSquared = radius * radius;
+    const int minX = cellX(x - radius), maxX = cellX(x + radius);
+    const int minY = cellY(y - radius), maxY = cellY(y + radius);
+    
+    for (int cy = minY; cy <= maxY; cy++) {
+        for (int cx = minX; cx <= maxX; cx++) {
+            for (const Entry& entry : cellAt(cx, cy)) {
+                double dx = entry.x - x;
+                double dy = entry.y - y;
+                if (dx * dx + dy * dy < radiusSquared) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+int SpatialGrid::cellCoord(double value, double origin) const {
+    double cell = std::floor((value - origin) * inverseCellSize);
+    if (cell < 0.0) return 0;
+    if (cell >= cellsPerSide) return cellsPerSide - 1;
+    return static_cast<int>(cell);
+}
+
+ConnectivityMode connectivityModeFromString(const std::string& name) {
+    if (name == "delaunay") return ConnectivityMode::Delaunay;
+    return ConnectivityMode::NearestNeighbors;
+}
+
+const char* connectivityModeName(ConnectivityMode mode) {
+    switch (mode) {
+        case ConnectivityMode::Delaunay: return "delaunay";
+        case ConnectivityMode::NearestNeighbors: break;
+    }
+    return "nearest";
+}
+
+SystemTier systemTierFromType(const std::string& type) {
+    for (size_t tier = 0; tier + 1 < kSystemTierCount; tier++) {
+        if (type == kSystemTierNames[tier]) return static_cast<SystemTier>(tier);
+    }
+    return SystemTier::Rim;
+}
+
+// ============================================================================
+// GALAXY GEOMETRY
+// ============================================================================
+
+namespace {
+
+template <typename Systems>
+void assignPositionsFrom(GalaxyGeometry& geometry, const Systems& systems) {
+    geometry.x.resize(systems.size());
+    geometry.y.resize(systems.size());
+    geometry.tier.resize(systems.size());
+    size_t i = 0;
+    for (const StarSystem& system : systems) {
+        geometry.x[i] = system.x;
+        geometry.y[i] = system.y;
+        geometry.tier[i++] = systemTierFromType(system.type);
+    }
+    geometry.laneOffsets.clear();
+    geometry.laneTargets.clear();
+    geometry.laneDistances.clear();
+    geometry.laneIds.clear();
+}
+
+} // namespace
+
+void GalaxyGeometry::assignPositions(const std::vector<StarSystem>& systems) {
+    assignPositionsFrom(*this, systems);
+}
+
+void GalaxyGeometry::assignPositions(const CowVector<StarSystem>& systems) {
+    assignPositionsFrom(*this, systems);
+}
+
+void GalaxyGeometry::assignLanes(const LaneGraph& lanes) {
+    std::vector<std::pair<uint32_t, uint32_t>> endpoints;
+    std::vector<double> distances;
+    endpoints.reserve(lanes.edgeCount());
+    distances.reserve(lanes.edgeCount());
+    for (const auto& edge : lanes.edges()) {
+        endpoints.push_back({edge.from, edge.to});
+        distances.push_back(edge.distance);
+    }
+    assignLanes(endpoints, distances);
+}
+
+void GalaxyGeometry::assignLanes(const std::vector<std::pair<uint32_t, uint32_t>>& endpoints,
+                                 const std::vector<double>& distances) {
+    // Counting sort into CSR; filling in edge order reproduces LaneGraph's neighbor order
+    laneOffsets.assign(size() + 1, 0);
+    for (const auto& lane : endpoints) {
+        laneOffsets[lane.first + 1]++;
+        laneOffsets[lane.second + 1]++;
+    }
+    for (size_t i = 1; i < laneOffsets.size(); i++) {
+        laneOffsets[i] += laneOffsets[i - 1];
+    }
+
+    laneTargets.resize(laneOffsets.back());
+    laneDistances.resize(laneOffsets.back());
+    laneIds.resize(laneOffsets.back());
+    std::vector<uint32_t> cursor(laneOffsets.begin(), laneOffsets.end() - 1);
+    for (size_t i = 0; i < endpoints.size(); i++) {
+        uint32_t a = endpoints[i].first, b = endpoints[i].second;
+        laneTargets[cursor[a]] = b;
+        laneIds[cursor[a]] = static_cast<uint32_t>(i);
+        laneDistances[cursor[a]++] = distances[i];
+        laneTargets[cursor[b]] = a;
+        laneIds[cursor[b]] = static_cast<uint32_t>(i);
+        laneDistances[cursor[b]++] = distances[i];
+    }
+}
+
+int64_t GalaxyGeometry::findLane(uint32_t a, uint32_t b) const {
+    if (degree(b) < degree(a)) std::swap(a, b);
+    for (uint32_t k = laneOffsets[a]; k < laneOffsets[a + 1]; k++) {
+        if (laneTargets[k] == b) return laneIds[k];
+    }
+    return -1;
+}
+
+void GalaxyGeometry::appendLane(uint32_t a, uint32_t b, double distance, uint32_t id) {
+    for (uint32_t node : {a, b}) {
+        uint32_t slot = laneOffsets[node + 1];
+        laneTargets.insert(laneTargets.begin() + slot, node == a ? b : a);
+        laneDistances.insert(laneDistances.begin() + slot, distance);
+        laneIds.insert(laneIds.begin() + slot, id);
+        for (size_t n = node + 1; n < laneOffsets.size(); n++) laneOffsets[n]++;
+    }
+}
+
+void GalaxyGeometry::removeLane(uint32_t a, uint32_t b, uint32_t id) {
+    for (uint32_t node : {a, b}) {
+        for (uint32_t k = laneOffsets[node]; k < laneOffsets[node + 1]; k++) {
+            if (laneIds[k] != id) continue;
+            laneTargets.erase(laneTargets.begin() + k);
+            laneDistances.erase(laneDistances.begin() + k);
+            laneIds.erase(laneIds.begin() + k);
+            for (size_t n = node + 1; n < laneOffsets.size(); n++) laneOffsets[n]--;
+            break;
+        }
+    }
+    for (uint32_t& lane : laneIds) {
+        if (lane > id) lane--;
+    }
+}
+
+size_t GalaxyGeometry::heapBytes() const {
+    return x.capacity() * sizeof(double) + y.capacity() * sizeof(double) +
+           tier.capacity() * sizeof(SystemTier) + laneOffsets.capacity() * sizeof(uint32_t) +
+           laneTargets.capacity() * sizeof(uint32_t) + laneDistances.capacity() * sizeof(double) +
+           laneIds.capacity() * sizeof(uint32_t);
+}
+
+void Galaxy::indexSystems() {
+    auto ids = std::make_shared<SystemIdIndex>();
+    ids->reserve(systems.size());
+    uint32_t position = 0;
+    for (const auto& system : systems) {
+        ids->emplace(system.id, position++);
+    }
+    systemIndex = std::move(ids);
+
+    geometry.assignPositions(systems);
+    indexLanes();
+}
+
+void Galaxy::indexLanes() {
+    std::vector<std::pair<uint32_t, uint32_t>> endpoints;
+    std::vector<double> distances;
+    std::vector<uint32_t> ids;  // Lanes with an unknown end are skipped, so ids are remapped
+    endpoints.reserve(warpLanes.size());
+    distances.reserve(warpLanes.size());
+    ids.reserve(warpLanes.size());
+    uint32_t position = 0;
+    for (const auto& lane : warpLanes) {
+        auto from = systemIndex->find(lane.from);
+        auto to = systemIndex->find(lane.to);
+        if (from != systemIndex->end() && to != systemIndex->end()) {
+            endpoints.push_back({from->second, to->second});
+            distances.push_back(lane.distance);
+            ids.push_back(position);
+        }
+        position++;
+    }
+    geometry.assignLanes(endpoints, distances);
+    for (uint32_t& id : geometry.laneIds) id = ids[id];
+    landmarks.reset();
+}
+
+int64_t Galaxy::findSystemIndex(const std::string& id) const {
+    auto it = systemIndex->find(id);
+    return it == systemIndex->end() ? -1 : static_cast<int64_t>(it->second);
+}
+
+const StarSystem* Galaxy::findSystem(const std::string& id) const {
+    int64_t index = findSystemIndex(id);
+    return index < 0 ? nullptr : &systems[index];
+}
+
+int64_t Galaxy::findLaneIndex(const std::string& from, const std::string& to) const {
+    int64_t a = findSystemIndex(from);
+    int64_t b = findSystemIndex(to);
+    if (a < 0 || b < 0 || !geometry.hasLanes()) return -1;
+    return geometry.findLane(static_cast<uint32_t>(a), static_cast<uint32_t>(b));
+}
+
+WarpLane makeWarpLane(const StarSystem& from, const StarSystem& to, double distance) {
+    WarpLane lane;
+    lane.id = from.id + "-" + to.id;
+    lane.from = from.id;
+    lane.to = to.id;
+    lane.distance = distance;
+    lane.travelTime = laneTravelTime(distance);
+    lane.discovered = from.explored && to.explored;
+    return lane;
+}
+
+namespace {
+
+// Runs body(i) for every i in [0, count) on up to `threads` workers of the
+// shared JobSystem, handing out fixed-size chunks. body must only write state
+// owned by index i; the first exception it throws is rethrown here.
+template <typename Body>
+void parallelFor(size_t count, int threads, Body&& body) {
+    if (threads <= 1 || count < 2) {
+        for (size_t i = 0; i < count; i++) body(i);
+        return;
+    }
+    
+    // One job per worker, each pulling chunks off a shared counter so uneven
+    // tiles still balance; the pool never runs more than `workers` of them
+    const size_t workers = std::min<size_t>(threads, count);
+    const size_t chunk = std::max<size_t>(1, count / (workers * 8));
+    std::atomic<size_t> nextIndex(0);
+    
+    JobSystem::global().parallelFor(workers, 1, [&](size_t, size_t) {
+        for (;;) {
+            size_t start = nextIndex.fetch_add(chunk);
+            if (start >= count) break;
+            size_t end = std::min(count, start + chunk);
+            for (size_t i = start; i < end; i++) body(i);
+        }
+    });
+}
+
+template <typename T, size_t N>
+constexpr size_t arraySize(const T (&)[N]) { return N; }
+
+// Lane range multiplier for every pair of end tiers, folded at compile time
+constexpr double kTierPairRange[kSystemTierCount][kSystemTierCount] = {
+    {tierPairRangeMultiplier<SystemTier::Origin, SystemTier::Origin>(),
+     tierPairRangeMultiplier<SystemTier::Origin, SystemTier::Core>(),
+     tierPairRangeMultiplier<SystemTier::Origin, SystemTier::Rim>()},
+    {tierPairRangeMultiplier<SystemTier::Core, SystemTier::Origin>(),
+     tierPairRangeMultiplier<SystemTier::Core, SystemTier::Core>(),
+     tierPairRangeMultiplier<SystemTier::Core, SystemTier::Rim>()},
+    {tierPairRangeMultiplier<SystemTier::Rim, SystemTier::Origin>(),
+     tierPairRangeMultiplier<SystemTier::Rim, SystemTier::Core>(),
+     tierPairRangeMultiplier<SystemTier::Rim, SystemTier::Rim>()}
+};
+static_assert(kTierPairRange[static_cast<size_t>(SystemTier::Core)][static_cast<size_t>(SystemTier::Rim)] == 2.0,
+              "mixed lanes take the more generous tier");
+
+constexpr const char* kSystemNamePrefixes[] = {"Alpha", "Beta", "Gamma", "Delta", "Epsilon", "Zeta", "Eta", "Theta"};
+constexpr const char* kSystemNameSuffixes[] = {"Centauri", "Draconis", "Leonis", "Aquarii", "Orionis", "Cygni", "Lyrae"};
+
+// Per AnomalyType, in enum order: name, spawn weight, display names and effect
+struct AnomalyKind {
+    const char* type;
+    double weight;
+    const char* names[4];
+    const char* effect;
+    double effectValue;
+};
+
+constexpr AnomalyKind kAnomalyKinds[] = {
+    {"nebula", 0.4, {"Crimson Nebula", "Azure Cloud", "Stellar Nursery", "Dark Nebula"}, "sensor_interference", -0.5},
+    {"blackhole", 0.1, {"Void Maw", "Event Horizon", "Singularity", "Dark Star"}, "gravity_well", 2.0},
+    {"wormhole", 0.1, {"Quantum Gate", "Space Fold", "Dimensional Rift", "Warp Tunnel"}, "fast_travel", 0.1},
+    {"artifact", 0.2, {"Ancient Relic", "Precursor Site", "Mysterious Structure", "Alien Beacon"}, "research_bonus", 1.5},
+    {"resource", 0.2, {"Asteroid Field", "Resource Cluster", "Mining Zone", "Rare Elements"}, "mining_bonus", 2.0}
+};
+static_assert(arraySize(kAnomalyKinds) == static_cast<size_t>(AnomalyType::Resource) + 1, "one kind per AnomalyType");
+
+} // namespace
+
+// ============================================================================
+// GALAXY GENERATION
+// ============================================================================
+
 GalaxyGenerator::GalaxyGenerator(const GalaxyConfig& cfg) 
-    : config(cfg), random(cfg.seed) {
+    : config(cfg), random(cfg.seed), systemConfigManager(SystemConfigManager::catalog()) {
+}
+
+int GalaxyGenerator::workerCount() const {
+    if (!config.generation.parallel) return 1;
+    // threads comes straight from the request; more than the cores would only queue
+    int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int threads = config.generation.threads;
+    if (threads <= 0 || threads > cores) threads = cores;
+    return threads;
+}
+
+void GalaxyGenerator::beginStage(GenerationStage stage) {
+    // Serial generation keeps the single mt19937 sequence of the original game
+    if (config.generation.parallel) {
+        random = SeededRandom::stream(config.seed, stage, 0);
+    }
+}
+
+void GalaxyGenerator::endStage(const char* stage) {
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - stageStart).count();
+    timings.push_back({stage, seconds * 1000.0});
+    stageStart = now;
+    
+    MetricsRegistry& metrics = MetricsRegistry::global();
+    metrics.observe(metrics.histogram("space4x_generation_stage_seconds", "Galaxy generation time per pipeline stage",
+                                      metricLabel("stage", stage)), seconds);
+    if (stageObserver) stageObserver(timings.back());
+}
+
+size_t GalaxyGenerator::stageCount(const GalaxyConfig& config) {
+    // sites and neighbors only exist on the Voronoi path
+    return config.connectivity.useVoronoiConnectivity ? 9 : 7;
 }
 
 Galaxy GalaxyGenerator::generateGalaxy() {
-    std::cout << "🌌 Generating galaxy with seed: " << config.seed << std::endl;
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "🌌 Generating galaxy with seed: " << config.seed << '\n';
+    }
+    timings.clear();
+    stageStart = std::chrono::steady_clock::now();
+    if (config.generation.parallel && logEnabled(LogLevel::Debug)) {
+        std::cout << "🧵 Parallel generation with " << workerCount() << " worker threads\n";
+    }
     
     std::vector<StarSystem> systems;
-    std::vector<WarpLane> warpLanes;
+    LaneGraph lanes;
     
     if (config.connectivity.useVoronoiConnectivity) {
-        std::cout << "📐 Using Voronoi-based galaxy generation (like original game)" << std::endl;
+        if (logEnabled(LogLevel::Debug)) {
+            std::cout << "📐 Using Voronoi-based galaxy generation (like original game)\n";
+        }
         
         // Generate Voronoi sites
         voronoiSites = generateVoronoiSites(config.starSystemCount);
+        endStage("sites");
         
         // Compute Voronoi neighbors
         computeVoronoiNeighbors();
+        endStage("neighbors");
         
         // Generate systems from Voronoi sites
+        beginStage(GenerationStage::FixedSystems);
         systems = generateSystemsFromVoronoi();
+        indexSystems(systems);
+        geometry.assignPositions(systems);
+        endStage("systems");
         
         // Generate warp lanes based on Voronoi connectivity
-        warpLanes = generateVoronoiWarpLanes(systems);
+        beginStage(GenerationStage::Lanes);
+        lanes = generateVoronoiWarpLanes(systems);
+        endStage("lanes");
     } else {
-        std::cout << "🔗 Using traditional distance-based galaxy generation" << std::endl;
+        if (logEnabled(LogLevel::Debug)) {
+            std::cout << "🔗 Using traditional distance-based galaxy generation\n";
+        }
         
-        // Generate star systems
+        // Generate star systems (placement is sequential rejection sampling)
+        beginStage(GenerationStage::Systems);
         systems = generateStarSystems();
+        geometry.assignPositions(systems);
+        endStage("systems");
         
         // Generate warp lanes
-        warpLanes = generateWarpLanes(systems);
+        beginStage(GenerationStage::Lanes);
+        lanes = generateWarpLanes(systems);
+        endStage("lanes");
     }
     
     // Add strategic redundant connections (from original game)
-    // Build connections map from existing warp lanes
-    std::unordered_map<std::string, std::vector<std::string>> connections;
-    for (auto& system : systems) {
-        connections[system.id] = std::vector<std::string>();
-    }
-    
-    // Populate connections from existing warp lanes
-    for (const auto& lane : warpLanes) {
-        connections[lane.from].push_back(lane.to);
-        connections[lane.to].push_back(lane.from);
-    }
-    addRedundantConnections(systems, warpLanes, connections);
+    addRedundantConnections(systems, lanes);
+    endStage("redundant_lanes");
     
     // Final safety net: ensure all systems are connected
-    ensureMinimumConnectivity(systems, warpLanes, connections);
+    ensureMinimumConnectivity(systems, lanes);
     
     // Final verification: ensure full network connectivity
-    ensureNetworkConnectivity(systems, warpLanes, connections);
-    
-    // Update system connections after redundant connections
-    for (auto& system : systems) {
-        system.connections = connections[system.id];
-    }
+    ensureNetworkConnectivity(systems, lanes);
     
     // Verify all systems are connected
-    verifyConnectivity(systems, connections);
+    reachableSystems = verifyConnectivity(systems, lanes);
+    endStage("connectivity");
+    
+    // Attach system IDs to lanes and connection lists
+    std::vector<WarpLane> warpLanes = materializeWarpLanes(systems, lanes);
+    endStage("materialize");
     
     // Generate anomalies (same for both approaches)
+    beginStage(GenerationStage::Anomalies);
     auto anomalies = generateAnomalies(systems);
+    endStage("anomalies");
     
     Galaxy galaxy;
     galaxy.config = config;
@@ -84,6 +471,9 @@ Galaxy GalaxyGenerator::generateGalaxy() {
     galaxy.anomalies = anomalies;
     galaxy.warpLanes = warpLanes;
     galaxy.bounds = {-config.radius, config.radius, -config.radius, config.radius, config.radius};
+    galaxy.indexSystems();
+    galaxy.landmarks = RouteLandmarks::build(galaxy.geometry);
+    endStage("index");
     
     // Calculate statistics
     double avgConnections = 0;
@@ -102,17 +492,20 @@ Galaxy GalaxyGenerator::generateGalaxy() {
         avgDistance /= warpLanes.size();
     }
     
-    std::cout << "✅ Generated galaxy: " << systems.size() << " systems, " 
-              << anomalies.size() << " anomalies, " << warpLanes.size() << " warp lanes" << std::endl;
-    std::cout << "📊 Connectivity: " << std::fixed << std::setprecision(1) 
-              << avgConnections << " avg connections, " << maxDistance << " max distance, " 
-              << avgDistance << " avg distance" << std::endl;
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "✅ Generated galaxy: " << systems.size() << " systems, " 
+                  << anomalies.size() << " anomalies, " << warpLanes.size() << " warp lanes\n";
+        std::cout << "📊 Connectivity: " << std::fixed << std::setprecision(1) 
+                  << avgConnections << " avg connections, " << maxDistance << " max distance, " 
+                  << avgDistance << " avg distance\n";
+    }
     
     return galaxy;
 }
 
 std::vector<StarSystem> GalaxyGenerator::generateStarSystems() {
     std::vector<StarSystem> systems;
+    systemIndex.reset(config.radius, SpatialGrid::cellSizeFor(config.radius, config.starSystemCount, 2.0));
     
     // Add fixed systems first
     for (const auto& fixedSystem : config.fixedSystems) {
@@ -125,8 +518,9 @@ std::vector<StarSystem> GalaxyGenerator::generateStarSystems() {
         system.type = fixedSystem.type;
         system.isFixed = true;
         system.connections.clear();
-        system.explored = (fixedSystem.type == "origin");
-        system.population = (fixedSystem.type == "origin") ? 1000000 : 0;
+        bool origin = systemTierFromType(fixedSystem.type) == SystemTier::Origin;
+        system.explored = origin;
+        system.population = origin ? 1000000 : 0;
         system.gdp = system.population * random.range(0.8, 1.5);
         
         // Explicitly initialize resources
@@ -151,9 +545,8 @@ std::vector<StarSystem> GalaxyGenerator::generateStarSystems() {
             system.detailedSystem = detailedSystem;
         } else {
             // Use random generation
-            std::vector<std::string> starTypes = {"G-class", "K-class", "M-class", "F-class", "A-class"};
-            int starTypeIndex = random.intRange(0, starTypes.size() - 1);
-            system.systemInfo.starType = starTypes[starTypeIndex];
+            int starTypeIndex = random.intRange(0, static_cast<int>(arraySize(kStarTypes)) - 1);
+            system.systemInfo.starType = kStarTypes[starTypeIndex];
             system.systemInfo.planetCount = random.intRange(2, 12);
             system.systemInfo.moonCount = random.intRange(0, system.systemInfo.planetCount * 3);
             system.systemInfo.asteroidCount = random.intRange(100, 5000);
@@ -161,12 +554,14 @@ std::vector<StarSystem> GalaxyGenerator::generateStarSystems() {
         }
         
         // Debug output for fixed systems
-        std::cout << "  " << system.name << " system info: " 
-                 << "star=" << system.systemInfo.starType
-                 << " planets=" << system.systemInfo.planetCount 
-                 << " moons=" << system.systemInfo.moonCount
-                 << " asteroids=" << system.systemInfo.asteroidCount
-                 << " gdp=" << system.gdp << std::endl;
+        if (logEnabled(LogLevel::Debug)) {
+            std::cout << "  " << system.name << " system info: " 
+                     << "star=" << system.systemInfo.starType
+                     << " planets=" << system.systemInfo.planetCount 
+                     << " moons=" << system.systemInfo.moonCount
+                     << " asteroids=" << system.systemInfo.asteroidCount
+                     << " gdp=" << system.gdp << '\n';
+        }
         
         if (fixedSystem.hasFixedPosition) {
             // Use exact coordinates for real star systems
@@ -186,12 +581,15 @@ std::vector<StarSystem> GalaxyGenerator::generateStarSystems() {
             system.x = distance * std::cos(angle);
             system.y = distance * std::sin(angle);
             
-            std::cout << "  Placed " << system.name << " at distance " 
-                     << std::sqrt(system.x * system.x + system.y * system.y) 
-                     << " LY (target: " << targetDist << " ± " << tolerance << ")" << std::endl;
+            if (logEnabled(LogLevel::Debug)) {
+                std::cout << "  Placed " << system.name << " at distance " 
+                         << std::sqrt(system.x * system.x + system.y * system.y) 
+                         << " LY (target: " << targetDist << " ± " << tolerance << ")\n";
+            }
         }
         
         systems.push_back(system);
+        systemIndex.insert(system.x, system.y);
     }
     
     // Generate remaining random systems
@@ -206,7 +604,7 @@ std::vector<StarSystem> GalaxyGenerator::generateStarSystems() {
             position = generateRandomPositionInCircle();
             attempts++;
         } while (attempts < 100 && 
-                isPositionTooCloseToSystems(position, systems, 2.0));
+                isPositionTooCloseToSystems(position, systemIndex, 2.0));
         
         StarSystem system;
         // Explicitly initialize all fields to avoid corruption
@@ -214,7 +612,7 @@ std::vector<StarSystem> GalaxyGenerator::generateStarSystems() {
         system.name = generateSystemName(i + 1);
         system.x = position.first;
         system.y = position.second;
-        system.type = determineSystemType(position);
+        system.type = systemTierName(determineSystemType(position));
         system.isFixed = false;
         system.connections.clear();
         system.explored = false;
@@ -241,6 +639,7 @@ std::vector<StarSystem> GalaxyGenerator::generateStarSystems() {
         system.detailedSystem = nullptr; // Random systems don't store detailed data
         
         systems.push_back(system);
+        systemIndex.insert(system.x, system.y);
     }
     
     return systems;
@@ -248,6 +647,11 @@ std::vector<StarSystem> GalaxyGenerator::generateStarSystems() {
 
 std::vector<Anomaly> GalaxyGenerator::generateAnomalies(const std::vector<StarSystem>& systems) {
     std::vector<Anomaly> anomalies;
+    SpatialGrid anomalyIndex(config.radius, SpatialGrid::cellSizeFor(config.radius, config.anomalyCount, 2.0));
+    
+    if (systemIndex.size() != systems.size()) {
+        indexSystems(systems);
+    }
     
     for (int i = 0; i < config.anomalyCount; i++) {
         std::pair<double, double> position;
@@ -258,68 +662,49 @@ std::vector<Anomaly> GalaxyGenerator::generateAnomalies(const std::vector<StarSy
             position = generateRandomPositionInCircle();
             attempts++;
         } while (attempts < 100 && 
-                (isPositionTooCloseToSystems(position, systems, 3.0) ||
-                 isPositionTooClose(position, anomalies, 2.0)));
+                (isPositionTooCloseToSystems(position, systemIndex, 3.0) ||
+                 isPositionTooClose(position, anomalyIndex, 2.0)));
         
         Anomaly anomaly;
         anomaly.id = "anomaly-" + std::to_string(i + 1);
-        anomaly.type = generateAnomalyType();
-        anomaly.name = generateAnomalyName(anomaly.type, i + 1);
+        AnomalyType type = generateAnomalyType();
+        const AnomalyKind& kind = kAnomalyKinds[static_cast<size_t>(type)];
+        anomaly.type = kind.type;
+        anomaly.name = generateAnomalyName(type, i + 1);
         anomaly.x = position.first;
         anomaly.y = position.second;
         anomaly.discovered = false;
-        
-        // Set effect based on type
-        if (anomaly.type == "nebula") {
-            anomaly.effect = {"sensor_interference", -0.5};
-        } else if (anomaly.type == "blackhole") {
-            anomaly.effect = {"gravity_well", 2.0};
-        } else if (anomaly.type == "wormhole") {
-            anomaly.effect = {"fast_travel", 0.1};
-        } else if (anomaly.type == "artifact") {
-            anomaly.effect = {"research_bonus", 1.5};
-        } else if (anomaly.type == "resource") {
-            anomaly.effect = {"mining_bonus", 2.0};
-        } else {
-            anomaly.effect = {"none", 0.0};
-        }
+        anomaly.effect = {kind.effect, kind.effectValue};
         
         anomalies.push_back(anomaly);
+        anomalyIndex.insert(anomaly.x, anomaly.y);
     }
     
     return anomalies;
 }
 
-std::vector<WarpLane> GalaxyGenerator::generateWarpLanes(std::vector<StarSystem>& systems) {
-    std::vector<WarpLane> warpLanes;
-    std::unordered_map<std::string, std::vector<std::string>> connections;
-    
-    // Initialize connection tracking
-    for (auto& system : systems) {
-        connections[system.id] = std::vector<std::string>();
-    }
+LaneGraph GalaxyGenerator::generateWarpLanes(const std::vector<StarSystem>& systems) {
+    LaneGraph lanes(systems.size());
     
     // Phase 1: Create initial connections based on proximity
-    for (auto& system : systems) {
-        auto& currentConnections = connections[system.id];
+    for (uint32_t current = 0; current < systems.size(); current++) {
+        const double x = geometry.x[current];
+        const double y = geometry.y[current];
         
         // Find candidates within max distance
-        std::vector<std::pair<StarSystem*, double>> candidates;
-        for (auto& other : systems) {
-            if (other.id != system.id) {
-                double distance = calculateDistance({system.x, system.y}, {other.x, other.y});
-                if (distance <= config.connectivity.maxDistance) {
-                    candidates.push_back({&other, distance});
-                }
+        std::vector<std::pair<double, uint32_t>> candidates;
+        systemIndex.forEachWithin(x, y, config.connectivity.maxDistance,
+                                  [&](size_t index, double distance) {
+            if (index != current) {
+                candidates.push_back({distance, static_cast<uint32_t>(index)});
             }
-        }
+        });
         
         // Sort by distance
-        std::sort(candidates.begin(), candidates.end(), 
-                 [](const auto& a, const auto& b) { return a.second < b.second; });
+        std::sort(candidates.begin(), candidates.end());
         
         // Determine target connections - more for central systems
-        double distanceFromOrigin = std::sqrt(system.x * system.x + system.y * system.y);
+        double distanceFromOrigin = std::sqrt(x * x + y * y);
         double normalizedDistanceFromOrigin = distanceFromOrigin / config.radius;
         
         // Central systems get more connections
@@ -333,49 +718,44 @@ std::vector<WarpLane> GalaxyGenerator::generateWarpLanes(std::vector<StarSystem>
         
         // Phase 1a: Always connect to closest systems (guaranteed connectivity)
         int guaranteedConnections = std::min(2, static_cast<int>(candidates.size()));
-        for (int i = 0; i < guaranteedConnections && i < static_cast<int>(candidates.size()); i++) {
-            const auto& candidate = candidates[i];
-            if (std::find(currentConnections.begin(), currentConnections.end(), 
-                         candidate.first->id) == currentConnections.end()) {
-                createWarpLane(system, *candidate.first, candidate.second, warpLanes, connections);
-            }
+        for (int i = 0; i < guaranteedConnections; i++) {
+            createWarpLane(current, candidates[i].second, candidates[i].first, lanes);
         }
         
         // Phase 1b: Add additional connections with distance-based probability
         for (const auto& candidate : candidates) {
-            if (static_cast<int>(currentConnections.size()) >= targetConnections) break;
+            if (static_cast<int>(lanes.degree(current)) >= targetConnections) break;
             
             // Check if already connected
-            if (std::find(currentConnections.begin(), currentConnections.end(), 
-                         candidate.first->id) != currentConnections.end()) {
+            if (lanes.connected(current, candidate.second)) {
                 continue;
             }
             
             // More generous probability for connections
-            double normalizedDistance = candidate.second / config.connectivity.maxDistance;
+            double normalizedDistance = candidate.first / config.connectivity.maxDistance;
             double probability = std::exp(-normalizedDistance * config.connectivity.distanceDecayFactor);
             
             // Bonus for creating network diversity
             double diversityBonus = 1.0;
-            if (connections[candidate.first->id].size() < 2) {
+            if (lanes.degree(candidate.second) < 2) {
                 diversityBonus = 1.5; // Help isolated systems
             }
             
             double finalProbability = probability * diversityBonus;
             
             if (random.next() < finalProbability) {
-                createWarpLane(system, *candidate.first, candidate.second, warpLanes, connections);
+                createWarpLane(current, candidate.second, candidate.first, lanes);
             }
         }
     }
     
     // Phase 2: Ensure minimum connectivity
-    ensureMinimumConnectivity(systems, warpLanes, connections);
+    ensureMinimumConnectivity(systems, lanes);
     
     // Phase 3: Ensure network connectivity
-    ensureNetworkConnectivity(systems, warpLanes, connections);
+    ensureNetworkConnectivity(systems, lanes);
     
-    return warpLanes;
+    return lanes;
 }
 
 std::pair<double, double> GalaxyGenerator::generateRandomPositionInCircle() {
@@ -384,157 +764,127 @@ std::pair<double, double> GalaxyGenerator::generateRandomPositionInCircle() {
     return {radius * std::cos(angle), radius * std::sin(angle)};
 }
 
-bool GalaxyGenerator::isPositionTooCloseToSystems(const std::pair<double, double>& pos,
-                                                const std::vector<StarSystem>& systems,
-                                                double minDistance) {
+void GalaxyGenerator::indexSystems(const std::vector<StarSystem>& systems) {
+    systemIndex.reset(config.radius, SpatialGrid::cellSizeFor(config.radius, systems.size(), 2.0));
     for (const auto& system : systems) {
-        if (calculateDistance(pos, {system.x, system.y}) < minDistance) {
-            return true;
-        }
+        systemIndex.insert(system.x, system.y);
     }
-    return false;
+}
+
+bool GalaxyGenerator::isPositionTooCloseToSystems(const std::pair<double, double>& pos,
+                                                const SpatialGrid& systems,
+                                                double minDistance) {
+    return systems.anyWithin(pos.first, pos.second, minDistance);
 }
 
 bool GalaxyGenerator::isPositionTooClose(const std::pair<double, double>& pos,
-                                       const std::vector<Anomaly>& anomalies,
+                                       const SpatialGrid& anomalies,
                                        double minDistance) {
-    for (const auto& anomaly : anomalies) {
-        if (calculateDistance(pos, {anomaly.x, anomaly.y}) < minDistance) {
-            return true;
-        }
-    }
-    return false;
+    return anomalies.anyWithin(pos.first, pos.second, minDistance);
 }
 
-double GalaxyGenerator::calculateDistance(const std::pair<double, double>& a,
-                                        const std::pair<double, double>& b) {
-    double dx = a.first - b.first;
-    double dy = a.second - b.second;
-    return std::sqrt(dx * dx + dy * dy);
+void GalaxyGenerator::createWarpLane(uint32_t system1, uint32_t system2, double distance, LaneGraph& lanes) {
+    // Duplicate connections are ignored by the graph
+    lanes.addEdge(system1, system2, distance);
 }
 
-void GalaxyGenerator::createWarpLane(StarSystem& system1, StarSystem& system2, double distance,
-                                   std::vector<WarpLane>& warpLanes,
-                                   std::unordered_map<std::string, std::vector<std::string>>& connections) {
-    // Avoid duplicate connections
-    auto& conn1 = connections[system1.id];
-    if (std::find(conn1.begin(), conn1.end(), system2.id) != conn1.end()) {
-        return;
-    }
+std::vector<WarpLane> GalaxyGenerator::materializeWarpLanes(std::vector<StarSystem>& systems, const LaneGraph& lanes) {
+    std::vector<WarpLane> warpLanes;
+    warpLanes.reserve(lanes.edgeCount());
     
-    WarpLane lane;
-    lane.id = system1.id + "-" + system2.id;
-    lane.from = system1.id;
-    lane.to = system2.id;
-    lane.distance = distance;
-    lane.travelTime = static_cast<int>(std::ceil(distance / 5.0)); // 5 LY per turn
-    lane.discovered = system1.explored && system2.explored;
+    for (const auto& edge : lanes.edges()) {
+        warpLanes.push_back(makeWarpLane(systems[edge.from], systems[edge.to], edge.distance));
+    }
     
-    warpLanes.push_back(lane);
+    for (uint32_t i = 0; i < systems.size(); i++) {
+        auto& connections = systems[i].connections;
+        connections.clear();
+        connections.reserve(lanes.degree(i));
+        for (uint32_t neighbor : lanes.neighbors(i)) {
+            connections.push_back(systems[neighbor].id);
+        }
+    }
     
-    // Update connections
-    connections[system1.id].push_back(system2.id);
-    connections[system2.id].push_back(system1.id);
-    system1.connections.push_back(system2.id);
-    system2.connections.push_back(system1.id);
+    return warpLanes;
 }
 
-void GalaxyGenerator::ensureMinimumConnectivity(std::vector<StarSystem>& systems,
-                                              std::vector<WarpLane>& warpLanes,
-                                              std::unordered_map<std::string, std::vector<std::string>>& connections) {
+void GalaxyGenerator::ensureMinimumConnectivity(const std::vector<StarSystem>& systems, LaneGraph& lanes) {
     // Find isolated systems
-    for (auto& system : systems) {
-        if (connections[system.id].empty()) {
+    for (uint32_t current = 0; current < systems.size(); current++) {
+        if (lanes.degree(current) == 0) {
             // Find nearest system
-            StarSystem* nearest = nullptr;
-            double minDistance = std::numeric_limits<double>::max();
+            auto closest = systemIndex.nearest(geometry.x[current], geometry.y[current], 1, [current](size_t index) {
+                return index != current;
+            });
             
-            for (auto& other : systems) {
-                if (other.id != system.id) {
-                    double distance = calculateDistance({system.x, system.y}, {other.x, other.y});
-                    if (distance < minDistance) {
-                        minDistance = distance;
-                        nearest = &other;
-                    }
+            if (!closest.empty()) {  // Always connect isolated systems, regardless of distance
+                double minDistance = closest[0].first;
+                uint32_t nearest = static_cast<uint32_t>(closest[0].second);
+                createWarpLane(current, nearest, minDistance, lanes);
+                if (logEnabled(LogLevel::Debug)) {
+                    std::cout << "🔗 Connected isolated system " << systems[current].name 
+                             << " to " << systems[nearest].name << " (" << minDistance << " LY)\n";
                 }
             }
-            
-            if (nearest) {  // Always connect isolated systems, regardless of distance
-                createWarpLane(system, *nearest, minDistance, warpLanes, connections);
-                std::cout << "🔗 Connected isolated system " << system.name 
-                         << " to " << nearest->name << " (" << minDistance << " LY)" << std::endl;
-            }
         }
     }
 }
 
-void GalaxyGenerator::ensureNetworkConnectivity(std::vector<StarSystem>& systems,
-                                              std::vector<WarpLane>& warpLanes,
-                                              std::unordered_map<std::string, std::vector<std::string>>& connections) {
-    std::cout << "🌉 Ensuring network connectivity using MST approach..." << std::endl;
-    
-    if (systems.size() < 2) return;
-    
-    // Create mapping from system ID to index for union-find
-    std::unordered_map<std::string, size_t> systemToIndex;
-    for (size_t i = 0; i < systems.size(); i++) {
-        systemToIndex[systems[i].id] = i;
+void GalaxyGenerator::ensureNetworkConnectivity(const std::vector<StarSystem>& systems, LaneGraph& lanes) {
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "🌉 Ensuring network connectivity using MST approach...\n";
     }
     
-    // Union-Find data structures
-    std::vector<size_t> parent(systems.size());
-    std::vector<size_t> rank(systems.size(), 0);
+    if (systems.size() < 2) return;
+    if (systemIndex.size() != systems.size()) indexSystems(systems);
     
-    // Initialize union-find
-    for (size_t i = 0; i < systems.size(); i++) {
-        parent[i] = i;
+    // Mark existing connections in union-find
+    DisjointSet components(systems.size());
+    for (const auto& edge : lanes.edges()) {
+        components.unite(edge.from, edge.to);
     }
-    
-    // Find function for union-find
-    std::function<size_t(size_t)> find = [&](size_t x) -> size_t {
-        if (parent[x] != x) {
-            parent[x] = find(parent[x]);
+    if (components.componentCount() == 1) return;
+    
+    // Borůvka over components: each round picks the shortest lane leaving every
+    // component except the largest (which is reached by the others anyway),
+    // found with nearest-foreign-system queries on the spatial index. These are
+    // exactly the lanes Kruskal over all cross-component pairs would choose.
+    typedef std::pair<double, std::pair<uint32_t, uint32_t>> Bridge;
+    std::vector<Bridge> bridgeEdges;
+    DisjointSet merged = components;
+    
+    while (merged.componentCount() > 1) {
+        uint32_t largest = 0;
+        for (uint32_t i = 0; i < systems.size(); i++) {
+            if (merged.setSize(i) > merged.setSize(largest)) largest = merged.find(i);
         }
-        return parent[x];
-    };
-    
-    // Union function for union-find
-    auto unite = [&](size_t x, size_t y) -> bool {
-        size_t px = find(x);
-        size_t py = find(y);
-        if (px == py) return false;
+        largest = merged.find(largest);
         
-        if (rank[px] < rank[py]) {
-            parent[px] = py;
-        } else if (rank[px] > rank[py]) {
-            parent[py] = px;
-        } else {
-            parent[py] = px;
-            rank[px]++;
+        // Shortest outgoing lane per component root, ordered by (distance, u, v)
+        std::unordered_map<uint32_t, Bridge> cheapest;
+        for (uint32_t i = 0; i < systems.size(); i++) {
+            uint32_t root = merged.find(i);
+            if (root == largest) continue;
+            
+            auto closest = systemIndex.nearest(geometry.x[i], geometry.y[i], 1, [&](size_t index) {
+                return merged.find(static_cast<uint32_t>(index)) != root;
+            });
+            if (closest.empty()) continue;
+            
+            uint32_t j = static_cast<uint32_t>(closest[0].second);
+            uint32_t u = std::min(i, j), v = std::max(i, j);
+            Bridge candidate = {geometry.distance(u, v), {u, v}};
+            
+            auto it = cheapest.find(root);
+            if (it == cheapest.end() || candidate < it->second) {
+                cheapest[root] = candidate;
+            }
         }
-        return true;
-    };
-    
-    // Mark existing connections in union-find
-    for (const auto& lane : warpLanes) {
-        auto it1 = systemToIndex.find(lane.from);
-        auto it2 = systemToIndex.find(lane.to);
         
-        if (it1 != systemToIndex.end() && it2 != systemToIndex.end()) {
-            unite(it1->second, it2->second);
-        }
-    }
-    
-    // Find disconnected components and connect them with minimal bridges
-    std::vector<std::pair<double, std::pair<size_t, size_t>>> bridgeEdges;
-    
-    // Only consider edges between different components
-    for (size_t i = 0; i < systems.size(); i++) {
-        for (size_t j = i + 1; j < systems.size(); j++) {
-            if (find(i) != find(j)) { // Different components
-                double dist = calculateDistance({systems[i].x, systems[i].y},
-                                              {systems[j].x, systems[j].y});
-                bridgeEdges.push_back({dist, {i, j}});
+        for (const auto& entry : cheapest) {
+            const Bridge& bridge = entry.second;
+            if (merged.unite(bridge.second.first, bridge.second.second)) {
+                bridgeEdges.push_back(bridge);
             }
         }
     }
@@ -544,69 +894,63 @@ void GalaxyGenerator::ensureNetworkConnectivity(std::vector<StarSystem>& systems
     
     int bridgesAdded = 0;
     for (const auto& edge : bridgeEdges) {
-        size_t u = edge.second.first;
-        size_t v = edge.second.second;
+        uint32_t u = edge.second.first;
+        uint32_t v = edge.second.second;
         
         // Only add if this connection bridges different components
-        if (unite(u, v)) {
-            createWarpLane(systems[u], systems[v], edge.first, warpLanes, connections);
+        if (components.unite(u, v)) {
+            createWarpLane(u, v, edge.first, lanes);
             bridgesAdded++;
-            std::cout << "  Added bridge lane: " << systems[u].name << " ↔ " << systems[v].name 
-                     << " (" << edge.first << " LY)" << std::endl;
+            if (logEnabled(LogLevel::Debug)) {
+                std::cout << "  Added bridge lane: " << systems[u].name << " ↔ " << systems[v].name 
+                         << " (" << edge.first << " LY)\n";
+            }
         }
     }
     
-    if (bridgesAdded > 0) {
-        std::cout << "  Added " << bridgesAdded << " bridge connections to ensure full connectivity" << std::endl;
+    if (bridgesAdded > 0 && logEnabled(LogLevel::Debug)) {
+        std::cout << "  Added " << bridgesAdded << " bridge connections to ensure full connectivity\n";
     }
 }
 
 std::string GalaxyGenerator::generateSystemName(int index) {
-    std::vector<std::string> prefixes = {"Alpha", "Beta", "Gamma", "Delta", "Epsilon", "Zeta", "Eta", "Theta"};
-    std::vector<std::string> suffixes = {"Centauri", "Draconis", "Leonis", "Aquarii", "Orionis", "Cygni", "Lyrae"};
-    
-    std::string prefix = prefixes[index % prefixes.size()];
-    std::string suffix = suffixes[(index / prefixes.size()) % suffixes.size()];
+    const char* prefix = kSystemNamePrefixes[index % arraySize(kSystemNamePrefixes)];
+    const char* suffix = kSystemNameSuffixes[(index / arraySize(kSystemNamePrefixes)) % arraySize(kSystemNameSuffixes)];
     
-    return prefix + " " + suffix;
+    std::string name(prefix);
+    name += ' ';
+    name += suffix;
+    return name;
 }
 
-std::string GalaxyGenerator::generateAnomalyName(const std::string& type, int index) {
-    std::unordered_map<std::string, std::vector<std::string>> typeNames = {
-        {"nebula", {"Crimson Nebula", "Azure Cloud", "Stellar Nursery", "Dark Nebula"}},
-        {"blackhole", {"Void Maw", "Event Horizon", "Singularity", "Dark Star"}},
-        {"wormhole", {"Quantum Gate", "Space Fold", "Dimensional Rift", "Warp Tunnel"}},
-        {"artifact", {"Ancient Relic", "Precursor Site", "Mysterious Structure", "Alien Beacon"}},
-        {"resource", {"Asteroid Field", "Resource Cluster", "Mining Zone", "Rare Elements"}}
-    };
-    
-    auto& names = typeNames[type];
-    return names[index % names.size()] + " " + std::to_string((index / names.size()) + 1);
+std::string GalaxyGenerator::generateAnomalyName(AnomalyType type, int index) {
+    const auto& names = kAnomalyKinds[static_cast<size_t>(type)].names;
+    std::string name(names[index % arraySize(names)]);
+    name += ' ';
+    name += std::to_string((index / arraySize(names)) + 1);
+    return name;
 }
 
-std::string GalaxyGenerator::determineSystemType(const std::pair<double, double>& position) {
+SystemTier GalaxyGenerator::determineSystemType(const std::pair<double, double>& position) {
     double distanceFromOrigin = std::sqrt(position.first * position.first + position.second * position.second);
     
     // Systems up to 300 LY from origin are considered "core" for connectivity purposes
-    if (distanceFromOrigin <= 300.0) return "core";
-    return "rim";
+    if (distanceFromOrigin <= 300.0) return SystemTier::Core;
+    return SystemTier::Rim;
 }
 
-std::string GalaxyGenerator::generateAnomalyType() {
-    std::vector<std::string> types = {"nebula", "blackhole", "wormhole", "artifact", "resource"};
-    std::vector<double> weights = {0.4, 0.1, 0.1, 0.2, 0.2};
-    
+AnomalyType GalaxyGenerator::generateAnomalyType() {
     double random_val = random.next();
     double cumulative = 0;
     
-    for (size_t i = 0; i < types.size(); i++) {
-        cumulative += weights[i];
+    for (size_t i = 0; i < arraySize(kAnomalyKinds); i++) {
+        cumulative += kAnomalyKinds[i].weight;
         if (random_val < cumulative) {
-            return types[i];
+            return static_cast<AnomalyType>(i);
         }
     }
     
-    return "nebula";
+    return AnomalyType::Nebula;
 }
 
 // ============================================================================
@@ -617,10 +961,16 @@ std::vector<VoronoiSite> GalaxyGenerator::generateVoronoiSites(int numSites) {
     std::vector<VoronoiSite> sites;
     sites.reserve(numSites);
     
-    std::cout << "📐 Generating " << numSites << " Voronoi sites (original game approach)" << std::endl;
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "📐 Generating " << numSites << " Voronoi sites (original game approach)\n";
+    }
     
     // Use original game's simple approach: uniform distribution with only minimum distance
     const double minDistance = 2.5;  // Minimum distance between any two systems (slightly more than original 2.0)
+    if (config.generation.parallel) {
+        return generateVoronoiSitesTiled(numSites, minDistance);
+    }
+    siteIndex.reset(config.radius, SpatialGrid::cellSizeFor(config.radius, numSites, minDistance));
     
     for (int i = 0; i < numSites; i++) {
         std::pair<double, double> pos;
@@ -635,48 +985,184 @@ std::vector<VoronoiSite> GalaxyGenerator::generateVoronoiSites(int numSites) {
             VoronoiSite site;
             site.x = pos.first;
             site.y = pos.second;
-            site.systemId = "";
+            site.systemIndex = 0;
             site.hasSystem = false;
             sites.push_back(site);
+            siteIndex.insert(site.x, site.y);
         }
     }
     
-    std::cout << "✅ Generated " << sites.size() << " Voronoi sites using original game distribution" << std::endl;
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "✅ Generated " << sites.size() << " Voronoi sites using original game distribution\n";
+    }
     return sites;
 }
 
 bool GalaxyGenerator::isValidVoronoiPosition(const std::pair<double, double>& pos, double minDistance) {
-    for (const auto& site : voronoiSites) {
-        if (calculateDistance(pos, {site.x, site.y}) < minDistance) {
-            return false;
+    return !siteIndex.anyWithin(pos.first, pos.second, minDistance);
+}
+
+std::vector<VoronoiSite> GalaxyGenerator::generateVoronoiSitesTiled(int numSites, double minDistance) {
+    struct SiteTile {
+        double minX, minY;
+        double weight;  // Share of the galaxy disc covered by this tile
+        int quota;
+        SpatialGrid grid;
+        std::vector<std::pair<double, double>> sites;
+    };
+    
+    // The tile layout depends only on the config, never on the thread count.
+    // Tiles are at least minDistance wide so conflicts only cross adjacent tiles.
+    const double radius = config.radius;
+    int tilesPerSide = static_cast<int>(std::sqrt(numSites / 256.0));
+    tilesPerSide = std::max(2, std::min(tilesPerSide, 64));
+    tilesPerSide = std::max(1, std::min(tilesPerSide, static_cast<int>(2.0 * radius / minDistance)));
+    const double tileSize = 2.0 * radius / tilesPerSide;
+    
+    std::vector<SiteTile> tiles(static_cast<size_t>(tilesPerSide) * tilesPerSide);
+    
+    // Estimate each tile's share of the disc on a fixed sample lattice
+    const int samples = 32;
+    double totalWeight = 0.0;
+    for (int ty = 0; ty < tilesPerSide; ty++) {
+        for (int tx = 0; tx < tilesPerSide; tx++) {
+            SiteTile& tile = tiles[ty * tilesPerSide + tx];
+            tile.minX = -radius + tx * tileSize;
+            tile.minY = -radius + ty * tileSize;
+            
+            int inside = 0;
+            for (int sy = 0; sy < samples; sy++) {
+                for (int sx = 0; sx < samples; sx++) {
+                    double x = tile.minX + (sx + 0.5) * tileSize / samples;
+                    double y = tile.minY + (sy + 0.5) * tileSize / samples;
+                    if (x * x + y * y <= radius * radius) inside++;
+                }
+            }
+            tile.weight = static_cast<double>(inside) / (samples * samples);
+            totalWeight += tile.weight;
         }
     }
-    return true;
+    
+    // Split the site budget by area, handing out the remainder by largest fraction
+    std::vector<std::pair<double, size_t>> remainders;
+    int assigned = 0;
+    for (size_t t = 0; t < tiles.size(); t++) {
+        double share = totalWeight > 0.0 ? numSites * tiles[t].weight / totalWeight : 0.0;
+        tiles[t].quota = static_cast<int>(share);
+        assigned += tiles[t].quota;
+        remainders.push_back({-(share - tiles[t].quota), t});
+    }
+    std::sort(remainders.begin(), remainders.end());
+    for (size_t r = 0; assigned < numSites && r < remainders.size(); r++) {
+        if (tiles[remainders[r].second].weight <= 0.0) continue;
+        tiles[remainders[r].second].quota++;
+        assigned++;
+    }
+    
+    auto fillTile = [&](size_t t) {
+        SiteTile& tile = tiles[t];
+        const int tx = static_cast<int>(t % tilesPerSide);
+        const int ty = static_cast<int>(t / tilesPerSide);
+        const double halfSize = tileSize * 0.5;
+        SeededRandom rng = SeededRandom::stream(config.seed, GenerationStage::Sites, t);
+        
+        tile.grid.reset(tile.minX + halfSize, tile.minY + halfSize, halfSize,
+                        SpatialGrid::cellSizeFor(halfSize, tile.quota, minDistance));
+        
+        auto isValid = [&](double x, double y) {
+            for (int ny = std::max(0, ty - 1); ny <= std::min(tilesPerSide - 1, ty + 1); ny++) {
+                for (int nx = std::max(0, tx - 1); nx <= std::min(tilesPerSide - 1, tx + 1); nx++) {
+                    if (tiles[ny * tilesPerSide + nx].grid.anyWithin(x, y, minDistance)) return false;
+                }
+            }
+            return true;
+        };
+        
+        for (int i = 0; i < tile.quota; i++) {
+            for (int attempts = 0; attempts < 500; attempts++) {
+                double x = tile.minX + rng.next() * tileSize;
+                double y = tile.minY + rng.next() * tileSize;
+                if (x * x + y * y > radius * radius || !isValid(x, y)) continue;
+                
+                tile.grid.insert(x, y);
+                tile.sites.push_back({x, y});
+                break;
+            }
+        }
+    };
+    
+    // 2x2 colouring: tiles of one colour never touch, so each phase can fill
+    // its tiles concurrently while reading finished neighbours from earlier phases
+    for (int phase = 0; phase < 4; phase++) {
+        std::vector<size_t> phaseTiles;
+        for (size_t t = 0; t < tiles.size(); t++) {
+            int tx = static_cast<int>(t % tilesPerSide);
+            int ty = static_cast<int>(t / tilesPerSide);
+            if ((tx % 2) + 2 * (ty % 2) == phase) phaseTiles.push_back(t);
+        }
+        parallelFor(phaseTiles.size(), workerCount(), [&](size_t i) { fillTile(phaseTiles[i]); });
+    }
+    
+    std::vector<VoronoiSite> sites;
+    sites.reserve(numSites);
+    siteIndex.reset(config.radius, SpatialGrid::cellSizeFor(config.radius, numSites, minDistance));
+    for (const SiteTile& tile : tiles) {
+        for (const auto& position : tile.sites) {
+            VoronoiSite site;
+            site.x = position.first;
+            site.y = position.second;
+            site.systemIndex = 0;
+            site.hasSystem = false;
+            sites.push_back(site);
+            siteIndex.insert(site.x, site.y);
+        }
+    }
+    
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "✅ Generated " << sites.size() << " Voronoi sites across " << tiles.size() << " tiles\n";
+    }
+    return sites;
 }
 
 void GalaxyGenerator::computeVoronoiNeighbors() {
-    std::cout << "🔗 Computing Voronoi neighbor relationships (original game approach)..." << std::endl;
-    
     // Clear existing neighbor relationships
     for (auto& site : voronoiSites) {
         site.neighbors.clear();
     }
     
-    // Use original game's conservative approach: connect each site to only 1-3 closest neighbors
-    for (size_t i = 0; i < voronoiSites.size(); i++) {
-        std::vector<std::pair<double, size_t>> distances;
+    if (config.connectivity.mode == ConnectivityMode::Delaunay) {
+        if (logEnabled(LogLevel::Info)) {
+            std::cout << "🔗 Computing Voronoi neighbor relationships (Delaunay triangulation)...\n";
+        }
         
-        // Calculate distances to all other sites
-        for (size_t j = 0; j < voronoiSites.size(); j++) {
-            if (i != j) {
-                double dist = calculateDistance({voronoiSites[i].x, voronoiSites[i].y},
-                                              {voronoiSites[j].x, voronoiSites[j].y});
-                distances.push_back({dist, j});
-            }
+        std::vector<std::pair<double, double>> positions;
+        positions.reserve(voronoiSites.size());
+        for (const auto& site : voronoiSites) {
+            positions.push_back({site.x, site.y});
         }
         
-        // Sort by distance
-        std::sort(distances.begin(), distances.end());
+        // Edges come back sorted, so every neighbor list ends up in ascending order
+        for (const auto& edge : computeDelaunayEdges(positions)) {
+            voronoiSites[edge.first].neighbors.push_back(edge.second);
+            voronoiSites[edge.second].neighbors.push_back(edge.first);
+        }
+        
+        if (logEnabled(LogLevel::Info)) {
+            std::cout << "✅ Computed Delaunay neighbor relationships for " << voronoiSites.size() << " sites\n";
+        }
+        return;
+    }
+    
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "🔗 Computing Voronoi neighbor relationships (original game approach)...\n";
+    }
+    
+    // Use original game's conservative approach: connect each site to only 1-3 closest neighbors
+    std::vector<size_t> nearestCount(voronoiSites.size(), 0);
+    parallelFor(voronoiSites.size(), workerCount(), [&](size_t i) {
+        // Closest sites first, via the spatial index
+        std::vector<std::pair<double, size_t>> distances =
+            siteIndex.nearest(voronoiSites[i].x, voronoiSites[i].y, 6, [i](size_t j) { return j != i; });
         
         // Create initial connections - connect to more neighbors for better connectivity
         int maxConnections = std::min(6, static_cast<int>(distances.size()));  // Up to 6 instead of 3
@@ -693,27 +1179,34 @@ void GalaxyGenerator::computeVoronoiNeighbors() {
                 voronoiSites[i].neighbors.push_back(neighborIdx);
             }
         }
-        
-        // Debug output removed for production
-    }
+        nearestCount[i] = voronoiSites[i].neighbors.size();
+    });
     
-    // Make neighbor relationships symmetric
+    // Make neighbor relationships symmetric. Only the (at most six) nearest
+    // entries of the other site need checking: anything appended after them is
+    // a back-link to an earlier site, which can never be i.
     for (size_t i = 0; i < voronoiSites.size(); i++) {
-        for (size_t neighborIdx : voronoiSites[i].neighbors) {
+        for (size_t k = 0; k < nearestCount[i]; k++) {
+            size_t neighborIdx = voronoiSites[i].neighbors[k];
             auto& neighborNeighbors = voronoiSites[neighborIdx].neighbors;
-            if (std::find(neighborNeighbors.begin(), neighborNeighbors.end(), i) == neighborNeighbors.end()) {
+            auto nearestEnd = neighborNeighbors.begin() + nearestCount[neighborIdx];
+            if (std::find(neighborNeighbors.begin(), nearestEnd, i) == nearestEnd) {
                 neighborNeighbors.push_back(i);
             }
         }
     }
     
-    std::cout << "✅ Computed conservative neighbor relationships for " << voronoiSites.size() << " sites" << std::endl;
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "✅ Computed conservative neighbor relationships for " << voronoiSites.size() << " sites\n";
+    }
 }
 
 std::vector<StarSystem> GalaxyGenerator::generateSystemsFromVoronoi() {
     std::vector<StarSystem> systems;
     
-    std::cout << "🌟 Assigning systems to Voronoi sites..." << std::endl;
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "🌟 Assigning systems to Voronoi sites...\n";
+    }
     
     // First, place fixed systems at closest Voronoi sites
     for (const auto& fixedSystem : config.fixedSystems) {
@@ -737,29 +1230,25 @@ std::vector<StarSystem> GalaxyGenerator::generateSystemsFromVoronoi() {
             systemX = distance * std::cos(angle);
             systemY = distance * std::sin(angle);
             
-            std::cout << "  Placed " << fixedSystem.name << " at distance " 
-                     << std::sqrt(systemX * systemX + systemY * systemY) 
-                     << " LY (target: " << targetDist << " ± " << tolerance << ")" << std::endl;
+            if (logEnabled(LogLevel::Debug)) {
+                std::cout << "  Placed " << fixedSystem.name << " at distance " 
+                         << std::sqrt(systemX * systemX + systemY * systemY) 
+                         << " LY (target: " << targetDist << " ± " << tolerance << ")\n";
+            }
         }
         
-        // Find closest Voronoi site to the system position
+        // Find closest unassigned Voronoi site to the system position
         size_t closestSite = 0;
-        double minDistance = std::numeric_limits<double>::max();
-        
-        for (size_t i = 0; i < voronoiSites.size(); i++) {
-            if (voronoiSites[i].hasSystem) continue;
-            
-            double dist = calculateDistance({systemX, systemY}, 
-                                          {voronoiSites[i].x, voronoiSites[i].y});
-            if (dist < minDistance) {
-                minDistance = dist;
-                closestSite = i;
-            }
+        auto closest = siteIndex.nearest(systemX, systemY, 1, [&](size_t i) {
+            return !voronoiSites[i].hasSystem;
+        });
+        if (!closest.empty()) {
+            closestSite = closest[0].second;
         }
         
         // Assign system to this site
         voronoiSites[closestSite].hasSystem = true;
-        voronoiSites[closestSite].systemId = fixedSystem.id;
+        voronoiSites[closestSite].systemIndex = static_cast<uint32_t>(systems.size());
         
         StarSystem system;
         // Explicitly initialize all fields to avoid corruption
@@ -770,8 +1259,9 @@ std::vector<StarSystem> GalaxyGenerator::generateSystemsFromVoronoi() {
         system.type = fixedSystem.type;
         system.isFixed = true;
         system.connections.clear();
-        system.explored = (fixedSystem.type == "origin");
-        system.population = (fixedSystem.type == "origin") ? 1000000 : 0;
+        bool origin = systemTierFromType(fixedSystem.type) == SystemTier::Origin;
+        system.explored = origin;
+        system.population = origin ? 1000000 : 0;
         system.gdp = system.population * random.range(0.8, 1.5);
         
         // Explicitly initialize resources
@@ -796,8 +1286,7 @@ std::vector<StarSystem> GalaxyGenerator::generateSystemsFromVoronoi() {
             system.detailedSystem = detailedSystem;
         } else {
             // Use random generation
-            std::vector<std::string> starTypes = {"G-class", "K-class", "M-class", "F-class", "A-class"};
-            system.systemInfo.starType = starTypes[random.intRange(0, starTypes.size() - 1)];
+            system.systemInfo.starType = kStarTypes[random.intRange(0, static_cast<int>(arraySize(kStarTypes)) - 1)];
             system.systemInfo.planetCount = random.intRange(4, 10); // Updated to new rules
             system.systemInfo.moonCount = random.intRange(0, system.systemInfo.planetCount / 2);
             system.systemInfo.asteroidCount = random.intRange(0, 5);
@@ -806,78 +1295,102 @@ std::vector<StarSystem> GalaxyGenerator::generateSystemsFromVoronoi() {
         
         systems.push_back(system);
         
-        std::cout << "  Fixed system: " << system.name << " at (" << system.x << ", " << system.y << ")" << std::endl;
+        if (logEnabled(LogLevel::Debug)) {
+            std::cout << "  Fixed system: " << system.name << " at (" << system.x << ", " << system.y << ")\n";
+        }
     }
     
-    // Generate remaining systems at remaining Voronoi sites
-    int systemIndex = 1;
-    for (size_t i = 0; i < voronoiSites.size() && systems.size() < static_cast<size_t>(config.starSystemCount); i++) {
+    // Generate remaining systems at remaining Voronoi sites, in site order
+    std::vector<size_t> freeSites;
+    for (size_t i = 0; i < voronoiSites.size() && systems.size() + freeSites.size() < static_cast<size_t>(config.starSystemCount); i++) {
         if (voronoiSites[i].hasSystem) continue;
         
         voronoiSites[i].hasSystem = true;
-        voronoiSites[i].systemId = "system-" + std::to_string(systemIndex);
-        
-        StarSystem system;
-        // Explicitly initialize all fields to avoid corruption
-        system.id = voronoiSites[i].systemId;
-        system.name = generateSystemName(systemIndex);
-        system.x = voronoiSites[i].x;
-        system.y = voronoiSites[i].y;
-        system.type = determineSystemType({system.x, system.y});
-        system.isFixed = false;
-        system.connections.clear();
-        system.explored = false;
-        system.population = 0;
-        system.gdp = 0.0;
-        
-        // Explicitly initialize resources
-        system.resources.minerals = random.intRange(10, 150);
-        system.resources.energy = random.intRange(10, 150);
-        system.resources.research = random.intRange(10, 150);
-        
-        // Generate random system using new rules
-        SystemDefinition randomSystemDef = systemConfigManager.generateRandomSystem(system.id, system.name);
-        system.systemInfo.starType = randomSystemDef.starType;
-        system.systemInfo.planetCount = randomSystemDef.planets.size();
-        
-        // Count moons from generated system
-        int totalMoons = 0;
-        for (const auto& planet : randomSystemDef.planets) {
-            totalMoons += planet.moons.size();
+        voronoiSites[i].systemIndex = static_cast<uint32_t>(systems.size() + freeSites.size());
+        freeSites.push_back(i);
+    }
+    
+    const size_t firstGenerated = systems.size();
+    systems.resize(firstGenerated + freeSites.size());
+    if (config.generation.parallel) {
+        // Each system draws from its own stream, so scheduling cannot change the result
+        parallelFor(freeSites.size(), workerCount(), [&](size_t k) {
+            SeededRandom rng = SeededRandom::stream(config.seed, GenerationStage::Systems, k);
+            systems[firstGenerated + k] = createVoronoiSystem(voronoiSites[freeSites[k]], static_cast<int>(k + 1), rng);
+        });
+    } else {
+        for (size_t k = 0; k < freeSites.size(); k++) {
+            systems[firstGenerated + k] = createVoronoiSystem(voronoiSites[freeSites[k]], static_cast<int>(k + 1), random);
         }
-        system.systemInfo.moonCount = totalMoons;
-        system.systemInfo.asteroidCount = random.intRange(0, 5); // Few asteroids for random systems
-        system.detailedSystem = nullptr; // Random systems don't store detailed data
-        
-        // Debug output for first few systems
-        if (systemIndex <= 7) {
+    }
+    
+    // Debug output for first few systems
+    for (size_t k = 0; k < freeSites.size() && k < 7; k++) {
+        const StarSystem& system = systems[firstGenerated + k];
+        if (logEnabled(LogLevel::Debug)) {
             std::cout << "  " << system.name << " (Voronoi) system info: " 
                      << "star=" << system.systemInfo.starType
                      << " planets=" << system.systemInfo.planetCount 
                      << " moons=" << system.systemInfo.moonCount
                      << " asteroids=" << system.systemInfo.asteroidCount
-                     << " gdp=" << system.gdp << std::endl;
+                     << " gdp=" << system.gdp << '\n';
         }
-        
-        systems.push_back(system);
-        systemIndex++;
     }
     
-    std::cout << "✅ Generated " << systems.size() << " star systems using Voronoi distribution" << std::endl;
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "✅ Generated " << systems.size() << " star systems using Voronoi distribution\n";
+    }
     return systems;
 }
 
-std::vector<WarpLane> GalaxyGenerator::generateVoronoiWarpLanes(std::vector<StarSystem>& systems) {
-    std::vector<WarpLane> warpLanes;
-    std::unordered_map<std::string, std::vector<std::string>> connections;
+StarSystem GalaxyGenerator::createVoronoiSystem(const VoronoiSite& site, int systemNumber, SeededRandom& rng) {
+    StarSystem system;
+    // Explicitly initialize all fields to avoid corruption
+    system.id = "system-" + std::to_string(systemNumber);
+    system.name = generateSystemName(systemNumber);
+    system.x = site.x;
+    system.y = site.y;
+    system.type = systemTierName(determineSystemType({system.x, system.y}));
+    system.isFixed = false;
+    system.connections.clear();
+    system.explored = false;
+    system.population = 0;
+    system.gdp = 0.0;
+    
+    // Explicitly initialize resources
+    system.resources.minerals = rng.intRange(10, 150);
+    system.resources.energy = rng.intRange(10, 150);
+    system.resources.research = rng.intRange(10, 150);
+    
+    // Generate random system using new rules
+    SystemDefinition randomSystemDef = systemConfigManager.generateRandomSystem(system.id, system.name);
+    system.systemInfo.starType = randomSystemDef.starType;
+    system.systemInfo.planetCount = randomSystemDef.planets.size();
+    
+    // Count moons from generated system
+    int totalMoons = 0;
+    for (const auto& planet : randomSystemDef.planets) {
+        totalMoons += planet.moons.size();
+    }
+    system.systemInfo.moonCount = totalMoons;
+    system.systemInfo.asteroidCount = rng.intRange(0, 5); // Few asteroids for random systems
+    system.detailedSystem = nullptr; // Random systems don't store detailed data
     
-    std::cout << "🔗 Generating warp lanes using Voronoi connectivity..." << std::endl;
+    return system;
+}
+
+LaneGraph GalaxyGenerator::generateVoronoiWarpLanes(const std::vector<StarSystem>& systems) {
+    LaneGraph lanes(systems.size());
     
-    // Initialize connection tracking
-    for (auto& system : systems) {
-        connections[system.id] = std::vector<std::string>();
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "🔗 Generating warp lanes using Voronoi connectivity...\n";
     }
     
+    // Calculate base distance threshold
+    double baseVoronoiDistance = config.connectivity.maxDistance * 1.5;
+    double galaxyScaledDistance = config.radius * 0.25;  // 25% of galaxy radius
+    double baseMaxDistance = std::max(baseVoronoiDistance, galaxyScaledDistance);
+    
     // Create warp lanes based on Voronoi neighbor relationships
     int potentialLanes = 0;
     int createdLanes = 0;
@@ -892,72 +1405,65 @@ std::vector<WarpLane> GalaxyGenerator::generateVoronoiWarpLanes(std::vector<Star
             if (i < neighborIdx) {
                 potentialLanes++;
                 
-                // Find the systems corresponding to these sites
-                StarSystem* system1 = nullptr;
-                StarSystem* system2 = nullptr;
+                uint32_t index1 = voronoiSites[i].systemIndex;
+                uint32_t index2 = voronoiSites[neighborIdx].systemIndex;
                 
-                for (auto& sys : systems) {
-                    if (sys.id == voronoiSites[i].systemId) system1 = &sys;
-                    if (sys.id == voronoiSites[neighborIdx].systemId) system2 = &sys;
-                }
+                double distance = geometry.distance(index1, index2);
+                
+                // Apply tiered connectivity based on system types
+                double maxVoronoiDistance = calculateTieredDistance(index1, index2, baseMaxDistance);
                 
-                if (system1 && system2) {
-                    double distance = calculateDistance({system1->x, system1->y}, {system2->x, system2->y});
-                    
-                    // Calculate base distance threshold
-                    double baseVoronoiDistance = config.connectivity.maxDistance * 1.5;
-                    double galaxyScaledDistance = config.radius * 0.25;  // 25% of galaxy radius
-                    double baseMaxDistance = std::max(baseVoronoiDistance, galaxyScaledDistance);
-                    
-                    // Apply tiered connectivity based on system types
-                    double maxVoronoiDistance = calculateTieredDistance(system1, system2, baseMaxDistance);
-                    
-                    if (distance <= maxVoronoiDistance) {
-                        createWarpLane(*system1, *system2, distance, warpLanes, connections);
-                        createdLanes++;
-                    }
+                if (distance <= maxVoronoiDistance) {
+                    createWarpLane(index1, index2, distance, lanes);
+                    createdLanes++;
                 }
             }
         }
     }
     
-    std::cout << "  Evaluated " << potentialLanes << " potential lanes, created " << createdLanes << std::endl;
+    if (logEnabled(LogLevel::Debug)) {
+        std::cout << "  Evaluated " << potentialLanes << " potential lanes, created " << createdLanes << '\n';
+    }
     
     // Ensure minimum connectivity using traditional approach as fallback
-    ensureMinimumConnectivity(systems, warpLanes, connections);
+    ensureMinimumConnectivity(systems, lanes);
     
     // Ensure full network connectivity (critical for Voronoi method)
-    ensureNetworkConnectivity(systems, warpLanes, connections);
+    ensureNetworkConnectivity(systems, lanes);
     
-    std::cout << "✅ Generated " << warpLanes.size() << " warp lanes using Voronoi method" << std::endl;
-    return warpLanes;
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "✅ Generated " << lanes.edgeCount() << " warp lanes using Voronoi method\n";
+    }
+    return lanes;
 }
 
-void GalaxyGenerator::addRedundantConnections(std::vector<StarSystem>& systems,
-                                            std::vector<WarpLane>& warpLanes,
-                                            std::unordered_map<std::string, std::vector<std::string>>& connections) {
-    std::cout << "🔗 Adding strategic redundant connections..." << std::endl;
+void GalaxyGenerator::addRedundantConnections(const std::vector<StarSystem>& systems, LaneGraph& lanes) {
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "🔗 Adding strategic redundant connections...\n";
+    }
     
     if (systems.size() < 3) {
-        std::cout << "  Not enough systems for redundant connections." << std::endl;
+        if (logEnabled(LogLevel::Debug)) {
+            std::cout << "  Not enough systems for redundant connections.\n";
+        }
         return;
     }
     
     // Find vulnerable systems (systems with 1-2 connections or far from center)
-    std::vector<StarSystem*> vulnerableSystems;
+    std::vector<uint32_t> vulnerableSystems;
     double centerX = 0, centerY = 0;
     
     // Calculate galaxy center
-    for (const auto& system : systems) {
-        centerX += system.x;
-        centerY += system.y;
+    for (size_t i = 0; i < geometry.size(); i++) {
+        centerX += geometry.x[i];
+        centerY += geometry.y[i];
     }
     centerX /= systems.size();
     centerY /= systems.size();
     
-    for (auto& system : systems) {
-        int connectionCount = connections[system.id].size();
-        double distanceFromCenter = calculateDistance({system.x, system.y}, {centerX, centerY});
+    for (uint32_t i = 0; i < systems.size(); i++) {
+        int connectionCount = lanes.degree(i);
+        double distanceFromCenter = geometry.distanceTo(i, centerX, centerY);
         
         // Mark as vulnerable if:
         // - Has only 1-2 connections, OR
@@ -966,154 +1472,149 @@ void GalaxyGenerator::addRedundantConnections(std::vector<StarSystem>& systems,
                            (distanceFromCenter > config.radius * 0.6 && connectionCount < 4);
         
         if (isVulnerable) {
-            vulnerableSystems.push_back(&system);
+            vulnerableSystems.push_back(i);
         }
     }
     
-    std::cout << "  Found " << vulnerableSystems.size() << " vulnerable/outlying systems" << std::endl;
+    if (logEnabled(LogLevel::Debug)) {
+        std::cout << "  Found " << vulnerableSystems.size() << " vulnerable/outlying systems\n";
+    }
     
     // Add redundant connections for vulnerable systems
     int redundantConnectionsAdded = 0;
     const int maxRedundantConnections = std::min(static_cast<int>(systems.size() / 4), 40);  // Slightly more generous for gameplay
+    size_t maxDegree = 0;
+    for (uint32_t i = 0; i < systems.size(); i++) {
+        maxDegree = std::max(maxDegree, lanes.degree(i));
+    }
+    std::vector<std::pair<double, uint32_t>> potentialConnections;
     
-    for (StarSystem* vulnSystem : vulnerableSystems) {
+    for (uint32_t vulnIndex : vulnerableSystems) {
         if (redundantConnectionsAdded >= maxRedundantConnections) break;
         
-        // Find potential connection targets (systems not already connected)
-        std::vector<std::pair<double, StarSystem*>> potentialConnections;
-        
-        for (auto& system : systems) {
-            StarSystem* targetSystem = &system;
-            
-            // Skip if same system or already connected
-            if (targetSystem == vulnSystem) continue;
-            
-            bool alreadyConnected = false;
-            for (const std::string& connectedId : connections[vulnSystem->id]) {
-                if (connectedId == targetSystem->id) {
-                    alreadyConnected = true;
-                    break;
-                }
+        // Add 1-2 redundant connections for this vulnerable system  
+        const size_t connectionsToAdd = (lanes.degree(vulnIndex) == 1) ? 2 : 1;
+        
+        // Find potential connection targets (systems not already connected) among
+        // the nearest systems, widening the query until no system beyond it could
+        // score better: a score divides distance by at most 1 + maxDegree * 0.2
+        for (size_t k = 16;; k *= 4) {
+            auto nearby = systemIndex.nearest(geometry.x[vulnIndex], geometry.y[vulnIndex], k,
+                                              [vulnIndex](size_t index) { return index != vulnIndex; });
+            potentialConnections.clear();
+            for (const auto& candidate : nearby) {
+                uint32_t target = static_cast<uint32_t>(candidate.second);
+                if (lanes.connected(vulnIndex, target)) continue;
+                
+                // Adjust score based on target system's connectivity (prefer well-connected systems)
+                int targetConnections = lanes.degree(target);
+                double connectionScore = candidate.first / (1.0 + targetConnections * 0.2);
+                
+                potentialConnections.push_back({connectionScore, target});
             }
-            if (alreadyConnected) continue;
             
-            double distance = calculateDistance({vulnSystem->x, vulnSystem->y}, 
-                                              {targetSystem->x, targetSystem->y});
+            // Only the best few are looked at, so select them rather than sorting everything
+            // (score, target) pairs are unique, so this matches a full sort's prefix
+            auto selectedEnd = potentialConnections.begin() +
+                               std::min(connectionsToAdd, potentialConnections.size());
+            std::partial_sort(potentialConnections.begin(), selectedEnd, potentialConnections.end());
             
-            // Adjust score based on target system's connectivity (prefer well-connected systems)
-            int targetConnections = connections[targetSystem->id].size();
-            double connectionScore = distance / (1.0 + targetConnections * 0.2);
-            
-            potentialConnections.push_back({connectionScore, targetSystem});
+            if (nearby.size() < k) break;  // Every other system was considered
+            double unseenScore = nearby.back().first / (1.0 + maxDegree * 0.2);
+            if (potentialConnections.size() >= connectionsToAdd &&
+                potentialConnections[connectionsToAdd - 1].first < unseenScore) break;
         }
         
-        // Sort by connection score (distance adjusted for target connectivity)
-        std::sort(potentialConnections.begin(), potentialConnections.end());
-        
-        // Add 1-2 redundant connections for this vulnerable system  
-        int connectionsToAdd = (connections[vulnSystem->id].size() == 1) ? 2 : 1;
-        
-        for (int i = 0; i < connectionsToAdd && 
-                        i < static_cast<int>(potentialConnections.size()) &&
-                        redundantConnectionsAdded < maxRedundantConnections; ++i) {
+        for (size_t i = 0; i < connectionsToAdd && 
+                           i < potentialConnections.size() &&
+                           redundantConnectionsAdded < maxRedundantConnections; ++i) {
             
-            StarSystem* targetSystem = potentialConnections[i].second;
-            double distance = calculateDistance({vulnSystem->x, vulnSystem->y},
-                                              {targetSystem->x, targetSystem->y});
+            uint32_t target = potentialConnections[i].second;
+            double distance = geometry.distance(vulnIndex, target);
             
             // Only add if distance is reasonable (more generous for redundant connections)
             // Use 40% of galaxy radius for redundant connections to ensure better connectivity
             if (distance < config.radius * 0.4) {
-                createWarpLane(*vulnSystem, *targetSystem, distance, warpLanes, connections);
+                createWarpLane(vulnIndex, target, distance, lanes);
+                maxDegree = std::max({maxDegree, lanes.degree(vulnIndex), lanes.degree(target)});
                 redundantConnectionsAdded++;
                 
-                std::cout << "  Added redundant connection: " << vulnSystem->name 
-                         << " ↔ " << targetSystem->name 
-                         << " (distance: " << distance << " LY)" << std::endl;
+                if (logEnabled(LogLevel::Debug)) {
+                    std::cout << "  Added redundant connection: " << systems[vulnIndex].name 
+                             << " ↔ " << systems[target].name 
+                             << " (distance: " << distance << " LY)\n";
+                }
             }
         }
     }
     
+    if (!logEnabled(LogLevel::Debug)) return;
     if (redundantConnectionsAdded > 0) {
         std::cout << "  Added " << redundantConnectionsAdded 
-                 << " redundant connections for network resilience" << std::endl;
+                 << " redundant connections for network resilience\n";
     } else {
-        std::cout << "  No suitable redundant connections found within distance limits" << std::endl;
+        std::cout << "  No suitable redundant connections found within distance limits\n";
     }
 }
 
-double GalaxyGenerator::calculateTieredDistance(const StarSystem* system1, const StarSystem* system2, double baseDistance) {
-    // Determine connectivity tier based on system types
-    // origin system gets +150% range (2.5x) - galactic capital
-    // core systems get +100% range (2.0x) - extremely well connected core
-    // rim systems get -60% range (0.4x) - very isolated outer rim
-    // Mixed connections use the more generous (higher) threshold
-    
-    auto getDistanceMultiplier = [](const std::string& systemType) -> double {
-        if (systemType == "origin") {
-            return 2.5;   // +150% for origin system (galactic capital)
-        } else if (systemType == "core") {
-            return 2.0;   // +100% for core systems (extremely well connected)
-        } else {
-            return 0.4;   // -60% for rim systems (very isolated)
-        }
-    };
-    
-    double multiplier1 = getDistanceMultiplier(system1->type);
-    double multiplier2 = getDistanceMultiplier(system2->type);
-    
-    // Use the more generous (higher) multiplier for mixed connections
-    double finalMultiplier = std::max(multiplier1, multiplier2);
-    
-    return baseDistance * finalMultiplier;
+double GalaxyGenerator::calculateTieredDistance(uint32_t system1, uint32_t system2, double baseDistance) {
+    // Determine connectivity tier based on system types (see kTierRangeMultipliers):
+    // one table load per lane instead of per-end branches
+    size_t tier1 = static_cast<size_t>(geometry.tier[system1]);
+    size_t tier2 = static_cast<size_t>(geometry.tier[system2]);
+    return baseDistance * kTierPairRange[tier1][tier2];
 }
 
-void GalaxyGenerator::verifyConnectivity(const std::vector<StarSystem>& systems,
-                                       const std::unordered_map<std::string, std::vector<std::string>>& connections) {
-    if (systems.empty()) return;
+size_t GalaxyGenerator::verifyConnectivity(const std::vector<StarSystem>& systems, const LaneGraph& lanes) {
+    if (systems.empty()) return 0;
     
-    std::cout << "🔍 Verifying network connectivity..." << std::endl;
+    if (logEnabled(LogLevel::Info)) {
+        std::cout << "🔍 Verifying network connectivity...\n";
+    }
     
     // Use BFS to check if all systems are reachable from the first system
-    std::unordered_set<std::string> visited;
-    std::queue<std::string> toVisit;
+    std::vector<char> visited(systems.size(), 0);
+    std::queue<uint32_t> toVisit;
     
-    toVisit.push(systems[0].id);
-    visited.insert(systems[0].id);
+    toVisit.push(0);
+    visited[0] = 1;
+    int connectedSystems = 1;
     
     while (!toVisit.empty()) {
-        std::string current = toVisit.front();
+        uint32_t current = toVisit.front();
         toVisit.pop();
         
-        auto it = connections.find(current);
-        if (it != connections.end()) {
-            for (const auto& neighbor : it->second) {
-                if (visited.find(neighbor) == visited.end()) {
-                    visited.insert(neighbor);
-                    toVisit.push(neighbor);
-                }
+        for (uint32_t neighbor : lanes.neighbors(current)) {
+            if (!visited[neighbor]) {
+                visited[neighbor] = 1;
+                connectedSystems++;
+                toVisit.push(neighbor);
             }
         }
     }
     
-    int connectedSystems = visited.size();
     int totalSystems = systems.size();
     
     if (connectedSystems == totalSystems) {
-        std::cout << "✅ All " << totalSystems << " systems are connected to the network" << std::endl;
+        if (logEnabled(LogLevel::Info)) {
+            std::cout << "✅ All " << totalSystems << " systems are connected to the network\n";
+        }
     } else {
-        std::cout << "❌ WARNING: Only " << connectedSystems << " of " << totalSystems 
+        std::cerr << "❌ WARNING: Only " << connectedSystems << " of " << totalSystems 
                   << " systems are connected to the network!" << std::endl;
         
         // List disconnected systems
-        std::cout << "   Disconnected systems: ";
-        for (const auto& system : systems) {
-            if (visited.find(system.id) == visited.end()) {
-                std::cout << system.name << " ";
+        if (logEnabled(LogLevel::Debug)) {
+            std::cout << "   Disconnected systems: ";
+            for (size_t i = 0; i < systems.size(); i++) {
+                if (!visited[i]) {
+                    std::cout << systems[i].name << " ";
+                }
             }
+            std::cout << '\n';
         }
-        std::cout << std::endl;
     }
+    return static_cast<size_t>(connectedSystems);
 }
 
 } // namespace space4x
@@ -0,0 +1,176 @@
+#include "galaxy_cache.h"
+#include "json_writer.h"
+#include "route_planner.h"
+#include <cstdint>
+
+namespace space4x {
+
+namespace {
+
+size_t stringBytes(const std::string& s) {
+    return sizeof(std::string) + (s.capacity() > 15 ? s.capacity() : 0);  // Beyond the SSO buffer
+}
+
+} // namespace
+
+// ============================================================================
+// CACHE KEYS
+// ============================================================================
+
+std::string canonicalGalaxyKey(const GalaxyConfig& config) {
+    // Shortest round-trip doubles, so distinct configs never share a key
+    JsonWriter key(256 + config.fixedSystems.size() * 96, 0);
+    key.beginArray()
+        .value(config.seed)
+        .value(config.radius)
+        .value(config.starSystemCount)
+        .value(config.anomalyCount)
+        .value(config.minDistance)
+        .value(config.connectivity.minConnections)
+        .value(config.connectivity.maxConnections)
+        .value(config.connectivity.maxDistance)
+        .value(config.connectivity.distanceDecayFactor)
+        .value(config.connectivity.useVoronoiConnectivity)
+        .value(connectivityModeName(config.connectivity.mode))
+        .value(config.generation.parallel)
+        .value(config.visualization.width)
+        .value(config.visualization.height)
+        .value(config.visualization.scale);
+    for (const auto& fixed : config.fixedSystems) {
+        key.beginArray()
+            .value(fixed.id)
+            .value(fixed.name)
+            .value(fixed.x)
+            .value(fixed.y)
+            .value(fixed.type)
+            .value(fixed.hasFixedPosition)
+            .value(fixed.targetDistance)
+            .value(fixed.distanceTolerance)
+            .endArray();
+    }
+    key.endArray();
+    return key.release();
+}
+
+std::string computeEtag(const std::string& body) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : body) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    std::string etag = "\"";
+    for (int shift = 60; shift >= 0; shift -= 4) {
+        etag.push_back(hex[(hash >> shift) & 0xF]);
+    }
+    etag.push_back('"');
+    return etag;
+}
+
+size_t estimateGalaxyBytes(const Galaxy& galaxy) {
+    size_t total = sizeof(Galaxy);
+    for (const auto& system : galaxy.systems) {
+        total += sizeof(StarSystem) + stringBytes(system.id) + stringBytes(system.name) +
+                 stringBytes(system.type) + stringBytes(system.systemInfo.starType);
+        for (const auto& connection : system.connections) {
+            total += stringBytes(connection);
+        }
+    }
+    for (const auto& anomaly : galaxy.anomalies) {
+        total += sizeof(Anomaly) + stringBytes(anomaly.id) + stringBytes(anomaly.name) +
+                 stringBytes(anomaly.type) + stringBytes(anomaly.effect.type);
+    }
+    for (const auto& lane : galaxy.warpLanes) {
+        total += sizeof(WarpLane) + stringBytes(lane.id) + stringBytes(lane.from) + stringBytes(lane.to);
+    }
+    total += galaxy.geometry.heapBytes();
+    if (galaxy.landmarks) total += galaxy.landmarks->heapBytes();
+    for (const auto& entry : *galaxy.systemIndex) {
+        total += stringBytes(entry.first) + sizeof(uint32_t) + 2 * sizeof(void*);  // Node plus bucket
+    }
+    return total;
+}
+
+// ============================================================================
+// GALAXY CACHE
+// ============================================================================
+
+std::shared_ptr<const GalaxyCache::Entry> GalaxyCache::find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end()) return nullptr;
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->second;
+}
+
+std::shared_ptr<const GalaxyCache::Entry> GalaxyCache::insert(const std::string& key,
+                                                              std::shared_ptr<const Galaxy> galaxy,
+                                                              std::shared_ptr<const std::string> json,
+                                                              std::shared_ptr<const std::string> snapshot) {
+    auto entry = std::make_shared<Entry>();
+    entry->etag = computeEtag(*json);
+    entry->bytes = key.size() + estimateGalaxyBytes(*galaxy) + json->size() + (snapshot ? snapshot->size() : 0);
+    entry->galaxy = std::move(galaxy);
+    entry->json = std::move(json);
+    entry->snapshot = std::move(snapshot);
+    if (entry->bytes > budget) return entry;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // A concurrent miss for the same key may have finished first
+    auto existing = index.find(key);
+    if (existing != index.end()) drop(existing->second);
+    evictToFit(entry->bytes);
+
+    lru.emplace_front(key, entry);
+    index[key] = lru.begin();
+    entry->resident = true;
+    used += entry->bytes;
+    return entry;
+}
+
+std::shared_ptr<const std::string> GalaxyCache::encodedJson(const std::shared_ptr<const Entry>& entry,
+                                                           ContentEncoding encoding) {
+    if (encoding == ContentEncoding::Identity) return nullptr;
+    size_t slot = static_cast<size_t>(encoding);
+    std::lock_guard<std::mutex> encodingLock(entry->encodingMutex);
+    if (entry->encoded[slot]) return entry->encoded[slot];
+
+    std::shared_ptr<const std::string> body = encodeBody(*entry->json, encoding);
+    if (!body) return nullptr;
+    entry->encoded[slot] = body;
+
+    // A resident entry grows, so the rest of the cache may have to make room
+    std::lock_guard<std::mutex> lock(mutex);
+    entry->encodedBytes += body->size();
+    if (entry->resident) {
+        used += body->size();
+        evictToFit(0);
+    }
+    return body;
+}
+
+void GalaxyCache::evictToFit(size_t incoming) {
+    while (!lru.empty() && used + incoming > budget) {
+        drop(std::prev(lru.end()));
+    }
+}
+
+void GalaxyCache::drop(LruList::iterator it) {
+    used -= it->second->bytes + it->second->encodedBytes;
+    it->second->resident = false;
+    index.erase(it->first);
+    lru.erase(it);
+}
+
+size_t GalaxyCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lru.size();
+}
+
+size_t GalaxyCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+} // namespace space4x
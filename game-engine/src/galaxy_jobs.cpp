@@ -0,0 +1,202 @@
+#include "galaxy_jobs.h"
+#include "logging.h"
+#include <iostream>
+
+namespace space4x {
+
+const char* jobStateName(JobState state) {
+    switch (state) {
+        case JobState::Queued: return "queued";
+        case JobState::Running: return "running";
+        case JobState::Done: return "done";
+        case JobState::Failed: return "failed";
+        case JobState::Cancelled: return "cancelled";
+    }
+    return "unknown";
+}
+
+// ============================================================================
+// GALAXY JOB
+// ============================================================================
+
+GalaxyJob::GalaxyJob(std::string id, std::string key, const GalaxyConfig& config)
+    : jobId(std::move(id)), jobKey(std::move(key)), jobConfig(config), lastPolled(Clock::now()) {
+    current.stageCount = GalaxyGenerator::stageCount(config) + 1;
+}
+
+GalaxyJob::Progress GalaxyJob::snapshot() const {
+    Progress progress = current;
+    if (progress.state == JobState::Running) {
+        progress.elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - startedAt).count();
+    }
+    return progress;
+}
+
+void GalaxyJob::publish() {
+    current.version++;
+    changed.notify_all();
+}
+
+GalaxyJob::Progress GalaxyJob::progress() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    lastPolled = Clock::now();
+    return snapshot();
+}
+
+GalaxyJob::Progress GalaxyJob::waitForChange(uint64_t seen, std::chrono::milliseconds timeout) const {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait_for(lock, timeout, [&]() { return current.version > seen; });
+    lastPolled = Clock::now();
+    return snapshot();
+}
+
+std::shared_ptr<const GalaxyCache::Entry> GalaxyJob::result() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entry;
+}
+
+bool GalaxyJob::active() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !cancelRequested && (current.state == JobState::Queued || current.state == JobState::Running);
+}
+
+void GalaxyJob::subscribe() {
+    std::lock_guard<std::mutex> lock(mutex);
+    subscribers++;
+}
+
+bool GalaxyJob::unsubscribe() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (subscribers > 0) subscribers--;
+        if (subscribers > 0) return cancelRequested;
+    }
+    cancel();
+    return true;
+}
+
+void GalaxyJob::cancel() {
+    std::lock_guard<std::mutex> lock(mutex);
+    cancelRequested = true;
+    if (current.state == JobState::Queued) {
+        // Never starts; the runner just drops it
+        current.state = JobState::Cancelled;
+        publish();
+    }
+}
+
+bool GalaxyJob::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cancelRequested) return false;
+    current.state = JobState::Running;
+    startedAt = Clock::now();
+    publish();
+    return true;
+}
+
+void GalaxyJob::stageFinished(const char* stage) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!cancelRequested && Clock::now() - lastPolled > std::chrono::seconds(kAbandonAfterSeconds)) {
+        if (logEnabled(LogLevel::Info)) {
+            std::cout << "⌛ Galaxy job " << jobId << " abandoned by its clients\n";
+        }
+        cancelRequested = true;
+    }
+    if (cancelRequested) throw GenerationCancelled();
+    current.stage = stage;
+    current.stagesDone++;
+    publish();
+}
+
+void GalaxyJob::finish(std::shared_ptr<const GalaxyCache::Entry> result) {
+    std::lock_guard<std::mutex> lock(mutex);
+    current.elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - startedAt).count();
+    current.state = JobState::Done;
+    current.stagesDone = current.stageCount;
+    entry = std::move(result);
+    publish();
+}
+
+void GalaxyJob::fail(const std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex);
+    current.elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - startedAt).count();
+    current.state = cancelRequested ? JobState::Cancelled : JobState::Failed;
+    if (!cancelRequested) current.error = error;
+    publish();
+}
+
+// ============================================================================
+// JOB QUEUE
+// ============================================================================
+
+GalaxyJobQueue::GalaxyJobQueue(size_t threads, size_t maxPending, size_t keepFinished, Runner runner)
+    : runner(std::move(runner)), maxPending(maxPending), keepFinished(keepFinished),
+      pool(new ThreadPool(threads)) {}
+
+GalaxyJobQueue::~GalaxyJobQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& job : inFlight) job.second->cancel();
+    }
+    pool.reset();
+}
+
+std::shared_ptr<GalaxyJob> GalaxyJobQueue::submit(const std::string& key, const GalaxyConfig& config, bool& coalesced) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = inFlight.find(key);
+    if (found != inFlight.end() && found->second->active()) {
+        coalesced = true;
+        found->second->subscribe();
+        return found->second;
+    }
+    coalesced = false;
+    if (pending >= maxPending) return nullptr;
+
+    auto job = std::make_shared<GalaxyJob>("job-" + std::to_string(nextId++), key, config);
+    jobs[job->id()] = job;
+    inFlight[key] = job;
+    pending++;
+    pool->submit([this, job]() { run(job); });
+    return job;
+}
+
+std::shared_ptr<GalaxyJob> GalaxyJobQueue::find(const std::string& id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = jobs.find(id);
+    return it == jobs.end() ? nullptr : it->second;
+}
+
+void GalaxyJobQueue::run(const std::shared_ptr<GalaxyJob>& job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending--;
+    }
+    if (job->start()) {
+        try {
+            job->finish(runner(*job));
+            if (logEnabled(LogLevel::Info)) {
+                std::cout << "✅ Galaxy job " << job->id() << " done\n";
+            }
+        } catch (const GenerationCancelled&) {
+            job->fail("");
+            if (logEnabled(LogLevel::Info)) {
+                std::cout << "🛑 Galaxy job " << job->id() << " cancelled\n";
+            }
+        } catch (const std::exception& e) {
+            job->fail(e.what());
+            std::cerr << "❌ Galaxy job " << job->id() << " failed: " << e.what() << std::endl;
+        }
+    }
+
+    // Finished jobs stay collectable until keepFinished newer ones push them out
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = inFlight.find(job->key());
+    if (it != inFlight.end() && it->second == job) inFlight.erase(it);
+    finishedIds.push_back(job->id());
+    while (finishedIds.size() > keepFinished) {
+        jobs.erase(finishedIds.front());
+        finishedIds.pop_front();
+    }
+}
+
+} // namespace space4x
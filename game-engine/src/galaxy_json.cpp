@@ -0,0 +1,173 @@
+#include "galaxy_json.h"
+#include "metrics.h"
+
+namespace space4x {
+
+namespace {
+
+void writeResources(JsonWriter& json, const std::vector<ResourceDeposit>& resources) {
+    json.key("resources").beginArray();
+    for (const auto& resource : resources) {
+        json.beginObject()
+            .field("type", static_cast<int>(resource.type))
+            .field("abundance", resource.abundance)
+            .field("accessibility", resource.accessibility)
+            .endObject();
+    }
+    json.endArray();
+}
+
+// Members every body shares; distanceKey differs between planets, moons and asteroids
+void writeBodyFields(JsonWriter& json, const CelestialBody& body, const char* distanceKey) {
+    json.field("id", body.id)
+        .field("name", body.name)
+        .field("type", body.type)
+        .field(distanceKey, body.distanceFromParent)
+        .field("radius", body.radius)
+        .field("diameter", body.diameter)
+        .field("mass", body.mass)
+        .field("gravity", body.gravity)
+        .field("habitability", body.habitability)
+        .field("atmosphere", body.atmosphere)
+        .field("composition", body.composition);
+    writeResources(json, body.resources);
+}
+
+} // namespace
+
+// ============================================================================
+// GALAXY
+// ============================================================================
+
+void writeSystem(JsonWriter& json, const StarSystem& system) {
+    json.beginObject()
+        .field("id", system.id)
+        .field("name", system.name)
+        .field("x", system.x)
+        .field("y", system.y)
+        .field("type", system.type)
+        .field("isFixed", system.isFixed)
+        .field("explored", true);
+
+    // Adjacency is already on the system; no scan over every lane per system
+    json.key("connections").beginArray();
+    for (const auto& connectedId : system.connections) {
+        json.value(connectedId);
+    }
+    json.endArray();
+
+    json.key("systemInfo").beginObject()
+        .field("starType", system.systemInfo.starType)
+        .field("planetCount", system.systemInfo.planetCount)
+        .field("moonCount", system.systemInfo.moonCount)
+        .field("asteroidCount", system.systemInfo.asteroidCount)
+        .endObject();
+
+    // Only mark systems as having detailed data if a predefined definition exists
+    json.field("hasDetailedData", system.detailedSystem != nullptr);
+    json.endObject();
+}
+
+void writeAnomaly(JsonWriter& json, const Anomaly& anomaly) {
+    json.beginObject()
+        .field("id", anomaly.id)
+        .field("name", anomaly.name)
+        .field("x", anomaly.x)
+        .field("y", anomaly.y)
+        .field("type", anomaly.type)
+        .endObject();
+}
+
+std::string serializeGalaxy(const Galaxy& galaxy) {
+    static const MetricId timer = MetricsRegistry::global().histogram(
+        "space4x_serialization_seconds", "Time to serialize a galaxy or system body", metricLabel("format", "galaxy_json"));
+    ScopedTimer timing(timer);
+
+    // Rough per-element sizes so the buffer grows once, not per append
+    JsonWriter json(256 + galaxy.systems.size() * 320 + galaxy.warpLanes.size() * 80 + galaxy.anomalies.size() * 96);
+
+    json.beginObject();
+    json.key("config").beginObject()
+        .field("radius", galaxy.config.radius)
+        .field("systems", galaxy.config.starSystemCount)
+        .field("anomalies", galaxy.config.anomalyCount)
+        .field("seed", galaxy.config.seed)
+        .endObject();
+    json.key("visualization").beginObject()
+        .field("width", galaxy.config.visualization.width)
+        .field("height", galaxy.config.visualization.height)
+        .field("scale", galaxy.config.visualization.scale)
+        .endObject();
+
+    json.key("systems").beginArray();
+    for (const auto& system : galaxy.systems) {
+        writeSystem(json, system);
+    }
+    json.endArray();
+
+    json.key("anomalies").beginArray();
+    for (const auto& anomaly : galaxy.anomalies) {
+        writeAnomaly(json, anomaly);
+    }
+    json.endArray();
+
+    json.key("warpLanes").beginArray();
+    for (const auto& lane : galaxy.warpLanes) {
+        json.beginObject()
+            .field("from", lane.from)
+            .field("to", lane.to)
+            .field("distance", lane.distance)
+            .endObject();
+    }
+    json.endArray();
+    json.endObject();
+
+    return json.release();
+}
+
+// ============================================================================
+// SYSTEM DETAILS
+// ============================================================================
+
+std::string serializeSystemDefinition(const SystemDefinition& systemDef) {
+    static const MetricId timer = MetricsRegistry::global().histogram(
+        "space4x_serialization_seconds", "Time to serialize a galaxy or system body", metricLabel("format", "system_json"));
+    ScopedTimer timing(timer);
+
+    JsonWriter json(1024 + systemDef.planets.size() * 512 + systemDef.asteroids.size() * 384);
+    json.beginObject()
+        .field("systemId", systemDef.systemId)
+        .field("systemName", systemDef.systemName)
+        .field("starType", systemDef.starType)
+        .field("starMass", systemDef.starMass)
+        .field("starRadius", systemDef.starRadius)
+        .field("starTemperature", systemDef.starTemperature);
+
+    json.key("planets").beginArray();
+    for (const auto& planet : systemDef.planets) {
+        json.beginObject();
+        writeBodyFields(json, planet, "distanceFromStar");
+        json.key("moons").beginArray();
+        for (const auto& moon : planet.moons) {
+            json.beginObject();
+            writeBodyFields(json, moon, "distanceFromPlanet");
+            json.endObject();
+        }
+        json.endArray();
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("asteroids").beginArray();
+    for (const auto& asteroid : systemDef.asteroids) {
+        json.beginObject();
+        writeBodyFields(json, asteroid, "distanceFromStar");
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+
+    return json.release();
+}
+
+} // namespace space4x
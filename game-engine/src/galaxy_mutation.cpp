@@ -0,0 +1,394 @@
+#include "galaxy.h"
+#include "distance_kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace space4x {
+
+namespace {
+
+void link(Galaxy& galaxy, const WarpLane& lane) {
+    galaxy.systems.edit(galaxy.systemIndex->at(lane.from)).connections.push_back(lane.to);
+    galaxy.systems.edit(galaxy.systemIndex->at(lane.to)).connections.push_back(lane.from);
+}
+
+void unlink(StarSystem& system, const std::string& neighbor) {
+    auto& connections = system.connections;
+    for (auto it = connections.begin(); it != connections.end(); ++it) {
+        if (*it == neighbor) {
+            connections.erase(it);
+            return;
+        }
+    }
+}
+
+void addLaneRecord(Galaxy& galaxy, uint32_t a, uint32_t b, double distance, GalaxyDelta& delta) {
+    WarpLane lane = makeWarpLane(galaxy.systems[a], galaxy.systems[b], distance);
+    link(galaxy, lane);
+    delta.lanesAdded.push_back(lane);
+    galaxy.warpLanes.push_back(std::move(lane));
+}
+
+// Labels the component of start with label, stopping early once every probe
+// has been labeled; returns its size (the full size only if it wasn't cut short)
+size_t labelComponent(const GalaxyGeometry& geometry, uint32_t start, int32_t label,
+                      std::vector<int32_t>& component, size_t& unlabeledProbes,
+                      const std::vector<char>& isProbe, bool stopEarly) {
+    std::queue<uint32_t> frontier;
+    frontier.push(start);
+    component[start] = label;
+    size_t size = 1;
+    if (isProbe[start]) unlabeledProbes--;
+
+    while (!frontier.empty()) {
+        if (stopEarly && unlabeledProbes == 0) break;
+        uint32_t current = frontier.front();
+        frontier.pop();
+        for (const uint32_t* n = geometry.neighborsBegin(current); n != geometry.neighborsEnd(current); ++n) {
+            if (component[*n] >= 0) continue;
+            component[*n] = label;
+            size++;
+            if (isProbe[*n]) unlabeledProbes--;
+            frontier.push(*n);
+        }
+    }
+    return size;
+}
+
+// Makes sure all probes (the endpoints touched by a removal) still reach each
+// other. The common case is a short search from the first probe that finds the
+// rest; only when the network really split are the stranded components walked
+// in full and each joined to the largest one by its shortest possible lane.
+// The lane cutA-cutB, if given, is never re-added.
+void repairConnectivity(Galaxy& galaxy, const std::vector<uint32_t>& probes, uint32_t cutA, uint32_t cutB,
+                        GalaxyDelta& delta) {
+    const GalaxyGeometry& geometry = galaxy.geometry;
+    const size_t count = geometry.size();
+    if (probes.size() < 2 || count < 2) return;
+
+    std::vector<char> isProbe(count, 0);
+    size_t unlabeledProbes = 0;
+    for (uint32_t probe : probes) {
+        if (!isProbe[probe]) unlabeledProbes++;
+        isProbe[probe] = 1;
+    }
+
+    std::vector<int32_t> component(count, -1);
+    std::vector<size_t> sizes;
+    sizes.push_back(labelComponent(geometry, probes[0], 0, component, unlabeledProbes, isProbe, true));
+    if (unlabeledProbes == 0) return;
+
+    // Split: the first search ran to exhaustion, so component 0 is complete
+    for (uint32_t probe : probes) {
+        if (component[probe] >= 0) continue;
+        int32_t label = static_cast<int32_t>(sizes.size());
+        sizes.push_back(labelComponent(geometry, probe, label, component, unlabeledProbes, isProbe, false));
+    }
+
+    int32_t largest = 0;
+    for (size_t label = 1; label < sizes.size(); label++) {
+        if (sizes[label] > sizes[largest]) largest = static_cast<int32_t>(label);
+    }
+
+    std::vector<char> attached(count, 0);
+    for (size_t i = 0; i < count; i++) attached[i] = component[i] == largest;
+
+    const DistanceKernels& kernels = distanceKernels();
+    std::vector<double> squared(count);
+    for (int32_t label = 0; label < static_cast<int32_t>(sizes.size()); label++) {
+        if (label == largest) continue;
+
+        // Shortest lane from this component to anything already attached, ordered by (distance, u, v)
+        double bestSquared = INFINITY;
+        uint32_t bestU = 0, bestV = 0;
+        for (uint32_t u = 0; u < count; u++) {
+            if (component[u] != label) continue;
+            kernels.squaredDistances(geometry.x.data(), geometry.y.data(), count,
+                                     geometry.x[u], geometry.y[u], squared.data());
+            for (uint32_t v = 0; v < count; v++) {
+                if (!attached[v] || squared[v] >= bestSquared) continue;
+                if ((u == cutA && v == cutB) || (u == cutB && v == cutA)) continue;
+                bestSquared = squared[v];
+                bestU = u;
+                bestV = v;
+            }
+        }
+        if (bestSquared == INFINITY) continue;
+
+        addLaneRecord(galaxy, bestU, bestV, std::sqrt(bestSquared), delta);
+        for (uint32_t i = 0; i < count; i++) {
+            if (component[i] == label) attached[i] = 1;
+        }
+    }
+    galaxy.indexLanes();
+}
+
+} // namespace
+
+// ============================================================================
+// SYSTEM EDITS
+// ============================================================================
+
+bool Galaxy::addSystem(StarSystem system, GalaxyDelta& delta, std::string& error) {
+    if (system.id.empty()) {
+        error = "System id is required";
+        return false;
+    }
+    if (systemIndex->count(system.id)) {
+        error = "System " + system.id + " already exists";
+        return false;
+    }
+    if (!std::isfinite(system.x) || !std::isfinite(system.y)) {
+        error = "System position must be finite";
+        return false;
+    }
+
+    system.connections.clear();
+    delta.systemsAdded.push_back(system);
+
+    uint32_t index = static_cast<uint32_t>(systems.size());
+    systems.push_back(std::move(system));
+    auto ids = std::make_shared<SystemIdIndex>(*systemIndex);
+    ids->emplace(systems.back().id, index);
+    systemIndex = std::move(ids);
+    geometry.x.push_back(systems.back().x);
+    geometry.y.push_back(systems.back().y);
+    geometry.tier.push_back(systemTierFromType(systems.back().type));
+
+    // Like isolated systems during generation: always link to the nearest ones, whatever the distance
+    size_t links = static_cast<size_t>(std::max(1, config.connectivity.minConnections));
+    auto nearest = nearestPoints(geometry.x.data(), geometry.y.data(), index,
+                                 geometry.x[index], geometry.y[index], links, [](size_t) { return true; });
+    for (const auto& neighbor : nearest) {
+        addLaneRecord(*this, index, neighbor.second, neighbor.first, delta);
+    }
+    indexLanes();
+    return true;
+}
+
+bool Galaxy::removeSystem(const std::string& id, GalaxyDelta& delta, std::string& error) {
+    int64_t index = findSystemIndex(id);
+    if (index < 0) {
+        error = "System " + id + " not found";
+        return false;
+    }
+
+    std::vector<std::string> neighbors = systems[index].connections;
+    for (const auto& neighbor : neighbors) {
+        unlink(systems.edit(systemIndex->at(neighbor)), id);
+    }
+
+    auto touches = [&id](const WarpLane& lane) { return lane.from == id || lane.to == id; };
+    for (const auto& lane : warpLanes) {
+        if (touches(lane)) delta.lanesRemoved.push_back({lane.from, lane.to});
+    }
+    warpLanes.eraseIf(touches);
+
+    systems.erase(static_cast<size_t>(index));
+    indexSystems();
+    delta.systemsRemoved.push_back(id);
+
+    std::vector<uint32_t> probes;
+    for (const auto& neighbor : neighbors) {
+        probes.push_back(systemIndex->at(neighbor));
+    }
+    repairConnectivity(*this, probes, UINT32_MAX, UINT32_MAX, delta);
+    return true;
+}
+
+bool Galaxy::setSystemExplored(const std::string& id, bool explored, GalaxyDelta& delta, std::string& error) {
+    int64_t index = findSystemIndex(id);
+    if (index < 0) {
+        error = "System " + id + " not found";
+        return false;
+    }
+    if (systems[index].explored != explored) {
+        systems.edit(index).explored = explored;
+        delta.systemsExplored.push_back({id, explored});
+    }
+    return true;
+}
+
+// ============================================================================
+// LANE EDITS
+// ============================================================================
+
+bool Galaxy::addLane(const std::string& from, const std::string& to, GalaxyDelta& delta, std::string& error) {
+    int64_t a = findSystemIndex(from);
+    int64_t b = findSystemIndex(to);
+    if (a < 0 || b < 0) {
+        error = "System " + (a < 0 ? from : to) + " not found";
+        return false;
+    }
+    if (a == b) {
+        error = "A lane needs two different systems";
+        return false;
+    }
+    if (findLaneIndex(from, to) >= 0) {
+        error = "Lane " + from + " - " + to + " already exists";
+        return false;
+    }
+
+    addLaneRecord(*this, static_cast<uint32_t>(a), static_cast<uint32_t>(b),
+                  geometry.distance(static_cast<uint32_t>(a), static_cast<uint32_t>(b)), delta);
+    geometry.appendLane(static_cast<uint32_t>(a), static_cast<uint32_t>(b), warpLanes.back().distance,
+                        static_cast<uint32_t>(warpLanes.size() - 1));
+    landmarks.reset();
+    return true;
+}
+
+bool Galaxy::removeLane(const std::string& from, const std::string& to, GalaxyDelta& delta, std::string& error) {
+    int64_t lane = findLaneIndex(from, to);
+    if (lane < 0) {
+        error = "Lane " + from + " - " + to + " not found";
+        return false;
+    }
+
+    uint32_t a = systemIndex->at(from);
+    uint32_t b = systemIndex->at(to);
+    unlink(systems.edit(a), to);
+    unlink(systems.edit(b), from);
+    delta.lanesRemoved.push_back({warpLanes[lane].from, warpLanes[lane].to});
+    warpLanes.erase(static_cast<size_t>(lane));
+    geometry.removeLane(a, b, static_cast<uint32_t>(lane));
+    landmarks.reset();
+
+    // Bridge check: usually a and b still meet within a few hops
+    repairConnectivity(*this, {a, b}, a, b, delta);
+    return true;
+}
+
+bool Galaxy::setLaneDiscovered(const std::string& from, const std::string& to, bool discovered,
+                               GalaxyDelta& delta, std::string& error) {
+    int64_t lane = findLaneIndex(from, to);
+    if (lane < 0) {
+        error = "Lane " + from + " - " + to + " not found";
+        return false;
+    }
+    if (warpLanes[lane].discovered != discovered) {
+        warpLanes.edit(lane).discovered = discovered;
+        delta.lanesDiscovered.push_back({warpLanes[lane].from, warpLanes[lane].to, discovered});
+    }
+    return true;
+}
+
+// ============================================================================
+// ANOMALY EDITS
+// ============================================================================
+
+bool Galaxy::setAnomalyDiscovered(const std::string& id, bool discovered, GalaxyDelta& delta, std::string& error) {
+    for (size_t i = 0; i < anomalies.size(); i++) {
+        if (anomalies[i].id != id) continue;
+        if (anomalies[i].discovered != discovered) {
+            anomalies.edit(i).discovered = discovered;
+            delta.anomaliesDiscovered.push_back({id, discovered});
+        }
+        return true;
+    }
+    error = "Anomaly " + id + " not found";
+    return false;
+}
+
+// ============================================================================
+// DELTA REPLAY
+// ============================================================================
+
+// Same order the edits produce them in, so the replayed galaxy has its lanes
+// and connections in the same order and serializes identically
+bool Galaxy::applyDelta(const GalaxyDelta& delta, std::string& error) {
+    if (delta.baseRevision < revision) return true;
+    if (delta.baseRevision > revision) {
+        error = "Delta against revision " + std::to_string(delta.baseRevision) +
+                " cannot follow revision " + std::to_string(revision);
+        return false;
+    }
+
+    // Looked up while the geometry still matches the lanes, then erased from the back
+    std::vector<size_t> removedLanes;
+    for (const auto& removed : delta.lanesRemoved) {
+        int64_t lane = findLaneIndex(removed.first, removed.second);
+        if (lane < 0 || std::count(removedLanes.begin(), removedLanes.end(), static_cast<size_t>(lane))) {
+            error = "Lane " + removed.first + " - " + removed.second + " not found";
+            return false;
+        }
+        unlink(systems.edit(systemIndex->at(removed.first)), removed.second);
+        unlink(systems.edit(systemIndex->at(removed.second)), removed.first);
+        removedLanes.push_back(static_cast<size_t>(lane));
+    }
+    std::sort(removedLanes.rbegin(), removedLanes.rend());
+    for (size_t lane : removedLanes) {
+        warpLanes.erase(lane);
+    }
+
+    for (const auto& id : delta.systemsRemoved) {
+        int64_t index = findSystemIndex(id);
+        if (index < 0) {
+            error = "System " + id + " not found";
+            return false;
+        }
+        if (!systems[index].connections.empty()) {
+            error = "System " + id + " still has lanes";
+            return false;
+        }
+        systems.erase(static_cast<size_t>(index));
+        indexSystems();
+    }
+
+    if (!delta.systemsAdded.empty()) {
+        auto ids = std::make_shared<SystemIdIndex>(*systemIndex);
+        for (const auto& added : delta.systemsAdded) {
+            if (!ids->emplace(added.id, static_cast<uint32_t>(systems.size())).second) {
+                error = "System " + added.id + " already exists";
+                return false;
+            }
+            StarSystem system = added;
+            system.connections.clear();
+            systems.push_back(std::move(system));
+        }
+        systemIndex = std::move(ids);
+    }
+
+    for (const auto& lane : delta.lanesAdded) {
+        if (!systemIndex->count(lane.from) || !systemIndex->count(lane.to)) {
+            error = "Lane " + lane.from + " - " + lane.to + " references an unknown system";
+            return false;
+        }
+        link(*this, lane);
+        warpLanes.push_back(lane);
+    }
+
+    // Positions, tiers and lane adjacency in one pass; the lane flags below look lanes up through it
+    indexSystems();
+
+    for (const auto& flag : delta.systemsExplored) {
+        int64_t index = findSystemIndex(flag.id);
+        if (index < 0) {
+            error = "System " + flag.id + " not found";
+            return false;
+        }
+        systems.edit(index).explored = flag.value;
+    }
+    for (const auto& flag : delta.lanesDiscovered) {
+        int64_t lane = findLaneIndex(flag.from, flag.to);
+        if (lane < 0) {
+            error = "Lane " + flag.from + " - " + flag.to + " not found";
+            return false;
+        }
+        warpLanes.edit(lane).discovered = flag.value;
+    }
+    for (const auto& flag : delta.anomaliesDiscovered) {
+        size_t index = 0;
+        while (index < anomalies.size() && anomalies[index].id != flag.id) index++;
+        if (index == anomalies.size()) {
+            error = "Anomaly " + flag.id + " not found";
+            return false;
+        }
+        anomalies.edit(index).discovered = flag.value;
+    }
+
+    revision++;
+    return true;
+}
+
+} // namespace space4x
@@ -0,0 +1,598 @@
+#include "galaxy_request.h"
+#include <nlohmann/json.hpp>
+#include <climits>
+#include <cmath>
+#include <vector>
+
+namespace space4x {
+
+namespace {
+
+typedef nlohmann::json Json;
+
+// A scalar (or the start of a container) as seen by the SAX callbacks
+struct Value {
+    enum Kind { Number, Boolean, String, Null, Container } kind;
+    double number = 0.0;
+    bool flag = false;
+    const std::string* text = nullptr;
+};
+
+enum class Assigned { Ok, Unknown, WrongType };
+
+bool toInt(const Value& v, int& out) {
+    if (v.kind != Value::Number || v.number != std::floor(v.number) ||
+        v.number < INT_MIN || v.number > INT_MAX) {
+        return false;
+    }
+    out = static_cast<int>(v.number);
+    return true;
+}
+
+bool toDouble(const Value& v, double& out) {
+    if (v.kind != Value::Number) return false;
+    out = v.number;
+    return true;
+}
+
+bool toBool(const Value& v, bool& out) {
+    if (v.kind != Value::Boolean) return false;
+    out = v.flag;
+    return true;
+}
+
+bool toString(const Value& v, std::string& out) {
+    if (v.kind != Value::String) return false;
+    out = *v.text;
+    return true;
+}
+
+Assigned result(bool ok) { return ok ? Assigned::Ok : Assigned::WrongType; }
+
+bool provided(bool ok, bool& flag) {
+    if (ok) flag = true;
+    return ok;
+}
+
+// Where in the document the parser currently is
+enum class Scope { Root, Connectivity, Generation, Visualization, FixedSystems, FixedSystem, Skipped };
+
+class GalaxyRequestHandler : public nlohmann::json_sax<Json> {
+public:
+    GalaxyRequestHandler(GalaxyRequest& request, std::string& error) : request(request), error(error) {}
+
+    bool null() override { return scalar(Value{Value::Null}); }
+    bool boolean(bool v) override {
+        Value value{Value::Boolean};
+        value.flag = v;
+        return scalar(value);
+    }
+    bool number_integer(number_integer_t v) override { return number(static_cast<double>(v)); }
+    bool number_unsigned(number_unsigned_t v) override { return number(static_cast<double>(v)); }
+    bool number_float(number_float_t v, const string_t&) override { return number(v); }
+    bool string(string_t& v) override {
+        Value value{Value::String};
+        value.text = &v;
+        return scalar(value);
+    }
+    bool binary(binary_t&) override { return scalar(Value{Value::Null}); }
+
+    bool key(string_t& name) override {
+        currentKey = name;
+        return true;
+    }
+
+    bool start_object(std::size_t) override {
+        if (scopes.empty()) {
+            scopes.push_back(Scope::Root);
+            return true;
+        }
+        Scope scope = scopes.back();
+        if (scope == Scope::Root && currentKey == "connectivity") {
+            scopes.push_back(Scope::Connectivity);
+        } else if (scope == Scope::Root && currentKey == "generation") {
+            scopes.push_back(Scope::Generation);
+        } else if (scope == Scope::Root && currentKey == "visualization") {
+            scopes.push_back(Scope::Visualization);
+        } else if (scope == Scope::FixedSystems) {
+            request.config.fixedSystems.emplace_back();
+            scopes.push_back(Scope::FixedSystem);
+        } else {
+            return container();
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        if (scopes.back() == Scope::FixedSystem && request.config.fixedSystems.back().id.empty()) {
+            error = "Every fixedSystems entry needs an id";
+            return false;
+        }
+        scopes.pop_back();
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        if (scopes.empty()) {
+            error = "Request body must be a JSON object";
+            return false;
+        }
+        if (scopes.back() == Scope::Root && currentKey == "fixedSystems") {
+            request.config.fixedSystems.clear();
+            request.fixedSystemsProvided = true;
+            scopes.push_back(Scope::FixedSystems);
+            return true;
+        }
+        return container();
+    }
+
+    bool end_array() override {
+        scopes.pop_back();
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception&) override {
+        error = "Invalid JSON at byte " + std::to_string(position);
+        return false;
+    }
+
+private:
+    GalaxyRequest& request;
+    std::string& error;
+    std::vector<Scope> scopes;
+    std::string currentKey;
+
+    bool number(double v) {
+        Value value{Value::Number};
+        value.number = v;
+        return scalar(value);
+    }
+
+    // A nested container nobody asked for is skipped; one in place of a known scalar is an error
+    bool container() {
+        Scope scope = scopes.back();
+        if (scope == Scope::FixedSystems) {
+            error = "fixedSystems entries must be objects";
+            return false;
+        }
+        if (scope != Scope::Skipped && assign(scope, Value{Value::Container}) == Assigned::WrongType) {
+            return wrongType();
+        }
+        scopes.push_back(Scope::Skipped);
+        return true;
+    }
+
+    bool scalar(const Value& value) {
+        if (scopes.empty()) {
+            error = "Request body must be a JSON object";
+            return false;
+        }
+        Scope scope = scopes.back();
+        if (scope == Scope::Skipped) return true;
+        if (scope == Scope::FixedSystems) {
+            error = "fixedSystems entries must be objects";
+            return false;
+        }
+        return assign(scope, value) == Assigned::WrongType ? wrongType() : true;
+    }
+
+    bool wrongType() {
+        error = "Invalid value for \"" + currentKey + "\"";
+        return false;
+    }
+
+    Assigned assign(Scope scope, const Value& v) {
+        GalaxyConfig& config = request.config;
+        const std::string& k = currentKey;
+        switch (scope) {
+            case Scope::Root:
+                if (k == "seed") return result(provided(toInt(v, config.seed), request.seedProvided));
+                if (k == "radius") return result(provided(toDouble(v, config.radius), request.radiusProvided));
+                if (k == "systems" || k == "starSystemCount") {
+                    return result(provided(toInt(v, config.starSystemCount), request.systemsProvided));
+                }
+                if (k == "anomalies" || k == "anomalyCount") {
+                    return result(provided(toInt(v, config.anomalyCount), request.anomaliesProvided));
+                }
+                if (k == "minDistance") return result(toDouble(v, config.minDistance));
+                if (k == "save_slot") return result(toInt(v, request.saveSlot));
+                if (k == "use_saved") return result(toBool(v, request.useSaved));
+                if (k == "parallel") return result(toBool(v, config.generation.parallel));
+                if (k == "threads") return result(toInt(v, config.generation.threads));
+                if (k == "connectivity_mode") return mode(v);
+                if (k == "connectivity" || k == "generation" || k == "visualization" || k == "fixedSystems") {
+                    return Assigned::WrongType;  // Containers are handled by start_object/start_array
+                }
+                return Assigned::Unknown;
+            case Scope::Connectivity:
+                if (k == "minConnections") return result(toInt(v, config.connectivity.minConnections));
+                if (k == "maxConnections") return result(toInt(v, config.connectivity.maxConnections));
+                if (k == "maxDistance") return result(toDouble(v, config.connectivity.maxDistance));
+                if (k == "distanceDecayFactor") return result(toDouble(v, config.connectivity.distanceDecayFactor));
+                if (k == "useVoronoiConnectivity") return result(toBool(v, config.connectivity.useVoronoiConnectivity));
+                if (k == "mode") return mode(v);
+                return Assigned::Unknown;
+            case Scope::Generation:
+                if (k == "parallel") return result(toBool(v, config.generation.parallel));
+                if (k == "threads") return result(toInt(v, config.generation.threads));
+                return Assigned::Unknown;
+            case Scope::Visualization:
+                if (k == "width") return result(toInt(v, config.visualization.width));
+                if (k == "height") return result(toInt(v, config.visualization.height));
+                if (k == "scale") return result(toDouble(v, config.visualization.scale));
+                return Assigned::Unknown;
+            case Scope::FixedSystem: {
+                FixedSystem& fixed = config.fixedSystems.back();
+                if (k == "id") return result(toString(v, fixed.id));
+                if (k == "name") return result(toString(v, fixed.name));
+                if (k == "x") return result(toDouble(v, fixed.x));
+                if (k == "y") return result(toDouble(v, fixed.y));
+                if (k == "type") return result(toString(v, fixed.type));
+                if (k == "hasFixedPosition") return result(toBool(v, fixed.hasFixedPosition));
+                if (k == "targetDistance") return result(toDouble(v, fixed.targetDistance));
+                if (k == "distanceTolerance") return result(toDouble(v, fixed.distanceTolerance));
+                return Assigned::Unknown;
+            }
+            default:
+                return Assigned::Unknown;
+        }
+    }
+
+    Assigned mode(const Value& v) {
+        std::string name;
+        if (!toString(v, name)) return Assigned::WrongType;
+        request.config.connectivity.mode = connectivityModeFromString(name);
+        return Assigned::Ok;
+    }
+};
+
+// Validates a whole document while picking out one top-level integer
+class SaveSlotHandler : public nlohmann::json_sax<Json> {
+public:
+    SaveSlotHandler(int& saveSlot, std::string& error) : saveSlot(saveSlot), error(error) {}
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t v) override { return number(static_cast<double>(v)); }
+    bool number_unsigned(number_unsigned_t v) override { return number(static_cast<double>(v)); }
+    bool number_float(number_float_t v, const string_t&) override { return number(v); }
+    bool string(string_t&) override { return true; }
+    bool binary(binary_t&) override { return true; }
+    bool key(string_t& name) override {
+        slotKey = depth == 1 && name == "save_slot";
+        return true;
+    }
+    bool start_object(std::size_t) override { depth++; slotKey = false; return true; }
+    bool end_object() override { depth--; slotKey = false; return true; }
+    bool start_array(std::size_t) override { depth++; slotKey = false; return true; }
+    bool end_array() override { depth--; slotKey = false; return true; }
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception&) override {
+        error = "Invalid JSON at byte " + std::to_string(position);
+        return false;
+    }
+
+private:
+    int& saveSlot;
+    std::string& error;
+    int depth = 0;
+    bool slotKey = false;
+
+    bool number(double v) {
+        if (!slotKey) return true;
+        Value value{Value::Number};
+        value.number = v;
+        if (!toInt(value, saveSlot)) {
+            error = "Invalid value for \"save_slot\"";
+            return false;
+        }
+        return true;
+    }
+};
+
+// Flat object of scalars; nested containers are skipped
+class GameActionHandler : public nlohmann::json_sax<Json> {
+public:
+    GameActionHandler(GameAction& action, std::string& error) : action(action), error(error) {}
+
+    bool null() override { return scalar(Value{Value::Null}); }
+    bool boolean(bool v) override {
+        Value value{Value::Boolean};
+        value.flag = v;
+        return scalar(value);
+    }
+    bool number_integer(number_integer_t v) override { return number(static_cast<double>(v)); }
+    bool number_unsigned(number_unsigned_t v) override { return number(static_cast<double>(v)); }
+    bool number_float(number_float_t v, const string_t&) override { return number(v); }
+    bool string(string_t& v) override {
+        Value value{Value::String};
+        value.text = &v;
+        return scalar(value);
+    }
+    bool binary(binary_t&) override { return true; }
+    bool key(string_t& name) override {
+        currentKey = name;
+        return true;
+    }
+    bool start_object(std::size_t) override { return open(); }
+    bool end_object() override { depth--; return true; }
+    bool start_array(std::size_t) override {
+        if (depth == 0) {
+            error = "Request body must be a JSON object";
+            return false;
+        }
+        return open();
+    }
+    bool end_array() override { depth--; return true; }
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception&) override {
+        error = "Invalid JSON at byte " + std::to_string(position);
+        return false;
+    }
+
+    bool sawX = false, sawY = false;
+
+private:
+    GameAction& action;
+    std::string& error;
+    std::string currentKey;
+    int depth = 0;
+
+    bool open() {
+        depth++;
+        return true;
+    }
+
+    bool number(double v) {
+        Value value{Value::Number};
+        value.number = v;
+        return scalar(value);
+    }
+
+    bool scalar(const Value& v) {
+        if (depth == 0) {
+            error = "Request body must be a JSON object";
+            return false;
+        }
+        if (depth > 1) return true;
+
+        const std::string& k = currentKey;
+        bool ok = true;
+        if (k == "action") ok = toString(v, action.action);
+        else if (k == "id") ok = toString(v, action.id);
+        else if (k == "from") ok = toString(v, action.from);
+        else if (k == "to") ok = toString(v, action.to);
+        else if (k == "name") ok = toString(v, action.name);
+        else if (k == "type") ok = toString(v, action.type);
+        else if (k == "x") ok = provided(toDouble(v, action.x), sawX);
+        else if (k == "y") ok = provided(toDouble(v, action.y), sawY);
+        else if (k == "value") ok = toBool(v, action.value);
+        if (!ok) error = "Invalid value for \"" + k + "\"";
+        return ok;
+    }
+};
+
+// Top-level metric/from/to plus the routes array of {from, to} objects
+class RouteRequestHandler : public nlohmann::json_sax<Json> {
+public:
+    RouteRequestHandler(RouteRequest& request, std::string& error) : request(request), error(error) {}
+
+    bool null() override { return scalar(Value{Value::Null}); }
+    bool boolean(bool v) override {
+        Value value{Value::Boolean};
+        value.flag = v;
+        return scalar(value);
+    }
+    bool number_integer(number_integer_t) override { return scalar(Value{Value::Number}); }
+    bool number_unsigned(number_unsigned_t) override { return scalar(Value{Value::Number}); }
+    bool number_float(number_float_t, const string_t&) override { return scalar(Value{Value::Number}); }
+    bool string(string_t& v) override {
+        Value value{Value::String};
+        value.text = &v;
+        return scalar(value);
+    }
+    bool binary(binary_t&) override { return scalar(Value{Value::Null}); }
+    bool key(string_t& name) override {
+        currentKey = name;
+        return true;
+    }
+
+    bool start_object(std::size_t) override {
+        if (scopes.empty()) {
+            scopes.push_back(Scope::Root);
+        } else if (scopes.back() == Scope::Routes) {
+            request.routes.emplace_back();
+            scopes.push_back(Scope::Route);
+        } else {
+            return container();
+        }
+        return true;
+    }
+    bool end_object() override {
+        if (scopes.back() == Scope::Route && (request.routes.back().from.empty() || request.routes.back().to.empty())) {
+            error = "Every routes entry needs from and to";
+            return false;
+        }
+        scopes.pop_back();
+        return true;
+    }
+    bool start_array(std::size_t) override {
+        if (scopes.empty()) {
+            error = "Request body must be a JSON object";
+            return false;
+        }
+        if (scopes.back() == Scope::Root && currentKey == "routes") {
+            scopes.push_back(Scope::Routes);
+            return true;
+        }
+        return container();
+    }
+    bool end_array() override {
+        scopes.pop_back();
+        return true;
+    }
+    bool parse_error(std::size_t position, const std::string&, const nlohmann::detail::exception&) override {
+        error = "Invalid JSON at byte " + std::to_string(position);
+        return false;
+    }
+
+    RouteQuery single;  // Top-level from/to
+
+private:
+    enum class Scope { Root, Routes, Route, Skipped };
+
+    RouteRequest& request;
+    std::string& error;
+    std::vector<Scope> scopes;
+    std::string currentKey;
+
+    bool container() {
+        Scope scope = scopes.back();
+        if (scope == Scope::Routes) {
+            error = "routes entries must be objects";
+            return false;
+        }
+        if (scope != Scope::Skipped && isKnown(scope)) return wrongType();
+        scopes.push_back(Scope::Skipped);
+        return true;
+    }
+
+    bool isKnown(Scope scope) const {
+        const std::string& k = currentKey;
+        if (scope == Scope::Root) return k == "metric" || k == "from" || k == "to" || k == "routes";
+        return scope == Scope::Route && (k == "from" || k == "to");
+    }
+
+    bool scalar(const Value& v) {
+        if (scopes.empty()) {
+            error = "Request body must be a JSON object";
+            return false;
+        }
+        Scope scope = scopes.back();
+        if (scope == Scope::Skipped) return true;
+        if (scope == Scope::Routes) {
+            error = "routes entries must be objects";
+            return false;
+        }
+
+        const std::string& k = currentKey;
+        RouteQuery& query = scope == Scope::Route ? request.routes.back() : single;
+        bool ok = true;
+        if (scope == Scope::Root && k == "metric") ok = toString(v, request.metric);
+        else if (scope == Scope::Root && k == "routes") ok = false;
+        else if (k == "from") ok = toString(v, query.from);
+        else if (k == "to") ok = toString(v, query.to);
+        return ok ? true : wrongType();
+    }
+
+    bool wrongType() {
+        error = "Invalid value for \"" + currentKey + "\"";
+        return false;
+    }
+};
+
+bool blank(const std::string& body) {
+    return body.find_first_not_of(" \t\r\n") == std::string::npos;
+}
+
+} // namespace
+
+// ============================================================================
+// REQUEST DECODING
+// ============================================================================
+
+GalaxyRequest defaultGalaxyRequest() {
+    GalaxyRequest params;
+    GalaxyConfig& config = params.config;
+    config.seed = 1111111111;
+    config.radius = 500;
+    config.starSystemCount = 400;
+    config.anomalyCount = 25;
+    config.minDistance = 2.0;
+    config.connectivity.minConnections = 1;
+    config.connectivity.maxConnections = 8;
+    config.connectivity.maxDistance = 10.0;
+    config.connectivity.distanceDecayFactor = 0.8;
+    config.connectivity.useVoronoiConnectivity = true;
+    config.visualization.width = 2000;
+    config.visualization.height = 2000;
+    config.visualization.scale = 6.0;
+    
+    // Add fixed systems
+    config.fixedSystems = {
+        {"sol", "Sol System", 0.0, 0.0, "origin", true},
+        {"alpha-centauri", "Alpha Centauri", 4.37, 0.0, "core", true},
+        {"tau-ceti", "Tau Ceti", -7.8, 9.1, "core", true},
+        {"barnards-star", "Barnard's Star", 2.1, -5.6, "core", true},
+        {"bellatrix", "Bellatrix", 180.0, 165.0, "rim", true},
+        {"lumiere", "Lumière", 0.0, 0.0, "rim", false, 250.0, 20.0},
+        {"aspida", "Aspida", 0.0, 0.0, "rim", false, 350.0, 20.0}
+    };
+    return params;
+}
+
+bool decodeGalaxyRequest(const std::string& body, GalaxyRequest& request, std::string& error) {
+    if (blank(body)) return true;
+    GalaxyRequestHandler handler(request, error);
+    if (!Json::sax_parse(body, &handler)) {
+        if (error.empty()) error = "Invalid request body";
+        return false;
+    }
+    return true;
+}
+
+bool decodeGameAction(const std::string& body, GameAction& action, std::string& error) {
+    if (blank(body)) {
+        error = "Empty action body";
+        return false;
+    }
+    GameActionHandler handler(action, error);
+    if (!Json::sax_parse(body, &handler)) {
+        if (error.empty()) error = "Invalid request body";
+        return false;
+    }
+    if (action.action.empty()) {
+        error = "Missing \"action\"";
+        return false;
+    }
+    action.positionProvided = handler.sawX && handler.sawY;
+    return true;
+}
+
+bool decodeRouteRequest(const std::string& body, RouteRequest& request, std::string& error) {
+    if (blank(body)) {
+        error = "Empty route body";
+        return false;
+    }
+    RouteRequestHandler handler(request, error);
+    if (!Json::sax_parse(body, &handler)) {
+        if (error.empty()) error = "Invalid request body";
+        return false;
+    }
+    const RouteQuery& single = handler.single;
+    if (!single.from.empty() || !single.to.empty()) {
+        if (single.from.empty() || single.to.empty()) {
+            error = "A route needs both from and to";
+            return false;
+        }
+        request.routes.insert(request.routes.begin(), single);
+    }
+    if (request.routes.empty()) {
+        error = "Missing \"from\"/\"to\" or \"routes\"";
+        return false;
+    }
+    return true;
+}
+
+bool decodeSaveSlot(const std::string& body, int& saveSlot, std::string& error) {
+    if (blank(body)) {
+        error = "Empty save body";
+        return false;
+    }
+    SaveSlotHandler handler(saveSlot, error);
+    if (!Json::sax_parse(body, &handler)) {
+        if (error.empty()) error = "Invalid request body";
+        return false;
+    }
+    return true;
+}
+
+} // namespace space4x
@@ -0,0 +1,580 @@
+#include "galaxy_snapshot.h"
+#include "metrics.h"
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#ifdef SPACE4X_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace space4x {
+
+namespace {
+
+const char kMagic[4] = {'S', '4', 'X', 'S'};
+const char kDeltaMagic[4] = {'S', '4', 'X', 'D'};
+const size_t kHeaderSize = 12;
+const uint32_t kMaxCount = 1u << 26;  // Sanity limit for any decoded array
+
+// System record flags
+const uint8_t kFlagFixed = 1;
+const uint8_t kFlagExplored = 2;
+const uint8_t kFlagDetailed = 4;
+
+class SnapshotWriter {
+public:
+    std::string out;
+
+    void u8(uint8_t v) { out.push_back(static_cast<char>(v)); }
+    void u16(uint16_t v) { for (int i = 0; i < 2; i++) u8(static_cast<uint8_t>(v >> (8 * i))); }
+    void u32(uint32_t v) { for (int i = 0; i < 4; i++) u8(static_cast<uint8_t>(v >> (8 * i))); }
+    void u64(uint64_t v) { for (int i = 0; i < 8; i++) u8(static_cast<uint8_t>(v >> (8 * i))); }
+    void i32(int32_t v) { u32(static_cast<uint32_t>(v)); }
+    void i64(int64_t v) { u64(static_cast<uint64_t>(v)); }
+    void f64(double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        u64(bits);
+    }
+    void bytes(const std::string& s) {
+        u32(static_cast<uint32_t>(s.size()));
+        out.append(s);
+    }
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const char* data, size_t size) : data(data), size(size) {}
+
+    bool ok() const { return good; }
+    bool atEnd() const { return position == size; }
+
+    uint8_t u8() {
+        if (!need(1)) return 0;
+        return static_cast<uint8_t>(data[position++]);
+    }
+    uint16_t u16() { return static_cast<uint16_t>(little(2)); }
+    uint32_t u32() { return static_cast<uint32_t>(little(4)); }
+    uint64_t u64() { return little(8); }
+    int32_t i32() { return static_cast<int32_t>(u32()); }
+    int64_t i64() { return static_cast<int64_t>(u64()); }
+    double f64() {
+        uint64_t bits = u64();
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    std::string bytes() {
+        uint32_t length = u32();
+        if (!need(length)) return std::string();
+        std::string s(data + position, length);
+        position += length;
+        return s;
+    }
+
+    // Array length, rejected when the remaining bytes can't possibly hold it
+    uint32_t count(size_t minRecordSize) {
+        uint32_t n = u32();
+        if (n > kMaxCount || (good && n * minRecordSize > size - position)) good = false;
+        return good ? n : 0;
+    }
+
+private:
+    const char* data;
+    size_t size;
+    size_t position = 0;
+    bool good = true;
+
+    bool need(size_t n) {
+        if (!good || size - position < n) {
+            good = false;
+            return false;
+        }
+        return true;
+    }
+    uint64_t little(int n) {
+        if (!need(static_cast<size_t>(n))) return 0;
+        uint64_t v = 0;
+        for (int i = 0; i < n; i++) {
+            v |= static_cast<uint64_t>(static_cast<uint8_t>(data[position + i])) << (8 * i);
+        }
+        position += static_cast<size_t>(n);
+        return v;
+    }
+};
+
+// Deduplicating string table; ids are handed out in first-use order
+class StringTable {
+public:
+    uint32_t intern(const std::string& s) {
+        auto it = index.find(s);
+        if (it != index.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(strings.size());
+        index.emplace(s, id);
+        strings.push_back(&index.find(s)->first);
+        return id;
+    }
+
+    void write(SnapshotWriter& w) const {
+        w.u32(static_cast<uint32_t>(strings.size()));
+        for (const std::string* s : strings) w.bytes(*s);
+    }
+
+private:
+    std::unordered_map<std::string, uint32_t> index;
+    std::vector<const std::string*> strings;
+};
+
+std::string encodePayload(const Galaxy& galaxy) {
+    StringTable table;
+    std::unordered_map<std::string, uint32_t> systemIndex;
+    systemIndex.reserve(galaxy.systems.size());
+    for (size_t i = 0; i < galaxy.systems.size(); i++) {
+        systemIndex.emplace(galaxy.systems[i].id, static_cast<uint32_t>(i));
+    }
+
+    // Records first so the string table is complete when it is written
+    SnapshotWriter records;
+    records.u32(static_cast<uint32_t>(galaxy.systems.size()));
+    for (const auto& system : galaxy.systems) {
+        records.u32(table.intern(system.id));
+        records.u32(table.intern(system.name));
+        records.u32(table.intern(system.type));
+        records.u32(table.intern(system.systemInfo.starType));
+        records.f64(system.x);
+        records.f64(system.y);
+        records.u8((system.isFixed ? kFlagFixed : 0) | (system.explored ? kFlagExplored : 0) |
+                   (system.detailedSystem ? kFlagDetailed : 0));
+        records.i64(system.population);
+        records.f64(system.gdp);
+        records.i32(system.resources.minerals);
+        records.i32(system.resources.energy);
+        records.i32(system.resources.research);
+        records.i32(system.systemInfo.planetCount);
+        records.i32(system.systemInfo.moonCount);
+        records.i32(system.systemInfo.asteroidCount);
+    }
+
+    records.u32(static_cast<uint32_t>(galaxy.anomalies.size()));
+    for (const auto& anomaly : galaxy.anomalies) {
+        records.u32(table.intern(anomaly.id));
+        records.u32(table.intern(anomaly.name));
+        records.u32(table.intern(anomaly.type));
+        records.u32(table.intern(anomaly.effect.type));
+        records.f64(anomaly.x);
+        records.f64(anomaly.y);
+        records.f64(anomaly.effect.value);
+        records.u8(anomaly.discovered ? 1 : 0);
+    }
+
+    records.u32(static_cast<uint32_t>(galaxy.warpLanes.size()));
+    for (const auto& lane : galaxy.warpLanes) {
+        auto from = systemIndex.find(lane.from);
+        auto to = systemIndex.find(lane.to);
+        if (from == systemIndex.end() || to == systemIndex.end()) {
+            throw std::runtime_error("Warp lane " + lane.id + " references an unknown system");
+        }
+        records.u32(table.intern(lane.id));
+        records.u32(from->second);
+        records.u32(to->second);
+        records.f64(lane.distance);
+        records.i32(lane.travelTime);
+        records.u8(lane.discovered ? 1 : 0);
+    }
+
+    SnapshotWriter payload;
+    const GalaxyConfig& config = galaxy.config;
+    payload.i32(config.seed);
+    payload.f64(config.radius);
+    payload.i32(config.starSystemCount);
+    payload.i32(config.anomalyCount);
+    payload.f64(config.minDistance);
+    payload.i32(config.connectivity.minConnections);
+    payload.i32(config.connectivity.maxConnections);
+    payload.f64(config.connectivity.maxDistance);
+    payload.f64(config.connectivity.distanceDecayFactor);
+    payload.u8(config.connectivity.useVoronoiConnectivity ? 1 : 0);
+    payload.u8(static_cast<uint8_t>(config.connectivity.mode));
+    payload.i32(config.visualization.width);
+    payload.i32(config.visualization.height);
+    payload.f64(config.visualization.scale);
+    payload.f64(galaxy.bounds.minX);
+    payload.f64(galaxy.bounds.maxX);
+    payload.f64(galaxy.bounds.minY);
+    payload.f64(galaxy.bounds.maxY);
+    payload.f64(galaxy.bounds.radius);
+    payload.u64(galaxy.revision);
+    table.write(payload);
+    payload.out.append(records.out);
+    return std::move(payload.out);
+}
+
+bool decodePayload(const char* data, size_t size, uint16_t version, Galaxy& galaxy, std::string& error,
+                   const SystemConfigManager* definitions) {
+    SnapshotReader r(data, size);
+    Galaxy result;
+    GalaxyConfig& config = result.config;
+    config.seed = r.i32();
+    config.radius = r.f64();
+    config.starSystemCount = r.i32();
+    config.anomalyCount = r.i32();
+    config.minDistance = r.f64();
+    config.connectivity.minConnections = r.i32();
+    config.connectivity.maxConnections = r.i32();
+    config.connectivity.maxDistance = r.f64();
+    config.connectivity.distanceDecayFactor = r.f64();
+    config.connectivity.useVoronoiConnectivity = r.u8() != 0;
+    config.connectivity.mode = r.u8() == static_cast<uint8_t>(ConnectivityMode::Delaunay)
+        ? ConnectivityMode::Delaunay : ConnectivityMode::NearestNeighbors;
+    config.visualization.width = r.i32();
+    config.visualization.height = r.i32();
+    config.visualization.scale = r.f64();
+    result.bounds.minX = r.f64();
+    result.bounds.maxX = r.f64();
+    result.bounds.minY = r.f64();
+    result.bounds.maxY = r.f64();
+    result.bounds.radius = r.f64();
+    result.revision = version >= 2 ? r.u64() : 0;  // Version 1 predates edit deltas
+
+    std::vector<std::string> strings(r.count(4));
+    for (auto& s : strings) s = r.bytes();
+
+    bool badReference = false;
+    auto text = [&](uint32_t id) -> const std::string& {
+        static const std::string empty;
+        if (id >= strings.size()) {
+            badReference = true;
+            return empty;
+        }
+        return strings[id];
+    };
+
+    std::vector<StarSystem> systems(r.count(73));
+    for (auto& system : systems) {
+        system.id = text(r.u32());
+        system.name = text(r.u32());
+        system.type = text(r.u32());
+        system.systemInfo.starType = text(r.u32());
+        system.x = r.f64();
+        system.y = r.f64();
+        uint8_t flags = r.u8();
+        system.isFixed = (flags & kFlagFixed) != 0;
+        system.explored = (flags & kFlagExplored) != 0;
+        system.population = static_cast<long>(r.i64());
+        system.gdp = r.f64();
+        system.resources.minerals = r.i32();
+        system.resources.energy = r.i32();
+        system.resources.research = r.i32();
+        system.systemInfo.planetCount = r.i32();
+        system.systemInfo.moonCount = r.i32();
+        system.systemInfo.asteroidCount = r.i32();
+        system.detailedSystem = (flags & kFlagDetailed) && definitions
+            ? definitions->getSystemDefinition(system.id) : nullptr;
+    }
+
+    std::vector<Anomaly> anomalies(r.count(41));
+    for (auto& anomaly : anomalies) {
+        anomaly.id = text(r.u32());
+        anomaly.name = text(r.u32());
+        anomaly.type = text(r.u32());
+        anomaly.effect.type = text(r.u32());
+        anomaly.x = r.f64();
+        anomaly.y = r.f64();
+        anomaly.effect.value = r.f64();
+        anomaly.discovered = r.u8() != 0;
+    }
+
+    std::vector<WarpLane> lanes(r.count(25));
+    for (auto& lane : lanes) {
+        lane.id = text(r.u32());
+        uint32_t from = r.u32();
+        uint32_t to = r.u32();
+        lane.distance = r.f64();
+        lane.travelTime = r.i32();
+        lane.discovered = r.u8() != 0;
+        if (from >= systems.size() || to >= systems.size()) {
+            badReference = true;
+            break;
+        }
+        lane.from = systems[from].id;
+        lane.to = systems[to].id;
+        systems[from].connections.push_back(lane.to);
+        systems[to].connections.push_back(lane.from);
+    }
+
+    if (!r.ok() || !r.atEnd()) {
+        error = "Truncated or corrupt galaxy snapshot";
+        return false;
+    }
+    if (badReference) {
+        error = "Galaxy snapshot references a missing string or system";
+        return false;
+    }
+    result.systems = std::move(systems);
+    result.anomalies = std::move(anomalies);
+    result.warpLanes = std::move(lanes);
+    result.indexSystems();
+    galaxy = std::move(result);
+    return true;
+}
+
+void writeSystemRecord(SnapshotWriter& w, const StarSystem& system) {
+    w.bytes(system.id);
+    w.bytes(system.name);
+    w.bytes(system.type);
+    w.bytes(system.systemInfo.starType);
+    w.f64(system.x);
+    w.f64(system.y);
+    w.u8((system.isFixed ? kFlagFixed : 0) | (system.explored ? kFlagExplored : 0) |
+         (system.detailedSystem ? kFlagDetailed : 0));
+    w.i64(system.population);
+    w.f64(system.gdp);
+    w.i32(system.resources.minerals);
+    w.i32(system.resources.energy);
+    w.i32(system.resources.research);
+    w.i32(system.systemInfo.planetCount);
+    w.i32(system.systemInfo.moonCount);
+    w.i32(system.systemInfo.asteroidCount);
+}
+
+void readSystemRecord(SnapshotReader& r, StarSystem& system, const SystemConfigManager* definitions) {
+    system.id = r.bytes();
+    system.name = r.bytes();
+    system.type = r.bytes();
+    system.systemInfo.starType = r.bytes();
+    system.x = r.f64();
+    system.y = r.f64();
+    uint8_t flags = r.u8();
+    system.isFixed = (flags & kFlagFixed) != 0;
+    system.explored = (flags & kFlagExplored) != 0;
+    system.population = static_cast<long>(r.i64());
+    system.gdp = r.f64();
+    system.resources.minerals = r.i32();
+    system.resources.energy = r.i32();
+    system.resources.research = r.i32();
+    system.systemInfo.planetCount = r.i32();
+    system.systemInfo.moonCount = r.i32();
+    system.systemInfo.asteroidCount = r.i32();
+    system.detailedSystem = (flags & kFlagDetailed) && definitions
+        ? definitions->getSystemDefinition(system.id) : nullptr;
+}
+
+} // namespace
+
+// ============================================================================
+// GALAXY SNAPSHOTS
+// ============================================================================
+
+bool isGalaxySnapshot(const std::string& data) {
+    return data.size() >= kHeaderSize && std::memcmp(data.data(), kMagic, sizeof(kMagic)) == 0;
+}
+
+std::string encodeGalaxySnapshot(const Galaxy& galaxy, bool compress) {
+    static const MetricId timer = MetricsRegistry::global().histogram(
+        "space4x_serialization_seconds", "Time to serialize a galaxy or system body", metricLabel("format", "snapshot"));
+    ScopedTimer timing(timer);
+    std::string payload = encodePayload(galaxy);
+    uint32_t payloadSize = static_cast<uint32_t>(payload.size());
+    uint16_t flags = 0;
+
+#ifdef SPACE4X_WITH_ZSTD
+    if (compress) {
+        std::string packed(ZSTD_compressBound(payload.size()), '\0');
+        size_t packedSize = ZSTD_compress(&packed[0], packed.size(), payload.data(), payload.size(), 3);
+        if (!ZSTD_isError(packedSize) && packedSize < payload.size()) {
+            packed.resize(packedSize);
+            payload.swap(packed);
+            flags |= kSnapshotCompressed;
+        }
+    }
+#else
+    (void)compress;
+#endif
+
+    SnapshotWriter snapshot;
+    snapshot.out.reserve(kHeaderSize + payload.size());
+    snapshot.out.append(kMagic, sizeof(kMagic));
+    snapshot.u16(kSnapshotVersion);
+    snapshot.u16(flags);
+    snapshot.u32(payloadSize);  // Uncompressed, so decoding allocates once
+    snapshot.out.append(payload);
+    return std::move(snapshot.out);
+}
+
+bool decodeGalaxySnapshot(const std::string& data, Galaxy& galaxy, std::string& error,
+                          const SystemConfigManager* definitions) {
+    if (!isGalaxySnapshot(data)) {
+        error = "Not a galaxy snapshot";
+        return false;
+    }
+
+    SnapshotReader header(data.data() + sizeof(kMagic), kHeaderSize - sizeof(kMagic));
+    uint16_t version = header.u16();
+    uint16_t flags = header.u16();
+    uint32_t payloadSize = header.u32();
+    if (version < 1 || version > kSnapshotVersion) {
+        error = "Unsupported galaxy snapshot version " + std::to_string(version);
+        return false;
+    }
+
+    const char* payload = data.data() + kHeaderSize;
+    size_t storedSize = data.size() - kHeaderSize;
+    if (!(flags & kSnapshotCompressed)) {
+        if (storedSize != payloadSize) {
+            error = "Truncated or corrupt galaxy snapshot";
+            return false;
+        }
+        return decodePayload(payload, storedSize, version, galaxy, error, definitions);
+    }
+
+#ifdef SPACE4X_WITH_ZSTD
+    std::string expanded(payloadSize, '\0');
+    size_t expandedSize = ZSTD_decompress(&expanded[0], expanded.size(), payload, storedSize);
+    if (ZSTD_isError(expandedSize) || expandedSize != payloadSize) {
+        error = "Corrupt compressed galaxy snapshot";
+        return false;
+    }
+    return decodePayload(expanded.data(), expanded.size(), version, galaxy, error, definitions);
+#else
+    error = "Galaxy snapshot is zstd-compressed but this build has no zstd support";
+    return false;
+#endif
+}
+
+// ============================================================================
+// GALAXY DELTAS
+// ============================================================================
+
+bool isGalaxyDelta(const std::string& data) {
+    return data.size() >= kHeaderSize && std::memcmp(data.data(), kDeltaMagic, sizeof(kDeltaMagic)) == 0;
+}
+
+std::string encodeGalaxyDelta(const GalaxyDelta& delta) {
+    SnapshotWriter payload;
+    payload.u64(delta.baseRevision);
+
+    payload.u32(static_cast<uint32_t>(delta.systemsAdded.size()));
+    for (const auto& system : delta.systemsAdded) writeSystemRecord(payload, system);
+
+    payload.u32(static_cast<uint32_t>(delta.systemsRemoved.size()));
+    for (const auto& id : delta.systemsRemoved) payload.bytes(id);
+
+    payload.u32(static_cast<uint32_t>(delta.lanesAdded.size()));
+    for (const auto& lane : delta.lanesAdded) {
+        payload.bytes(lane.id);
+        payload.bytes(lane.from);
+        payload.bytes(lane.to);
+        payload.f64(lane.distance);
+        payload.i32(lane.travelTime);
+        payload.u8(lane.discovered ? 1 : 0);
+    }
+
+    payload.u32(static_cast<uint32_t>(delta.lanesRemoved.size()));
+    for (const auto& lane : delta.lanesRemoved) {
+        payload.bytes(lane.first);
+        payload.bytes(lane.second);
+    }
+
+    payload.u32(static_cast<uint32_t>(delta.systemsExplored.size()));
+    for (const auto& flag : delta.systemsExplored) {
+        payload.bytes(flag.id);
+        payload.u8(flag.value ? 1 : 0);
+    }
+
+    payload.u32(static_cast<uint32_t>(delta.lanesDiscovered.size()));
+    for (const auto& flag : delta.lanesDiscovered) {
+        payload.bytes(flag.from);
+        payload.bytes(flag.to);
+        payload.u8(flag.value ? 1 : 0);
+    }
+
+    payload.u32(static_cast<uint32_t>(delta.anomaliesDiscovered.size()));
+    for (const auto& flag : delta.anomaliesDiscovered) {
+        payload.bytes(flag.id);
+        payload.u8(flag.value ? 1 : 0);
+    }
+
+    SnapshotWriter record;
+    record.out.reserve(kHeaderSize + payload.out.size());
+    record.out.append(kDeltaMagic, sizeof(kDeltaMagic));
+    record.u16(kDeltaVersion);
+    record.u16(0);
+    record.u32(static_cast<uint32_t>(payload.out.size()));
+    record.out.append(payload.out);
+    return std::move(record.out);
+}
+
+bool decodeGalaxyDelta(const std::string& data, GalaxyDelta& delta, std::string& error,
+                       const SystemConfigManager* definitions) {
+    if (!isGalaxyDelta(data)) {
+        error = "Not a galaxy delta";
+        return false;
+    }
+
+    SnapshotReader header(data.data() + sizeof(kDeltaMagic), kHeaderSize - sizeof(kDeltaMagic));
+    uint16_t version = header.u16();
+    header.u16();  // Flags, none defined yet
+    uint32_t payloadSize = header.u32();
+    if (version != kDeltaVersion) {
+        error = "Unsupported galaxy delta version " + std::to_string(version);
+        return false;
+    }
+    if (data.size() - kHeaderSize != payloadSize) {
+        error = "Truncated or corrupt galaxy delta";
+        return false;
+    }
+
+    SnapshotReader r(data.data() + kHeaderSize, payloadSize);
+    GalaxyDelta result;
+    result.baseRevision = r.u64();
+
+    result.systemsAdded.resize(r.count(73));
+    for (auto& system : result.systemsAdded) readSystemRecord(r, system, definitions);
+
+    result.systemsRemoved.resize(r.count(4));
+    for (auto& id : result.systemsRemoved) id = r.bytes();
+
+    result.lanesAdded.resize(r.count(25));
+    for (auto& lane : result.lanesAdded) {
+        lane.id = r.bytes();
+        lane.from = r.bytes();
+        lane.to = r.bytes();
+        lane.distance = r.f64();
+        lane.travelTime = r.i32();
+        lane.discovered = r.u8() != 0;
+    }
+
+    result.lanesRemoved.resize(r.count(8));
+    for (auto& lane : result.lanesRemoved) {
+        lane.first = r.bytes();
+        lane.second = r.bytes();
+    }
+
+    result.systemsExplored.resize(r.count(5));
+    for (auto& flag : result.systemsExplored) {
+        flag.id = r.bytes();
+        flag.value = r.u8() != 0;
+    }
+
+    result.lanesDiscovered.resize(r.count(9));
+    for (auto& flag : result.lanesDiscovered) {
+        flag.from = r.bytes();
+        flag.to = r.bytes();
+        flag.value = r.u8() != 0;
+    }
+
+    result.anomaliesDiscovered.resize(r.count(5));
+    for (auto& flag : result.anomaliesDiscovered) {
+        flag.id = r.bytes();
+        flag.value = r.u8() != 0;
+    }
+
+    if (!r.ok() || !r.atEnd()) {
+        error = "Truncated or corrupt galaxy delta";
+        return false;
+    }
+    delta = std::move(result);
+    return true;
+}
+
+} // namespace space4x
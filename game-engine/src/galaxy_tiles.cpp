@@ -0,0 +1,210 @@
+#include "galaxy_tiles.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace space4x {
+
+namespace {
+
+// Lower ranks win a level-of-detail cell
+int detailRank(const StarSystem& system, SystemTier tier) {
+    if (system.isFixed || tier == SystemTier::Origin) return 0;
+    return tier == SystemTier::Core ? 1 : 2;
+}
+
+// Liang-Barsky: trims the segment to the viewport, false if it misses it entirely
+bool clipSegment(const GalaxyTileIndex::Viewport& viewport, GalaxyTileIndex::LaneSegment& segment) {
+    const double dx = segment.x2 - segment.x1;
+    const double dy = segment.y2 - segment.y1;
+    const double p[4] = {-dx, dx, -dy, dy};
+    const double q[4] = {segment.x1 - viewport.minX, viewport.maxX - segment.x1,
+                         segment.y1 - viewport.minY, viewport.maxY - segment.y1};
+    double enter = 0.0, leave = 1.0;
+    for (int side = 0; side < 4; side++) {
+        if (p[side] == 0.0) {
+            if (q[side] < 0.0) return false;  // Parallel to this edge and outside it
+            continue;
+        }
+        double t = q[side] / p[side];
+        if (p[side] < 0.0) {
+            if (t > leave) return false;
+            enter = std::max(enter, t);
+        } else {
+            if (t < enter) return false;
+            leave = std::min(leave, t);
+        }
+    }
+
+    segment.clipped = enter > 0.0 || leave < 1.0;
+    double x1 = segment.x1, y1 = segment.y1;
+    segment.x1 = x1 + enter * dx;
+    segment.y1 = y1 + enter * dy;
+    segment.x2 = x1 + leave * dx;
+    segment.y2 = y1 + leave * dy;
+    return true;
+}
+
+} // namespace
+
+// ============================================================================
+// GALAXY TILE INDEX
+// ============================================================================
+
+GalaxyTileIndex::GalaxyTileIndex(std::shared_ptr<const Galaxy> galaxy) : source(std::move(galaxy)) {
+    // Edits may place systems past the generated radius; tiles cover them too
+    extent = std::max(source->config.radius, 1.0);
+    for (const auto& system : source->systems) {
+        extent = std::max(extent, std::max(std::fabs(system.x), std::fabs(system.y)));
+    }
+
+    // Cells whose diagonal is below the minimum spacing hold at most one system
+    double spacing = source->config.minDistance;
+    if (spacing > 0.0) {
+        double zoom = std::ceil(std::log2(2.0 * extent * std::sqrt(2.0) / (kCellsPerTile * spacing)));
+        finestZoom = static_cast<int>(std::max(0.0, std::min<double>(zoom, kMaxZoom)));
+    } else {
+        finestZoom = kMaxZoom;
+    }
+}
+
+bool GalaxyTileIndex::tileViewport(int zoom, int x, int y, Viewport& viewport) const {
+    if (zoom < 0 || zoom > kMaxZoom) return false;
+    const int tiles = 1 << zoom;
+    if (x < 0 || y < 0 || x >= tiles || y >= tiles) return false;
+
+    const double size = 2.0 * extent / tiles;
+    viewport.minX = -extent + x * size;
+    viewport.minY = -extent + y * size;
+    viewport.maxX = viewport.minX + size;
+    viewport.maxY = viewport.minY + size;
+    viewport.zoom = zoom;
+    return true;
+}
+
+void GalaxyTileIndex::build() {
+    const Galaxy& galaxy = *source;
+    const GalaxyGeometry& geometry = galaxy.geometry;
+    const size_t count = galaxy.systems.size();
+
+    systemGrid.reset(extent, SpatialGrid::cellSizeFor(extent, count, 1.0));
+    for (size_t i = 0; i < count; i++) {
+        systemGrid.insert(galaxy.systems[i].x, galaxy.systems[i].y);
+    }
+    anomalyGrid.reset(extent, SpatialGrid::cellSizeFor(extent, galaxy.anomalies.size(), 1.0));
+    for (const auto& anomaly : galaxy.anomalies) {
+        anomalyGrid.insert(anomaly.x, anomaly.y);
+    }
+
+    // The best system of a cell is also the best of the finer cell it sits in,
+    // so a system shown at one zoom stays shown at every closer one
+    systemZoom.assign(count, static_cast<uint8_t>(finestZoom));
+    std::unordered_map<uint64_t, uint32_t> best;
+    best.reserve(count);
+    for (int zoom = 0; zoom < finestZoom; zoom++) {
+        const int64_t cells = static_cast<int64_t>(kCellsPerTile) << zoom;
+        const double scale = cells / (2.0 * extent);
+        best.clear();
+        for (uint32_t i = 0; i < count; i++) {
+            int64_t cx = std::min<int64_t>(cells - 1, std::max<int64_t>(0, static_cast<int64_t>((galaxy.systems[i].x + extent) * scale)));
+            int64_t cy = std::min<int64_t>(cells - 1, std::max<int64_t>(0, static_cast<int64_t>((galaxy.systems[i].y + extent) * scale)));
+            auto slot = best.emplace(static_cast<uint64_t>(cy * cells + cx), i);
+            if (slot.second) continue;
+
+            uint32_t holder = slot.first->second;
+            int rank = detailRank(galaxy.systems[i], geometry.tier[i]);
+            int holderRank = detailRank(galaxy.systems[holder], geometry.tier[holder]);
+            if (rank < holderRank || (rank == holderRank && geometry.degree(i) > geometry.degree(holder))) {
+                slot.first->second = i;
+            }
+        }
+        for (const auto& cell : best) {
+            systemZoom[cell.second] = std::min<uint8_t>(systemZoom[cell.second], static_cast<uint8_t>(zoom));
+        }
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (detailRank(galaxy.systems[i], geometry.tier[i]) == 0) systemZoom[i] = 0;
+    }
+
+    // Lanes by the grid cells their bounding boxes touch (counting sort into CSR)
+    const size_t lanes = galaxy.warpLanes.size();
+    laneEnds.resize(2 * lanes);
+    for (size_t l = 0; l < lanes; l++) {
+        laneEnds[2 * l] = galaxy.systemIndex->at(galaxy.warpLanes[l].from);
+        laneEnds[2 * l + 1] = galaxy.systemIndex->at(galaxy.warpLanes[l].to);
+    }
+    laneCellsPerSide = std::max(1, std::min(1024, static_cast<int>(std::ceil(std::sqrt(lanes / 2.0)))));
+    laneCellSize = 2.0 * extent / laneCellsPerSide;
+
+    auto forEachCell = [&](size_t l, auto&& visit) {
+        uint32_t a = laneEnds[2 * l], b = laneEnds[2 * l + 1];
+        int firstX = laneCell(std::min(geometry.x[a], geometry.x[b]));
+        int lastX = laneCell(std::max(geometry.x[a], geometry.x[b]));
+        int firstY = laneCell(std::min(geometry.y[a], geometry.y[b]));
+        int lastY = laneCell(std::max(geometry.y[a], geometry.y[b]));
+        for (int cy = firstY; cy <= lastY; cy++) {
+            for (int cx = firstX; cx <= lastX; cx++) visit(cy * laneCellsPerSide + cx);
+        }
+    };
+    laneCellOffsets.assign(static_cast<size_t>(laneCellsPerSide) * laneCellsPerSide + 1, 0);
+    for (size_t l = 0; l < lanes; l++) {
+        forEachCell(l, [&](int cell) { laneCellOffsets[cell + 1]++; });
+    }
+    for (size_t cell = 1; cell < laneCellOffsets.size(); cell++) {
+        laneCellOffsets[cell] += laneCellOffsets[cell - 1];
+    }
+    laneCellLanes.resize(laneCellOffsets.back());
+    std::vector<uint32_t> fill(laneCellOffsets.begin(), laneCellOffsets.end() - 1);
+    for (size_t l = 0; l < lanes; l++) {
+        forEachCell(l, [&](int cell) { laneCellLanes[fill[cell]++] = static_cast<uint32_t>(l); });
+    }
+}
+
+int GalaxyTileIndex::laneCell(double value) const {
+    double cell = std::floor((value + extent) / laneCellSize);
+    if (cell < 0.0) return 0;
+    if (cell >= laneCellsPerSide) return laneCellsPerSide - 1;
+    return static_cast<int>(cell);
+}
+
+GalaxyTileIndex::Tile GalaxyTileIndex::query(const Viewport& viewport) {
+    std::call_once(built, [this]() { build(); });
+    const GalaxyGeometry& geometry = source->geometry;
+    const int zoom = std::max(0, viewport.zoom);
+    Tile tile;
+
+    systemGrid.forEachInBox(viewport.minX, viewport.minY, viewport.maxX, viewport.maxY, [&](size_t i) {
+        if (systemZoom[i] <= zoom) {
+            tile.systems.push_back(static_cast<uint32_t>(i));
+        } else {
+            tile.hiddenSystems++;
+        }
+    });
+    std::sort(tile.systems.begin(), tile.systems.end());
+
+    anomalyGrid.forEachInBox(viewport.minX, viewport.minY, viewport.maxX, viewport.maxY, [&](size_t i) {
+        tile.anomalies.push_back(static_cast<uint32_t>(i));
+    });
+    std::sort(tile.anomalies.begin(), tile.anomalies.end());
+
+    std::vector<uint32_t> candidates;
+    for (int cy = laneCell(viewport.minY); cy <= laneCell(viewport.maxY); cy++) {
+        for (int cx = laneCell(viewport.minX); cx <= laneCell(viewport.maxX); cx++) {
+            int cell = cy * laneCellsPerSide + cx;
+            candidates.insert(candidates.end(), laneCellLanes.begin() + laneCellOffsets[cell],
+                              laneCellLanes.begin() + laneCellOffsets[cell + 1]);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    for (uint32_t l : candidates) {
+        uint32_t a = laneEnds[2 * l], b = laneEnds[2 * l + 1];
+        if (systemZoom[a] > zoom || systemZoom[b] > zoom) continue;
+        LaneSegment segment = {l, geometry.x[a], geometry.y[a], geometry.x[b], geometry.y[b], false};
+        if (clipSegment(viewport, segment)) tile.lanes.push_back(segment);
+    }
+    return tile;
+}
+
+} // namespace space4x
@@ -0,0 +1,191 @@
+#include "http_encoding.h"
+#include "metrics.h"
+#include <zlib.h>
+#include <cctype>
+#include <cstdlib>
+#ifdef SPACE4X_WITH_BROTLI
+#include <brotli/encode.h>
+#endif
+#ifdef SPACE4X_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace space4x {
+
+namespace {
+
+// Dynamic responses are compressed per request, so levels favour speed
+const int kGzipLevel = 6;
+const int kBrotliQuality = 5;
+const int kZstdLevel = 3;
+
+// Server preference when q values tie
+const ContentEncoding kPreferred[] = {ContentEncoding::Brotli, ContentEncoding::Zstd, ContentEncoding::Gzip};
+
+std::string trimmed(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t");
+    if (first == std::string::npos) return "";
+    size_t last = text.find_last_not_of(" \t");
+    return text.substr(first, last - first + 1);
+}
+
+std::string lowercase(std::string text) {
+    for (char& c : text) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return text;
+}
+
+std::shared_ptr<const std::string> gzip(const std::string& body) {
+    z_stream stream = {};
+    // 15 + 16: largest window, with a gzip header and trailer
+    if (deflateInit2(&stream, kGzipLevel, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) return nullptr;
+    auto out = std::make_shared<std::string>(deflateBound(&stream, body.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+    stream.avail_in = static_cast<uInt>(body.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&(*out)[0]);
+    stream.avail_out = static_cast<uInt>(out->size());
+    int status = deflate(&stream, Z_FINISH);
+    out->resize(stream.total_out);
+    deflateEnd(&stream);
+    return status == Z_STREAM_END ? out : nullptr;
+}
+
+#ifdef SPACE4X_WITH_BROTLI
+std::shared_ptr<const std::string> brotli(const std::string& body) {
+    size_t size = BrotliEncoderMaxCompressedSize(body.size());
+    if (size == 0) return nullptr;
+    auto out = std::make_shared<std::string>(size, '\0');
+    if (!BrotliEncoderCompress(kBrotliQuality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, body.size(),
+                               reinterpret_cast<const uint8_t*>(body.data()), &size,
+                               reinterpret_cast<uint8_t*>(&(*out)[0]))) {
+        return nullptr;
+    }
+    out->resize(size);
+    return out;
+}
+#endif
+
+#ifdef SPACE4X_WITH_ZSTD
+std::shared_ptr<const std::string> zstd(const std::string& body) {
+    auto out = std::make_shared<std::string>(ZSTD_compressBound(body.size()), '\0');
+    size_t size = ZSTD_compress(&(*out)[0], out->size(), body.data(), body.size(), kZstdLevel);
+    if (ZSTD_isError(size)) return nullptr;
+    out->resize(size);
+    return out;
+}
+#endif
+
+} // namespace
+
+// ============================================================================
+// NEGOTIATION
+// ============================================================================
+
+const char* contentEncodingName(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::Identity: return "identity";
+        case ContentEncoding::Gzip: return "gzip";
+        case ContentEncoding::Brotli: return "br";
+        case ContentEncoding::Zstd: return "zstd";
+    }
+    return "identity";
+}
+
+bool encodingSupported(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::Identity:
+        case ContentEncoding::Gzip:
+            return true;
+        case ContentEncoding::Brotli:
+#ifdef SPACE4X_WITH_BROTLI
+            return true;
+#else
+            return false;
+#endif
+        case ContentEncoding::Zstd:
+#ifdef SPACE4X_WITH_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+ContentEncoding negotiateEncoding(const std::string& acceptEncoding) {
+    // q per encoding as listed; -1 = not mentioned, so "*" decides
+    double q[kContentEncodingCount] = {-1.0, -1.0, -1.0, -1.0};
+    double wildcard = 0.0;
+    size_t start = 0;
+    while (start < acceptEncoding.size()) {
+        size_t end = acceptEncoding.find(',', start);
+        if (end == std::string::npos) end = acceptEncoding.size();
+        std::string item = acceptEncoding.substr(start, end - start);
+        start = end + 1;
+
+        size_t semicolon = item.find(';');
+        std::string coding = lowercase(trimmed(item.substr(0, semicolon)));
+        double weight = 1.0;
+        if (semicolon != std::string::npos) {
+            std::string parameter = trimmed(item.substr(semicolon + 1));
+            if (parameter.size() > 2 && (parameter[0] == 'q' || parameter[0] == 'Q') && parameter[1] == '=') {
+                weight = std::strtod(parameter.c_str() + 2, nullptr);
+            }
+        }
+        if (coding == "*") {
+            wildcard = weight;
+        } else if (coding == "gzip" || coding == "x-gzip") {
+            q[static_cast<size_t>(ContentEncoding::Gzip)] = weight;
+        } else if (coding == "br") {
+            q[static_cast<size_t>(ContentEncoding::Brotli)] = weight;
+        } else if (coding == "zstd") {
+            q[static_cast<size_t>(ContentEncoding::Zstd)] = weight;
+        }
+    }
+
+    ContentEncoding best = ContentEncoding::Identity;
+    double bestWeight = 0.0;
+    for (ContentEncoding encoding : kPreferred) {
+        double weight = q[static_cast<size_t>(encoding)];
+        if (weight < 0.0) weight = wildcard;
+        if (encodingSupported(encoding) && weight > bestWeight) {
+            best = encoding;
+            bestWeight = weight;
+        }
+    }
+    return best;
+}
+
+// ============================================================================
+// ENCODING
+// ============================================================================
+
+std::shared_ptr<const std::string> encodeBody(const std::string& body, ContentEncoding encoding) {
+    if (encoding == ContentEncoding::Identity) return nullptr;
+    static const MetricId timers[kContentEncodingCount] = {
+        0,
+        MetricsRegistry::global().histogram("space4x_compression_seconds", "Time to compress a response body",
+                                            metricLabel("encoding", "gzip")),
+        MetricsRegistry::global().histogram("space4x_compression_seconds", "Time to compress a response body",
+                                            metricLabel("encoding", "br")),
+        MetricsRegistry::global().histogram("space4x_compression_seconds", "Time to compress a response body",
+                                            metricLabel("encoding", "zstd")),
+    };
+    ScopedTimer timing(timers[static_cast<size_t>(encoding)]);
+    switch (encoding) {
+        case ContentEncoding::Gzip: return gzip(body);
+#ifdef SPACE4X_WITH_BROTLI
+        case ContentEncoding::Brotli: return brotli(body);
+#endif
+#ifdef SPACE4X_WITH_ZSTD
+        case ContentEncoding::Zstd: return zstd(body);
+#endif
+        default: return nullptr;
+    }
+}
+
+std::string encodedEtag(const std::string& etag, ContentEncoding encoding) {
+    if (encoding == ContentEncoding::Identity || etag.size() < 2) return etag;
+    return etag.substr(0, etag.size() - 1) + "-" + contentEncodingName(encoding) + "\"";
+}
+
+} // namespace space4x
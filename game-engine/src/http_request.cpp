@@ -0,0 +1,111 @@
+#include "http_request.h"
+#include <cctype>
+
+namespace space4x {
+
+namespace {
+
+std::string lowercase(std::string text) {
+    for (char& c : text) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return text;
+}
+
+std::string trim(const std::string& text, size_t start, size_t end) {
+    while (start < end && (text[start] == ' ' || text[start] == '\t')) start++;
+    while (end > start && (text[end - 1] == ' ' || text[end - 1] == '\t')) end--;
+    return text.substr(start, end - start);
+}
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+std::string percentDecode(const std::string& text, size_t start, size_t end) {
+    std::string decoded;
+    decoded.reserve(end - start);
+    for (size_t i = start; i < end; i++) {
+        if (text[i] == '+') {
+            decoded.push_back(' ');
+        } else if (text[i] == '%' && i + 2 < end && hexDigit(text[i + 1]) >= 0 && hexDigit(text[i + 2]) >= 0) {
+            decoded.push_back(static_cast<char>(hexDigit(text[i + 1]) * 16 + hexDigit(text[i + 2])));
+            i += 2;
+        } else {
+            decoded.push_back(text[i]);
+        }
+    }
+    return decoded;
+}
+
+} // namespace
+
+bool HttpRequest::parse(const std::string& raw, HttpRequest& request) {
+    size_t headEnd = raw.find("\r\n\r\n");
+    size_t lineEnd = raw.find("\r\n");
+    if (headEnd == std::string::npos || lineEnd == std::string::npos) return false;
+
+    // Request line: METHOD SP target SP version
+    size_t methodEnd = raw.find(' ', 0);
+    if (methodEnd == std::string::npos || methodEnd == 0 || methodEnd > lineEnd) return false;
+    size_t targetEnd = raw.find(' ', methodEnd + 1);
+    if (targetEnd == std::string::npos || targetEnd > lineEnd || targetEnd == methodEnd + 1) return false;
+
+    request.method = raw.substr(0, methodEnd);
+    request.version = raw.substr(targetEnd + 1, lineEnd - targetEnd - 1);
+    size_t queryStart = raw.find('?', methodEnd + 1);
+    if (queryStart != std::string::npos && queryStart < targetEnd) {
+        request.path = raw.substr(methodEnd + 1, queryStart - methodEnd - 1);
+        request.query = raw.substr(queryStart + 1, targetEnd - queryStart - 1);
+    } else {
+        request.path = raw.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+        request.query.clear();
+    }
+
+    request.headers.clear();
+    size_t lineStart = lineEnd + 2;
+    while (lineStart < headEnd) {
+        size_t end = raw.find("\r\n", lineStart);
+        if (end == std::string::npos || end > headEnd) end = headEnd;
+        size_t colon = raw.find(':', lineStart);
+        if (colon != std::string::npos && colon < end) {
+            request.headers.emplace_back(lowercase(trim(raw, lineStart, colon)), trim(raw, colon + 1, end));
+        }
+        lineStart = end + 2;
+    }
+
+    request.body = raw.substr(headEnd + 4);
+    return true;
+}
+
+std::string HttpRequest::header(const std::string& name) const {
+    std::string wanted = lowercase(name);
+    for (const auto& header : headers) {
+        if (header.first == wanted) return header.second;
+    }
+    return "";
+}
+
+std::string HttpRequest::queryParam(const std::string& name) const {
+    size_t start = 0;
+    while (start <= query.size()) {
+        size_t end = query.find('&', start);
+        if (end == std::string::npos) end = query.size();
+        size_t equals = query.find('=', start);
+        size_t nameEnd = (equals != std::string::npos && equals < end) ? equals : end;
+        if (percentDecode(query, start, nameEnd) == name) {
+            return nameEnd < end ? percentDecode(query, nameEnd + 1, end) : "";
+        }
+        start = end + 1;
+    }
+    return "";
+}
+
+bool HttpRequest::keepAlive() const {
+    std::string connection = lowercase(header("Connection"));
+    if (version == "HTTP/1.0") return connection == "keep-alive";
+    return connection != "close";
+}
+
+} // namespace space4x
@@ -0,0 +1,749 @@
+#include "http_transport.h"
+#include <iostream>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+
+#ifdef __APPLE__
+#include <sys/event.h>
+#else
+#include <sys/epoll.h>
+#endif
+
+namespace space4x {
+
+// ============================================================================
+// CONNECTION HANDLING
+// ============================================================================
+
+// Readiness notification over epoll (Linux) or kqueue (macOS). Client sockets
+// are armed one-shot, so exactly one worker owns a connection between arms.
+// A self-pipe lets another thread cut a wait short.
+class EventPoller {
+public:
+    ~EventPoller() {
+        if (fd >= 0) close(fd);
+        for (int end : wakeFds) {
+            if (end >= 0) close(end);
+        }
+    }
+
+    bool open() {
+#ifdef __APPLE__
+        fd = kqueue();
+#else
+        fd = epoll_create1(0);
+#endif
+        if (fd < 0 || pipe(wakeFds) != 0) return false;
+        for (int end : wakeFds) fcntl(end, F_SETFL, fcntl(end, F_GETFL, 0) | O_NONBLOCK);
+        return watchListener(wakeFds[0]);
+    }
+
+    bool watchListener(int listenFd) {
+#ifdef __APPLE__
+        struct kevent change;
+        EV_SET(&change, listenFd, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+        return kevent(fd, &change, 1, nullptr, 0, nullptr) == 0;
+#else
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = listenFd;
+        return epoll_ctl(fd, EPOLL_CTL_ADD, listenFd, &event) == 0;
+#endif
+    }
+
+    bool unwatchListener(int listenFd) {
+#ifdef __APPLE__
+        struct kevent change;
+        EV_SET(&change, listenFd, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+        return kevent(fd, &change, 1, nullptr, 0, nullptr) == 0;
+#else
+        return epoll_ctl(fd, EPOLL_CTL_DEL, listenFd, nullptr) == 0;
+#endif
+    }
+
+    // Wakes the loop once when the client has data, or with forWrite once its
+    // socket takes more output; call again after each service
+    bool armClient(int clientFd, bool firstTime, bool forWrite = false) {
+#ifdef __APPLE__
+        (void)firstTime;
+        struct kevent change;
+        EV_SET(&change, clientFd, forWrite ? EVFILT_WRITE : EVFILT_READ, EV_ADD | EV_ONESHOT, 0, 0, nullptr);
+        return kevent(fd, &change, 1, nullptr, 0, nullptr) == 0;
+#else
+        // No EPOLLRDHUP while writing: a half-closed peer may still read, and
+        // would otherwise wake the loop for a socket that has no room yet
+        epoll_event event{};
+        event.events = (forWrite ? EPOLLOUT : EPOLLIN | EPOLLRDHUP) | EPOLLONESHOT;
+        event.data.fd = clientFd;
+        return epoll_ctl(fd, firstTime ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, clientFd, &event) == 0;
+#endif
+    }
+
+    // Ends the current or next wait early; safe from any thread
+    void wake() {
+        char byte = 0;
+        ssize_t written = write(wakeFds[1], &byte, 1);  // A full pipe already holds a wake-up
+        (void)written;
+    }
+
+    // Fills readyFds with up to maxEvents ready descriptors; returns the count.
+    // A wake-up ends the wait without being reported
+    int wait(int* readyFds, int maxEvents, int timeoutMs) {
+#ifdef __APPLE__
+        struct kevent events[64];
+        struct timespec timeout = {timeoutMs / 1000, (timeoutMs % 1000) * 1000000L};
+        int count = kevent(fd, nullptr, 0, events, std::min(maxEvents, 64), &timeout);
+        for (int i = 0; i < count; i++) readyFds[i] = static_cast<int>(events[i].ident);
+#else
+        epoll_event events[64];
+        int count = epoll_wait(fd, events, std::min(maxEvents, 64), timeoutMs);
+        for (int i = 0; i < count; i++) readyFds[i] = events[i].data.fd;
+#endif
+        int kept = 0;
+        for (int i = 0; i < count; i++) {
+            if (readyFds[i] != wakeFds[0]) {
+                readyFds[kept++] = readyFds[i];
+                continue;
+            }
+            char drained[64];
+            while (read(wakeFds[0], drained, sizeof(drained)) > 0) {}
+        }
+        return count < 0 ? count : kept;
+    }
+
+private:
+    int fd = -1;
+    int wakeFds[2] = {-1, -1};  // Read end watched, write end written by wake()
+};
+
+struct ClientConnection {
+    typedef std::chrono::steady_clock Clock;
+
+    int fd;
+    HttpRequestParser parser;
+
+    // Response the socket had no room for, and what becomes of the connection after
+    std::string pendingHead;
+    std::shared_ptr<const std::string> pendingBody;
+    size_t pendingWritten = 0;  // Through the head, then the body
+    bool closeAfterWrite = false;
+    bool peerClosed = false;    // Buffered requests are still served, then it closes
+    Clock::time_point requestStarted;  // When the partial request in the buffer began
+
+    // Set while the connection waits in the poller, where only the loop thread
+    // touches it; the sweep closes it then if the deadline has passed
+    std::atomic<bool> armed{false};
+    std::atomic<Clock::rep> deadline{0};
+
+    // Transport-wide count of unparsed request bytes, and this connection's share
+    std::atomic<size_t>& bufferedBytes;
+    size_t counted = 0;
+
+    ClientConnection(int fd, size_t maxRequestBytes, std::atomic<size_t>& bufferedBytes)
+        : fd(fd), parser(maxRequestBytes), bufferedBytes(bufferedBytes) {}
+    ~ClientConnection() { bufferedBytes -= counted; }
+
+    // Returns the share of requests the parser has taken off
+    void releaseParsed() {
+        size_t held = parser.buffered();
+        if (held >= counted) return;
+        bufferedBytes -= counted - held;
+        counted = held;
+    }
+};
+
+namespace {
+
+const int kTickMillis = 500;
+const int kPausedTickMillis = 10;  // Queue depth is rechecked this often while the listener is paused
+const size_t kRetainedParserBytes = 64 * 1024;  // Parser storage kept between requests
+
+void setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0) fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+// Value of a header in the request head (case-insensitive name), or ""
+std::string headerValue(const std::string& request, size_t headerEnd, const std::string& name) {
+    const std::string wanted = toLower(name);
+    size_t lineStart = request.find("\r\n");
+    while (lineStart != std::string::npos && lineStart < headerEnd) {
+        lineStart += 2;
+        size_t lineEnd = request.find("\r\n", lineStart);
+        if (lineEnd == std::string::npos || lineEnd > headerEnd) lineEnd = headerEnd;
+
+        size_t colon = request.find(':', lineStart);
+        if (colon != std::string::npos && colon < lineEnd &&
+            toLower(request.substr(lineStart, colon - lineStart)) == wanted) {
+            size_t valueStart = request.find_first_not_of(" \t", colon + 1);
+            if (valueStart == std::string::npos || valueStart >= lineEnd) return "";
+            size_t valueEnd = request.find_last_not_of(" \t", lineEnd - 1);
+            return request.substr(valueStart, valueEnd - valueStart + 1);
+        }
+        lineStart = lineEnd;
+    }
+    return "";
+}
+
+// Takes up to wanted bytes of the transport-wide budget; returns how many
+size_t claimBuffer(ClientConnection& connection, size_t wanted, size_t maxBufferedBytes) {
+    size_t used = connection.bufferedBytes.load();
+    size_t granted;
+    do {
+        granted = used >= maxBufferedBytes ? 0 : std::min(wanted, maxBufferedBytes - used);
+        if (granted == 0) return 0;
+    } while (!connection.bufferedBytes.compare_exchange_weak(used, used + granted));
+    return granted;
+}
+
+enum class ReadResult { Open, PeerClosed, OverBudget };
+
+// Reads what is available until the parser holds a request's limit or the
+// transport's buffer budget is spent; the rest waits in the socket for the
+// parser to take requests off. OverBudget only when the socket has more
+ReadResult readAvailable(ClientConnection& connection, size_t maxBufferedBytes) {
+    char buffer[16384];
+    while (connection.parser.room() > 0) {
+        size_t granted = claimBuffer(connection, std::min(sizeof(buffer), connection.parser.room()), maxBufferedBytes);
+        if (granted == 0) {
+            char next;
+            ssize_t peeked = recv(connection.fd, &next, 1, MSG_PEEK);
+            if (peeked > 0) return ReadResult::OverBudget;
+            if (peeked < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return ReadResult::Open;
+            return ReadResult::PeerClosed;
+        }
+
+        ssize_t bytesRead = read(connection.fd, buffer, granted);
+        size_t kept = bytesRead > 0 ? static_cast<size_t>(bytesRead) : 0;
+        connection.bufferedBytes -= granted - kept;
+        if (bytesRead > 0) {
+            connection.counted += kept;
+            connection.parser.append(buffer, kept);
+            continue;
+        }
+        if (bytesRead == 0) return ReadResult::PeerClosed;
+        if (errno == EINTR) continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK ? ReadResult::Open : ReadResult::PeerClosed;
+    }
+    return ReadResult::Open;
+}
+
+enum class WriteResult { Done, Blocked, Failed };
+
+// Writes as much of the pending response as the socket takes without waiting
+WriteResult writePending(ClientConnection& connection) {
+    const std::string& head = connection.pendingHead;
+    size_t bodySize = connection.pendingBody ? connection.pendingBody->size() : 0;
+    while (connection.pendingWritten < head.size() + bodySize) {
+        struct iovec parts[2];
+        int count = 0;
+        size_t written = connection.pendingWritten;
+        if (written < head.size()) {
+            parts[count++] = {const_cast<char*>(head.data()) + written, head.size() - written};
+            written = head.size();
+        }
+        size_t bodyOffset = written - head.size();
+        if (bodyOffset < bodySize) {
+            parts[count++] = {const_cast<char*>(connection.pendingBody->data()) + bodyOffset, bodySize - bodyOffset};
+        }
+
+        ssize_t sent = writev(connection.fd, parts, count);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return WriteResult::Blocked;
+        if (sent <= 0) return WriteResult::Failed;
+        connection.pendingWritten += static_cast<size_t>(sent);
+    }
+    connection.pendingHead.clear();
+    connection.pendingBody.reset();
+    connection.pendingWritten = 0;
+    return WriteResult::Done;
+}
+
+} // namespace
+
+bool writeAll(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t count = write(fd, data.data() + written, data.size() - written);
+        if (count > 0) {
+            written += static_cast<size_t>(count);
+        } else if (count < 0 && errno == EINTR) {
+            continue;
+        } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Socket buffer full: wait for the client to drain it
+            struct pollfd pending = {fd, POLLOUT, 0};
+            if (poll(&pending, 1, 30000) <= 0) return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// REQUEST PARSER
+// ============================================================================
+
+HttpRequestParser::Status HttpRequestParser::readHead() {
+    // Resume a few bytes back, in case the terminator straddles two reads
+    size_t from = scanned > 3 ? scanned - 3 : 0;
+    size_t headerEnd = buffer.find("\r\n\r\n", from);
+    if (headerEnd == std::string::npos) {
+        scanned = buffer.size();
+        return buffer.size() > maxRequestBytes ? Status::TooLarge : Status::NeedMore;
+    }
+
+    if (!headerValue(buffer, headerEnd, "Transfer-Encoding").empty()) return Status::Unsupported;
+    size_t contentLength = 0;
+    std::string lengthValue = headerValue(buffer, headerEnd, "Content-Length");
+    if (!lengthValue.empty()) {
+        char* end = nullptr;
+        unsigned long long parsed = std::strtoull(lengthValue.c_str(), &end, 10);
+        if (end == lengthValue.c_str() || *end != '\0') return Status::Malformed;
+        if (parsed > maxRequestBytes || headerEnd + 4 + parsed > maxRequestBytes) return Status::TooLarge;
+        contentLength = static_cast<size_t>(parsed);
+    }
+    bodyStart = headerEnd + 4;
+    total = bodyStart + contentLength;
+    expectContinue = contentLength > 0 && toLower(headerValue(buffer, headerEnd, "Expect")) == "100-continue";
+    return Status::Complete;
+}
+
+HttpRequestParser::Status HttpRequestParser::next(HttpRequest& request) {
+    if (bodyStart == 0) {
+        Status head = readHead();
+        if (head != Status::Complete) return head;
+    }
+    if (buffer.size() < total) return Status::NeedMore;
+
+    bool parsed = HttpRequest::parse(buffer.substr(0, total), request);
+    buffer.erase(0, total);
+    if (buffer.capacity() > kRetainedParserBytes && buffer.size() < buffer.capacity() / 4) {
+        buffer.shrink_to_fit();  // A large request's storage goes with it
+    }
+    scanned = 0;
+    bodyStart = 0;
+    total = 0;
+    expectContinue = false;
+    return parsed ? Status::Complete : Status::Malformed;
+}
+
+bool HttpRequestParser::wantsContinue() {
+    if (!expectContinue || buffer.size() >= total) return false;
+    expectContinue = false;
+    return true;
+}
+
+// ============================================================================
+// ROUTER
+// ============================================================================
+
+void HttpRouter::add(const std::string& method, const std::string& pattern, Handler handler) {
+    auto known = std::find(patterns.begin(), patterns.end(), pattern);
+    size_t label = static_cast<size_t>(known - patterns.begin());
+    if (known == patterns.end()) patterns.push_back(pattern);
+
+    const std::string wildcard = "/:id";
+    bool prefix = pattern.size() > wildcard.size() &&
+                  pattern.compare(pattern.size() - wildcard.size(), wildcard.size(), wildcard) == 0;
+    std::string path = prefix ? pattern.substr(0, pattern.size() - wildcard.size() + 1) : pattern;
+    routes.push_back({method, path, prefix, label, std::move(handler)});
+}
+
+HttpRouter::Match HttpRouter::match(const HttpRequest& request) const {
+    Match found;
+    found.label = patterns.size();
+    for (int pass = 0; pass < 2; pass++) {
+        bool prefixPass = pass == 1;
+        for (const Route& route : routes) {
+            if (route.prefix != prefixPass) continue;
+            bool pathMatches = prefixPass ? request.path.compare(0, route.path.size(), route.path) == 0
+                                          : request.path == route.path;
+            if (!pathMatches) continue;
+            if (!found.pathKnown) {
+                found.pathKnown = true;
+                found.label = route.label;
+            }
+            if (route.method == "*" || route.method == request.method) {
+                found.handler = &route.handler;
+                found.label = route.label;
+                return found;
+            }
+        }
+        if (found.pathKnown) return found;
+    }
+    return found;
+}
+
+std::vector<std::string> HttpRouter::labels() const {
+    std::vector<std::string> all = patterns;
+    all.push_back("other");
+    return all;
+}
+
+// ============================================================================
+// TRANSPORT
+// ============================================================================
+
+HttpTransport::HttpTransport(int port, const Limits& limits, Handler handler, ErrorResponder errorResponse)
+    : listenPort(port), limits(limits), handler(std::move(handler)), errorResponse(std::move(errorResponse)) {
+    if (this->limits.workers == 0) {
+        this->limits.workers = std::max(4u, std::thread::hardware_concurrency());
+    }
+    MetricsRegistry& metrics = MetricsRegistry::global();
+    connectionsRejected = metrics.counter("space4x_http_connections_rejected_total",
+                                          "Connections turned away at the connection limit");
+    listenerPauses = metrics.counter("space4x_http_listener_paused_total",
+                                     "Times accepting paused because the worker queue was full");
+    connectionsTimedOut = metrics.counter("space4x_http_connections_timed_out_total",
+                                          "Connections closed for sitting past their idle, request or write deadline");
+    requestsShed = metrics.counter("space4x_http_requests_shed_total",
+                                   "Requests turned away because the request buffer budget was spent");
+}
+
+HttpTransport::~HttpTransport() {
+    stop();
+    if (listenFd >= 0) close(listenFd);  // Started but never run
+}
+
+bool HttpTransport::start() {
+    // A peer that hangs up mid-response must fail the write, not end the process
+    std::signal(SIGPIPE, SIG_IGN);
+
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "❌ Failed to create socket" << std::endl;
+        return false;
+    }
+
+    int opt = 1;
+    if (setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        std::cerr << "❌ Failed to set socket options" << std::endl;
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(listenPort);
+    if (bind(listenFd, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        std::cerr << "❌ Bind failed on port " << listenPort << std::endl;
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    if (listen(listenFd, SOMAXCONN) < 0) {
+        std::cerr << "❌ Failed to listen on socket" << std::endl;
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    setNonBlocking(listenFd);
+    poller.reset(new EventPoller());
+    if (!poller->open() || !poller->watchListener(listenFd)) {
+        std::cerr << "❌ Failed to set up event polling" << std::endl;
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    isRunning = true;
+    return true;
+}
+
+// Leaves the listener to the loop thread, which still polls and accepts on it;
+// closing it here could close a descriptor number a new client already reuses
+void HttpTransport::stop() {
+    isRunning = false;
+    if (poller) poller->wake();
+}
+
+void HttpTransport::run(const std::function<void()>& onTick) {
+    workers.reset(new ThreadPool(limits.workers));
+
+    int ready[64];
+    auto lastTick = std::chrono::steady_clock::now();
+    while (isRunning) {
+        int count = poller->wait(ready, 64, listenerPaused ? kPausedTickMillis : kTickMillis);
+        if (count < 0) {
+            if (errno != EINTR && isRunning) {
+                std::cerr << "❌ Event wait failed: " << std::strerror(errno) << std::endl;
+            }
+            count = 0;
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (ready[i] == listenFd) {
+                acceptConnections();
+                continue;
+            }
+
+            std::shared_ptr<ClientConnection> connection;
+            {
+                std::lock_guard<std::mutex> lock(connectionsMutex);
+                auto it = connections.find(ready[i]);
+                if (it != connections.end()) connection = it->second;
+            }
+            if (connection) {
+                connection->armed = false;
+                workers->submit([this, connection]() { serviceConnection(connection); });
+            }
+        }
+        applyBackpressure();
+
+        // Swept after the batch, so no event still in hand names a closed descriptor
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastTick >= std::chrono::milliseconds(kTickMillis)) {
+            lastTick = now;
+            closeExpiredConnections();
+            if (onTick) onTick();
+        }
+    }
+
+    // Stop taking clients, let in-flight requests finish, then drop idle
+    // keep-alive connections
+    close(listenFd);
+    listenFd = -1;
+    listenerPaused = false;
+    workers.reset();
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    for (const auto& entry : connections) {
+        close(entry.first);
+    }
+    connections.clear();
+}
+
+void HttpTransport::applyBackpressure() {
+    if (listenFd < 0) return;
+    size_t queued = workers->pending();
+    size_t limit = limits.workers * limits.maxQueuedPerWorker;
+    if (!listenerPaused && queued > limit) {
+        if (poller->unwatchListener(listenFd)) {
+            listenerPaused = true;
+            MetricsRegistry::global().add(listenerPauses);
+        }
+    } else if (listenerPaused && queued <= limit / 2) {
+        if (poller->watchListener(listenFd)) listenerPaused = false;
+    }
+}
+
+void HttpTransport::acceptConnections() {
+    for (;;) {
+        struct sockaddr_in client_address;
+        socklen_t client_len = sizeof(client_address);
+
+        int client_fd = accept(listenFd, (struct sockaddr*)&client_address, &client_len);
+        if (client_fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK && isRunning) {
+                std::cerr << "❌ Failed to accept connection" << std::endl;
+            }
+            return;
+        }
+
+        setNonBlocking(client_fd);
+        int noDelay = 1;
+        setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        auto connection = std::make_shared<ClientConnection>(client_fd, limits.maxRequestBytes, bufferedBytes);
+        bool full;
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            full = connections.size() >= limits.maxConnections;
+            if (!full) connections[client_fd] = connection;
+        }
+        if (full) {
+            // A fresh socket's buffer takes a short response; one try, never a wait
+            std::string rejection = errorResponse(503, "Too many connections; retry later");
+            send(client_fd, rejection.data(), rejection.size(), 0);
+            close(client_fd);
+            MetricsRegistry::global().add(connectionsRejected);
+            continue;
+        }
+        connection->deadline = (std::chrono::steady_clock::now() + limits.idleTimeout).time_since_epoch().count();
+        connection->armed = true;
+        if (!poller->armClient(client_fd, true)) {
+            closeConnection(connection);
+        }
+    }
+}
+
+void HttpTransport::serviceConnection(const std::shared_ptr<ClientConnection>& connection) {
+    ClientConnection& client = *connection;
+
+    // A response parked on a full socket goes out before anything else is read
+    if (!sendPending(connection)) return;
+    bool overBudget = false;
+    if (!client.peerClosed) {
+        ReadResult read = readAvailable(client, limits.maxBufferedBytes);
+        client.peerClosed = read == ReadResult::PeerClosed;
+        overBudget = read == ReadResult::OverBudget;
+    }
+
+    // Serve every complete request in the buffer (pipelined requests included)
+    for (;;) {
+        HttpRequest request;
+        HttpRequestParser::Status status = client.parser.next(request);
+        client.releaseParsed();
+        if (status == HttpRequestParser::Status::NeedMore) {
+            if (overBudget && !client.peerClosed) {
+                // Requests taken off since may have freed some budget; without
+                // progress the request cannot be finished, so it is shed
+                size_t before = client.parser.buffered();
+                ReadResult read = readAvailable(client, limits.maxBufferedBytes);
+                client.peerClosed = read == ReadResult::PeerClosed;
+                overBudget = read == ReadResult::OverBudget;
+                if (overBudget && client.parser.buffered() == before) {
+                    client.pendingHead = errorResponse(503, "Server busy; retry later");
+                    client.closeAfterWrite = true;
+                    MetricsRegistry::global().add(requestsShed);
+                    sendPending(connection);
+                    return;
+                }
+                continue;
+            }
+            if (client.peerClosed || !client.parser.wantsContinue()) break;
+            client.pendingHead = "HTTP/1.1 100 Continue\r\n\r\n";
+            if (!sendPending(connection)) return;
+            continue;
+        }
+        if (status != HttpRequestParser::Status::Complete) {
+            if (status == HttpRequestParser::Status::TooLarge) {
+                client.pendingHead = errorResponse(413, "Request too large");
+            } else if (status == HttpRequestParser::Status::Unsupported) {
+                client.pendingHead = errorResponse(501, "Chunked request bodies are not supported");
+            } else {
+                client.pendingHead = errorResponse(400, "Malformed request");
+            }
+            client.closeAfterWrite = true;
+            sendPending(connection);
+            return;
+        }
+        client.requestStarted = ClientConnection::Clock::time_point();
+
+        HttpResponse response(std::string{});
+        try {
+            response = handler(request);
+        } catch (const std::exception& e) {
+            std::cerr << "❌ Request failed: " << e.what() << std::endl;
+            response = errorResponse(500, "Internal server error");
+        }
+
+        if (response.stream) {
+            // The stream keeps this worker anyway, so its head may wait for room too
+            if (writeAll(client.fd, response.head) && (!response.body || writeAll(client.fd, *response.body))) {
+                response.stream(client.fd);
+            }
+            closeConnection(connection);
+            return;
+        }
+        client.pendingHead = std::move(response.head);
+        client.pendingBody = std::move(response.body);
+        client.closeAfterWrite = !request.keepAlive();
+        if (!sendPending(connection)) return;
+    }
+
+    if (client.peerClosed) {
+        closeConnection(connection);
+        return;
+    }
+
+    // Idle until the next request starts; from then on it has requestTimeout in all
+    auto now = ClientConnection::Clock::now();
+    if (client.parser.buffered() == 0) {
+        client.requestStarted = ClientConnection::Clock::time_point();
+        park(connection, false, now + limits.idleTimeout);
+    } else {
+        if (client.requestStarted == ClientConnection::Clock::time_point()) client.requestStarted = now;
+        park(connection, false, client.requestStarted + limits.requestTimeout);
+    }
+}
+
+// Writes the pending response, if any. True when it is out and the connection
+// stays open; false when it was parked until the socket drains, or closed, and
+// the caller must let go of it
+bool HttpTransport::sendPending(const std::shared_ptr<ClientConnection>& connection) {
+    WriteResult result = writePending(*connection);
+    if (result == WriteResult::Blocked) {
+        park(connection, true, ClientConnection::Clock::now() + limits.writeTimeout);
+        return false;
+    }
+    if (result == WriteResult::Failed || connection->closeAfterWrite) {
+        closeConnection(connection);
+        return false;
+    }
+    return true;
+}
+
+// Hands the connection back to the loop, or closes it if its deadline has
+// already passed: a client trickling bytes is mostly with a worker when the
+// sweep looks. The deadline is set before the connection counts as armed, so
+// the sweep never sees a stale one
+void HttpTransport::park(const std::shared_ptr<ClientConnection>& connection, bool forWrite,
+                         std::chrono::steady_clock::time_point deadline) {
+    if (deadline <= std::chrono::steady_clock::now()) {
+        closeConnection(connection);
+        MetricsRegistry::global().add(connectionsTimedOut);
+        return;
+    }
+    connection->deadline = deadline.time_since_epoch().count();
+    connection->armed = true;
+    if (!poller->armClient(connection->fd, false, forWrite)) {
+        closeConnection(connection);
+    }
+}
+
+// Only closes the descriptor if it still belongs to this connection
+void HttpTransport::closeConnection(const std::shared_ptr<ClientConnection>& connection) {
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        auto it = connections.find(connection->fd);
+        if (it == connections.end() || it->second != connection) return;
+        connections.erase(it);
+    }
+    close(connection->fd);
+}
+
+void HttpTransport::closeExpiredConnections() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    std::vector<int> expired;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        for (auto it = connections.begin(); it != connections.end();) {
+            // Connections out with a worker are never touched here
+            if (it->second->armed && it->second->deadline <= now) {
+                expired.push_back(it->first);
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    for (int fd : expired) {
+        close(fd);
+    }
+    if (!expired.empty()) MetricsRegistry::global().add(connectionsTimedOut, expired.size());
+}
+
+} // namespace space4x
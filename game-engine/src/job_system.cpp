@@ -0,0 +1,142 @@
+#include "job_system.h"
+#include <algorithm>
+
+namespace space4x {
+
+JobSystem::JobSystem(size_t threadCount) {
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < threadCount; i++) {
+        queues.emplace_back(new Queue());
+    }
+    workers.reserve(threadCount);
+    try {
+        for (size_t i = 0; i < threadCount; i++) {
+            workers.emplace_back([this, i]() { workerLoop(i); });
+        }
+    } catch (...) {
+        // Join whatever did start; a joinable std::thread going out of scope terminates
+        stop();
+        throw;
+    }
+}
+
+JobSystem::~JobSystem() {
+    stop();
+}
+
+JobSystem& JobSystem::global() {
+    static JobSystem jobs;
+    return jobs;
+}
+
+void JobSystem::stop() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const RangeBody& body) {
+    if (count == 0) return;
+    grain = std::max<size_t>(grain, 1);
+    size_t chunkCount = (count + grain - 1) / grain;
+    if (chunkCount == 1) {
+        body(0, count);
+        return;
+    }
+
+    Batch batch;
+    batch.body = &body;
+    batch.remaining = chunkCount;
+
+    // Deal the chunks out round-robin, so every worker starts with its own share
+    size_t start = nextQueue.fetch_add(1, std::memory_order_relaxed);
+    for (size_t q = 0; q < queues.size(); q++) {
+        Queue& queue = *queues[(start + q) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        for (size_t c = q; c < chunkCount; c += queues.size()) {
+            queue.chunks.push_back({&batch, c * grain, std::min(count, (c + 1) * grain)});
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued += static_cast<long>(chunkCount);
+    }
+    available.notify_all();
+
+    // Help until this batch is done; chunks of other batches count as help too
+    Chunk chunk;
+    while (batch.remaining.load(std::memory_order_acquire) > 0) {
+        if (take(start % queues.size(), chunk)) {
+            run(chunk);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(batch.mutex);
+        batch.finished.wait(lock, [&batch]() { return batch.remaining.load(std::memory_order_acquire) == 0; });
+    }
+
+    // Chunks count down under the batch mutex, so once it is ours the last one
+    // has let go of the batch too and it may go out of scope
+    std::lock_guard<std::mutex> lock(batch.mutex);
+    if (batch.failure) std::rethrow_exception(batch.failure);
+}
+
+bool JobSystem::take(size_t self, Chunk& chunk) {
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.chunks.empty()) {
+            chunk = own.chunks.front();
+            own.chunks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); i++) {
+        Queue& victim = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.chunks.empty()) {
+            chunk = victim.chunks.back();
+            victim.chunks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::run(const Chunk& chunk) {
+    Batch& batch = *chunk.batch;
+    try {
+        (*batch.body)(chunk.begin, chunk.end);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(batch.mutex);
+        if (!batch.failure) batch.failure = std::current_exception();
+    }
+    // Count down and notify in one hold of the mutex: parallelFor may return
+    // and destroy the batch as soon as it sees zero and takes the mutex
+    std::lock_guard<std::mutex> lock(batch.mutex);
+    if (batch.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        batch.finished.notify_all();
+    }
+}
+
+void JobSystem::workerLoop(size_t self) {
+    Chunk chunk;
+    for (;;) {
+        if (take(self, chunk)) {
+            run(chunk);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        available.wait(lock, [this]() { return stopping || queued.load() > 0; });
+        if (stopping) return;
+    }
+}
+
+} // namespace space4x
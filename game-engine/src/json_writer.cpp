@@ -0,0 +1,131 @@
+#include "json_writer.h"
+#include <charconv>
+#include <cmath>
+
+namespace space4x {
+
+JsonWriter::JsonWriter(size_t reserveBytes, int digits) : significantDigits(digits) {
+    out.reserve(reserveBytes);
+}
+
+void JsonWriter::separate() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (!firstInScope.empty()) {
+        if (!firstInScope.back()) out.push_back(',');
+        firstInScope.back() = false;
+    }
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    out.push_back('{');
+    firstInScope.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    out.push_back('}');
+    firstInScope.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    out.push_back('[');
+    firstInScope.push_back(true);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    out.push_back(']');
+    firstInScope.pop_back();
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    value(name);
+    out.push_back(':');
+    afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+
+    separate();
+    out.push_back('"');
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        // Copy the clean run before the character that needs escaping
+        out.append(text.data() + runStart, i - runStart);
+        runStart = i + 1;
+        switch (c) {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                out.append("\\u00");
+                out.push_back(hex[c >> 4]);
+                out.push_back(hex[c & 0xF]);
+        }
+    }
+    out.append(text.data() + runStart, text.size() - runStart);
+    out.push_back('"');
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    if (!std::isfinite(number)) return null();  // JSON has no NaN/Infinity
+
+    separate();
+    char buffer[32];
+    auto result = significantDigits > 0
+        ? std::to_chars(buffer, buffer + sizeof(buffer), number, std::chars_format::general, significantDigits)
+        : std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out.append(buffer, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(long long number) {
+    separate();
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out.append(buffer, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(unsigned long long number) {
+    separate();
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out.append(buffer, result.ptr);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    out.append(flag ? "true" : "false");
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    out.append("null");
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json) {
+    separate();
+    out.append(json.data(), json.size());
+    return *this;
+}
+
+} // namespace space4x
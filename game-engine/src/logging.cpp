@@ -0,0 +1,50 @@
+#include "logging.h"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+
+namespace space4x {
+
+namespace {
+
+std::atomic<int> currentLevel(static_cast<int>(LogLevel::Debug));
+
+struct NullBuffer : std::streambuf {
+    int overflow(int c) override { return c; }
+};
+
+} // namespace
+
+bool parseLogLevel(const std::string& name, LogLevel& level) {
+    if (name == "error") {
+        level = LogLevel::Error;
+    } else if (name == "info") {
+        level = LogLevel::Info;
+    } else if (name == "debug") {
+        level = LogLevel::Debug;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void setLogLevel(LogLevel level) {
+    static std::mutex mutex;
+    static NullBuffer nullBuffer;
+    static std::streambuf* console = nullptr;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    currentLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+    if (level == LogLevel::Error && !console) {
+        console = std::cout.rdbuf(&nullBuffer);
+    } else if (level != LogLevel::Error && console) {
+        std::cout.rdbuf(console);
+        console = nullptr;
+    }
+}
+
+LogLevel logLevel() {
+    return static_cast<LogLevel>(currentLevel.load(std::memory_order_relaxed));
+}
+
+} // namespace space4x
@@ -3,9 +3,16 @@
 #include <chrono>
 #include <thread>
 #include <csignal>
+#include <cstdlib>
 #include "galaxy.h"
 #include "http_server.h"
 #include "backend_server.h"
+#include "logging.h"
+#include "batch_runner.h"
+
+// Database the service uses; batch mode writes there unless --db-conninfo says otherwise
+const char* const kDefaultConnectionInfo =
+    "host=localhost port=5432 dbname=space4x_game user=space4x_user password=space4x_dev_password";
 
 // Global server instance for signal handling
 space4x::BackendServer* global_server = nullptr;
@@ -50,12 +57,39 @@ void runAsService() {
 }
 
 int main(int argc, char* argv[]) {
-    if (argc > 1 && std::string(argv[1]) == "--mode" && argc > 2 && std::string(argv[2]) == "service") {
+    // Console verbosity: --log-level wins over SPACE4X_LOG_LEVEL
+    space4x::LogLevel level = space4x::LogLevel::Debug;
+    const char* levelEnv = std::getenv("SPACE4X_LOG_LEVEL");
+    if (levelEnv && !space4x::parseLogLevel(levelEnv, level)) {
+        std::cerr << "⚠️  Ignoring SPACE4X_LOG_LEVEL=" << levelEnv << " (expected error, info or debug)" << std::endl;
+    }
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) == "--log-level" && !space4x::parseLogLevel(argv[i + 1], level)) {
+            std::cerr << "❌ Unknown log level " << argv[i + 1] << " (expected error, info or debug)" << std::endl;
+            return 1;
+        }
+    }
+    space4x::setLogLevel(level);
+    
+    std::string mode = argc > 2 && std::string(argv[1]) == "--mode" ? argv[2] : "";
+    if (mode == "service") {
         runAsService();
+    } else if (mode == "batch") {
+        space4x::BatchOptions options;
+        options.connectionInfo = kDefaultConnectionInfo;
+        std::string error;
+        if (!space4x::parseBatchOptions(argc, argv, options, error)) {
+            std::cerr << "❌ " << error << std::endl;
+            return 2;
+        }
+        return space4x::runBatch(options);
     } else {
         std::cout << "🎮 Space 4X Game Engine" << std::endl;
-        std::cout << "Usage: " << argv[0] << " --mode service" << std::endl;
-        std::cout << "Or run without arguments for single execution" << std::endl;
+        std::cout << "Usage: " << argv[0] << " --mode service [--log-level error|info|debug]" << std::endl;
+        std::cout << "       " << argv[0] << " --mode batch (--seeds A-B | --config FILE)... (--out DIR | --db)" << std::endl;
+        std::cout << "             [--template FILE] [--format snapshot|json] [--user NAME] [--slot N]" << std::endl;
+        std::cout << "             [--threads N] [--db-conninfo STRING] [--log-level error|info|debug]" << std::endl;
+        std::cout << "Batch mode pre-bakes galaxies offline; see include/batch_runner.h" << std::endl;
     }
     
     return 0;
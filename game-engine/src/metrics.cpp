@@ -0,0 +1,166 @@
+#include "metrics.h"
+#include <cstdio>
+
+namespace space4x {
+
+const double MetricsRegistry::kBucketBounds[MetricsRegistry::kBucketCount] = {
+    0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5
+};
+
+namespace {
+
+// Single writer per slot, so a relaxed load and store is enough (no locked add)
+inline void bump(std::atomic<uint64_t>& slot, uint64_t amount) {
+    slot.store(slot.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void appendNumber(std::string& out, double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    out += buffer;
+}
+
+// name{labels} or name{labels,extra}, without braces when both are empty
+void appendSeriesName(std::string& out, const std::string& name, const std::string& labels,
+                      const std::string& extra = "") {
+    out += name;
+    if (labels.empty() && extra.empty()) return;
+    out += '{';
+    out += labels;
+    if (!labels.empty() && !extra.empty()) out += ',';
+    out += extra;
+    out += '}';
+}
+
+} // namespace
+
+// ============================================================================
+// METRICS REGISTRY
+// ============================================================================
+
+MetricsRegistry::Shard::Shard() {
+    for (auto& slot : slots) slot.store(0, std::memory_order_relaxed);
+}
+
+MetricsRegistry& MetricsRegistry::global() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricId MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    return registerSeries(name, help, labels, Kind::Counter);
+}
+
+MetricId MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::string& labels) {
+    return registerSeries(name, help, labels, Kind::Histogram);
+}
+
+MetricId MetricsRegistry::registerSeries(const std::string& name, const std::string& help,
+                                         const std::string& labels, Kind kind) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < series.size(); i++) {
+        if (series[i].name == name && series[i].labels == labels) return static_cast<MetricId>(i);
+    }
+    if (series.size() >= kMaxSeries) return static_cast<MetricId>(kMaxSeries);
+    series.push_back({name, help, labels, kind});
+    return static_cast<MetricId>(series.size() - 1);
+}
+
+MetricsRegistry::Shard& MetricsRegistry::localShard() {
+    thread_local Shard* shard = nullptr;
+    if (!shard) {
+        std::lock_guard<std::mutex> lock(mutex);
+        shards.emplace_back(new Shard());
+        shard = shards.back().get();
+    }
+    return *shard;
+}
+
+void MetricsRegistry::add(MetricId counter, uint64_t amount) {
+    if (counter >= kMaxSeries) return;
+    bump(localShard().slots[counter * kSlotsPerSeries], amount);
+}
+
+void MetricsRegistry::observe(MetricId histogram, double seconds) {
+    if (histogram >= kMaxSeries) return;
+    std::atomic<uint64_t>* slots = localShard().slots + histogram * kSlotsPerSeries;
+    bump(slots[0], 1);
+    bump(slots[1], static_cast<uint64_t>(seconds > 0.0 ? seconds * 1e9 : 0.0));
+    for (size_t b = 0; b < kBucketCount; b++) {
+        if (seconds <= kBucketBounds[b]) {
+            bump(slots[2 + b], 1);
+            break;
+        }
+    }
+}
+
+std::string MetricsRegistry::render() const {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Totals over every shard, per series
+    std::vector<uint64_t> totals(series.size() * kSlotsPerSeries, 0);
+    for (const auto& shard : shards) {
+        for (size_t i = 0; i < totals.size(); i++) {
+            totals[i] += shard->slots[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    // Series of one family are written together, families in registration order
+    std::string out;
+    out.reserve(series.size() * 256);
+    std::vector<bool> written(series.size(), false);
+    for (size_t first = 0; first < series.size(); first++) {
+        if (written[first]) continue;
+        const Series& family = series[first];
+        out += "# HELP " + family.name + " " + family.help + "\n";
+        out += "# TYPE " + family.name + (family.kind == Kind::Counter ? " counter\n" : " histogram\n");
+
+        for (size_t i = first; i < series.size(); i++) {
+            if (written[i] || series[i].name != family.name) continue;
+            written[i] = true;
+            const uint64_t* slots = totals.data() + i * kSlotsPerSeries;
+            const std::string& labels = series[i].labels;
+            if (family.kind == Kind::Counter) {
+                appendSeriesName(out, family.name, labels);
+                out += ' ' + std::to_string(slots[0]) + '\n';
+                continue;
+            }
+
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b < kBucketCount; b++) {
+                cumulative += slots[2 + b];
+                std::string bound = "le=\"";
+                appendNumber(bound, kBucketBounds[b]);
+                appendSeriesName(out, family.name + "_bucket", labels, bound + "\"");
+                out += ' ' + std::to_string(cumulative) + '\n';
+            }
+            appendSeriesName(out, family.name + "_bucket", labels, "le=\"+Inf\"");
+            out += ' ' + std::to_string(slots[0]) + '\n';
+            appendSeriesName(out, family.name + "_sum", labels);
+            out += ' ';
+            appendNumber(out, slots[1] / 1e9);
+            out += '\n';
+            appendSeriesName(out, family.name + "_count", labels);
+            out += ' ' + std::to_string(slots[0]) + '\n';
+        }
+    }
+    return out;
+}
+
+std::string metricLabel(const std::string& name, const std::string& value) {
+    std::string label = name + "=\"";
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            label += '\\';
+            label += c;
+        } else if (c == '\n') {
+            label += "\\n";
+        } else {
+            label += c;
+        }
+    }
+    label += '"';
+    return label;
+}
+
+} // namespace space4x
@@ -0,0 +1,321 @@
+#include "route_planner.h"
+#include "logging.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <queue>
+
+namespace space4x {
+
+namespace {
+
+const size_t kMaxCachedRoutes = 1 << 16;  // Beyond this the memo starts over
+const size_t kSharedSearchTargets = 3;    // Batch origins with this many targets get one Dijkstra
+
+typedef std::pair<double, uint32_t> QueueEntry;  // (priority, system)
+typedef std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> MinQueue;
+
+// Per-thread search arrays, reused across queries. Entries are valid only
+// when stamped with the current epoch, so a reset costs nothing.
+struct SearchState {
+    std::vector<double> cost;
+    std::vector<uint32_t> parent;
+    std::vector<uint32_t> via;  // Lane slot used to reach the system
+    std::vector<uint32_t> reached;
+    std::vector<uint32_t> closed;
+    uint32_t epoch = 0;
+
+    void reset(size_t count) {
+        if (cost.size() < count || ++epoch == 0) {
+            cost.assign(count, 0.0);
+            parent.assign(count, 0);
+            via.assign(count, 0);
+            reached.assign(count, 0);
+            closed.assign(count, 0);
+            epoch = 1;
+        }
+    }
+    bool isReached(uint32_t v) const { return reached[v] == epoch; }
+    bool isClosed(uint32_t v) const { return closed[v] == epoch; }
+};
+
+uint64_t routeKey(uint32_t from, uint32_t to, RouteMetric metric) {
+    return (static_cast<uint64_t>(from) << 33) | (static_cast<uint64_t>(to) << 1) | static_cast<uint64_t>(metric);
+}
+
+SearchState& searchState() {
+    thread_local SearchState state;
+    return state;
+}
+
+// Plain Dijkstra over lane lengths to every system
+void laneDistancesFrom(const GalaxyGeometry& geometry, uint32_t source, double* out) {
+    const size_t count = geometry.size();
+    std::fill(out, out + count, INFINITY);
+    MinQueue frontier;
+    out[source] = 0.0;
+    frontier.push({0.0, source});
+    while (!frontier.empty()) {
+        QueueEntry top = frontier.top();
+        frontier.pop();
+        if (top.first > out[top.second]) continue;
+        for (uint32_t slot = geometry.laneOffsets[top.second]; slot < geometry.laneOffsets[top.second + 1]; slot++) {
+            uint32_t next = geometry.laneTargets[slot];
+            double cost = top.first + geometry.laneDistances[slot];
+            if (cost < out[next]) {
+                out[next] = cost;
+                frontier.push({cost, next});
+            }
+        }
+    }
+}
+
+// Walks the search tree back from to; both totals come from the lanes taken
+std::shared_ptr<const Route> tracePath(const SearchState& state, const GalaxyGeometry& geometry,
+                                       const std::vector<int>& laneTimes, uint32_t from, uint32_t to) {
+    auto route = std::make_shared<Route>();
+    if (!state.isReached(to)) return route;
+
+    route->found = true;
+    for (uint32_t at = to; ; at = state.parent[at]) {
+        route->path.push_back(at);
+        if (at == from) break;
+        route->distance += geometry.laneDistances[state.via[at]];
+        route->travelTime += laneTimes[state.via[at]];
+    }
+    std::reverse(route->path.begin(), route->path.end());
+    return route;
+}
+
+} // namespace
+
+// ============================================================================
+// LANDMARKS
+// ============================================================================
+
+std::shared_ptr<const RouteLandmarks> RouteLandmarks::build(const GalaxyGeometry& geometry, size_t count) {
+    auto tables = std::make_shared<RouteLandmarks>();
+    const size_t systems = geometry.size();
+    tables->systemCount = systems;
+    if (systems == 0 || !geometry.hasLanes()) return tables;
+
+    count = std::min(count, systems);
+    tables->systems.reserve(count);
+    tables->distances.resize(count * systems);
+
+    // nearest[v]: lane distance from v to the closest landmark so far
+    std::vector<double> nearest(systems, INFINITY);
+    std::vector<double> scratch(systems);
+    laneDistancesFrom(geometry, 0, scratch.data());
+    for (size_t l = 0; l < count; l++) {
+        // Farthest reachable system from everything chosen (or from system 0 at first)
+        const std::vector<double>& from = l == 0 ? scratch : nearest;
+        uint32_t next = 0;
+        double farthest = -1.0;
+        for (uint32_t v = 0; v < systems; v++) {
+            if (std::isfinite(from[v]) && from[v] > farthest) {
+                farthest = from[v];
+                next = v;
+            }
+        }
+        if (farthest <= 0.0 && l > 0) break;  // Every system already is a landmark
+
+        double* row = tables->distances.data() + l * systems;
+        laneDistancesFrom(geometry, next, row);
+        tables->systems.push_back(next);
+        for (size_t v = 0; v < systems; v++) nearest[v] = std::min(nearest[v], row[v]);
+    }
+    tables->distances.resize(tables->systems.size() * systems);
+    return tables;
+}
+
+double RouteLandmarks::lowerBound(uint32_t from, uint32_t to) const {
+    double best = 0.0;
+    for (size_t l = 0; l < systems.size(); l++) {
+        const double* row = distances.data() + l * systemCount;
+        double a = row[from];
+        double b = row[to];
+        if (std::isfinite(a) && std::isfinite(b)) best = std::max(best, std::fabs(a - b));
+    }
+    return best;
+}
+
+// ============================================================================
+// ROUTE PLANNER
+// ============================================================================
+
+RoutePlanner::RoutePlanner(std::shared_ptr<const Galaxy> galaxy) : source(std::move(galaxy)) {
+    const GalaxyGeometry& geometry = source->geometry;
+    laneTimes.reserve(geometry.laneDistances.size());
+    for (double distance : geometry.laneDistances) {
+        laneTimes.push_back(laneTravelTime(distance));
+    }
+    if (source->landmarks && source->landmarks->systemCount == geometry.size()) {
+        landmarks = source->landmarks;
+    }
+}
+
+const RouteLandmarks& RoutePlanner::tables() {
+    std::call_once(landmarksBuilt, [this]() {
+        if (landmarks) return;
+        landmarks = RouteLandmarks::build(source->geometry);
+        if (logEnabled(LogLevel::Info)) {
+            std::cout << "🧭 Built " << landmarks->systems.size() << " route landmarks for "
+                      << landmarks->systemCount << " systems\n";
+        }
+    });
+    return *landmarks;
+}
+
+double RoutePlanner::weight(size_t slot, RouteMetric metric) const {
+    return metric == RouteMetric::TravelTime ? laneTimes[slot] : source->geometry.laneDistances[slot];
+}
+
+double RoutePlanner::heuristic(const RouteLandmarks& tables, uint32_t from, uint32_t to, RouteMetric metric) const {
+    double bound = std::max(source->geometry.distance(from, to), tables.lowerBound(from, to));
+    // No lane takes less than its length at warp speed
+    return metric == RouteMetric::TravelTime ? bound / kLightYearsPerTurn : bound;
+}
+
+std::shared_ptr<const Route> RoutePlanner::route(uint32_t from, uint32_t to, RouteMetric metric) {
+    uint64_t key = routeKey(from, to, metric);
+    std::shared_ptr<const Route> found = cached(key);
+    if (found) return found;
+
+    found = search(from, to, metric);
+    remember(key, found);
+    return found;
+}
+
+std::vector<std::shared_ptr<const Route>> RoutePlanner::routes(const std::vector<Query>& queries, RouteMetric metric) {
+    std::vector<std::shared_ptr<const Route>> answers(queries.size());
+
+    // Uncached queries grouped by origin, in first-seen order
+    std::vector<uint32_t> origins;
+    std::unordered_map<uint32_t, std::vector<size_t>> byOrigin;
+    for (size_t i = 0; i < queries.size(); i++) {
+        answers[i] = cached(routeKey(queries[i].first, queries[i].second, metric));
+        if (answers[i]) continue;
+        auto& group = byOrigin[queries[i].first];
+        if (group.empty()) origins.push_back(queries[i].first);
+        group.push_back(i);
+    }
+
+    for (uint32_t origin : origins) {
+        const std::vector<size_t>& group = byOrigin[origin];
+        if (group.size() < kSharedSearchTargets) {
+            for (size_t i : group) answers[i] = route(queries[i].first, queries[i].second, metric);
+            continue;
+        }
+
+        std::vector<uint32_t> targets;
+        for (size_t i : group) targets.push_back(queries[i].second);
+        std::sort(targets.begin(), targets.end());
+        targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+
+        std::vector<std::shared_ptr<const Route>> found;
+        searchFrom(origin, targets, metric, found);
+        for (size_t t = 0; t < targets.size(); t++) {
+            remember(routeKey(origin, targets[t], metric), found[t]);
+        }
+        for (size_t i : group) {
+            size_t t = std::lower_bound(targets.begin(), targets.end(), queries[i].second) - targets.begin();
+            answers[i] = found[t];
+        }
+    }
+    return answers;
+}
+
+size_t RoutePlanner::cachedRoutes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return cache.size();
+}
+
+std::shared_ptr<const Route> RoutePlanner::cached(uint64_t key) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(key);
+    return it == cache.end() ? nullptr : it->second;
+}
+
+void RoutePlanner::remember(uint64_t key, const std::shared_ptr<const Route>& route) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cache.size() >= kMaxCachedRoutes) cache.clear();
+    cache.emplace(key, route);
+}
+
+std::shared_ptr<const Route> RoutePlanner::search(uint32_t from, uint32_t to, RouteMetric metric) {
+    const GalaxyGeometry& geometry = source->geometry;
+    const RouteLandmarks& bounds = tables();
+    SearchState& state = searchState();
+    state.reset(geometry.size());
+
+    // The heuristic is consistent, so a system's cost is final once it is closed
+    MinQueue frontier;
+    state.cost[from] = 0.0;
+    state.reached[from] = state.epoch;
+    frontier.push({heuristic(bounds, from, to, metric), from});
+    while (!frontier.empty()) {
+        uint32_t current = frontier.top().second;
+        frontier.pop();
+        if (state.isClosed(current)) continue;
+        state.closed[current] = state.epoch;
+        if (current == to) break;
+
+        for (uint32_t slot = geometry.laneOffsets[current]; slot < geometry.laneOffsets[current + 1]; slot++) {
+            uint32_t next = geometry.laneTargets[slot];
+            if (state.isClosed(next)) continue;
+            double cost = state.cost[current] + weight(slot, metric);
+            if (state.isReached(next) && cost >= state.cost[next]) continue;
+            state.cost[next] = cost;
+            state.parent[next] = current;
+            state.via[next] = slot;
+            state.reached[next] = state.epoch;
+            frontier.push({cost + heuristic(bounds, next, to, metric), next});
+        }
+    }
+    return tracePath(state, geometry, laneTimes, from, to);
+}
+
+void RoutePlanner::searchFrom(uint32_t from, const std::vector<uint32_t>& targets, RouteMetric metric,
+                              std::vector<std::shared_ptr<const Route>>& found) {
+    const GalaxyGeometry& geometry = source->geometry;
+    SearchState& state = searchState();
+    state.reset(geometry.size());
+
+    std::vector<char> wanted(geometry.size(), 0);
+    for (uint32_t target : targets) wanted[target] = 1;
+    size_t remaining = targets.size();
+
+    // Dijkstra until every target is settled
+    MinQueue frontier;
+    state.cost[from] = 0.0;
+    state.reached[from] = state.epoch;
+    frontier.push({0.0, from});
+    while (!frontier.empty() && remaining > 0) {
+        uint32_t current = frontier.top().second;
+        frontier.pop();
+        if (state.isClosed(current)) continue;
+        state.closed[current] = state.epoch;
+        if (wanted[current]) remaining--;
+
+        for (uint32_t slot = geometry.laneOffsets[current]; slot < geometry.laneOffsets[current + 1]; slot++) {
+            uint32_t next = geometry.laneTargets[slot];
+            if (state.isClosed(next)) continue;
+            double cost = state.cost[current] + weight(slot, metric);
+            if (state.isReached(next) && cost >= state.cost[next]) continue;
+            state.cost[next] = cost;
+            state.parent[next] = current;
+            state.via[next] = slot;
+            state.reached[next] = state.epoch;
+            frontier.push({cost, next});
+        }
+    }
+
+    found.clear();
+    for (uint32_t target : targets) {
+        found.push_back(tracePath(state, geometry, laneTimes, from, target));
+    }
+}
+
+} // namespace space4x
@@ -0,0 +1,177 @@
+#include "session_store.h"
+#include "metrics.h"
+#include <algorithm>
+#include <vector>
+
+namespace space4x {
+
+// ============================================================================
+// GALAXY SESSION
+// ============================================================================
+
+std::shared_ptr<const GalaxySession> GalaxySession::create(std::shared_ptr<const Galaxy> galaxy) {
+    auto session = std::make_shared<GalaxySession>();
+    session->details = std::make_shared<SystemDetailCache>(galaxy->systems.size());
+    session->routes = std::make_shared<RoutePlanner>(galaxy);
+    session->tiles = std::make_shared<GalaxyTileIndex>(galaxy);
+    session->galaxy = std::move(galaxy);
+    return session;
+}
+
+std::shared_ptr<const GalaxySession> GalaxySession::edited(std::shared_ptr<const Galaxy> galaxy,
+                                                           const GalaxyDelta& delta) const {
+    auto session = std::make_shared<GalaxySession>(*this);
+    if (delta.changesSystems()) {
+        session->details = std::make_shared<SystemDetailCache>(galaxy->systems.size());
+    }
+    if (delta.changesSystems() || !delta.lanesAdded.empty() || !delta.lanesRemoved.empty()) {
+        session->routes = std::make_shared<RoutePlanner>(galaxy);
+        session->tiles = std::make_shared<GalaxyTileIndex>(galaxy);
+    }
+    session->galaxy = std::move(galaxy);
+    if (simulation) session->simulation = simulation->rebased(session->galaxy);
+    return session;
+}
+
+std::shared_ptr<const GalaxySession> GalaxySession::withSimulation() const {
+    auto session = std::make_shared<GalaxySession>(*this);
+    session->simulation = std::make_shared<GalaxySimulation>(galaxy);
+    return session;
+}
+
+// ============================================================================
+// SESSION STORE
+// ============================================================================
+
+GalaxySessionStore::GalaxySessionStore(size_t maxSessions, std::chrono::seconds idleTimeout)
+    : maxSessions(maxSessions),
+      idleMillis(std::chrono::duration_cast<std::chrono::milliseconds>(idleTimeout).count()) {}
+
+size_t GalaxySessionStore::KeyHash::operator()(const Key& key) const {
+    return std::hash<std::string>()(key.first) * 31 + std::hash<int>()(key.second);
+}
+
+int64_t GalaxySessionStore::nowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::shared_ptr<const GalaxySession> GalaxySessionStore::find(const Key& key) {
+    Shard& shard = shardFor(key);
+    std::shared_ptr<Entry> entry;
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) return nullptr;
+        entry = it->second;
+    }
+    entry->lastUsed.store(nowMillis(), std::memory_order_relaxed);
+    return std::atomic_load(&entry->session);
+}
+
+std::shared_ptr<GalaxySessionStore::Entry> GalaxySessionStore::acquire(const Key& key) {
+    Shard& shard = shardFor(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end()) return it->second;
+    }
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    std::shared_ptr<Entry>& entry = shard.entries[key];
+    if (!entry) {
+        entry = std::make_shared<Entry>();
+        entry->lastUsed.store(nowMillis(), std::memory_order_relaxed);
+    }
+    return entry;
+}
+
+void GalaxySessionStore::install(const Key& key, Entry& entry, std::shared_ptr<const GalaxySession> session) {
+    entry.lastUsed.store(nowMillis(), std::memory_order_relaxed);
+    bool wasResident = std::atomic_load(&entry.session) != nullptr;
+    if (session) {
+        if (!wasResident) resident.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_store(&entry.session, std::move(session));
+        return;
+    }
+
+    // Dropped: later updates start from a fresh entry
+    if (wasResident) resident.fetch_sub(1, std::memory_order_relaxed);
+    std::atomic_store(&entry.session, std::shared_ptr<const GalaxySession>());
+    entry.evicted = true;
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.entries.erase(key);
+}
+
+size_t GalaxySessionStore::evict() {
+    struct Candidate {
+        Key key;
+        int64_t lastUsed;
+    };
+    const int64_t now = nowMillis();
+    std::vector<Candidate> idle;
+    std::vector<Candidate> active;
+    for (Shard& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        for (const auto& item : shard.entries) {
+            int64_t lastUsed = item.second->lastUsed.load(std::memory_order_relaxed);
+            (now - lastUsed > idleMillis ? idle : active).push_back({item.first, lastUsed});
+        }
+    }
+
+    // Past the cap, the least recently used of the rest go too
+    if (active.size() > maxSessions) {
+        size_t excess = active.size() - maxSessions;
+        std::partial_sort(active.begin(), active.begin() + excess, active.end(),
+                          [](const Candidate& a, const Candidate& b) { return a.lastUsed < b.lastUsed; });
+        idle.insert(idle.end(), active.begin(), active.begin() + excess);
+    }
+
+    size_t evicted = 0;
+    for (const Candidate& candidate : idle) {
+        Shard& shard = shardFor(candidate.key);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(candidate.key);
+        if (it == shard.entries.end()) continue;
+
+        // try_lock: update() locks the entry before the shard, so waiting here could deadlock
+        std::shared_ptr<Entry> entry = it->second;  // Outlives the erase below
+        std::unique_lock<std::mutex> entryLock(entry->mutex, std::try_to_lock);
+        if (!entryLock.owns_lock()) continue;
+        if (std::atomic_load(&entry->session)) {
+            resident.fetch_sub(1, std::memory_order_relaxed);
+            evicted++;
+        }
+        std::atomic_store(&entry->session, std::shared_ptr<const GalaxySession>());
+        entry->evicted = true;
+        shard.entries.erase(it);
+    }
+    static const MetricId evictions =
+        MetricsRegistry::global().counter("space4x_sessions_evicted_total", "Galaxy sessions dropped from memory");
+    MetricsRegistry::global().add(evictions, evicted);
+    return evicted;
+}
+
+void GalaxySessionStore::setActiveSlot(const std::string& user, int slot) {
+    std::lock_guard<std::mutex> lock(activeMutex);
+    activeSlots[user] = {slot, ++activeUses};
+
+    // Trimmed in batches, so the sort is paid once per quarter of the cap
+    if (activeSlots.size() <= maxSessions + maxSessions / 4) return;
+    std::vector<std::pair<uint64_t, std::string>> byUse;
+    byUse.reserve(activeSlots.size());
+    for (const auto& item : activeSlots) byUse.emplace_back(item.second.lastUsed, item.first);
+    size_t excess = activeSlots.size() - maxSessions;
+    std::partial_sort(byUse.begin(), byUse.begin() + excess, byUse.end());
+    for (size_t i = 0; i < excess; i++) activeSlots.erase(byUse[i].second);
+}
+
+int GalaxySessionStore::activeSlot(const std::string& user) {
+    std::lock_guard<std::mutex> lock(activeMutex);
+    auto it = activeSlots.find(user);
+    if (it == activeSlots.end()) return 1;
+    it->second.lastUsed = ++activeUses;
+    return it->second.slot;
+}
+
+} // namespace space4x
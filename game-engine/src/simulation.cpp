@@ -0,0 +1,349 @@
+#include "simulation.h"
+#include "json_writer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace space4x {
+
+namespace {
+
+// Systems and fleets per job; a tick over 100k systems is a few dozen chunks
+const size_t kSystemGrain = 4096;
+const size_t kFleetGrain = 512;
+
+// Population: logistic growth per tick towards a capacity from the system's
+// bodies, and a share of the difference to each explored lane neighbour
+const double kGrowthRate = 0.002;
+const int64_t kBaseCapacity = 5000000;
+const int64_t kCapacityPerPlanet = 20000000;
+const int64_t kCapacityPerMoon = 2000000;
+const double kMigrationRate = 0.001;
+
+// Economy: output per head, plus a share of the smaller gdp of each
+// populated neighbour as trade; stockpiles grow by one unit per 100k people
+const double kOutputPerHead = 1.0;
+const double kTradeShare = 0.02;
+const int64_t kPeoplePerUnit = 100000;
+const int32_t kMaxStockpile = 1000000000;
+const size_t kMaxFleetIdLength = 64;
+
+int32_t stockpile(int32_t current, int64_t added) {
+    return static_cast<int32_t>(std::min<int64_t>(static_cast<int64_t>(current) + added, kMaxStockpile));
+}
+
+} // namespace
+
+void EconomyState::resize(size_t count) {
+    population.resize(count);
+    gdp.resize(count);
+    minerals.resize(count);
+    energy.resize(count);
+    research.resize(count);
+}
+
+// ============================================================================
+// SIMULATION
+// ============================================================================
+
+GalaxySimulation::GalaxySimulation(std::shared_ptr<const Galaxy> galaxy) : source(std::move(galaxy)) {
+    const CowVector<StarSystem>& systems = source->systems;
+    for (EconomyState& buffer : state) buffer.resize(systems.size());
+    EconomyState& now = state[current];
+    for (size_t i = 0; i < systems.size(); i++) {
+        now.population[i] = systems[i].population;
+        now.gdp[i] = systems[i].gdp;
+        now.minerals[i] = systems[i].resources.minerals;
+        now.energy[i] = systems[i].resources.energy;
+        now.research[i] = systems[i].resources.research;
+    }
+    prepare();
+}
+
+void GalaxySimulation::prepare() {
+    const CowVector<StarSystem>& systems = source->systems;
+    capacity.resize(systems.size());
+    explored.resize(systems.size());
+    for (size_t i = 0; i < systems.size(); i++) {
+        capacity[i] = kBaseCapacity + kCapacityPerPlanet * systems[i].systemInfo.planetCount +
+                      kCapacityPerMoon * systems[i].systemInfo.moonCount;
+        explored[i] = systems[i].explored ? 1 : 0;
+    }
+}
+
+std::shared_ptr<GalaxySimulation> GalaxySimulation::rebased(std::shared_ptr<const Galaxy> galaxy) const {
+    auto next = std::make_shared<GalaxySimulation>(std::move(galaxy));
+    next->ticks = ticks;
+
+    const Galaxy& edited = *next->source;
+    const EconomyState& from = state[current];
+    EconomyState& to = next->state[next->current];
+    for (size_t i = 0; i < edited.systems.size(); i++) {
+        int64_t old = source->findSystemIndex(edited.systems[i].id);
+        if (old < 0) continue;  // Added by the edit: starts from its record
+        to.population[i] = from.population[old];
+        to.gdp[i] = from.gdp[old];
+        to.minerals[i] = from.minerals[old];
+        to.energy[i] = from.energy[old];
+        to.research[i] = from.research[old];
+    }
+
+    for (const Fleet& fleet : fleetList) {
+        int64_t system = edited.findSystemIndex(source->systems[fleet.system].id);
+        if (system < 0) continue;
+
+        Fleet moved;
+        moved.id = fleet.id;
+        moved.system = static_cast<uint32_t>(system);
+        moved.turnsLeft = fleet.turnsLeft;
+        uint32_t previous = moved.system;
+        for (uint32_t stop : fleet.path) {
+            int64_t index = edited.findSystemIndex(source->systems[stop].id);
+            if (index < 0 || next->laneTurns(previous, static_cast<uint32_t>(index)) == 0) {
+                moved.path.clear();
+                moved.turnsLeft = 0;
+                break;
+            }
+            moved.path.push_back(static_cast<uint32_t>(index));
+            previous = static_cast<uint32_t>(index);
+        }
+        next->fleetIndex[moved.id] = next->fleetList.size();
+        next->fleetList.push_back(std::move(moved));
+    }
+    return next;
+}
+
+const Fleet* GalaxySimulation::findFleet(const std::string& id) const {
+    auto it = fleetIndex.find(id);
+    return it != fleetIndex.end() ? &fleetList[it->second] : nullptr;
+}
+
+int GalaxySimulation::laneTurns(uint32_t from, uint32_t to) const {
+    const GalaxyGeometry& geometry = source->geometry;
+    for (uint32_t slot = geometry.laneOffsets[from]; slot < geometry.laneOffsets[from + 1]; slot++) {
+        if (geometry.laneTargets[slot] == to) return laneTravelTime(geometry.laneDistances[slot]);
+    }
+    return 0;
+}
+
+bool GalaxySimulation::orderFleet(const std::string& id, const std::string& from, const std::string& to,
+                                  RoutePlanner& routes, std::string& error) {
+    if (id.empty() || id.size() > kMaxFleetIdLength) {
+        error = "Fleet id must be 1-" + std::to_string(kMaxFleetIdLength) + " characters";
+        return false;
+    }
+    int64_t destination = source->findSystemIndex(to);
+    if (destination < 0) {
+        error = "Unknown destination system: " + to;
+        return false;
+    }
+
+    auto existing = fleetIndex.find(id);
+    Fleet* fleet = existing != fleetIndex.end() ? &fleetList[existing->second] : nullptr;
+    int64_t start;
+    if (fleet) {
+        // In transit: the current lane is finished before the new route starts
+        start = fleet->path.empty() ? fleet->system : fleet->path.front();
+    } else {
+        if (fleetList.size() >= kMaxFleets) {
+            error = "Fleet limit of " + std::to_string(kMaxFleets) + " reached";
+            return false;
+        }
+        start = source->findSystemIndex(from);
+        if (start < 0) {
+            error = from.empty() ? "A new fleet needs \"from\"" : "Unknown system: " + from;
+            return false;
+        }
+    }
+
+    std::shared_ptr<const Route> route =
+        routes.route(static_cast<uint32_t>(start), static_cast<uint32_t>(destination), RouteMetric::TravelTime);
+    if (!route->found) {
+        error = "No route from " + source->systems[start].id + " to " + to;
+        return false;
+    }
+
+    if (!fleet) {
+        fleetIndex[id] = fleetList.size();
+        fleetList.emplace_back();
+        fleet = &fleetList.back();
+        fleet->id = id;
+        fleet->system = static_cast<uint32_t>(start);
+    }
+    bool inTransit = !fleet->path.empty();
+    std::vector<uint32_t> path;
+    if (inTransit) path.push_back(fleet->path.front());
+    path.insert(path.end(), route->path.begin() + 1, route->path.end());
+    fleet->path = std::move(path);
+    if (!inTransit) {
+        fleet->turnsLeft = fleet->path.empty() ? 0 : laneTurns(fleet->system, fleet->path.front());
+    }
+    return true;
+}
+
+TickDelta GalaxySimulation::tick(JobSystem& jobs) {
+    TickDelta delta;
+    delta.tick = ++ticks;
+
+    size_t systemCount = state[current].size();
+    systemChanges.resize((systemCount + kSystemGrain - 1) / kSystemGrain);
+    jobs.parallelFor(systemCount, kSystemGrain, [this](size_t begin, size_t end) {
+        stepSystems(begin, end, systemChanges[begin / kSystemGrain]);
+    });
+
+    fleetChanges.resize((fleetList.size() + kFleetGrain - 1) / kFleetGrain);
+    jobs.parallelFor(fleetList.size(), kFleetGrain, [this](size_t begin, size_t end) {
+        stepFleets(begin, end, fleetChanges[begin / kFleetGrain]);
+    });
+
+    // Every slot of the next buffer is written, so it simply becomes current
+    current = 1 - current;
+
+    for (const auto& changes : systemChanges) {
+        delta.systems.insert(delta.systems.end(), changes.begin(), changes.end());
+    }
+    for (const auto& changes : fleetChanges) {
+        delta.fleets.insert(delta.fleets.end(), changes.begin(), changes.end());
+    }
+    return delta;
+}
+
+void GalaxySimulation::stepSystems(size_t begin, size_t end, std::vector<TickDelta::SystemChange>& changes) {
+    const EconomyState& now = state[current];
+    EconomyState& next = state[1 - current];
+    const GalaxyGeometry& geometry = source->geometry;
+    changes.clear();
+
+    for (size_t i = begin; i < end; i++) {
+        int64_t population = now.population[i];
+        uint32_t degree = geometry.degree(static_cast<uint32_t>(i));
+
+        int64_t grown = population;
+        if (population > 0) {
+            double room = 1.0 - static_cast<double>(population) / static_cast<double>(capacity[i]);
+            grown += std::llround(population * kGrowthRate * room);
+        }
+
+        // Flows are a pure function of both ends' current values, so each end
+        // computes the same amount and population is conserved
+        double trade = 0.0;
+        for (const uint32_t* it = geometry.neighborsBegin(i); it != geometry.neighborsEnd(i); ++it) {
+            uint32_t j = *it;
+            int64_t other = now.population[j];
+            double share = kMigrationRate / std::max(degree, geometry.degree(j));
+            if (population > other && explored[j] && other < capacity[j]) {
+                grown -= static_cast<int64_t>(share * (population - other));
+            } else if (other > population && explored[i] && population < capacity[i]) {
+                grown += static_cast<int64_t>(share * (other - population));
+            }
+            if (population > 0 && other > 0) trade += kTradeShare * std::min(now.gdp[i], now.gdp[j]);
+        }
+
+        grown = std::max<int64_t>(grown, 0);
+        next.population[i] = grown;
+        next.gdp[i] = grown > 0 ? grown * kOutputPerHead + trade : 0.0;
+        int64_t produced = grown / kPeoplePerUnit;
+        next.minerals[i] = stockpile(now.minerals[i], produced);
+        next.energy[i] = stockpile(now.energy[i], produced);
+        next.research[i] = stockpile(now.research[i], produced / 2);
+
+        if (next.population[i] != population || next.gdp[i] != now.gdp[i] || next.minerals[i] != now.minerals[i] ||
+            next.energy[i] != now.energy[i] || next.research[i] != now.research[i]) {
+            changes.push_back({static_cast<uint32_t>(i), next.population[i], next.gdp[i],
+                               next.minerals[i], next.energy[i], next.research[i]});
+        }
+    }
+}
+
+void GalaxySimulation::stepFleets(size_t begin, size_t end, std::vector<TickDelta::FleetChange>& changes) {
+    changes.clear();
+    for (size_t f = begin; f < end; f++) {
+        Fleet& fleet = fleetList[f];
+        if (fleet.path.empty()) continue;
+
+        bool arrived = --fleet.turnsLeft <= 0;
+        if (arrived) {
+            fleet.system = fleet.path.front();
+            fleet.path.erase(fleet.path.begin());
+            fleet.turnsLeft = fleet.path.empty() ? 0 : laneTurns(fleet.system, fleet.path.front());
+        }
+        changes.push_back({f, fleet.system, fleet.turnsLeft, arrived});
+    }
+}
+
+// ============================================================================
+// SERIALIZATION
+// ============================================================================
+
+namespace {
+
+void writeEconomy(JsonWriter& json, const std::string& id, int64_t population, double gdp,
+                  int32_t minerals, int32_t energy, int32_t research) {
+    json.beginObject()
+        .field("id", id)
+        .field("population", static_cast<long long>(population))
+        .field("gdp", gdp);
+    json.key("resources").beginObject()
+        .field("minerals", minerals)
+        .field("energy", energy)
+        .field("research", research)
+        .endObject();
+    json.endObject();
+}
+
+void writeFleet(JsonWriter& json, const Galaxy& galaxy, const Fleet& fleet) {
+    json.beginObject()
+        .field("id", fleet.id)
+        .field("system", galaxy.systems[fleet.system].id)
+        .field("turnsLeft", fleet.turnsLeft);
+    json.key("path").beginArray();
+    for (uint32_t stop : fleet.path) json.value(galaxy.systems[stop].id);
+    json.endArray();
+}
+
+} // namespace
+
+void writeTickDelta(JsonWriter& json, const GalaxySimulation& simulation, const TickDelta& delta) {
+    const Galaxy& galaxy = simulation.galaxy();
+    json.beginObject().field("tick", static_cast<long long>(delta.tick));
+    json.key("systems").beginArray();
+    for (const auto& change : delta.systems) {
+        writeEconomy(json, galaxy.systems[change.system].id, change.population, change.gdp,
+                     change.minerals, change.energy, change.research);
+    }
+    json.endArray();
+    json.key("fleets").beginArray();
+    for (const auto& change : delta.fleets) {
+        const Fleet& fleet = simulation.fleets()[change.fleet];
+        json.beginObject()
+            .field("id", fleet.id)
+            .field("system", galaxy.systems[change.system].id)
+            .field("turnsLeft", change.turnsLeft)
+            .field("arrived", change.arrived)
+            .endObject();
+    }
+    json.endArray();
+    json.endObject();
+}
+
+std::string serializeSimulation(const GalaxySimulation& simulation) {
+    const Galaxy& galaxy = simulation.galaxy();
+    const EconomyState& economy = simulation.economy();
+    JsonWriter json(256 + economy.size() * 128 + simulation.fleets().size() * 96);
+    json.beginObject().field("tick", static_cast<long long>(simulation.tickCount()));
+    json.key("systems").beginArray();
+    for (size_t i = 0; i < economy.size(); i++) {
+        writeEconomy(json, galaxy.systems[i].id, economy.population[i], economy.gdp[i],
+                     economy.minerals[i], economy.energy[i], economy.research[i]);
+    }
+    json.endArray();
+    json.key("fleets").beginArray();
+    for (const Fleet& fleet : simulation.fleets()) {
+        writeFleet(json, galaxy, fleet);
+        json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+    return json.release();
+}
+
+} // namespace space4x
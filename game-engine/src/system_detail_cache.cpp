@@ -0,0 +1,41 @@
+#include "system_detail_cache.h"
+#include "galaxy_cache.h"
+
+namespace space4x {
+
+// ============================================================================
+// SYSTEM DETAIL CACHE
+// ============================================================================
+
+SystemDetailCache::SystemDetailCache(size_t systemCount)
+    : arena(systemCount * sizeof(Detail) + 64 * sizeof(SystemDefinition)),
+      definitions(&arena),
+      slots(systemCount, &arena) {}
+
+SystemDetailCache::Detail SystemDetailCache::lookup(uint32_t index) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return slots[index];
+}
+
+SystemDetailCache::Detail SystemDetailCache::store(uint32_t index, SystemDefinition&& definition, std::string&& json) {
+    std::string etag = computeEtag(json);
+    auto body = std::make_shared<const std::string>(std::move(json));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Detail& slot = slots[index];
+    if (!slot) {
+        definitions.push_back(std::move(definition));
+        slot.system = &definitions.back();
+        slot.json = std::move(body);
+        slot.etag = std::move(etag);
+        built++;
+    }
+    return slot;
+}
+
+size_t SystemDetailCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return built;
+}
+
+} // namespace space4x